@@ -22,12 +22,15 @@ by Almalence Inc. All Rights Reserved.
 #include <android/log.h>
 
 #include "ImageConversionUtils.h"
+#include "FrameHandle.h"
+#include "FramePool.h"
 
 #include "bestshot.h"
 
 #define MAX_BEST_FRAMES 10
 
 static unsigned char *yuv[MAX_BEST_FRAMES] = {NULL};
+static FrameHandle yuvHandle[MAX_BEST_FRAMES] = {0};
 static void *instance = NULL;
 static int almashot_inited = 0;
 
@@ -82,7 +85,7 @@ extern "C" JNIEXPORT jstring JNICALL Java_com_almalence_plugins_processing_bests
 (
 	JNIEnv* env,
 	jobject thiz,
-	jintArray in,
+	jlongArray in,
 	jintArray in_len,
 	jint nFrames,
 	jint sx,
@@ -91,19 +94,34 @@ extern "C" JNIEXPORT jstring JNICALL Java_com_almalence_plugins_processing_bests
 {
 	int i;
 	int *jpeg_length;
-	unsigned char * *jpeg;
+	jlong *handles;
+	unsigned char *jpeg[MAX_BEST_FRAMES];
 	char status[1024];
 
 	Uint8 *inp[4];
 	int x, y;
 	int x0_out, y0_out, w_out, h_out;
 
-	jpeg = (unsigned char**)env->GetIntArrayElements(in, NULL);
+	if (nFrames > MAX_BEST_FRAMES)
+		nFrames = MAX_BEST_FRAMES;
+
+	handles = env->GetLongArrayElements(in, NULL);
 	jpeg_length = (int*)env->GetIntArrayElements(in_len, NULL);
 
-	DecodeAndRotateMultipleJpegs(yuv, jpeg, jpeg_length, sx, sy, nFrames, 0, 0, 0, false);
+	for (i=0; i<nFrames; ++i)
+		if ((jpeg[i] = (unsigned char*)FrameHandle_Data(handles[i], jpeg_length[i])) == NULL)
+			break;
+
+	if (i == nFrames)
+	{
+		DecodeAndRotateMultipleJpegs(yuv, jpeg, jpeg_length, sx, sy, nFrames, 0, 0, 0, false);
+
+		// decoded frames are not known to java
+		for (i=0; i<nFrames; ++i)
+			yuvHandle[i] = 0;
+	}
 
-	env->ReleaseIntArrayElements(in, (jint*)jpeg, JNI_ABORT);
+	env->ReleaseLongArrayElements(in, handles, JNI_ABORT);
 	env->ReleaseIntArrayElements(in_len, (jint*)jpeg_length, JNI_ABORT);
 
 	sprintf (status, "frames total: %d\n", (int)nFrames);
@@ -115,21 +133,24 @@ extern "C" JNIEXPORT jstring JNICALL Java_com_almalence_plugins_processing_bests
 (
 	JNIEnv* env,
 	jobject thiz,
-	jintArray in,
+	jlongArray in,
 	jint nFrames,
 	jint sx,
 	jint sy
 )
 {
 	int i;
-	unsigned char * *yuvIn;
+	jlong *yuvIn;
 	char status[1024];
 //
 //	Uint8 *inp[4];
 //	int x, y;
 //	int x0_out, y0_out, w_out, h_out;
 //
-	yuvIn = (unsigned char**)env->GetIntArrayElements(in, NULL);
+	if (nFrames > MAX_BEST_FRAMES)
+		nFrames = MAX_BEST_FRAMES;
+
+	yuvIn = env->GetLongArrayElements(in, NULL);
 //
 //	// pre-allocate uncompressed yuv buffers
 //	for (i=0; i<nFrames; ++i)
@@ -166,10 +187,14 @@ extern "C" JNIEXPORT jstring JNICALL Java_com_almalence_plugins_processing_bests
 //		}
 //	}
 
+	// java keeps the best frame, the rest are released after selection
 	for (i=0; i<nFrames; ++i)
-			yuv[i] = yuvIn[i];
+	{
+		yuvHandle[i] = yuvIn[i];
+		yuv[i] = (unsigned char*)FrameHandle_Data(yuvIn[i], sx*sy+2*((sx+1)/2)*((sy+1)/2));
+	}
 
-	env->ReleaseIntArrayElements(in, (jint*)yuvIn, JNI_ABORT);
+	env->ReleaseLongArrayElements(in, yuvIn, JNI_ABORT);
 
 	//sprintf (status, "frames total: %d\nsize0: %d\nsize1: %d\nsize2: %d\n", (int)nFrames, jpeg_length[0], jpeg_length[1], jpeg_length[2]);
 	sprintf (status, "frames total: %d\n", (int)nFrames);
@@ -194,15 +219,23 @@ extern "C" JNIEXPORT jint JNICALL Java_com_almalence_plugins_processing_bestshot
 //	unsigned char * *jpeg;
 //	jpeg = (unsigned char**)env->GetIntArrayElements(in, NULL);
 
+	for (int i=0; i<nFrames; ++i)
+		if (yuv[i] == NULL)
+			return 0;
+
 	BestShot_Select(yuv, sx, sy, nFrames, fullScanMode, BestFrames, FramesScores, nFramesToSelect);
 
 	for (int i=0; i<nFrames; ++i)
 	{
 		if(BestFrames[0] != i)
 		{
-			free(yuv[i]);
+			if (yuvHandle[i])
+				FrameHandle_Release(yuvHandle[i]);
+			else
+				FramePool_Free(yuv[i]);
 			yuv[i] = NULL;
 		}
+		yuvHandle[i] = 0;
 //		if (i!=BestFrames[0])
 //			free (jpeg[i]);
 	}
@@ -5,6 +5,8 @@
 #include <android/log.h>
 
 #include "ImageConversionUtils.h"
+#include "FrameHandle.h"
+#include "FramePool.h"
 
 #include "almashot.h"
 #include "filters.h"
@@ -58,7 +60,7 @@ extern "C" JNIEXPORT jint JNICALL Java_com_almalence_plugins_processing_simple_A
 		{
 			if (yuv[i])
 			{
-				free(yuv[i]);
+				FramePool_Free(yuv[i]);
 				yuv[i] = NULL;
 			}
 		}
@@ -74,7 +76,7 @@ extern "C" JNIEXPORT jstring JNICALL Java_com_almalence_plugins_processing_simpl
 (
 	JNIEnv* env,
 	jobject thiz,
-	jintArray in,
+	jlongArray in,
 	jintArray in_len,
 	jint nFrames,
 	jint sx,
@@ -83,7 +85,8 @@ extern "C" JNIEXPORT jstring JNICALL Java_com_almalence_plugins_processing_simpl
 {
 	int i;
 	int *jpeg_length;
-	unsigned char * *jpeg;
+	jlong *handles;
+	unsigned char *jpeg[MAX_FRAMES];
 	char status[1024];
 
 	Uint8 *inp[4];
@@ -92,10 +95,18 @@ extern "C" JNIEXPORT jstring JNICALL Java_com_almalence_plugins_processing_simpl
 
 	jbyteArray infrms[MAX_FRAMES];
 
-	jpeg = (unsigned char**)env->GetIntArrayElements(in, NULL);
+	if (nFrames > MAX_FRAMES)
+		nFrames = MAX_FRAMES;
+
+	handles = env->GetLongArrayElements(in, NULL);
 	jpeg_length = (int*)env->GetIntArrayElements(in_len, NULL);
 
-	DecodeAndRotateMultipleJpegs(yuv, jpeg, jpeg_length, sx, sy, nFrames, 0, 0, 0, true);
+	for (i=0; i<nFrames; ++i)
+		if ((jpeg[i] = (unsigned char*)FrameHandle_Data(handles[i], jpeg_length[i])) == NULL)
+			break;
+
+	if (i == nFrames)
+		DecodeAndRotateMultipleJpegs(yuv, jpeg, jpeg_length, sx, sy, nFrames, 0, 0, 0, true);
 
 	/*
 	// dump jpeg data
@@ -113,7 +124,7 @@ extern "C" JNIEXPORT jstring JNICALL Java_com_almalence_plugins_processing_simpl
 	}
 	*/
 
-	env->ReleaseIntArrayElements(in, (jint*)jpeg, JNI_ABORT);
+	env->ReleaseLongArrayElements(in, handles, JNI_ABORT);
 	env->ReleaseIntArrayElements(in_len, (jint*)jpeg_length, JNI_ABORT);
 
 	//sprintf (status, "frames total: %d\nsize0: %d\nsize1: %d\nsize2: %d\n", (int)nFrames, jpeg_length[0], jpeg_length[1], jpeg_length[2]);
@@ -122,26 +133,34 @@ extern "C" JNIEXPORT jstring JNICALL Java_com_almalence_plugins_processing_simpl
 }
 
 
-extern "C" JNIEXPORT jint JNICALL Java_com_almalence_plugins_processing_simple_AlmaShotDRO_GetYUVFrame
+// frame is handed over to java, it is freed by releasing the handle
+extern "C" JNIEXPORT jlong JNICALL Java_com_almalence_plugins_processing_simple_AlmaShotDRO_GetYUVFrame
 (
 	JNIEnv* env,
 	jobject thiz,
-	jint index
+	jint index,
+	jint sx,
+	jint sy
 )
 {
-	if(yuv[index] != NULL)
-	{
-		return (jint)yuv[index];
-	}
-	else return -1;
+	FrameHandle h;
+
+	if ((index < 0) || (index >= MAX_FRAMES) || (yuv[index] == NULL))
+		return 0;
+
+	h = FrameHandle_Create(yuv[index], sx*sy+2*((sx+1)/2)*((sy+1)/2), FRAME_FORMAT_NV21, sx, sy, sx, NULL);
+	if (h != 0)
+		yuv[index] = NULL;
+
+	return h;
 }
 
 
-extern "C" JNIEXPORT jint JNICALL Java_com_almalence_plugins_processing_simple_AlmaShotDRO_DroProcess
+extern "C" JNIEXPORT jlong JNICALL Java_com_almalence_plugins_processing_simple_AlmaShotDRO_DroProcess
 (
 	JNIEnv* env,
 	jobject thiz,
-	jint inputYUV,
+	jlong inputYUV,
 	jint sx,
 	jint sy,
 	jfloat max_amplify,
@@ -160,9 +179,12 @@ extern "C" JNIEXPORT jint JNICALL Java_com_almalence_plugins_processing_simple_A
 	Uint32 hist_loc[3][3][256];
 	Int32 lookup_table[3][3][256];
 
-	unsigned char* yuv = (unsigned char*)inputYUV;
+	unsigned char* yuv = (unsigned char*)FrameHandle_Data(inputYUV, sx*sy+sx*((sy+1)/2));
+
+	if (yuv == NULL)
+		return 0;
 
-	result_yuv = (Uint8*)malloc(sx*sy+sx*((sy+1)/2));
+	result_yuv = (Uint8*)FramePool_Alloc(sx*sy+sx*((sy+1)/2));
 
 	/*
 	// dump yuv data
@@ -206,7 +228,7 @@ extern "C" JNIEXPORT jint JNICALL Java_com_almalence_plugins_processing_simple_A
 				sx, sy);
 	}
 
-	return (jint)result_yuv;
+	return FrameHandle_Create(result_yuv, sx*sy+sx*((sy+1)/2), FRAME_FORMAT_NV21, sx, sy, sx, NULL);
 }
 
 jint throwRuntimeException(JNIEnv* env, const char* message)
@@ -218,7 +240,7 @@ jint throwRuntimeException(JNIEnv* env, const char* message)
 	return env->ThrowNew(exClass, message);
 }
 
-extern "C" JNIEXPORT jint JNICALL Java_com_almalence_plugins_capture_video_RealtimeDRO_initialize
+extern "C" JNIEXPORT jlong JNICALL Java_com_almalence_plugins_capture_video_RealtimeDRO_initialize
 (
 	JNIEnv* env,
 	jobject thiz,
@@ -233,9 +255,11 @@ extern "C" JNIEXPORT jint JNICALL Java_com_almalence_plugins_capture_video_Realt
 	if (result != ALMA_ALL_OK)
 	{
 		throwRuntimeException(env, "Native function Dro_StreamingInitialize() failed.");
+		return 0;
 	}
 
-	return (jint)fi;
+	// instance is released explicitly by Dro_StreamingRelease, the handle does not own it
+	return FrameHandle_Wrap(fi, 0, FRAME_FORMAT_OBJECT, 0, 0, 0);
 }
 
 
@@ -243,7 +267,7 @@ extern "C" JNIEXPORT void JNICALL Java_com_almalence_plugins_capture_video_Realt
 (
 	JNIEnv* env,
 	jobject thiz,
-	jint instance,
+	jlong instance,
 	jint texture_in,
 	jfloatArray jmtx,
 	jint sx,
@@ -264,12 +288,17 @@ extern "C" JNIEXPORT void JNICALL Java_com_almalence_plugins_capture_video_Realt
 	jint texture_out
 )
 {
+	void *fi = FrameHandle_Data(instance, 0);
+
+	if (fi == NULL)
+		return;
+
 	float* mtx = env->GetFloatArrayElements(jmtx, 0);
 	float* min_limit = env->GetFloatArrayElements(jmin_limit, 0);
 	float* max_limit = env->GetFloatArrayElements(jmax_limit, 0);
 
     Dro_StreamingRender(
-                        (void *)instance,
+                        fi,
                         texture_in,
                         mtx,
                         sx,
@@ -299,10 +328,17 @@ extern "C" JNIEXPORT void JNICALL Java_com_almalence_plugins_capture_video_Realt
 (
 	JNIEnv* env,
 	jobject thiz,
-	jint instance
+	jlong instance
 )
 {
-	const int result = Dro_StreamingRelease((void*)instance);
+	void *fi = FrameHandle_Data(instance, 0);
+
+	if (fi == NULL)
+		return;
+
+	FrameHandle_Release(instance);
+
+	const int result = Dro_StreamingRelease(fi);
 
 	if (result != ALMA_ALL_OK)
 	{
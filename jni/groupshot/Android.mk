@@ -107,7 +107,12 @@ LOCAL_SRC_FILES:= \
        FaceRecEm/common/src/b_FDSDK/SDK.c
 ##
 
-LOCAL_CFLAGS += -Depl_LINUX
+LOCAL_CFLAGS += -Depl_LINUX -fopenmp
+
+# bit feature activities count bits with NEON vcnt
+ifeq ($(TARGET_ARCH_ABI),armeabi-v7a)
+LOCAL_ARM_NEON := true
+endif
 
 LOCAL_C_INCLUDES += \
 	$(LOCAL_PATH)/FaceRecEm/common/src \
@@ -125,3 +130,35 @@ LOCAL_SHARED_LIBRARIES := \
 LOCAL_MODULE:= libFFTEm
 
 include $(BUILD_STATIC_LIBRARY)
+
+
+
+# ------------------------------------------------------------------
+# libFFTEm unit tests, only built with "ndk-build FD_TESTS=1"; each
+# is a plain executable run on the device, exit code 0 means passed.
+# Host builds work too: gcc -Depl_LINUX <includes> test.c <sources above> -lm
+# ------------------------------------------------------------------
+ifdef FD_TESTS
+
+FD_TEST_NAMES := BitSumTest PcaProjectTest MathTest DynMemManagerTest
+
+# $(1): test name, source is Embedded/common/test/$(1).c
+define fd_test
+include $(CLEAR_VARS)
+LOCAL_MODULE := $(1)
+LOCAL_SRC_FILES := Embedded/common/test/$(1).c
+LOCAL_C_INCLUDES += \
+	$(LOCAL_PATH)/Embedded/common/conf \
+	$(LOCAL_PATH)/Embedded/common/src
+LOCAL_CFLAGS += -Depl_LINUX -fopenmp
+ifeq ($(TARGET_ARCH_ABI),armeabi-v7a)
+LOCAL_ARM_NEON := true
+endif
+LOCAL_STATIC_LIBRARIES := libFFTEm gomp
+LOCAL_LDLIBS := -lm
+include $(BUILD_EXECUTABLE)
+endef
+
+$(foreach t,$(FD_TEST_NAMES),$(eval $(call fd_test,$(t))))
+
+endif
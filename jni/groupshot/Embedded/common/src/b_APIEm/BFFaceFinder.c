@@ -47,6 +47,7 @@ void bpi_BFFaceFinder_init( struct bbs_Context* cpA,
 	ptrA->baseE.typeE = ( uint32 )bpi_FF_BF_FACE_FINDER;
 	ptrA->baseE.vpSetParamsE = bpi_BFFaceFinder_setParams;
 	ptrA->baseE.vpSetRangeE = bpi_BFFaceFinder_setRange;
+	ptrA->baseE.vpSetTrackingE = bpi_BFFaceFinder_setTracking;
 	ptrA->baseE.vpProcessE = bpi_BFFaceFinder_processDcr;
 	ptrA->baseE.vpPutDcrE = bpi_BFFaceFinder_putDcr;
 	ptrA->baseE.vpGetDcrE = bpi_BFFaceFinder_getDcr;
@@ -54,6 +55,10 @@ void bpi_BFFaceFinder_init( struct bbs_Context* cpA,
 	ptrA->detectedFacesE = 0;
 	ptrA->availableFacesE = 0;
 	ptrA->faceDataBufferE = NULL;
+	ptrA->trackIntervalE = 0;
+	ptrA->trackFramesE = 0;
+	ptrA->trackFacesE = 0;
+	bts_Int16Rect_init( cpA, &ptrA->trackRoiE );
 	bbf_ScanDetector_init( cpA, &ptrA->detectorE );
 }
 
@@ -65,6 +70,10 @@ void bpi_BFFaceFinder_exit( struct bbs_Context* cpA,
 	ptrA->detectedFacesE = 0;
 	ptrA->availableFacesE = 0;
 	ptrA->faceDataBufferE = NULL;
+	ptrA->trackIntervalE = 0;
+	ptrA->trackFramesE = 0;
+	ptrA->trackFacesE = 0;
+	bts_Int16Rect_exit( cpA, &ptrA->trackRoiE );
 	bbf_ScanDetector_exit( cpA, &ptrA->detectorE );
 
 	bpi_FaceFinder_exit( cpA, &ptrA->baseE );
@@ -86,6 +95,7 @@ void bpi_BFFaceFinder_copy( struct bbs_Context* cpA,
 {
 	bpi_FaceFinder_copy( cpA, &ptrA->baseE, &srcPtrA->baseE );
 	bbf_ScanDetector_copy( cpA, &ptrA->detectorE, &srcPtrA->detectorE );
+	bpi_BFFaceFinder_setTrackInterval( cpA, ptrA, srcPtrA->trackIntervalE );
 }
 
 /* ------------------------------------------------------------------------- */
@@ -157,6 +167,17 @@ void bpi_BFFaceFinder_setMaxEyeDistance( struct bbs_Context* cpA,
 
 /* ------------------------------------------------------------------------- */
 	
+void bpi_BFFaceFinder_setTrackInterval( struct bbs_Context* cpA,
+										struct bpi_BFFaceFinder* ptrA, 
+										uint32 intervalA )
+{
+	ptrA->trackIntervalE = intervalA;
+	ptrA->trackFramesE = 0;
+	ptrA->trackFacesE = 0;
+}
+
+/* ------------------------------------------------------------------------- */
+	
 /* ========================================================================= */
 /*                                                                           */
 /* ---- \ghd{ I/O } -------------------------------------------------------- */
@@ -297,10 +318,56 @@ uint32 bpi_BFFaceFinder_multiProcess( struct bbs_Context* cpA,
 									  const struct bts_Int16Rect* roiPtrA )
 {
 	struct bpi_BFFaceFinder* ptrL = ( struct bpi_BFFaceFinder* )ptrA;
-	ptrL->detectedFacesE = bbf_ScanDetector_process( cpA, ( struct bbf_ScanDetector* )&ptrA->detectorE, imagePtrA, imageWidthA, imageHeightA, roiPtrA, &ptrL->faceDataBufferE );
-	ptrL->availableFacesE = ptrA->detectedFacesE > 0 ? ptrA->detectedFacesE : 1;
+	struct bbf_ScanDetector* detectorPtrL = ( struct bbf_ScanDetector* )&ptrA->detectorE;
+	struct bts_Int16Rect roiL = ( roiPtrA != NULL ) ? *roiPtrA : bts_Int16Rect_create( 0, 0, ( int16 )imageWidthA, ( int16 )imageHeightA );
+	flag trackL = FALSE;
+	uint32 facesL = 0;
+	uint32 iL;
+
+	/* faces of previous image are tracked unless it is time for a full scan */
+	if( ptrA->trackIntervalE > 0 && ptrA->trackFramesE < ptrA->trackIntervalE && ptrA->trackFacesE > 0 )
+	{
+		trackL = roiL.x1E == ptrA->trackRoiE.x1E && roiL.y1E == ptrA->trackRoiE.y1E &&
+				 roiL.x2E == ptrA->trackRoiE.x2E && roiL.y2E == ptrA->trackRoiE.y2E;
+	}
+
+	if( trackL )
+	{
+		facesL = bbf_ScanDetector_track( cpA, detectorPtrL, imagePtrA, imageWidthA, imageHeightA, &roiL, 
+										 ptrA->trackArrE, ptrA->trackFacesE, ptrL->trackActArrE, &ptrL->faceDataBufferE );
+		if( bbs_Context_error( cpA ) ) return 0;
+
+		/* fall back to full scan when a face was lost or its activity dropped to half */
+		trackL = facesL >= ptrA->trackFacesE;
+		for( iL = 0; iL < ptrA->trackFacesE && trackL; iL++ )
+		{
+			trackL = ptrA->trackActArrE[ iL ] > ( ptrA->trackArrE[ iL * 4 + 3 ] >> 1 );
+		}
+	}
+
+	if( trackL )
+	{
+		ptrL->trackFramesE++;
+	}
+	else
+	{
+		facesL = bbf_ScanDetector_process( cpA, detectorPtrL, imagePtrA, imageWidthA, imageHeightA, roiPtrA, &ptrL->faceDataBufferE );
+		ptrL->trackFramesE = 0;
+	}
+
+	ptrL->detectedFacesE = facesL;
+	ptrL->availableFacesE = facesL > 0 ? facesL : 1;
 	if( bbs_Context_error( cpA ) ) return 0;
-	return ptrL->detectedFacesE;
+
+	/* faces of this image are tracked in the next one */
+	if( ptrA->trackIntervalE > 0 )
+	{
+		ptrL->trackFacesE = facesL <= bpi_BF_FACE_FINDER_MAX_TRACK_FACES ? facesL : 0;
+		ptrL->trackRoiE = roiL;
+		bbs_memcpy32( ptrL->trackArrE, ptrA->faceDataBufferE, ptrL->trackFacesE * 4 );
+	}
+
+	return facesL;
 }
 
 /* ------------------------------------------------------------------------- */
@@ -422,6 +489,27 @@ void bpi_BFFaceFinder_setRange( struct bbs_Context* cpA,
 	}
 	bpi_BFFaceFinder_setMinEyeDistance( cpA, ( struct bpi_BFFaceFinder* )ptrA, minEyeDistanceA );
 	bpi_BFFaceFinder_setMaxEyeDistance( cpA, ( struct bpi_BFFaceFinder* )ptrA, maxEyeDistanceA );
+
+	/* tracked faces may be out of the new range */
+	( ( struct bpi_BFFaceFinder* )ptrA )->trackFacesE = 0;
+}
+
+/* ------------------------------------------------------------------------- */
+
+void bpi_BFFaceFinder_setTracking( struct bbs_Context* cpA,
+								   struct bpi_FaceFinder* ptrA, 
+								   uint32 intervalA )
+{
+	bbs_DEF_fNameL( "bpi_BFFaceFinder_setTracking" );
+
+	if( bbs_Context_error( cpA ) ) return;
+
+	if( ptrA->typeE != bpi_FF_BF_FACE_FINDER ) 
+	{
+		bbs_ERROR1( "%s:\nObject type mismatch", fNameL );
+		return;
+	}
+	bpi_BFFaceFinder_setTrackInterval( cpA, ( struct bpi_BFFaceFinder* )ptrA, intervalA );
 }
 
 /* ------------------------------------------------------------------------- */
@@ -34,6 +34,9 @@ struct bpi_DCR;
 /* data format version number */
 #define bpi_BF_FACE_FINDER_VERSION 100
 
+/* maximum number of faces tracked from frame to frame */
+#define bpi_BF_FACE_FINDER_MAX_TRACK_FACES 32
+
 /* ---- object definition -------------------------------------------------- */
 
 /** Face Finder using ractangle features */
@@ -53,6 +56,24 @@ struct bpi_BFFaceFinder
 	/* pointer to face data buffer */
 	int32* faceDataBufferE;
 
+	/* maximum number of frames tracked after a full scan (0: tracking is off) */
+	uint32 trackIntervalE;
+
+	/* number of frames tracked since last full scan */
+	uint32 trackFramesE;
+
+	/* number of faces of last frame in trackArrE (0: next frame is scanned fully) */
+	uint32 trackFacesE;
+
+	/* roi of last frame */
+	struct bts_Int16Rect trackRoiE;
+
+	/* faces of last frame (face data buffer format) */
+	int32 trackArrE[ bpi_BF_FACE_FINDER_MAX_TRACK_FACES * 4 ];
+
+	/* highest activities found around faces of last frame */
+	int32 trackActArrE[ bpi_BF_FACE_FINDER_MAX_TRACK_FACES ];
+
 	/* ---- public data ---------------------------------------------------- */
 
 	/* detector */
@@ -105,6 +126,17 @@ void bpi_BFFaceFinder_setMaxEyeDistance( struct bbs_Context* cpA,
 										 struct bpi_BFFaceFinder* ptrA, 
 										 uint32 distA );
 
+/** Enables tracking of faces in a sequence of similar images (e.g. burst frames).
+ *  multiProcess then scans an image fully only once in intervalA + 1 images;
+ *  the others are only scanned around the faces of the previous image.
+ *  An image is scanned fully as well when a face was lost, its confidence dropped
+ *  to half or the roi changed. New faces are therefore found with the next full scan only.
+ *  Each call starts with a full scan; intervalA = 0 disables tracking.
+ */
+void bpi_BFFaceFinder_setTrackInterval( struct bbs_Context* cpA,
+										struct bpi_BFFaceFinder* ptrA, 
+										uint32 intervalA );
+
 /* ---- \ghd{ memory I/O } ------------------------------------------------- */
 
 /** size object needs when written to memory */
@@ -171,6 +203,9 @@ int32 bpi_BFFaceFinder_process( struct bbs_Context* cpA,
  *  eventually be adjusted externally.
  *  The roi rectangle must not include pixels outside of the original image
  *  (checked -> error). The rectangle may be of uneven width.
+ *
+ *  With tracking enabled (see setTrackInterval) most images are only scanned
+ *  around the faces found in the previous one.
  */
 uint32 bpi_BFFaceFinder_multiProcess( struct bbs_Context* cpA,
 									  const struct bpi_BFFaceFinder* ptrA, 
@@ -228,6 +263,14 @@ void bpi_BFFaceFinder_setRange( struct bbs_Context* cpA,
 								uint32 minEyeDistanceA,
 								uint32 maxEyeDistanceA );
 
+/** sets tracking interval
+ *  Overload of vpSetTracking
+ *  wraps function setTrackInterval
+ */
+void bpi_BFFaceFinder_setTracking( struct bbs_Context* cpA,
+								   struct bpi_FaceFinder* ptrA, 
+								   uint32 intervalA );
+
 /** Single face processing function; returns confidence (8.24)  
  *  Overload of vpProcess
  *  wraps function process
@@ -44,6 +44,7 @@ void bpi_FaceFinder_init( struct bbs_Context* cpA,
 	ptrA->typeE = 0;
 	ptrA->vpSetParamsE = NULL;
 	ptrA->vpSetRangeE = NULL;
+	ptrA->vpSetTrackingE = NULL;
 	ptrA->vpProcessE = NULL;
 	ptrA->vpPutDcrE = NULL;
 	ptrA->vpGetDcrE = NULL;
@@ -57,6 +58,7 @@ void bpi_FaceFinder_exit( struct bbs_Context* cpA,
 	ptrA->typeE = 0;
 	ptrA->vpSetParamsE = NULL;
 	ptrA->vpSetRangeE = NULL;
+	ptrA->vpSetTrackingE = NULL;
 	ptrA->vpProcessE = NULL;
 	ptrA->vpPutDcrE = NULL;
 	ptrA->vpGetDcrE = NULL;
@@ -65,6 +65,11 @@ struct bpi_FaceFinder
 						   uint32 minEyeDistanceA,
 						   uint32 maxEyeDistanceA );
 
+	/** sets number of images tracked between full scans (0: no tracking) */ 
+	void ( *vpSetTrackingE )( struct bbs_Context* cpA,
+							  struct bpi_FaceFinder* ptrA, 
+							  uint32 intervalA );
+
 	/** single face processing function; returns confidence (8.24) */ 
 	int32 ( *vpProcessE )( struct bbs_Context* cpA,
 						   const struct bpi_FaceFinder* ptrA, 
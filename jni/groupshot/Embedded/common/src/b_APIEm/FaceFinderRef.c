@@ -231,6 +231,21 @@ void bpi_FaceFinderRef_setRange( struct bbs_Context* cpA,
 
 /* ------------------------------------------------------------------------- */
 
+void bpi_FaceFinderRef_setTracking( struct bbs_Context* cpA,
+									struct bpi_FaceFinderRef* ptrA, 
+									uint32 intervalA )
+{
+	bbs_DEF_fNameL( "bpi_FaceFinderRef_setTracking" );
+	if( ptrA->faceFinderPtrE == NULL )
+	{
+		bbs_ERROR1( "%s:\nNo face finder object was loaded", fNameL );
+		return;
+ 	}
+	ptrA->faceFinderPtrE->vpSetTrackingE( cpA, ptrA->faceFinderPtrE, intervalA );
+}
+
+/* ------------------------------------------------------------------------- */
+
 int32 bpi_FaceFinderRef_process( struct bbs_Context* cpA,
 							     const struct bpi_FaceFinderRef* ptrA, 
 								 struct bpi_DCR* dcrPtrA )
@@ -103,6 +103,11 @@ void bpi_FaceFinderRef_setRange( struct bbs_Context* cpA,
 								 uint32 minEyeDistanceA,
 								 uint32 maxEyeDistanceA );
 
+/** sets number of images tracked between full scans (0: no tracking) */ 
+void bpi_FaceFinderRef_setTracking( struct bbs_Context* cpA,
+									struct bpi_FaceFinderRef* ptrA, 
+									uint32 intervalA );
+
 /** single face processing function; returns confidence (8.24) */ 
 int32 bpi_FaceFinderRef_process( struct bbs_Context* cpA,
 							     const struct bpi_FaceFinderRef* ptrA, 
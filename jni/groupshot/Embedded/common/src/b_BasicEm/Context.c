@@ -392,6 +392,17 @@ uint32 bbs_Context_shrdAllocSize( struct bbs_Context* cpA, uint32 segIndexA )
 								  
 /* ------------------------------------------------------------------------- */
 
+void bbs_Context_setArenaBlockSize( struct bbs_Context* cpA, uint32 sizeA )
+{
+	uint32 iL;
+	for( iL = 0; iL < cpA->dynMemManagerArrSizeE; iL++ )
+	{
+		bbs_DynMemManager_setArenaBlockSize( cpA, &cpA->dynMemManagerArrE[ iL ], sizeA );
+	}
+}
+								  
+/* ------------------------------------------------------------------------- */
+
 void bbs_Context_quickInit( struct bbs_Context* cpA, 
 	 					    bbs_mallocFPtr mallocFPtrA,	/* function pointer to external mem alloc function (s. comment of type declaration)*/
 						    bbs_freeFPtr freeFPtrA,
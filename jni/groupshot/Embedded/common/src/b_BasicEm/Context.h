@@ -207,6 +207,12 @@ uint32 bbs_Context_exclAllocSize( struct bbs_Context* cpA, uint32 segIndexA );
  *  the actually allocated memory amount.
  */
 uint32 bbs_Context_shrdAllocSize( struct bbs_Context* cpA, uint32 segIndexA );
+
+/** Sets minimum size of arena blocks of all dynamic memory managers in units of 16bits.
+ *  With sizeA > 0 memory blocks are taken from arena blocks instead of being allocated individually.
+ *  Must be called before dynamic memory is allocated.
+ */
+void bbs_Context_setArenaBlockSize( struct bbs_Context* cpA, uint32 sizeA );
 								  
 /*******************************/
 
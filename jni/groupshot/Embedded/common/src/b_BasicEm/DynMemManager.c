@@ -26,10 +26,28 @@
 #define bbs_DYN_MEM_MIN_NEW_BLOCK_SIZE 0
 
 /** Offset to actual memory area on allocated memory blocks (in 16-bit words).
-  * Value needs to be large enough to hold the pointer to the next memory block
-  * and the size value (32-bit) of the memory area.
+  * Value needs to be large enough to hold the pointers to the next and the
+  * previous memory block and the size value (32-bit) of the memory area.
   */
-#define bbs_MEM_OFFSET 6
+#define bbs_MEM_OFFSET 10
+
+/** pointer to next memory block */
+#define bbs_MEM_NEXT( pA ) ( *( uint16** )( pA ) )
+
+/** pointer to previous memory block */
+#define bbs_MEM_PREV( pA ) ( *( uint16** )( ( pA ) + 4 ) )
+
+/** size of memory block including offset in 16-bit units */
+#define bbs_MEM_SIZE( pA ) ( *( uint32* )( ( pA ) + 8 ) )
+
+/** Offset to usable area of arena blocks (in 16-bit words).
+  * Holds the pointer to the previous arena block and the size of the arena block;
+  * memory blocks taken from the arena start at multiples of 4 words from its beginning.
+  */
+#define bbs_ARENA_OFFSET 8
+
+/** size of arena block including offset in 16-bit units */
+#define bbs_ARENA_SIZE( pA ) ( *( uint32* )( ( pA ) + 4 ) )
 
 /* ========================================================================= */
 /*                                                                           */
@@ -39,6 +57,124 @@
 
 /* ------------------------------------------------------------------------- */
 
+/** returns TRUE if a memory block header at pA lies within an arena block of the manager */
+static flag bbs_DynMemManager_arenaOwns( const struct bbs_DynMemManager* ptrA, 
+										 const uint16* pA )
+{
+	const uint16* arenaPtrL = ptrA->arenaPtrE;
+	while( arenaPtrL != NULL )
+	{
+		if( pA >= arenaPtrL + bbs_ARENA_OFFSET && pA + bbs_MEM_OFFSET <= arenaPtrL + bbs_ARENA_SIZE( arenaPtrL ) )
+		{
+			/* memory blocks start at multiples of 4 words */
+			return ( ( pA - arenaPtrL ) & 3 ) == 0;
+		}
+		arenaPtrL = bbs_MEM_NEXT( arenaPtrL );
+	}
+	return FALSE;
+}
+
+/* ------------------------------------------------------------------------- */
+
+/** returns memory block of memPtrA or NULL if memPtrA is not the memory area of an allocated block;
+ *  only headers of memory owned by the manager are read
+ */
+static uint16* bbs_DynMemManager_block( const struct bbs_DynMemManager* ptrA, 
+										uint16* memPtrA )
+{
+	uint16* pL;
+	if( memPtrA == NULL || ptrA->memPtrE == NULL ) return NULL;
+
+	pL = memPtrA - bbs_MEM_OFFSET;
+	if( pL == ptrA->lastPtrE || pL == ptrA->memPtrE ) return pL;
+
+	if( ptrA->arenaBlockSizeE > 0 )
+	{
+		/* an allocated block in the middle of the list is linked with its neighbours,
+		 * which are checked to be arena memory before their headers are read
+		 */
+		uint16* prevL;
+		uint16* nextL;
+		if( !bbs_DynMemManager_arenaOwns( ptrA, pL ) ) return NULL;
+		prevL = bbs_MEM_PREV( pL );
+		nextL = bbs_MEM_NEXT( pL );
+		if( !bbs_DynMemManager_arenaOwns( ptrA, prevL ) || !bbs_DynMemManager_arenaOwns( ptrA, nextL ) ) return NULL;
+		if( bbs_MEM_NEXT( prevL ) != pL || bbs_MEM_PREV( nextL ) != pL ) return NULL;
+		return pL;
+	}
+	else
+	{
+		/* blocks of the malloc handler cannot be told from other memory; 
+		 * the list is searched from the end, where blocks are usually freed
+		 */
+		uint16* qL = bbs_MEM_PREV( ptrA->lastPtrE );
+		while( qL != NULL && qL != pL ) qL = bbs_MEM_PREV( qL );
+		return qL;
+	}
+}
+
+/* ------------------------------------------------------------------------- */
+
+/** updates peak size statistics */
+static void bbs_DynMemManager_updatePeakSize( struct bbs_DynMemManager* ptrA )
+{
+	uint32 sizeL = ptrA->sizeE;
+	if( ptrA->arenaPtrE != NULL )
+	{
+		sizeL = ptrA->arenaSizeE - bbs_ARENA_SIZE( ptrA->arenaPtrE ) + ptrA->arenaIndexE;
+	}
+	if( sizeL > ptrA->peakSizeE ) ptrA->peakSizeE = sizeL;
+}
+
+/* ------------------------------------------------------------------------- */
+
+/** takes sizeA words (multiple of 4) from the current arena block; allocates a new arena block if necessary */
+static uint16* bbs_DynMemManager_arenaAlloc( struct bbs_Context* cpA, 
+											 struct bbs_DynMemManager* ptrA, 
+											 const struct bbs_MemSeg* memSegPtrA,
+											 uint32 sizeA )
+{
+	uint16* pL;
+
+	if( ptrA->arenaPtrE == NULL || ptrA->arenaIndexE + sizeA > bbs_ARENA_SIZE( ptrA->arenaPtrE ) )
+	{
+		/* the rest of the current arena block stays unused */
+		uint32 blockSizeL = ( sizeA > ptrA->arenaBlockSizeE ? sizeA : ptrA->arenaBlockSizeE ) + bbs_ARENA_OFFSET;
+		uint16* arenaPtrL = ptrA->mallocFPtrE( cpA, memSegPtrA, blockSizeL << 1 );
+		if( arenaPtrL == NULL ) return NULL;
+
+		bbs_MEM_NEXT( arenaPtrL ) = ptrA->arenaPtrE;
+		bbs_ARENA_SIZE( arenaPtrL ) = blockSizeL;
+		ptrA->arenaPtrE = arenaPtrL;
+		ptrA->arenaIndexE = bbs_ARENA_OFFSET;
+		ptrA->arenaSizeE += blockSizeL;
+		ptrA->mallocCountE++;
+	}
+
+	pL = ptrA->arenaPtrE + ptrA->arenaIndexE;
+	ptrA->arenaIndexE += sizeA;
+
+	return pL;
+}
+
+/* ------------------------------------------------------------------------- */
+
+/** frees all arena blocks following arenaPtrA */
+static void bbs_DynMemManager_freeArenaBlocks( struct bbs_DynMemManager* ptrA, 
+											   uint16* arenaPtrA )
+{
+	uint16* pL = arenaPtrA;
+	while( pL != NULL )
+	{
+		uint16* arenaPtrL = pL;
+		pL = bbs_MEM_NEXT( pL );
+		ptrA->arenaSizeE -= bbs_ARENA_SIZE( arenaPtrL );
+		ptrA->freeFPtrE( arenaPtrL );
+	}
+}
+
+/* ------------------------------------------------------------------------- */
+
 /* ========================================================================= */
 /*                                                                           */
 /* ---- \ghd{ constructor / destructor } ----------------------------------- */
@@ -50,9 +186,19 @@
 void bbs_DynMemManager_init( struct bbs_Context* cpA, 
 							 struct bbs_DynMemManager* ptrA )
 {
+	ptrA->lastPtrE = NULL;
+	ptrA->arenaPtrE = NULL;
+	ptrA->arenaIndexE = 0;
 	ptrA->memPtrE = NULL;
 	ptrA->mallocFPtrE = NULL;
 	ptrA->freeFPtrE = NULL;
+	ptrA->arenaBlockSizeE = 0;
+	ptrA->allocCountE = 0;
+	ptrA->freeCountE = 0;
+	ptrA->mallocCountE = 0;
+	ptrA->sizeE = 0;
+	ptrA->peakSizeE = 0;
+	ptrA->arenaSizeE = 0;
 }
 
 /* ------------------------------------------------------------------------- */
@@ -60,9 +206,19 @@ void bbs_DynMemManager_init( struct bbs_Context* cpA,
 void bbs_DynMemManager_exit( struct bbs_Context* cpA, 
 							 struct bbs_DynMemManager* ptrA )
 {
+	ptrA->lastPtrE = NULL;
+	ptrA->arenaPtrE = NULL;
+	ptrA->arenaIndexE = 0;
 	ptrA->memPtrE = NULL;
 	ptrA->mallocFPtrE = NULL;
 	ptrA->freeFPtrE = NULL;
+	ptrA->arenaBlockSizeE = 0;
+	ptrA->allocCountE = 0;
+	ptrA->freeCountE = 0;
+	ptrA->mallocCountE = 0;
+	ptrA->sizeE = 0;
+	ptrA->peakSizeE = 0;
+	ptrA->arenaSizeE = 0;
 }
 
 /* ------------------------------------------------------------------------- */
@@ -86,14 +242,7 @@ void bbs_DynMemManager_exit( struct bbs_Context* cpA,
 uint32 bbs_DynMemManager_allocatedSize( struct bbs_Context* cpA, 
 									    const struct bbs_DynMemManager* ptrA )
 {
-	uint32 sizeL = 0;
-	uint16* pL = ( uint16* )ptrA->memPtrE;
-	while( pL != NULL )
-	{
-		sizeL += ( ( uint32* )pL )[ 2 ];
-		pL = *( uint16** )pL;
-	}
-	return sizeL; 
+	return ptrA->sizeE; 
 }
 
 /* ------------------------------------------------------------------------- */
@@ -104,6 +253,23 @@ uint32 bbs_DynMemManager_allocatedSize( struct bbs_Context* cpA,
 /*                                                                           */
 /* ========================================================================= */
 
+/* ------------------------------------------------------------------------- */
+
+void bbs_DynMemManager_setArenaBlockSize( struct bbs_Context* cpA, 
+										  struct bbs_DynMemManager* ptrA, 
+										  uint32 sizeA )
+{
+	bbs_DEF_fNameL( "void bbs_DynMemManager_setArenaBlockSize( .... )" )
+
+	if( ptrA->memPtrE != NULL || ptrA->arenaPtrE != NULL )
+	{
+		bbs_ERROR1( "%s:\n Arena block size cannot be changed after memory was allocated.\n", fNameL );
+		return;
+	}
+
+	ptrA->arenaBlockSizeE = sizeA;
+}
+
 /* ------------------------------------------------------------------------- */
 	
 /* ========================================================================= */
@@ -128,6 +294,7 @@ uint16* bbs_DynMemManager_alloc( struct bbs_Context* cpA,
 								 uint32 sizeA )
 {
 	uint16* pL = NULL;
+	uint32 blockSizeL = sizeA + bbs_MEM_OFFSET;
 	bbs_DEF_fNameL( "uint16* bbs_DynMemManager_alloc( struct bbs_DynMemManager* ptrA, uint32 sizeA )" )
 
 
@@ -137,17 +304,16 @@ uint16* bbs_DynMemManager_alloc( struct bbs_Context* cpA,
 		return NULL;
 	}
 
-	if( ptrA->memPtrE == NULL )
+	if( ptrA->arenaBlockSizeE > 0 )
 	{
-		ptrA->memPtrE = ptrA->mallocFPtrE( cpA, memSegPtrA, ( sizeA + bbs_MEM_OFFSET ) << 1 );
-		pL = ptrA->memPtrE;
+		/* keeps blocks in the arena 64-bit aligned */
+		blockSizeL = ( blockSizeL + 3 ) & 0xFFFFFFFC;
+		pL = bbs_DynMemManager_arenaAlloc( cpA, ptrA, memSegPtrA, blockSizeL );
 	}
 	else
 	{
-		uint16** ppL = ( uint16** )ptrA->memPtrE;
-		while( *ppL != NULL ) ppL = ( uint16** )*ppL;
-		*ppL = ptrA->mallocFPtrE( cpA, memSegPtrA, ( sizeA + bbs_MEM_OFFSET ) << 1 );
-		pL = *ppL;
+		pL = ptrA->mallocFPtrE( cpA, memSegPtrA, blockSizeL << 1 );
+		if( pL != NULL ) ptrA->mallocCountE++;
 	}
 
 	if( pL == NULL )
@@ -156,9 +322,23 @@ uint16* bbs_DynMemManager_alloc( struct bbs_Context* cpA,
 		return NULL;
 	}
 
-	( ( uint32* )pL )[ 0 ] = 0;
-	( ( uint32* )pL )[ 1 ] = 0;
-	( ( uint32* )pL )[ 2 ] = sizeA + bbs_MEM_OFFSET;
+	/* append block to list */
+	bbs_MEM_NEXT( pL ) = NULL;
+	bbs_MEM_PREV( pL ) = ptrA->lastPtrE;
+	bbs_MEM_SIZE( pL ) = blockSizeL;
+	if( ptrA->lastPtrE != NULL )
+	{
+		bbs_MEM_NEXT( ptrA->lastPtrE ) = pL;
+	}
+	else
+	{
+		ptrA->memPtrE = pL;
+	}
+	ptrA->lastPtrE = pL;
+
+	ptrA->allocCountE++;
+	ptrA->sizeE += blockSizeL;
+	bbs_DynMemManager_updatePeakSize( ptrA );
 
 	return pL + bbs_MEM_OFFSET;
 }
@@ -169,6 +349,7 @@ void bbs_DynMemManager_free( struct bbs_Context* cpA,
 							 struct bbs_DynMemManager* ptrA, 
 							 uint16* memPtrA )
 {
+	uint16* pL;
 	bbs_DEF_fNameL( "void bbs_DynMemManager_free( .... )" )
 
 	if( ptrA->memPtrE == NULL )
@@ -176,49 +357,54 @@ void bbs_DynMemManager_free( struct bbs_Context* cpA,
 		bbs_ERROR1( "%s:\n Memory was not allocated.\n", fNameL );
 		return;
 	}
-	else if( ptrA->memPtrE + bbs_MEM_OFFSET == memPtrA )
+
+	pL = bbs_DynMemManager_block( ptrA, memPtrA );
+	if( pL == NULL )
+	{
+		bbs_ERROR1( "%s:\n Attempt to free memory that was not allocated.\n", fNameL );
+		return;
+	}
+
+	if( ptrA->freeFPtrE == NULL )
 	{
-		uint16* memPtrL = ptrA->memPtrE;
-		ptrA->memPtrE = *( uint16** )ptrA->memPtrE;
-		ptrA->freeFPtrE( memPtrL );
+		bbs_ERROR1( "%s:\n Free handler not defined.\n", fNameL );
+		return;
+	}
+
+	/* remove block from list */
+	if( bbs_MEM_PREV( pL ) != NULL )
+	{
+		bbs_MEM_NEXT( bbs_MEM_PREV( pL ) ) = bbs_MEM_NEXT( pL );
 	}
 	else
 	{
-		uint16* p0L = NULL; 
-		uint16* pL = ( uint16* )ptrA->memPtrE;
+		ptrA->memPtrE = bbs_MEM_NEXT( pL );
+	}
 
-		while( pL != NULL )
-		{
-			if( pL + bbs_MEM_OFFSET == memPtrA ) break;
-			p0L = pL;
-			pL = *( uint16** )pL;
-		}
+	if( bbs_MEM_NEXT( pL ) != NULL )
+	{
+		bbs_MEM_PREV( bbs_MEM_NEXT( pL ) ) = bbs_MEM_PREV( pL );
+	}
+	else
+	{
+		ptrA->lastPtrE = bbs_MEM_PREV( pL );
+	}
 
-		if( pL != NULL )
-		{
-			if( ptrA->freeFPtrE == NULL )
-			{
-				bbs_ERROR1( "%s:\n Free handler not defined.\n", fNameL );
-				return;
-			}
-
-			if( p0L != NULL )
-			{
-				*( uint16** )p0L = *( uint16** )pL;
-			}
-			else
-			{
-				ptrA->memPtrE = *( uint16** )pL;
-			}
-
-			ptrA->freeFPtrE( pL );
-		}
-		else
+	ptrA->freeCountE++;
+	ptrA->sizeE -= bbs_MEM_SIZE( pL );
+
+	if( ptrA->arenaBlockSizeE > 0 )
+	{
+		/* memory of the last block taken from the arena is reused */
+		if( pL + bbs_MEM_SIZE( pL ) == ptrA->arenaPtrE + ptrA->arenaIndexE )
 		{
-			bbs_ERROR1( "%s:\n Attempt to free memory that was not allocated.\n", fNameL );
-			return;
+			ptrA->arenaIndexE -= bbs_MEM_SIZE( pL );
 		}
 	}
+	else
+	{
+		ptrA->freeFPtrE( pL );
+	}
 }
 
 /* ------------------------------------------------------------------------- */
@@ -236,11 +422,7 @@ uint16* bbs_DynMemManager_nextBlock( struct bbs_Context* cpA,
 	if( curBlockPtrA != NULL )
 	{
 		/* find current block */
-		while( pL != NULL )
-		{
-			if( pL + bbs_MEM_OFFSET == curBlockPtrA ) break;
-			pL = *( uint16** )pL;
-		}
+		pL = bbs_DynMemManager_block( ptrA, curBlockPtrA );
 
 		if( pL == NULL )
 		{
@@ -250,14 +432,14 @@ uint16* bbs_DynMemManager_nextBlock( struct bbs_Context* cpA,
 		}
 
 		/* go to next block */
-		pL = *( uint16** )pL;
+		pL = bbs_MEM_NEXT( pL );
 	}
 
 	/* find next fitting block */
 	while( pL != NULL )
 	{
-		if( ( ( uint32* )pL )[ 2 ] >= minSizeA + bbs_MEM_OFFSET ) break;
-		pL = *( uint16** )pL;
+		if( bbs_MEM_SIZE( pL ) >= minSizeA + bbs_MEM_OFFSET ) break;
+		pL = bbs_MEM_NEXT( pL );
 	}
 
 	if( pL == NULL )
@@ -267,7 +449,7 @@ uint16* bbs_DynMemManager_nextBlock( struct bbs_Context* cpA,
 		uint16* memPtrL = bbs_DynMemManager_alloc( cpA, ptrA, memSegPtrA, blockSizeL );
 		if( memPtrL != NULL )
 		{
-			*actualSizePtrA = blockSizeL;
+			*actualSizePtrA = bbs_MEM_SIZE( memPtrL - bbs_MEM_OFFSET ) - bbs_MEM_OFFSET;
 		}
 		else
 		{
@@ -277,7 +459,7 @@ uint16* bbs_DynMemManager_nextBlock( struct bbs_Context* cpA,
 	}
 	else
 	{
-		*actualSizePtrA = ( ( uint32* )pL )[ 2 ] - bbs_MEM_OFFSET;
+		*actualSizePtrA = bbs_MEM_SIZE( pL ) - bbs_MEM_OFFSET;
 		return pL + bbs_MEM_OFFSET;
 	}
 }
@@ -286,14 +468,47 @@ uint16* bbs_DynMemManager_nextBlock( struct bbs_Context* cpA,
 
 void bbs_DynMemManager_freeAll( struct bbs_Context* cpA, struct bbs_DynMemManager* ptrA )
 {
-	uint16** ppL = ( uint16** )ptrA->memPtrE;
-	while( ppL != NULL )
+	if( ptrA->arenaBlockSizeE > 0 )
+	{
+		/* memory blocks are released with the arena blocks */
+		bbs_DynMemManager_freeArenaBlocks( ptrA, ptrA->arenaPtrE );
+		ptrA->arenaPtrE = NULL;
+		ptrA->arenaIndexE = 0;
+	}
+	else
+	{
+		uint16** ppL = ( uint16** )ptrA->memPtrE;
+		while( ppL != NULL )
+		{
+			uint16* memPtrL = ( uint16* )ppL;
+			ppL = ( uint16** )*ppL;
+			ptrA->freeFPtrE( memPtrL );
+		}
+	}
+	ptrA->memPtrE = NULL;
+	ptrA->lastPtrE = NULL;
+	ptrA->freeCountE = ptrA->allocCountE;
+	ptrA->sizeE = 0;
+}
+
+/* ------------------------------------------------------------------------- */
+
+void bbs_DynMemManager_reset( struct bbs_Context* cpA, struct bbs_DynMemManager* ptrA )
+{
+	if( ptrA->arenaPtrE == NULL )
 	{
-		uint16* memPtrL = ( uint16* )ppL;
-		ppL = ( uint16** )*ppL;
-		ptrA->freeFPtrE( memPtrL );
+		bbs_DynMemManager_freeAll( cpA, ptrA );
+		return;
 	}
+
+	bbs_DynMemManager_freeArenaBlocks( ptrA, bbs_MEM_NEXT( ptrA->arenaPtrE ) );
+	bbs_MEM_NEXT( ptrA->arenaPtrE ) = NULL;
+	ptrA->arenaIndexE = bbs_ARENA_OFFSET;
+
 	ptrA->memPtrE = NULL;
+	ptrA->lastPtrE = NULL;
+	ptrA->freeCountE = ptrA->allocCountE;
+	ptrA->sizeE = 0;
 }
 
 /* ------------------------------------------------------------------------- */
@@ -50,15 +50,30 @@ typedef void ( *bbs_freeFPtr )( void* memPtrA );
   * Each memory block is organized as follows:
   * - The first 8 bytes are reserved for the pointer to the next 
   *    memory block (8 to allow support of 64-bit platforms).
+  * - The next 8 bytes are reserved for the pointer to the previous memory block.
   * - Next a 32-bit value stores the allocated memory size in 16-bit units.
   * - Finally the actual allocated memory area. 
-  * This means for each new memory block an additional 12 bytes are allocated.
+  * This means for each new memory block an additional 20 bytes are allocated.
+  *
+  * In arena mode (arenaBlockSizeE > 0) memory blocks are not allocated
+  * individually but taken from arena blocks of at least arenaBlockSizeE.
+  * Memory of a freed block is reused only when it was the last block taken
+  * from the current arena block; all arena blocks are released by freeAll.
   */
 struct bbs_DynMemManager 
 {
 
 	/* ---- private data --------------------------------------------------- */
 
+	/** pointer to last memory block */ 
+	uint16* lastPtrE;
+
+	/** pointer to current arena block (arena blocks are linked to the previous ones) */ 
+	uint16* arenaPtrE;
+
+	/** used size of current arena block in 16-bit units */
+	uint32 arenaIndexE;
+
 	/* ---- public data ---------------------------------------------------- */
 
 	/** pointer to first memory block */ 
@@ -69,6 +84,29 @@ struct bbs_DynMemManager
 
 	/** function pointer to external mem free function */
 	bbs_freeFPtr freeFPtrE;
+
+	/** minimum size of arena blocks in 16-bit units; 0: arena mode is off */
+	uint32 arenaBlockSizeE;
+
+	/* ---- statistics (sizes in 16-bit units) ----------------------------- */
+
+	/** number of allocated memory blocks */
+	uint32 allocCountE;
+
+	/** number of freed memory blocks */
+	uint32 freeCountE;
+
+	/** number of calls of the malloc handler */
+	uint32 mallocCountE;
+
+	/** size of currently allocated memory blocks */
+	uint32 sizeE;
+
+	/** peak of sizeE; arena mode: peak of memory used in arena blocks */
+	uint32 peakSizeE;
+
+	/** size of all arena blocks */
+	uint32 arenaSizeE;
 };
 
 /* ---- associated objects ------------------------------------------------- */
@@ -92,6 +130,11 @@ uint32 bbs_DynMemManager_allocatedSize( struct bbs_Context* cpA, const struct bb
 
 /* ---- \ghd{ modify functions } ------------------------------------------- */
 
+/** sets minimum size of arena blocks in 16-bit units (0: arena mode off); must be set before memory is allocated */
+void bbs_DynMemManager_setArenaBlockSize( struct bbs_Context* cpA, 
+										  struct bbs_DynMemManager* ptrA, 
+										  uint32 sizeA );
+
 /* ---- \ghd{ memory I/O } ------------------------------------------------- */
 
 /* ---- \ghd{ exec functions } --------------------------------------------- */
@@ -119,6 +162,10 @@ uint16* bbs_DynMemManager_nextBlock( struct bbs_Context* cpA,
 void bbs_DynMemManager_freeAll( struct bbs_Context* cpA, 
 							    struct bbs_DynMemManager* ptrA );
 
+/** frees all memory blocks at once; in arena mode the current arena block is kept for reuse */
+void bbs_DynMemManager_reset( struct bbs_Context* cpA, 
+							  struct bbs_DynMemManager* ptrA );
+
 
 #endif /* bbs_DYN_MEM_MANAGER_EM_H */
 
@@ -19,6 +19,14 @@
 #include "b_BasicEm/Math.h"
 #include "b_BasicEm/Functions.h"
 
+#if defined( __ARM_NEON__ ) || defined( __ARM_NEON )
+#include <arm_neon.h>
+#define bbs_MATH_NEON
+#elif defined( __SSE2__ ) && !defined( HW_i586 ) && !defined( HW_i686 )
+#include <emmintrin.h>
+#define bbs_MATH_SSE2
+#endif
+
 /* ---- related objects  --------------------------------------------------- */
 
 /* ---- typedefs ----------------------------------------------------------- */
@@ -605,6 +613,96 @@ int32 bbs_dotProduct_arm9e( const int16* vec1A, const int16* vec2A, uint32 sizeA
 
 /* ------------------------------------------------------------------------- */
 
+#if defined( bbs_MATH_NEON )
+
+/** dot product with NEON; no alignment requirements */
+static int32 bbs_dotProduct_neon( const int16* vec1A, const int16* vec2A, uint32 sizeA )
+{
+	int32x4_t accu0L = vdupq_n_s32( 0 );
+	int32x4_t accu1L = vdupq_n_s32( 0 );
+	int32x2_t accuL;
+	int32 sumL;
+
+	for( ; sizeA >= 16; sizeA -= 16 )
+	{
+		int16x8_t v10L = vld1q_s16( vec1A );
+		int16x8_t v20L = vld1q_s16( vec2A );
+		int16x8_t v11L = vld1q_s16( vec1A + 8 );
+		int16x8_t v21L = vld1q_s16( vec2A + 8 );
+		accu0L = vmlal_s16( accu0L, vget_low_s16( v10L ), vget_low_s16( v20L ) );
+		accu1L = vmlal_s16( accu1L, vget_high_s16( v10L ), vget_high_s16( v20L ) );
+		accu0L = vmlal_s16( accu0L, vget_low_s16( v11L ), vget_low_s16( v21L ) );
+		accu1L = vmlal_s16( accu1L, vget_high_s16( v11L ), vget_high_s16( v21L ) );
+		vec1A += 16;
+		vec2A += 16;
+	}
+
+	if( sizeA >= 8 )
+	{
+		int16x8_t v1L = vld1q_s16( vec1A );
+		int16x8_t v2L = vld1q_s16( vec2A );
+		accu0L = vmlal_s16( accu0L, vget_low_s16( v1L ), vget_low_s16( v2L ) );
+		accu1L = vmlal_s16( accu1L, vget_high_s16( v1L ), vget_high_s16( v2L ) );
+		vec1A += 8;
+		vec2A += 8;
+		sizeA -= 8;
+	}
+
+	accu0L = vaddq_s32( accu0L, accu1L );
+	accuL = vadd_s32( vget_low_s32( accu0L ), vget_high_s32( accu0L ) );
+	sumL = vget_lane_s32( vpadd_s32( accuL, accuL ), 0 );
+
+	for( ; sizeA; sizeA-- ) sumL += ( int32 ) *vec1A++ * *vec2A++;
+
+	return sumL;
+}
+
+#endif
+
+/* ------------------------------------------------------------------------- */
+
+#if defined( bbs_MATH_SSE2 )
+
+/** dot product with SSE2; no alignment requirements */
+static int32 bbs_dotProduct_sse2( const int16* vec1A, const int16* vec2A, uint32 sizeA )
+{
+	__m128i accu0L = _mm_setzero_si128();
+	__m128i accu1L = _mm_setzero_si128();
+	int32 sumL;
+
+	for( ; sizeA >= 16; sizeA -= 16 )
+	{
+		accu0L = _mm_add_epi32( accu0L, _mm_madd_epi16( _mm_loadu_si128( ( const __m128i* )vec1A ), 
+														_mm_loadu_si128( ( const __m128i* )vec2A ) ) );
+		accu1L = _mm_add_epi32( accu1L, _mm_madd_epi16( _mm_loadu_si128( ( const __m128i* )( vec1A + 8 ) ), 
+														_mm_loadu_si128( ( const __m128i* )( vec2A + 8 ) ) ) );
+		vec1A += 16;
+		vec2A += 16;
+	}
+
+	if( sizeA >= 8 )
+	{
+		accu0L = _mm_add_epi32( accu0L, _mm_madd_epi16( _mm_loadu_si128( ( const __m128i* )vec1A ), 
+														_mm_loadu_si128( ( const __m128i* )vec2A ) ) );
+		vec1A += 8;
+		vec2A += 8;
+		sizeA -= 8;
+	}
+
+	accu0L = _mm_add_epi32( accu0L, accu1L );
+	accu0L = _mm_add_epi32( accu0L, _mm_shuffle_epi32( accu0L, 0x4E ) );
+	accu0L = _mm_add_epi32( accu0L, _mm_shuffle_epi32( accu0L, 0xB1 ) );
+	sumL = _mm_cvtsi128_si32( accu0L );
+
+	for( ; sizeA; sizeA-- ) sumL += ( int32 ) *vec1A++ * *vec2A++;
+
+	return sumL;
+}
+
+#endif
+
+/* ------------------------------------------------------------------------- */
+
 /**
  * Computes a fast dot product using standard C
  */
@@ -688,6 +786,16 @@ int32 bbs_dotProductInt16( const int16* vec1A, const int16* vec2A, uint32 sizeA
 
 	return bbs_dotProduct_dsp( vec1A, vec2A, sizeA );
 	
+/* ARMv7 and later */
+#elif defined( bbs_MATH_NEON )
+
+	return bbs_dotProduct_neon( vec1A, vec2A, sizeA );
+
+/* x86 ABIs other than the PC builds above */
+#elif defined( bbs_MATH_SSE2 )
+
+	return bbs_dotProduct_sse2( vec1A, vec2A, sizeA );
+
 #elif defined( HW_FR71 )
 
 	uint32 size16L = sizeA & 0xfffffff0;
@@ -995,13 +1103,89 @@ void bbs_vecSqrNorm32( const int32* vecA, uint32 sizeA, uint32* manPtrA, uint32*
 
 /* ------------------------------------------------------------------------- */
 
+/* The square sum below only grows. As long as it does not exceed 0x80000000
+ * the exponent stays 0 and blocks of squares can be added at once with the
+ * same result. The functions add blocks of 16 squares to *sumPtrA until the
+ * next block would exceed that limit and return the number of elements added.
+ */
+
+#if defined( bbs_MATH_NEON )
+
+static uint32 bbs_vecSqrSum16_neon( const int16* vecA, uint32 sizeA, uint32* sumPtrA )
+{
+	uint32 sumL = *sumPtrA;
+	uint32 iL;
+	for( iL = 0; iL + 16 <= sizeA; iL += 16 )
+	{
+		int16x8_t v0L = vld1q_s16( vecA + iL );
+		int16x8_t v1L = vld1q_s16( vecA + iL + 8 );
+
+		/* squares are at most 2^30, so sums of two fit in uint32 */
+		uint32x4_t s0L = vaddq_u32( vreinterpretq_u32_s32( vmull_s16( vget_low_s16( v0L ), vget_low_s16( v0L ) ) ),
+									vreinterpretq_u32_s32( vmull_s16( vget_high_s16( v0L ), vget_high_s16( v0L ) ) ) );
+		uint32x4_t s1L = vaddq_u32( vreinterpretq_u32_s32( vmull_s16( vget_low_s16( v1L ), vget_low_s16( v1L ) ) ),
+									vreinterpretq_u32_s32( vmull_s16( vget_high_s16( v1L ), vget_high_s16( v1L ) ) ) );
+		uint64x2_t blkL = vpadalq_u32( vpaddlq_u32( s0L ), s1L );
+		uint32x2_t blkSumL = vreinterpret_u32_u64( vadd_u64( vget_low_u64( blkL ), vget_high_u64( blkL ) ) );
+
+		/* sumL <= 0x80000000 holds here */
+		if( vget_lane_u32( blkSumL, 1 ) != 0 || vget_lane_u32( blkSumL, 0 ) > 0x80000000 - sumL ) break;
+		sumL += vget_lane_u32( blkSumL, 0 );
+	}
+	*sumPtrA = sumL;
+	return iL;
+}
+
+#endif
+
+#if defined( bbs_MATH_SSE2 )
+
+static uint32 bbs_vecSqrSum16_sse2( const int16* vecA, uint32 sizeA, uint32* sumPtrA )
+{
+	uint32 sumL = *sumPtrA;
+	const __m128i zeroL = _mm_setzero_si128();
+	uint32 iL;
+	for( iL = 0; iL + 16 <= sizeA; iL += 16 )
+	{
+		__m128i v0L = _mm_loadu_si128( ( const __m128i* )( vecA + iL ) );
+		__m128i v1L = _mm_loadu_si128( ( const __m128i* )( vecA + iL + 8 ) );
+
+		/* pair sums are at most 2^31 and read as unsigned */
+		__m128i s0L = _mm_madd_epi16( v0L, v0L );
+		__m128i s1L = _mm_madd_epi16( v1L, v1L );
+		__m128i blkL = _mm_add_epi64( _mm_add_epi64( _mm_unpacklo_epi32( s0L, zeroL ), _mm_unpackhi_epi32( s0L, zeroL ) ),
+									  _mm_add_epi64( _mm_unpacklo_epi32( s1L, zeroL ), _mm_unpackhi_epi32( s1L, zeroL ) ) );
+		uint32 blkSumL;
+
+		blkL = _mm_add_epi64( blkL, _mm_unpackhi_epi64( blkL, blkL ) );
+		blkSumL = ( uint32 )_mm_cvtsi128_si32( blkL );
+
+		/* sumL <= 0x80000000 holds here */
+		if( _mm_cvtsi128_si32( _mm_srli_si128( blkL, 4 ) ) != 0 || blkSumL > 0x80000000 - sumL ) break;
+		sumL += blkSumL;
+	}
+	*sumPtrA = sumL;
+	return iL;
+}
+
+#endif
+
+/* ------------------------------------------------------------------------- */
+
 void bbs_vecSqrNorm16( const int16* vecA, uint32 sizeA, uint32* manPtrA, uint32* expPtrA )
 {
 	uint32 sumL = 0;
 	int32 sumExpL = 0;
 
-	uint32 iL;
-	for( iL = 0; iL < sizeA; iL++ )
+	uint32 iL = 0;
+
+#if defined( bbs_MATH_NEON )
+	iL = bbs_vecSqrSum16_neon( vecA, sizeA, &sumL );
+#elif defined( bbs_MATH_SSE2 )
+	iL = bbs_vecSqrSum16_sse2( vecA, sizeA, &sumL );
+#endif
+
+	for( ; iL < sizeA; iL++ )
 	{
 		int32 vL = vecA[ iL ];
 		uint32 prdL = vL * vL;
@@ -1045,6 +1229,83 @@ uint32 bbs_vecNorm16( const int16* vecA, uint32 sizeA )
 
 /* ------------------------------------------------------------------------- */
 
+/* The functions below compute the first columns of bbs_matMultiplyFlt16 in
+ * blocks of 8 and return the number of computed columns. Each result is
+ * accumulated over the rows of x2A and rounded as in the loop of
+ * bbs_matMultiplyFlt16, so both give the same values.
+ */
+
+#if defined( bbs_MATH_NEON )
+
+static int16 bbs_matMultiplyFlt16_neon( const int16 *x1A, int16 row1A, int16 col1A, const int16 *x2A, int16 col2A, int16 *rA )
+{
+	const int32x4_t rndL = vdupq_n_s32( 1 << 14 );
+	int32 col8L = col2A & ~7;
+	int32 iL, jL, kL;
+	for( iL = 0; iL < row1A; iL++ )
+	{
+		const int16* row1L = x1A + iL * col1A;
+		int16* dstL = rA + iL * col2A;
+		for( jL = 0; jL < col8L; jL += 8 )
+		{
+			const int16* ptr2L = x2A + jL;
+			int32x4_t sum0L = rndL;
+			int32x4_t sum1L = rndL;
+			for( kL = 0; kL < col1A; kL++ )
+			{
+				int16x8_t v2L = vld1q_s16( ptr2L );
+				sum0L = vmlal_n_s16( sum0L, vget_low_s16( v2L ), row1L[ kL ] );
+				sum1L = vmlal_n_s16( sum1L, vget_high_s16( v2L ), row1L[ kL ] );
+				ptr2L += col2A;
+			}
+			vst1q_s16( dstL + jL, vcombine_s16( vshrn_n_s32( sum0L, 15 ), vshrn_n_s32( sum1L, 15 ) ) );
+		}
+	}
+	return col8L;
+}
+
+#endif
+
+#if defined( bbs_MATH_SSE2 )
+
+static int16 bbs_matMultiplyFlt16_sse2( const int16 *x1A, int16 row1A, int16 col1A, const int16 *x2A, int16 col2A, int16 *rA )
+{
+	const __m128i rndL = _mm_set1_epi32( 1 << 14 );
+	int32 col8L = col2A & ~7;
+	int32 iL, jL, kL;
+	for( iL = 0; iL < row1A; iL++ )
+	{
+		const int16* row1L = x1A + iL * col1A;
+		int16* dstL = rA + iL * col2A;
+		for( jL = 0; jL < col8L; jL += 8 )
+		{
+			const int16* ptr2L = x2A + jL;
+			__m128i sum0L = rndL;
+			__m128i sum1L = rndL;
+			for( kL = 0; kL < col1A; kL++ )
+			{
+				__m128i v1L = _mm_set1_epi16( row1L[ kL ] );
+				__m128i v2L = _mm_loadu_si128( ( const __m128i* )ptr2L );
+				__m128i loL = _mm_mullo_epi16( v1L, v2L );
+				__m128i hiL = _mm_mulhi_epi16( v1L, v2L );
+				sum0L = _mm_add_epi32( sum0L, _mm_unpacklo_epi16( loL, hiL ) );
+				sum1L = _mm_add_epi32( sum1L, _mm_unpackhi_epi16( loL, hiL ) );
+				ptr2L += col2A;
+			}
+
+			/* keep the low 16 bits as the int16 conversion does, pack would saturate */
+			sum0L = _mm_srai_epi32( _mm_slli_epi32( _mm_srai_epi32( sum0L, 15 ), 16 ), 16 );
+			sum1L = _mm_srai_epi32( _mm_slli_epi32( _mm_srai_epi32( sum1L, 15 ), 16 ), 16 );
+			_mm_storeu_si128( ( __m128i* )( dstL + jL ), _mm_packs_epi32( sum0L, sum1L ) );
+		}
+	}
+	return col8L;
+}
+
+#endif
+
+/* ------------------------------------------------------------------------- */
+
 void bbs_matMultiplyFlt16( const int16 *x1A, int16 row1A, int16 col1A, const int16 *x2A, int16 col2A, int16 *rA )
 {
 	#if defined( HW_TMS320C5x )
@@ -1103,14 +1364,21 @@ void bbs_matMultiplyFlt16( const int16 *x1A, int16 row1A, int16 col1A, const int
 			}
 		}
 	#else
-		/* needs to be optimized */
 		int16 iL,jL,kL;
 		int16 *ptr1L, *ptr2L;
 		int32 sumL;
+		int16 colsL = 0; /* columns computed with SIMD */
+
+		#if defined( bbs_MATH_NEON )
+			colsL = bbs_matMultiplyFlt16_neon( x1A, row1A, col1A, x2A, col2A, rA );
+		#elif defined( bbs_MATH_SSE2 )
+			colsL = bbs_matMultiplyFlt16_sse2( x1A, row1A, col1A, x2A, col2A, rA );
+		#endif
 		
 		for( iL = 0; iL < row1A; iL++ )
 		{
-			for( jL = 0; jL < col2A; jL++ )
+			rA += colsL;
+			for( jL = colsL; jL < col2A; jL++ )
 			{
 				ptr1L = ( int16* ) x1A + iL * col1A;
 				ptr2L = ( int16* ) x2A + jL;
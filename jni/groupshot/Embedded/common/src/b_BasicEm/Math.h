@@ -121,6 +121,11 @@ int16 bbs_satS16( int32 valA );
  */
 int32 bbs_dotProductInt16( const int16* vec1A, const int16* vec2A, uint32 sizeA );
 
+/** dot product in standard C; reference of the platform specific versions 
+ *  used by bbs_dotProductInt16
+ */
+int32 bbs_dotProduct_stdc( const int16* vec1A, const int16* vec2A, uint32 sizeA );
+
 /** Fermi function ( 1.0 / ( 1.0 + exp( -valA ) ) )
  *  Format valA: 16.16 
  *  Format return: 2.30 
@@ -28,6 +28,11 @@
 #include "b_ImageEm/UInt32Image.h"
 #include "b_ImageEm/UInt16ByteImage.h"
 
+#if defined( __ARM_NEON__ ) || defined( __ARM_NEON )
+#include <arm_neon.h>
+#define bbf_BIT_SUM_NEON
+#endif
+
 /* ---- related objects  --------------------------------------------------- */
 
 /* ---- typedefs ----------------------------------------------------------- */
@@ -45,8 +50,55 @@ extern const uint16 bbf_bit8TblG[ 256 ];
 /** sums up bits in 16 bit variable */
 #define bbf_BIT_SUM_16( vA ) ( bbf_bit8TblG[ vA & 0x00FF ] + bbf_bit8TblG[ ( vA >> 8 ) & 0x00FF ] )
 
-/** sums up bits in 16 bit variable */
-#define bbf_BIT_SUM_32( vA ) ( bbf_bit8TblG[ vA & 0x00FF ] + bbf_bit8TblG[ ( vA >> 8 ) & 0x00FF ]  + bbf_bit8TblG[ ( vA >> 16 ) & 0x00FF ] + bbf_bit8TblG[ ( vA >> 24 ) & 0x00FF ] )
+/** sums up bits in 32 bit variable (table reference) */
+#define bbf_BIT_SUM_32_TBL( vA ) ( bbf_bit8TblG[ ( vA ) & 0x00FF ] + bbf_bit8TblG[ ( ( vA ) >> 8 ) & 0x00FF ]  + bbf_bit8TblG[ ( ( vA ) >> 16 ) & 0x00FF ] + bbf_bit8TblG[ ( ( vA ) >> 24 ) & 0x00FF ] )
+
+/** sums up bits in 32 bit variable
+ *  Uses the popcnt instruction where it is a plain integer instruction.
+ *  On 32 bit ARM it would take a round trip through a NEON register, which
+ *  costs more than the table lookups.
+ */
+#if defined( __POPCNT__ ) || defined( __aarch64__ )
+#define bbf_BIT_SUM_32( vA ) ( ( uint32 )__builtin_popcount( vA ) )
+#else
+#define bbf_BIT_SUM_32( vA ) bbf_BIT_SUM_32_TBL( vA )
+#endif
+
+/** adds bit sums of vA masked with maskPtrA[ 0 ], ..., maskPtrA[ 3 ] to bArrA[ 0 ], ..., bArrA[ 3 ] */
+#ifdef bbf_BIT_SUM_NEON
+#define bbf_BIT_SUM_MASKED_4( bArrA, vA, maskPtrA ) \
+{ \
+	uint8x16_t cntL = vcntq_u8( vreinterpretq_u8_u32( vandq_u32( vdupq_n_u32( vA ), vld1q_u32( maskPtrA ) ) ) ); \
+	vst1q_u32( bArrA, vaddq_u32( vld1q_u32( bArrA ), vpaddlq_u16( vpaddlq_u8( cntL ) ) ) ); \
+}
+#else
+#define bbf_BIT_SUM_MASKED_4( bArrA, vA, maskPtrA ) \
+{ \
+	( bArrA )[ 0 ] += bbf_BIT_SUM_32( ( vA ) & ( maskPtrA )[ 0 ] ); \
+	( bArrA )[ 1 ] += bbf_BIT_SUM_32( ( vA ) & ( maskPtrA )[ 1 ] ); \
+	( bArrA )[ 2 ] += bbf_BIT_SUM_32( ( vA ) & ( maskPtrA )[ 2 ] ); \
+	( bArrA )[ 3 ] += bbf_BIT_SUM_32( ( vA ) & ( maskPtrA )[ 3 ] ); \
+}
+#endif
+
+/** adds bit sums of vA masked with maskPtrA[ 0 ], ..., maskPtrA[ 5 ] to bArrA[ 0 ], ..., bArrA[ 5 ] */
+#ifdef bbf_BIT_SUM_NEON
+#define bbf_BIT_SUM_MASKED_6( bArrA, vA, maskPtrA ) \
+{ \
+	bbf_BIT_SUM_MASKED_4( bArrA, vA, maskPtrA ) \
+	{ \
+		uint8x8_t cntL = vcnt_u8( vreinterpret_u8_u32( vand_u32( vdup_n_u32( vA ), vld1_u32( ( maskPtrA ) + 4 ) ) ) ); \
+		vst1_u32( ( bArrA ) + 4, vadd_u32( vld1_u32( ( bArrA ) + 4 ), vpaddl_u16( vpaddl_u8( cntL ) ) ) ); \
+	} \
+}
+#else
+#define bbf_BIT_SUM_MASKED_6( bArrA, vA, maskPtrA ) \
+{ \
+	bbf_BIT_SUM_MASKED_4( bArrA, vA, maskPtrA ) \
+	( bArrA )[ 4 ] += bbf_BIT_SUM_32( ( vA ) & ( maskPtrA )[ 4 ] ); \
+	( bArrA )[ 5 ] += bbf_BIT_SUM_32( ( vA ) & ( maskPtrA )[ 5 ] ); \
+}
+#endif
 
 
 #endif /* bbf_FUNCTIONS_EM_H */
@@ -191,6 +191,22 @@ int32 bbf_L01Tld1x1Ftr_activity( const struct bbf_Feature* ptrA, const uint32* p
 
 	uint32 bsL = 0;
 
+#ifdef bbf_BIT_SUM_NEON
+	/* data holds pairs of pattern and mask words, vld2 splits them */
+	uint32x4_t bsVecL = vdupq_n_u32( 0 );
+
+	for( iL = ptrL->baseE.patchWidthE >> 2; iL > 0; iL-- )
+	{
+		uint32x4x2_t dataL = vld2q_u32( dataPtrL );
+		uint32x4_t vL = vandq_u32( veorq_u32( vld1q_u32( patchL ), dataL.val[ 0 ] ), dataL.val[ 1 ] );
+		bsVecL = vaddq_u32( bsVecL, vpaddlq_u16( vpaddlq_u8( vcntq_u8( vreinterpretq_u8_u32( vL ) ) ) ) );
+
+		dataPtrL += 8;
+		patchL   += 4;
+	}
+
+	bsL = vgetq_lane_u32( bsVecL, 0 ) + vgetq_lane_u32( bsVecL, 1 ) + vgetq_lane_u32( bsVecL, 2 ) + vgetq_lane_u32( bsVecL, 3 );
+#else
 	for( iL = ptrL->baseE.patchWidthE >> 2; iL > 0; iL-- )
 	{
 		uint32 vL;
@@ -209,6 +225,7 @@ int32 bbf_L01Tld1x1Ftr_activity( const struct bbf_Feature* ptrA, const uint32* p
 		dataPtrL += 8;
 		patchL   += 4;
 	}
+#endif
 
 	return bsL * ptrL->activityFactorE;
 }
@@ -210,17 +210,7 @@ int32 bbf_L04Dns2x2Ftr_activity( const struct bbf_Feature* ptrA, const uint32* p
 				    ( ( patchL[ 1 ] >> 1 ) ^ dataPtrL[ 3 ] ) & borderMaskL;
 
 
-		{
-			uint32 vmL;
-			vmL = vL & dataPtrL[ 4 ];
-			bL[ 0 ] += bbf_BIT_SUM_32( vmL );
-			vmL = vL & dataPtrL[ 5 ];
-			bL[ 1 ] += bbf_BIT_SUM_32( vmL);
-			vmL = vL & dataPtrL[ 6 ];
-			bL[ 2 ] += bbf_BIT_SUM_32( vmL );
-			vmL = vL & dataPtrL[ 7 ];
-			bL[ 3 ] += bbf_BIT_SUM_32( vmL );
-		}
+		bbf_BIT_SUM_MASKED_4( bL, vL, dataPtrL + 4 );
 
 		sumL += bbf_BIT_SUM_32( vL );
 
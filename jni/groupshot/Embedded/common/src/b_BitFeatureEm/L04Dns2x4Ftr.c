@@ -244,17 +244,7 @@ int32 bbf_L04Dns2x4Ftr_activity( const struct bbf_Feature* ptrA, const uint32* p
 			vL = ( ~vL ) & 0x1FFFFFFF;
 
 			/* mask out and count bits */
-			{
-				uint32 vmL;
-				vmL = vL & dataPtrL[ 12 ];
-				bL[ 0 ] += bbf_BIT_SUM_32( vmL );
-				vmL = vL & dataPtrL[ 13 ];
-				bL[ 1 ] += bbf_BIT_SUM_32( vmL);
-				vmL = vL & dataPtrL[ 14 ];
-				bL[ 2 ] += bbf_BIT_SUM_32( vmL );
-				vmL = vL & dataPtrL[ 15 ];
-				bL[ 3 ] += bbf_BIT_SUM_32( vmL );
-			}
+			bbf_BIT_SUM_MASKED_4( bL, vL, dataPtrL + 12 );
 
 			dataPtrL += 16;
 		}
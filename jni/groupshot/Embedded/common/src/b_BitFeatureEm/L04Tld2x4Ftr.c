@@ -249,17 +249,7 @@ int32 bbf_L04Tld2x4Ftr_activity( const struct bbf_Feature* ptrA, const uint32* p
 		/* invert bits */
 		vL = ~vL;
 
-		{
-			uint32 vmL;
-			vmL = vL & dataPtrL[ 12 ];
-			bL[ 0 ] += bbf_BIT_SUM_32( vmL );
-			vmL = vL & dataPtrL[ 13 ];
-			bL[ 1 ] += bbf_BIT_SUM_32( vmL);
-			vmL = vL & dataPtrL[ 14 ];
-			bL[ 2 ] += bbf_BIT_SUM_32( vmL );
-			vmL = vL & dataPtrL[ 15 ];
-			bL[ 3 ] += bbf_BIT_SUM_32( vmL );
-		}
+		bbf_BIT_SUM_MASKED_4( bL, vL, dataPtrL + 12 );
 
 		dataPtrL += 16;
 		patchL  += 8;
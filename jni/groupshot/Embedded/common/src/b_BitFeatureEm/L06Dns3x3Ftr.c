@@ -266,21 +266,7 @@ int32 bbf_L06Dns3x3Ftr_activity( const struct bbf_Feature* ptrA, const uint32* p
 		vL = ~vL;
 
 		/* mask out and count bits */
-		{
-			uint32 vmL;
-			vmL = vL & dataPtrL[ 13 ];
-			bL[ 0 ] += bbf_BIT_SUM_32( vmL );
-			vmL = vL & dataPtrL[ 14 ];
-			bL[ 1 ] += bbf_BIT_SUM_32( vmL );
-			vmL = vL & dataPtrL[ 15 ];
-			bL[ 2 ] += bbf_BIT_SUM_32( vmL );
-			vmL = vL & dataPtrL[ 16 ];
-			bL[ 3 ] += bbf_BIT_SUM_32( vmL );
-			vmL = vL & dataPtrL[ 17 ];
-			bL[ 4 ] += bbf_BIT_SUM_32( vmL );
-			vmL = vL & dataPtrL[ 18 ];
-			bL[ 5 ] += bbf_BIT_SUM_32( vmL );
-		}
+		bbf_BIT_SUM_MASKED_6( bL, vL, dataPtrL + 13 );
 
 		dataPtrL += 19;
 	}
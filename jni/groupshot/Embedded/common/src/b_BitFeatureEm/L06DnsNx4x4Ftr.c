@@ -289,21 +289,7 @@ int32 bbf_L06DnsNx4x4Ftr_activity( const struct bbf_Feature* ptrA, const uint32*
 
 			vL = ~vL;
 
-			{
-				uint32 vmL;
-				vmL = vL & dataPtrL[ 20 ];
-				bL[ 0 ] += bbf_BIT_SUM_32( vmL );
-				vmL = vL & dataPtrL[ 21 ];
-				bL[ 1 ] += bbf_BIT_SUM_32( vmL);
-				vmL = vL & dataPtrL[ 22 ];
-				bL[ 2 ] += bbf_BIT_SUM_32( vmL );
-				vmL = vL & dataPtrL[ 23 ];
-				bL[ 3 ] += bbf_BIT_SUM_32( vmL );
-				vmL = vL & dataPtrL[ 24 ];
-				bL[ 4 ] += bbf_BIT_SUM_32( vmL );
-				vmL = vL & dataPtrL[ 25 ];
-				bL[ 5 ] += bbf_BIT_SUM_32( vmL );
-			}
+			bbf_BIT_SUM_MASKED_6( bL, vL, dataPtrL + 20 );
 
 			dataPtrL += 26;
 		}
@@ -31,6 +31,104 @@
 
 /* ------------------------------------------------------------------------- */
 
+/** stores the pca matrix transposed in pcaMatTrE,
+ *  so that the back projection of each coordinate is a dot product 
+ */
+static void bbf_LocalScanDetector_transposePcaMat( struct bbs_Context* cpA,
+												   struct bbf_LocalScanDetector* ptrA,
+												   struct bbs_MemSeg* mspA )
+{
+	uint32 dimL = ptrA->pcaDimSubSpaceE;
+	uint32 widthL = ptrA->pcaClusterE.clusterE.sizeE * 2;
+	uint32 iL, jL;
+
+	if( dimL == 0 ) return;
+	if( dimL * widthL > ptrA->pcaMatE.sizeE )
+	{
+		bbs_ERR0( bbs_ERR_CORRUPT_DATA, "bbf_LocalScanDetector_transposePcaMat:\npca matrix is too small" );
+		return;
+	}
+
+	bbs_Int16Arr_create( cpA, &ptrA->pcaMatTrE, dimL * widthL, mspA );
+	if( bbs_Context_error( cpA ) ) return;
+
+	for( iL = 0; iL < dimL; iL++ )
+	{
+		for( jL = 0; jL < widthL; jL++ )
+		{
+			ptrA->pcaMatTrE.arrPtrE[ jL * dimL + iL ] = ptrA->pcaMatE.arrPtrE[ iL * widthL + jL ];
+		}
+	}
+}
+
+/* ------------------------------------------------------------------------- */
+
+void bbf_LocalScanDetector_pcaProject( struct bbs_Context* cpA,
+									   const struct bbf_LocalScanDetector* ptrA, 
+									   struct bts_Cluster2D* clusterPtrA )
+{
+	bbs_DEF_fNameL( "bbf_LocalScanDetector_pcaProject" )
+
+	/* mat elements: 8.8 */
+	const int16* matPtrL = ptrA->pcaMatE.arrPtrE;
+	const int16* matTrPtrL = ptrA->pcaMatTrE.arrPtrE;
+	
+	/* same bbp as pca cluster */
+	const int16* avgPtrL = ptrA->pcaAvgE.arrPtrE;
+
+	struct bts_Int16Vec2D* vecArrL = clusterPtrA->vecArrE;
+
+	/* centered vector (x0, y0, x1, y1, ...) */
+	int16 difArrL[ bpi_LOCAL_SCAN_DETECTOR_MAX_CLUSTER_SIZE * 2 ];
+
+	/* projected vector */
+	int16 prjVecL[ bpi_LOCAL_SCAN_DETECTOR_MAX_PCA_DIM ];
+
+	/* width of matrix */
+	uint16 matWidthL = clusterPtrA->sizeE * 2;
+
+	uint32 dimL = ptrA->pcaDimSubSpaceE;
+
+	uint32 iL, jL;
+
+	if( dimL > bpi_LOCAL_SCAN_DETECTOR_MAX_PCA_DIM )
+	{
+		bbs_ERROR1( "%s:\nbpi_RF_LANDMARKER_MAX_PCA_DIM exceeded", fNameL );
+		return;
+	}
+
+	if( clusterPtrA->sizeE > bpi_LOCAL_SCAN_DETECTOR_MAX_CLUSTER_SIZE )
+	{
+		bbs_ERROR1( "%s:\nbpi_LOCAL_SCAN_DETECTOR_MAX_CLUSTER_SIZE exceeded", fNameL );
+		return;
+	}
+
+	for( jL = 0; jL < clusterPtrA->sizeE; jL++ )
+	{
+		difArrL[ 2 * jL + 0 ] = bbs_satS16( ( int32 )vecArrL[ jL ].xE - avgPtrL[ 2 * jL + 0 ] );
+		difArrL[ 2 * jL + 1 ] = bbs_satS16( ( int32 )vecArrL[ jL ].yE - avgPtrL[ 2 * jL + 1 ] );
+	}
+
+	/* forward trafo: one dot product per matrix row */
+	for( iL = 0; iL < dimL; iL++ )
+	{
+		prjVecL[ iL ] = bbs_satS16( ( bbs_dotProductInt16( matPtrL, difArrL, matWidthL ) + 128 ) >> 8 );
+		matPtrL += matWidthL;
+	}
+
+	/* backward trafo: one dot product per row of the transposed matrix */
+	for( jL = 0; jL < clusterPtrA->sizeE; jL++ )
+	{
+		vecArrL[ jL ].xE = ( ( bbs_dotProductInt16( matTrPtrL, prjVecL, dimL ) + 128 ) >> 8 ) + avgPtrL[ 0 ];
+		matTrPtrL += dimL;
+		vecArrL[ jL ].yE = ( ( bbs_dotProductInt16( matTrPtrL, prjVecL, dimL ) + 128 ) >> 8 ) + avgPtrL[ 1 ];
+		matTrPtrL += dimL;
+		avgPtrL += 2;
+	}
+}
+
+/* ------------------------------------------------------------------------- */
+
 /** applies PCA mapping 
  *  Input and output clusters may be identical
  */
@@ -39,14 +137,11 @@ void bbf_LocalScanDetector_pcaMap( struct bbs_Context* cpA,
 								   const struct bts_IdCluster2D* inClusterPtrA,
 								   struct bts_IdCluster2D* outClusterPtrA )
 {
-	bbs_DEF_fNameL( "bbf_LocalScanDetector_pcaMap" )
-
 	struct bts_Cluster2D* tmpCl1PtrL  = ( struct bts_Cluster2D* )&ptrA->tmpCluster1E;
 	struct bts_Cluster2D* tmpCl2PtrL  = ( struct bts_Cluster2D* )&ptrA->tmpCluster2E;
 	struct bts_RBFMap2D*  rbfPtrL     = ( struct bts_RBFMap2D* )&ptrA->rbfMapE;
 	struct bts_Flt16Alt2D altL;
 	uint32 outBbpL = inClusterPtrA->clusterE.bbpE;
-	uint32 iL, jL;
 
 	/* setup two equivalent clusters holding the essential (alt-free) moves to be handled by PCA */
 	bts_IdCluster2D_convertToEqivalentClusters( cpA, 
@@ -61,69 +156,8 @@ void bbf_LocalScanDetector_pcaMap( struct bbs_Context* cpA,
 	bts_RBFMap2D_mapCluster( cpA, rbfPtrL, &ptrA->pcaClusterE.clusterE, tmpCl1PtrL, 6/* ! */ );
 
 	/* PCA projection: cluster1 -> cluster1 */
-	{
-		/* mat elements: 8.8 */
-		const int16* matPtrL = ptrA->pcaMatE.arrPtrE;
-		
-		/* same bbp as pca cluster */
-		const int16* avgPtrL = ptrA->pcaAvgE.arrPtrE;
-
-		struct bts_Int16Vec2D* vecArrL = tmpCl1PtrL->vecArrE;
-
-		/* projected vector */
-		int32 prjVecL[ bpi_LOCAL_SCAN_DETECTOR_MAX_PCA_DIM ];
-
-		/* width of matrix */
-		uint16 matWidthL = tmpCl1PtrL->sizeE * 2;
-
-		if( ptrA->pcaDimSubSpaceE > bpi_LOCAL_SCAN_DETECTOR_MAX_PCA_DIM )
-		{
-			bbs_ERROR1( "%s:\nbpi_RF_LANDMARKER_MAX_PCA_DIM exceeded", fNameL );
-			return;
-		}
-
-		/* forward trafo */
-		for( iL = 0; iL < ptrA->pcaDimSubSpaceE; iL++ )
-		{
-			int32 sumL = 0;
-			avgPtrL = ptrA->pcaAvgE.arrPtrE;
-			for( jL = 0; jL < tmpCl1PtrL->sizeE; jL++ )
-			{
-				sumL += matPtrL[ 0 ] * ( vecArrL[ jL ].xE - avgPtrL[ 0 ] );
-				sumL += matPtrL[ 1 ] * ( vecArrL[ jL ].yE - avgPtrL[ 1 ] );
-				avgPtrL += 2;
-				matPtrL += 2;
-			}
-			prjVecL[ iL ] = ( sumL + 128 ) >> 8;
-		}
-
-		matPtrL = ptrA->pcaMatE.arrPtrE;
-		avgPtrL = ptrA->pcaAvgE.arrPtrE;
-		vecArrL = tmpCl1PtrL->vecArrE;
-
-		/* backward trafo */
-		for( jL = 0; jL < tmpCl1PtrL->sizeE; jL++ )
-		{
-			int32 sumL = 0;
-			for( iL = 0; iL < ptrA->pcaDimSubSpaceE; iL++ )
-			{
-				sumL += matPtrL[ iL * matWidthL + 0 ] * prjVecL[ iL ];
-			}
-
-			vecArrL[ jL ].xE = ( ( sumL + 128 ) >> 8 ) + avgPtrL[ 0 ];
-
-			sumL = 0;
-			for( iL = 0; iL < ptrA->pcaDimSubSpaceE; iL++ )
-			{
-				sumL += matPtrL[ iL * matWidthL + 1 ] * prjVecL[ iL ];
-			}
-
-			vecArrL[ jL ].yE = ( ( sumL + 128 ) >> 8 ) + avgPtrL[ 1 ];
-
-			matPtrL += 2;
-			avgPtrL += 2;
-		}
-	}
+	bbf_LocalScanDetector_pcaProject( cpA, ptrA, tmpCl1PtrL );
+	if( bbs_Context_error( cpA ) ) return;
 
 	/* ALT backtransformation */
 	bts_IdCluster2D_copy( cpA, outClusterPtrA, &ptrA->pcaClusterE ); 
@@ -153,6 +187,7 @@ void bbf_LocalScanDetector_init( struct bbs_Context* cpA,
 	bbs_Int32Arr_init( cpA, &ptrA->actArrE );
 	bbs_Int16Arr_init( cpA, &ptrA->idxArrE );
 	bbs_UInt8Arr_init( cpA, &ptrA->workImageBufE );
+	bbs_Int16Arr_init( cpA, &ptrA->pcaMatTrE );
 	ptrA->maxImageWidthE = 0;
 	ptrA->maxImageHeightE = 0;
 
@@ -194,6 +229,7 @@ void bbf_LocalScanDetector_exit( struct bbs_Context* cpA,
 	bbs_Int32Arr_exit( cpA, &ptrA->actArrE );
 	bbs_Int16Arr_exit( cpA, &ptrA->idxArrE );
 	bbs_UInt8Arr_exit( cpA, &ptrA->workImageBufE );
+	bbs_Int16Arr_exit( cpA, &ptrA->pcaMatTrE );
 	ptrA->maxImageWidthE = 0;
 	ptrA->maxImageHeightE = 0;
 
@@ -409,6 +445,9 @@ uint32 bbf_LocalScanDetector_memRead( struct bbs_Context* cpA,
 		return 0;
 	}
 
+	/* transposed pca matrix for the back projection */
+	bbf_LocalScanDetector_transposePcaMat( cpA, ptrA, espL );
+
 	/* initialize internal data */
 
 	/* ought to be placed on shared memory later */
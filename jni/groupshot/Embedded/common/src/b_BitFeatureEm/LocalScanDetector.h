@@ -85,6 +85,9 @@ struct bbf_LocalScanDetector
 	/** working image buffer */
 	struct bbs_UInt8Arr workImageBufE;
 
+	/** transposed pca projection matrix (8.8) */
+	struct bbs_Int16Arr pcaMatTrE; 
+
 	/* ---- public data ---------------------------------------------------- */
 
 	/** patch width */
@@ -191,6 +194,14 @@ uint32 bbf_LocalScanDetector_memRead( struct bbs_Context* cpA,
 
 /* ---- \ghd{ exec functions } --------------------------------------------- */
 
+/** projects cluster onto the pca subspace and back (in place); 
+ *  cluster must be equivalent to the pca reference cluster
+ *  (step of the pca mapping in bbf_LocalScanDetector_process)
+ */
+void bbf_LocalScanDetector_pcaProject( struct bbs_Context* cpA,
+									   const struct bbf_LocalScanDetector* ptrA, 
+									   struct bts_Cluster2D* clusterPtrA );
+
 /** processes image with cluster; produces output cluster and returns confidence (8.24) 
  *  offsPtrA specifies pixel position (0,0) in input image
  */
@@ -18,6 +18,7 @@
 
 #include "b_BasicEm/Functions.h"
 #include "b_BasicEm/Math.h"
+#include "b_ImageEm/Functions.h"
 #include "b_BitFeatureEm/LocalScanner.h"
 
 /* ------------------------------------------------------------------------- */
@@ -78,27 +79,13 @@ void bbf_LocalScanner_downscale0( struct bbs_Context* cpA, struct bbf_LocalScann
 	int32 h1L = ( h0L - ptrA->yOffE ) >> 1;
 
 	const uint8* iArrL = ptrA->origImagePtrE + ptrA->xOffE + ptrA->yOffE * w0L;
-		  uint8* oArrL = ptrA->workImageBufferE.arrPtrE;
-
-	int32 iL, jL;
-	int32 kL = 0;
 
 	bbs_UInt8Arr_size( cpA, &ptrA->workImageBufferE, w1L * h1L );
 	ptrA->workImagePtrE = ptrA->workImageBufferE.arrPtrE;
 	ptrA->workWidthE = w1L;
 	ptrA->workHeightE = h1L;
 
-	for( jL = 0; jL < h1L; jL++ )
-	{
-		for( iL = 0; iL < w1L; iL++ )
-		{
-			int32 idxL = jL * 2 * w0L + iL * 2;
-			oArrL[ kL++ ] = ( ( uint32 )iArrL[ idxL           ] + 
-										iArrL[ idxL + 1       ] + 
-										iArrL[ idxL + w0L     ] + 
-										iArrL[ idxL + w0L + 1 ] + 2 ) >> 2;
-		}
-	}
+	bim_downscaleBy2( ptrA->workImageBufferE.arrPtrE, iArrL, w0L, w0L - ptrA->xOffE, h0L - ptrA->yOffE );
 }
 
 /* ------------------------------------------------------------------------- */
@@ -111,22 +98,8 @@ void bbf_LocalScanner_downscale1( struct bbs_Context* cpA, struct bbf_LocalScann
 	int32 w1L = w0L >> 1;
 	int32 h1L = h0L >> 1;
 
-    uint8* arrL = ptrA->workImageBufferE.arrPtrE;
-
-	int32 iL, jL;
-	int32 kL = 0;
-
-	for( jL = 0; jL < h1L; jL++ )
-	{
-		for( iL = 0; iL < w1L; iL++ )
-		{
-			int32 idxL = jL * 2 * w0L + iL * 2;
-			arrL[ kL++ ] = ( ( uint32 )arrL[ idxL ] + 
-									   arrL[ idxL + 1 ] + 
-									   arrL[ idxL + w0L ] + 
-									   arrL[ idxL + w0L + 1 ] + 2 ) >> 2;
-		}
-	}
+	/* in place */
+	bim_downscaleBy2( ptrA->workImageBufferE.arrPtrE, ptrA->workImageBufferE.arrPtrE, w0L, w0L, h0L );
 
 	ptrA->workWidthE = w1L;
 	ptrA->workHeightE = h1L;
@@ -20,6 +20,10 @@
 #include "b_BasicEm/Math.h"
 #include "b_BitFeatureEm/ScanDetector.h"
 
+#ifdef _OPENMP
+#include <omp.h>
+#endif
+
 /* ------------------------------------------------------------------------- */
 
 /* ========================================================================= */
@@ -30,6 +34,188 @@
 
 /* ------------------------------------------------------------------------- */
 
+/** Scans scale levels firstLevelA, firstLevelA + levelStepA, ... of the image
+ *  assigned to the main scanner.
+ *  Positives are left in the output positions of the scanner (overlaps removed),
+ *  the best activity of levels without positives is stored in bestArrA
+ *  as x, y, scale, activity.
+ */
+void bbf_ScanDetector_scanLevels( struct bbs_Context* cpA, 
+								  const struct bbf_ScanDetector* ptrA,
+								  struct bbf_Scanner* scannerPtrA,
+								  uint32 firstLevelA,
+								  uint32 levelStepA,
+								  int32* bestArrA )
+{
+	/* best global values (used when no positives could be found) */
+	int32 bestGlobalActL = ( int32 )0x80000000;
+	int32 bestGlobalXL = 0;
+	int32 bestGlobalYL = 0;
+	uint32 bestGlobalScaleL = 0;
+
+	scannerPtrA->minScaleE = ptrA->minScaleE;
+	scannerPtrA->maxScaleE = ptrA->maxScaleE;
+
+	/* resets output positions */
+	bbf_Scanner_resetOutPos( cpA, scannerPtrA ); 
+
+	/* go to first level - reset scanner */
+	if( bbf_Scanner_assignPyramidLevel( cpA, scannerPtrA, &ptrA->bitParamArrE[ 0 ], firstLevelA ) )
+	{
+		while( bbf_Scanner_positions( scannerPtrA ) > 0 )
+		{
+			int32 bestActL = ( int32 )0x80000000;
+			uint32 bestIdxL = 0;
+			uint32 bestLvlL = 0;
+			uint32 iL;
+
+			const struct bbf_Feature* featurePtrL = ( const struct bbf_Feature* )&ptrA->featureArrE[ 0 ];
+			const struct bbf_BitParam* paramPtrL = &ptrA->bitParamArrE[ 0 ];
+			bbf_Scanner_bitParam( cpA, scannerPtrA, paramPtrL );
+
+			/* resets internal positions */
+			bbf_Scanner_resetIntPos( cpA, scannerPtrA );
+
+			do
+			{
+				int32 actL = featurePtrL->vpActivityE( featurePtrL, bbf_Scanner_getPatch( scannerPtrA ) );
+				if( actL > 0 ) 
+				{
+					bbf_Scanner_addIntPos( cpA, scannerPtrA, bbf_Scanner_scanIndex( scannerPtrA ), actL );
+				}
+				
+				if( actL > bestActL )
+				{
+					bestActL = actL;
+					bestIdxL = bbf_Scanner_scanIndex( scannerPtrA );
+				}
+			}
+			while( bbf_Scanner_next( cpA, scannerPtrA ) );
+
+			for( iL = 1; iL < ptrA->featuresE; iL++ )
+			{
+				const struct bbf_Feature* featurePtrL = ( const struct bbf_Feature* )&ptrA->featureArrE[ iL ];
+				const struct bbf_BitParam* paramPtrL = &ptrA->bitParamArrE[ iL ];
+				uint32* idxArrL = scannerPtrA->idxArrE.arrPtrE;
+				int32* actArrL = scannerPtrA->actArrE.arrPtrE;
+
+				uint32 kL = 0;
+				uint32 jL;
+
+				if( scannerPtrA->intCountE == 0 ) break;
+				bestActL = ( int32 )0x80000000;
+				bbf_Scanner_bitParam( cpA, scannerPtrA, paramPtrL );
+
+				for( jL = 0; jL < scannerPtrA->intCountE; jL++ )
+				{
+					int32 actL;
+					bbf_Scanner_goToIndex( cpA, scannerPtrA, idxArrL[ jL ] );
+					actL = featurePtrL->vpActivityE( featurePtrL, bbf_Scanner_getPatch( scannerPtrA ) );
+					if( actL > 0 )
+					{
+						idxArrL[ kL ] = idxArrL[ jL ];
+						actArrL[ kL ] = ( actArrL[ jL ] + actL ) >> 1;
+						kL++;
+					}
+
+					if( actL > bestActL )
+					{
+						bestActL = actL;
+						bestIdxL = idxArrL[ jL ];
+						bestLvlL = iL;
+					}
+				}
+
+				scannerPtrA->intCountE = kL;
+			}
+
+			if( scannerPtrA->intCountE == 0 )
+			{
+				int32 xL, yL;
+				uint32 scaleL;
+
+				/* 8.24 */
+				int32 actL = ( bestActL >> 4 ) + ( ( ( int32 )( bestLvlL + 1 - ptrA->featuresE ) << 24 ) / ( int32 )ptrA->featuresE );
+
+				/* 4.28 */
+				actL <<= 4;
+
+				bbf_Scanner_idxPos( scannerPtrA, bestIdxL, &xL, &yL, &scaleL );
+
+				if( actL > bestGlobalActL )
+				{
+	            	bestGlobalActL = actL;
+					bestGlobalXL = xL;
+					bestGlobalYL = yL;
+					bestGlobalScaleL = scaleL;
+				}
+			}
+			else
+			{
+				/* remove overlaps for current scale */
+				bbf_Scanner_removeIntOverlaps( cpA, scannerPtrA, ptrA->overlapThrE );
+
+				for( iL = 0; iL < scannerPtrA->intCountE; iL++ )
+				{
+					int32 xL, yL;
+					uint32 scaleL;
+					uint32* idxArrL = scannerPtrA->idxArrE.arrPtrE;
+					int32* actArrL = scannerPtrA->actArrE.arrPtrE;
+
+					int32 actL = actArrL[ iL ];
+					bbf_Scanner_idxPos( scannerPtrA, idxArrL[ iL ], &xL, &yL, &scaleL );
+
+					/* add external position */
+					bbf_Scanner_addOutPos( cpA, scannerPtrA, xL, yL, scaleL, actL ); 
+				}
+
+				/* remove overlapping positions */
+				bbf_Scanner_removeOutOverlaps( cpA, scannerPtrA, ptrA->overlapThrE ); 
+
+			}
+
+			if( !bbf_Scanner_nextScales( cpA, scannerPtrA, levelStepA ) ) break;
+		}
+	}
+
+	bestArrA[ 0 ] = bestGlobalXL;
+	bestArrA[ 1 ] = bestGlobalYL;
+	bestArrA[ 2 ] = ( int32 )bestGlobalScaleL;
+	bestArrA[ 3 ] = bestGlobalActL;
+}
+
+/* ------------------------------------------------------------------------- */
+
+/** Allocates scanners for parallel scanning as needed; returns number of
+ *  scanners available including the main one (at most workersA).
+ *  Static memory segments are sized for the main scanner only, so scanners
+ *  are only added when dynamic memory is available.
+ */
+uint32 bbf_ScanDetector_createWorkers( struct bbs_Context* cpA, 
+									   struct bbf_ScanDetector* ptrA,
+									   uint32 workersA )
+{
+	struct bbs_MemSeg* espL;
+
+	if( workersA > bbf_SCAN_DETECTOR_MAX_WORKERS ) workersA = bbf_SCAN_DETECTOR_MAX_WORKERS;
+	if( workersA <= ptrA->workersE + 1 ) return workersA;
+
+	espL = bbs_MemTbl_segPtr( cpA, &cpA->memTblE, 0 );
+	if( bbs_Context_error( cpA ) ) return 0;
+	if( espL->dynMemManagerPtrE == NULL ) return ptrA->workersE + 1;
+
+	while( ptrA->workersE + 1 < workersA )
+	{
+		bbf_Scanner_createWorker( cpA, &ptrA->workerArrE[ ptrA->workersE ], &ptrA->scannerE, &cpA->memTblE );
+		if( bbs_Context_error( cpA ) ) return 0;
+		ptrA->workersE++;
+	}
+
+	return workersA;
+}
+
+/* ------------------------------------------------------------------------- */
+
 /* ========================================================================= */
 /*                                                                           */
 /* ---- \ghd{ constructor / destructor } ----------------------------------- */
@@ -48,6 +234,8 @@ void bbf_ScanDetector_init( struct bbs_Context* cpA,
 	ptrA->maxImageWidthE = 0;
 	ptrA->maxImageHeightE = 0;
 	bbf_Scanner_init( cpA, &ptrA->scannerE );
+	for( iL = 0; iL < bbf_SCAN_DETECTOR_MAX_WORKERS - 1; iL++ ) bbf_Scanner_init( cpA, &ptrA->workerArrE[ iL ] );
+	ptrA->workersE = 0;
 
 	ptrA->patchWidthE = 0;
 	ptrA->patchHeightE = 0;
@@ -76,6 +264,8 @@ void bbf_ScanDetector_exit( struct bbs_Context* cpA,
 	ptrA->maxImageWidthE = 0;
 	ptrA->maxImageHeightE = 0;
 	bbf_Scanner_exit( cpA, &ptrA->scannerE );
+	for( iL = 0; iL < ptrA->workersE; iL++ ) bbf_Scanner_exit( cpA, &ptrA->workerArrE[ iL ] );
+	ptrA->workersE = 0;
 
 	ptrA->patchWidthE = 0;
 	ptrA->patchHeightE = 0;
@@ -302,17 +492,12 @@ uint32 bbf_ScanDetector_process( struct bbs_Context* cpA,
 								 const struct bts_Int16Rect* roiPtrA,
 								 int32** outArrPtrPtrA )
 {
-	/* best global values (used when no positives could be found) */
-	int32 bestGlobalActL = ( int32 )0x80000000;
-	int32 bestGlobalXL = 0;
-	int32 bestGlobalYL = 0;
-	uint32 bestGlobalScaleL = 0;
+	/* best values of the scanners (used when no positives could be found) */
+	int32 bestArrL[ bbf_SCAN_DETECTOR_MAX_WORKERS ][ 4 ];
+	uint32 workersL = 1;
 
 	struct bbf_Scanner* scannerPtrL = &ptrA->scannerE;
 
-	scannerPtrL->minScaleE = ptrA->minScaleE;
-	scannerPtrL->maxScaleE = ptrA->maxScaleE;
-
 	*outArrPtrPtrA = NULL;
 
 	if( bbs_Context_error( cpA ) ) return 0;
@@ -328,125 +513,84 @@ uint32 bbf_ScanDetector_process( struct bbs_Context* cpA,
 		return 0;
 	}
 
-	/* resets output positions */
-	bbf_Scanner_resetOutPos( cpA, scannerPtrL ); 
+#ifdef _OPENMP
+	/* nested in a parallel region (e.g. several images at once) the scan stays serial */
+	if( !omp_in_parallel() ) workersL = bbf_ScanDetector_createWorkers( cpA, ptrA, omp_get_max_threads() );
+	if( bbs_Context_error( cpA ) ) return 0;
+#endif
 
-	/* assign image to scanner - reset scanner */
-	bbf_Scanner_assign( cpA, scannerPtrL, imagePtrA, imageWidthA, imageHeightA, roiPtrA, &ptrA->bitParamArrE[ 0 ] );
+	/* assign image to main scanner */
+	scannerPtrL->minScaleE = ptrA->minScaleE;
+	scannerPtrL->maxScaleE = ptrA->maxScaleE;
+	bbf_Scanner_assignImage( cpA, scannerPtrL, imagePtrA, imageWidthA, imageHeightA, roiPtrA );
+	if( bbs_Context_error( cpA ) ) return 0;
 
-	while( bbf_Scanner_positions( scannerPtrL ) > 0 )
+	if( workersL <= 1 )
 	{
-		int32 bestActL = ( int32 )0x80000000;
-		uint32 bestIdxL = 0;
-		uint32 bestLvlL = 0;
-		uint32 iL;
-
-		const struct bbf_Feature* featurePtrL = ( const struct bbf_Feature* )&ptrA->featureArrE[ 0 ];
-		const struct bbf_BitParam* paramPtrL = &ptrA->bitParamArrE[ 0 ];
-		bbf_Scanner_bitParam( cpA, scannerPtrL, paramPtrL );
-
-		/* resets internal positions */
-		bbf_Scanner_resetIntPos( cpA, scannerPtrL );
-
-		do
+		bbf_ScanDetector_scanLevels( cpA, ptrA, scannerPtrL, 0, 1, bestArrL[ 0 ] );
+	}
+	else
+	{
+		/* Workers read the work image pyramid of the main scanner, so it is
+		 * computed completely up front. Each scanner takes every workersL-th
+		 * level; larger (costlier) levels are spread evenly that way.
+		 * Workers report errors in own contexts.
+		 */
+		struct bbs_Error errArrL[ bbf_SCAN_DETECTOR_MAX_WORKERS ];
+		flag errFlagArrL[ bbf_SCAN_DETECTOR_MAX_WORKERS ];
+		int32 wL;
+		uint32 iL, jL;
+
+		bbf_Scanner_buildPyramid( cpA, scannerPtrL );
+		if( bbs_Context_error( cpA ) ) return 0;
+
+		#pragma omp parallel for num_threads( workersL )
+		for( wL = 0; wL < ( int32 )workersL; wL++ )
 		{
-			int32 actL = featurePtrL->vpActivityE( featurePtrL, bbf_Scanner_getPatch( scannerPtrL ) );
-			if( actL > 0 ) 
+			errFlagArrL[ wL ] = FALSE;
+			if( wL == 0 )
 			{
-				bbf_Scanner_addIntPos( cpA, scannerPtrL, bbf_Scanner_scanIndex( scannerPtrL ), actL );
+				bbf_ScanDetector_scanLevels( cpA, ptrA, scannerPtrL, 0, workersL, bestArrL[ 0 ] );
 			}
-			
-			if( actL > bestActL )
+			else
 			{
-				bestActL = actL;
-				bestIdxL = bbf_Scanner_scanIndex( scannerPtrL );
-			}
-		}
-		while( bbf_Scanner_next( cpA, scannerPtrL ) );
-
-		for( iL = 1; iL < ptrA->featuresE; iL++ )
-		{
-			const struct bbf_Feature* featurePtrL = ( const struct bbf_Feature* )&ptrA->featureArrE[ iL ];
-			const struct bbf_BitParam* paramPtrL = &ptrA->bitParamArrE[ iL ];
-			uint32* idxArrL = scannerPtrL->idxArrE.arrPtrE;
-			int32* actArrL = scannerPtrL->actArrE.arrPtrE;
-
-			uint32 kL = 0;
-			uint32 jL;
-
-			if( scannerPtrL->intCountE == 0 ) break;
-			bestActL = ( int32 )0x80000000;
-			bbf_Scanner_bitParam( cpA, scannerPtrL, paramPtrL );
-
-			for( jL = 0; jL < scannerPtrL->intCountE; jL++ )
-			{
-				int32 actL;
-				bbf_Scanner_goToIndex( cpA, scannerPtrL, idxArrL[ jL ] );
-				actL = featurePtrL->vpActivityE( featurePtrL, bbf_Scanner_getPatch( scannerPtrL ) );
-				if( actL > 0 )
+				struct bbs_Context contextL;
+				bbs_Context_init( &contextL );
+				bbf_ScanDetector_scanLevels( &contextL, ptrA, &ptrA->workerArrE[ wL - 1 ], wL, workersL, bestArrL[ wL ] );
+				if( bbs_Context_error( &contextL ) )
 				{
-					idxArrL[ kL ] = idxArrL[ jL ];
-					actArrL[ kL ] = ( actArrL[ jL ] + actL ) >> 1;
-					kL++;
-				}
-
-				if( actL > bestActL )
-				{
-					bestActL = actL;
-					bestIdxL = idxArrL[ jL ];
-					bestLvlL = iL;
+					errArrL[ wL ] = bbs_Context_popError( &contextL );
+					errFlagArrL[ wL ] = TRUE;
 				}
+				bbs_Context_exit( &contextL );
 			}
-
-			scannerPtrL->intCountE = kL;
 		}
 
-		if( scannerPtrL->intCountE == 0 )
+		for( iL = 1; iL < workersL; iL++ )
 		{
-			int32 xL, yL;
-			uint32 scaleL;
-
-			/* 8.24 */
-			int32 actL = ( bestActL >> 4 ) + ( ( ( int32 )( bestLvlL + 1 - ptrA->featuresE ) << 24 ) / ( int32 )ptrA->featuresE );
-
-			/* 4.28 */
-			actL <<= 4;
-
-			bbf_Scanner_idxPos( scannerPtrL, bestIdxL, &xL, &yL, &scaleL );
+			if( errFlagArrL[ iL ] ) bbs_Context_pushError( cpA, errArrL[ iL ] );
+		}
+		if( bbs_Context_error( cpA ) ) return 0;
 
-			if( actL > bestGlobalActL )
+		/* merge positions of all levels and remove overlaps among them */
+		for( iL = 1; iL < workersL; iL++ )
+		{
+			const struct bbf_Scanner* workerPtrL = &ptrA->workerArrE[ iL - 1 ];
+			const int32* outArrL = workerPtrL->outArrE.arrPtrE;
+			for( jL = 0; jL < workerPtrL->outCountE; jL++ )
 			{
-            	bestGlobalActL = actL;
-				bestGlobalXL = xL;
-				bestGlobalYL = yL;
-				bestGlobalScaleL = scaleL;
+				bbf_Scanner_addOutPos( cpA, scannerPtrL, outArrL[ jL * 4 + 0 ], outArrL[ jL * 4 + 1 ], outArrL[ jL * 4 + 2 ], outArrL[ jL * 4 + 3 ] );
 			}
-		}
-		else
-		{
-			/* remove overlaps for current scale */
-			bbf_Scanner_removeIntOverlaps( cpA, scannerPtrL, ptrA->overlapThrE );
 
-			for( iL = 0; iL < scannerPtrL->intCountE; iL++ )
+			/* best of lower scale wins a tie, as when scanning serially */
+			if( bestArrL[ iL ][ 3 ] > bestArrL[ 0 ][ 3 ] || 
+				( bestArrL[ iL ][ 3 ] == bestArrL[ 0 ][ 3 ] && ( uint32 )bestArrL[ iL ][ 2 ] < ( uint32 )bestArrL[ 0 ][ 2 ] ) )
 			{
-				int32 xL, yL;
-				uint32 scaleL;
-				uint32* idxArrL = scannerPtrL->idxArrE.arrPtrE;
-				int32* actArrL = scannerPtrL->actArrE.arrPtrE;
-
-				int32 actL = actArrL[ iL ];
-				bbf_Scanner_idxPos( scannerPtrL, idxArrL[ iL ], &xL, &yL, &scaleL );
-
-				/* add external position */
-				bbf_Scanner_addOutPos( cpA, scannerPtrL, xL, yL, scaleL, actL ); 
+				bbs_memcpy32( bestArrL[ 0 ], bestArrL[ iL ], 4 );
 			}
-
-			/* remove overlapping positions */
-			bbf_Scanner_removeOutOverlaps( cpA, scannerPtrL, ptrA->overlapThrE ); 
-
 		}
 
-		if( !bbf_Scanner_nextScale( cpA, scannerPtrL ) ) break;
+		bbf_Scanner_removeOutOverlaps( cpA, scannerPtrL, ptrA->overlapThrE ); 
 	}
 /*
 	{
@@ -469,7 +613,7 @@ uint32 bbf_ScanDetector_process( struct bbs_Context* cpA,
 	if( scannerPtrL->outCountE == 0 )
 	{
 		/* no positive activities found: store best negative activity */
-		bbf_Scanner_addOutPos( cpA, scannerPtrL, bestGlobalXL, bestGlobalYL, bestGlobalScaleL, bestGlobalActL );
+		bbf_Scanner_addOutPos( cpA, scannerPtrL, bestArrL[ 0 ][ 0 ], bestArrL[ 0 ][ 1 ], ( uint32 )bestArrL[ 0 ][ 2 ], bestArrL[ 0 ][ 3 ] );
 		return 0;
 	}
 	else
@@ -480,5 +624,102 @@ uint32 bbf_ScanDetector_process( struct bbs_Context* cpA,
 
 /* ------------------------------------------------------------------------- */
 
+uint32 bbf_ScanDetector_track( struct bbs_Context* cpA, 
+							   struct bbf_ScanDetector* ptrA,
+							   const void* imagePtrA,
+							   uint32 imageWidthA,
+							   uint32 imageHeightA,
+							   const struct bts_Int16Rect* roiPtrA,
+							   const int32* posArrA,
+							   uint32 sizeA,
+							   int32* actArrA,
+							   int32** outArrPtrPtrA )
+{
+	/* positions found in all sections */
+	int32 foundArrL[ bbf_SCAN_DETECTOR_MAX_TRACK_POSITIONS * 4 ];
+	uint32 foundL = 0;
+
+	/* detection range is narrowed for each section */
+	uint32 minScaleL = ptrA->minScaleE;
+	uint32 maxScaleL = ptrA->maxScaleE;
+
+	struct bbf_Scanner* scannerPtrL = &ptrA->scannerE;
+	struct bts_Int16Rect roiL;
+	uint32 iL, jL;
+
+	*outArrPtrPtrA = NULL;
+
+	if( bbs_Context_error( cpA ) ) return 0;
+
+	roiL = ( roiPtrA != NULL ) ? *roiPtrA : bts_Int16Rect_create( 0, 0, ( int16 )imageWidthA, ( int16 )imageHeightA );
+
+	for( iL = 0; iL < sizeA; iL++ )
+	{
+		const int32* posL = posArrA + iL * 4;
+		uint32 scaleL = ( uint32 )posL[ 2 ];
+
+		/* patch size at scale of position */
+		int32 wL = ( int32 )( ( ptrA->patchWidthE  * ( scaleL >> 12 ) + 128 ) >> 8 );
+		int32 hL = ( int32 )( ( ptrA->patchHeightE * ( scaleL >> 12 ) + 128 ) >> 8 );
+
+		/* section of twice the patch size around patch (image coordinates) */
+		int32 x1L = roiL.x1E + ( ( posL[ 0 ] + ( 1 << 15 ) ) >> 16 ) - ( wL >> 1 );
+		int32 y1L = roiL.y1E + ( ( posL[ 1 ] + ( 1 << 15 ) ) >> 16 ) - ( hL >> 1 );
+		int32 x2L = x1L + ( wL << 1 );
+		int32 y2L = y1L + ( hL << 1 );
+
+		struct bts_Int16Rect sectionL;
+		uint32 outCountL;
+		int32* outArrL;
+
+		if( actArrA != NULL ) actArrA[ iL ] = 0;
+
+		x1L = x1L > roiL.x1E ? x1L : roiL.x1E;
+		y1L = y1L > roiL.y1E ? y1L : roiL.y1E;
+		x2L = x2L < roiL.x2E ? x2L : roiL.x2E;
+		y2L = y2L < roiL.y2E ? y2L : roiL.y2E;
+		if( x2L <= x1L || y2L <= y1L ) continue;
+
+		ptrA->minScaleE = scaleL - ( scaleL >> 2 );
+		ptrA->maxScaleE = scaleL + ( scaleL >> 2 );
+		if( ptrA->minScaleE < minScaleL ) ptrA->minScaleE = minScaleL;
+		if( maxScaleL > 0 && ptrA->maxScaleE > maxScaleL ) ptrA->maxScaleE = maxScaleL;
+		if( ptrA->minScaleE > ptrA->maxScaleE ) continue;
+
+		sectionL = bts_Int16Rect_create( ( int16 )x1L, ( int16 )y1L, ( int16 )x2L, ( int16 )y2L );
+		outCountL = bbf_ScanDetector_process( cpA, ptrA, imagePtrA, imageWidthA, imageHeightA, &sectionL, &outArrL );
+		if( bbs_Context_error( cpA ) ) break;
+
+		/* first position has the highest activity (best negative if nothing was found) */
+		if( actArrA != NULL ) actArrA[ iL ] = outArrL[ 3 ];
+
+		for( jL = 0; jL < outCountL && foundL < bbf_SCAN_DETECTOR_MAX_TRACK_POSITIONS; jL++ )
+		{
+			foundArrL[ foundL * 4 + 0 ] = outArrL[ jL * 4 + 0 ] + ( ( x1L - roiL.x1E ) << 16 );
+			foundArrL[ foundL * 4 + 1 ] = outArrL[ jL * 4 + 1 ] + ( ( y1L - roiL.y1E ) << 16 );
+			foundArrL[ foundL * 4 + 2 ] = outArrL[ jL * 4 + 2 ];
+			foundArrL[ foundL * 4 + 3 ] = outArrL[ jL * 4 + 3 ];
+			foundL++;
+		}
+	}
+
+	ptrA->minScaleE = minScaleL;
+	ptrA->maxScaleE = maxScaleL;
+	if( bbs_Context_error( cpA ) ) return 0;
+
+	/* sections of close faces overlap: merge positions and remove duplicates */
+	bbf_Scanner_resetOutPos( cpA, scannerPtrL );
+	for( jL = 0; jL < foundL; jL++ )
+	{
+		bbf_Scanner_addOutPos( cpA, scannerPtrL, foundArrL[ jL * 4 + 0 ], foundArrL[ jL * 4 + 1 ], ( uint32 )foundArrL[ jL * 4 + 2 ], foundArrL[ jL * 4 + 3 ] );
+	}
+	bbf_Scanner_removeOutOverlaps( cpA, scannerPtrL, ptrA->overlapThrE ); 
+
+	*outArrPtrPtrA = scannerPtrL->outArrE.arrPtrE;
+	return scannerPtrL->outCountE;
+}
+
+/* ------------------------------------------------------------------------- */
+
 /* ========================================================================= */
 
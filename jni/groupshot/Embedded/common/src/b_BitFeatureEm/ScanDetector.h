@@ -41,6 +41,12 @@
 /* maximum number of features in scan detector */
 #define bbf_SCAN_DETECTOR_MAX_FEATURES 4
 
+/* maximum number of scanners working in parallel */
+#define bbf_SCAN_DETECTOR_MAX_WORKERS 4
+
+/* maximum number of positions collected by bbf_ScanDetector_track */
+#define bbf_SCAN_DETECTOR_MAX_TRACK_POSITIONS 64
+
 /* ---- object definition -------------------------------------------------- */
 
 /** discrete feature set */
@@ -63,6 +69,12 @@ struct bbf_ScanDetector
 	/** scanner */
 	struct bbf_Scanner scannerE;
 
+	/** scanners working in parallel to scannerE (allocated on demand) */
+	struct bbf_Scanner workerArrE[ bbf_SCAN_DETECTOR_MAX_WORKERS - 1 ];
+
+	/** number of allocated scanners in workerArrE */
+	uint32 workersE;
+
 	/* ---- public data ---------------------------------------------------- */
 
 	/** patch width */
@@ -174,6 +186,11 @@ uint32 bbf_ScanDetector_memRead( struct bbs_Context* cpA,
  *  eventually be adjusted externally.
  *  The roi rectangle must not include pixels outside of the original image
  *  (checked -> error). The rectangle may be of uneven width.
+ *
+ *  When built with OpenMP and not called from a parallel region, scale levels
+ *  are distributed among up to bbf_SCAN_DETECTOR_MAX_WORKERS scanners running
+ *  in parallel. Their scanners are allocated on first use, from dynamic
+ *  memory only.
  */
 uint32 bbf_ScanDetector_process( struct bbs_Context* cpA, 
 							     struct bbf_ScanDetector* ptrA,
@@ -183,5 +200,31 @@ uint32 bbf_ScanDetector_process( struct bbs_Context* cpA,
 								 const struct bts_Int16Rect* roiPtrA,
 								 int32** outArrPtrPtrA );
 
+/** Scans image only around sizeA given positions (e.g. the faces found in a
+ *  previous, nearly identical frame) and returns number of detected positions.
+ *  posArrA holds the positions in the output format of bbf_ScanDetector_process
+ *  with coordinates referring to *roiPtrA (whole image if roiPtrA is NULL);
+ *  it must not point to the output data of this detector, which are overwritten.
+ *
+ *  Each position is searched in a section of twice its size around it and at
+ *  scales within +-25% of its own (limited to the detection range).
+ *  Positions found are merged, freed of overlaps and stored like the output of
+ *  bbf_ScanDetector_process, coordinates referring to *roiPtrA. Unlike there,
+ *  no position is stored when nothing was found.
+ *
+ *  If actArrA is not NULL, actArrA[ i ] receives the highest activity found
+ *  around position i; it is negative (or 0) when the position was lost.
+ */
+uint32 bbf_ScanDetector_track( struct bbs_Context* cpA, 
+							   struct bbf_ScanDetector* ptrA,
+							   const void* imagePtrA,
+							   uint32 imageWidthA,
+							   uint32 imageHeightA,
+							   const struct bts_Int16Rect* roiPtrA,
+							   const int32* posArrA,
+							   uint32 sizeA,
+							   int32* actArrA,
+							   int32** outArrPtrPtrA );
+
 #endif /* bbf_SCAN_DETECTOR_EM_H */
 
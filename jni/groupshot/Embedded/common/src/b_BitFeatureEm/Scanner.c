@@ -18,8 +18,20 @@
 
 #include "b_BasicEm/Functions.h"
 #include "b_BasicEm/Math.h"
+#include "b_ImageEm/Functions.h"
 #include "b_BitFeatureEm/Scanner.h"
 
+#if defined( __ARM_NEON__ ) || defined( __ARM_NEON )
+#include <arm_neon.h>
+#define bbf_SCANNER_NEON
+
+/** ( v0A * ( 0x10000 - wA ) + v1A * wA ) in 4 lanes of 32 bit, wA < 0x10000
+ *  computed as ( v0A << 16 ) - v0A * wA + v1A * wA to keep weights in 16 bit
+ */
+#define bbf_SCANNER_LERP_U16X4( v0A, v1A, wA ) \
+	vmlal_u16( vmlsl_u16( vshll_n_u16( v0A, 16 ), v0A, wA ), v1A, wA )
+#endif
+
 /* ------------------------------------------------------------------------- */
 
 /* ========================================================================= */
@@ -40,15 +52,49 @@ uint32 bbf_Scanner_scalePrd( uint32 scaleA, uint32 factorA /*0.32 */ )\
 
 /* ------------------------------------------------------------------------- */
 
-/** allocates arays */
+/** effective max scale (12.20) for work image of given size */
+uint32 bbf_Scanner_effMaxScale( const struct bbf_Scanner* ptrA, uint32 widthA, uint32 heightA )
+{
+	/* 16.16 */
+	uint32 maxHScaleL = ( widthA << 16 ) / ( ptrA->patchWidthE + 1 );
+	uint32 maxVScaleL = ( heightA << 16 ) / ( ptrA->patchHeightE + 1 );
+
+	/* 12.20 */
+	uint32 effMaxScaleL = maxHScaleL < maxVScaleL ? ( maxHScaleL << 4 ) : ( maxVScaleL << 4 );
+
+	if( ptrA->maxScaleE > 0 ) effMaxScaleL = effMaxScaleL < ptrA->maxScaleE ? effMaxScaleL : ptrA->maxScaleE;
+
+	return effMaxScaleL;
+}
+
+/* ------------------------------------------------------------------------- */
+
+/** size of work image pyramid (16 bit words) for image of given size */
+uint32 bbf_Scanner_pyramidSize( uint32 widthA, uint32 heightA )
+{
+	uint32 sizeL = 0;
+	uint32 iL;
+	for( iL = 0; iL < bbf_SCANNER_MAX_LEVELS && widthA > 0 && heightA > 0; iL++ )
+	{
+		sizeL += ( ( widthA >> 1 ) + ( widthA & 1 ) ) * heightA;
+		widthA >>= 1;
+		heightA >>= 1;
+	}
+	return sizeL;
+}
+
+/* ------------------------------------------------------------------------- */
+
+/** allocates arays; exclusiveMemoryA: no shared memory is used at all */
 void bbf_Scanner_alloc( struct bbs_Context* cpA,
 						struct bbf_Scanner* ptrA, 
 						struct bbs_MemTbl* mtpA,
-						flag maximizeSharedMemoryA )
+						flag maximizeSharedMemoryA,
+						flag exclusiveMemoryA )
 {
 	struct bbs_MemTbl memTblL = *mtpA;
 	struct bbs_MemSeg* espL = bbs_MemTbl_segPtr( cpA, &memTblL, 0 );
-	struct bbs_MemSeg* sspL = bbs_MemTbl_sharedSegPtr( cpA, &memTblL, 0 );
+	struct bbs_MemSeg* sspL = exclusiveMemoryA ? espL : bbs_MemTbl_sharedSegPtr( cpA, &memTblL, 0 );
 	struct bbs_MemSeg* mspL = maximizeSharedMemoryA ? sspL : espL;
 
 	/* filter patch dimension */
@@ -63,10 +109,13 @@ void bbf_Scanner_alloc( struct bbs_Context* cpA,
 	uint32 xwoL = woL + ( ptrA->borderWidthE  << 1 );
 	uint32 xhoL = hoL + ( ptrA->borderHeightE << 1 );
 
-	/* allocate working image */
-	bbs_UInt16Arr_create( cpA, &ptrA->workImageE, ( ( woL >> 1 ) + ( woL & 1 ) ) * hoL, mspL );
-	if( bbs_Context_error( cpA ) ) return;
-	bbs_UInt16Arr_fill( cpA, &ptrA->workImageE, 0 );
+	/* allocate working image pyramid */
+	if( ptrA->pyrSrcPtrE == NULL )
+	{
+		bbs_UInt16Arr_create( cpA, &ptrA->workImageE, bbf_Scanner_pyramidSize( woL, hoL ), mspL );
+		if( bbs_Context_error( cpA ) ) return;
+		bbs_UInt16Arr_fill( cpA, &ptrA->workImageE, 0 );
+	}
 
 	/* allocate bit image */
 	bim_UInt32Image_create( cpA, &ptrA->bitImageE, xwoL, ( xhoL >> 5 ) + ( ( ( xhoL & 0x1F ) != 0 ) ? 1 : 0 ), mspL );
@@ -93,41 +142,97 @@ void bbf_Scanner_alloc( struct bbs_Context* cpA,
 
 /* ------------------------------------------------------------------------- */
 
-/** downscales work image */
-void bbf_Scanner_downscale( struct bbs_Context* cpA, struct bbf_Scanner* ptrA )
+/** work image at current level */
+const uint16* bbf_Scanner_workImagePtr( const struct bbf_Scanner* ptrA )
 {
-	uint32 w0L = ptrA->workWidthE;
-	uint32 h0L = ptrA->workHeightE;
+	const struct bbf_Scanner* pyrL = ( ptrA->pyrSrcPtrE != NULL ) ? ptrA->pyrSrcPtrE : ptrA;
+	return pyrL->workImageE.arrPtrE + pyrL->levelOffsArrE[ ptrA->scaleExpE ];
+}
+
+/* ------------------------------------------------------------------------- */
+
+/** computes next pyramid level from the last one */
+void bbf_Scanner_addLevel( struct bbs_Context* cpA, struct bbf_Scanner* ptrA )
+{
+	bbs_DEF_fNameL( "void bbf_Scanner_addLevel( struct bbs_Context* cpA, struct bbf_Scanner* ptrA )" )
+
+	uint32 w0L = ptrA->pyrWidthE  >> ( ptrA->levelsE - 1 );
+	uint32 h0L = ptrA->pyrHeightE >> ( ptrA->levelsE - 1 );
 	uint32 w1L = w0L >> 1;
 	uint32 h1L = h0L >> 1;
 	uint32 w20L = ( w0L >> 1 ) + ( w0L & 1 );
-	uint16* arrL = ptrA->workImageE.arrPtrE;
+	uint32 w21L = ( w1L >> 1 ) + ( w1L & 1 );
+	const uint16* srcL;
+	uint16* dstL;
+	uint32 jL;
 
-	uint32 iL, jL;
-	uint32 kL = 0;
+	if( ptrA->levelsE >= bbf_SCANNER_MAX_LEVELS )
+	{
+		bbs_ERROR1( "%s:\n too many pyramid levels", fNameL );
+		return;
+	}
+
+	srcL = ptrA->workImageE.arrPtrE + ptrA->levelOffsArrE[ ptrA->levelsE - 1 ];
+	dstL = ( uint16* )srcL + w20L * h0L;
+	ptrA->levelOffsArrE[ ptrA->levelsE ] = dstL - ptrA->workImageE.arrPtrE;
+	ptrA->levelsE++;
+
+#ifdef bbf_SCANNER_NEON
+	/* pixel pairs are little endian words: rows are plain byte rows */
+	bim_downscaleBy2Stride( ( uint8* )dstL, w21L * 2, ( const uint8* )srcL, w20L * 2, w0L, h0L );
+	if( ( w1L & 1 ) != 0 )
+	{
+		for( jL = 0; jL < h1L; jL++ ) dstL[ jL * w21L + w21L - 1 ] &= 0x00FF;
+	}
+#else
 	for( jL = 0; jL < h1L; jL++ )
 	{
+		const uint16* s0L = srcL + jL * 2 * w20L;
+		const uint16* s1L = s0L + w20L;
+		uint16* d1L = dstL + jL * w21L;
+		uint32 iL;
 		for( iL = 0; iL < ( w1L >> 1 ); iL++ )
 		{
 			uint16 loL, hiL;
-			uint32 idxL = jL * 2 * w20L + iL * 2;
-
-			loL = ( ( arrL[ idxL ] & 0x00FF ) + ( arrL[ idxL ] >> 8 ) + ( arrL[ idxL + w20L ] & 0x00FF ) + ( arrL[ idxL + w20L ] >> 8 ) + 2 ) >> 2;
-			idxL++;
-			hiL = ( ( arrL[ idxL ] & 0x00FF ) + ( arrL[ idxL ] >> 8 ) + ( arrL[ idxL + w20L ] & 0x00FF ) + ( arrL[ idxL + w20L ] >> 8 ) + 2 ) >> 2;
-
-			arrL[ kL ] = loL | ( hiL << 8 );
-			kL++;
+			loL = ( ( s0L[ 0 ] & 0x00FF ) + ( s0L[ 0 ] >> 8 ) + ( s1L[ 0 ] & 0x00FF ) + ( s1L[ 0 ] >> 8 ) + 2 ) >> 2;
+			hiL = ( ( s0L[ 1 ] & 0x00FF ) + ( s0L[ 1 ] >> 8 ) + ( s1L[ 1 ] & 0x00FF ) + ( s1L[ 1 ] >> 8 ) + 2 ) >> 2;
+			*d1L++ = loL | ( hiL << 8 );
+			s0L += 2;
+			s1L += 2;
 		}
 		if( ( w1L & 1 ) != 0 )
 		{
-			uint32 idxL = jL * 2 * w20L + iL;
-			arrL[ kL++ ] = ( ( arrL[ idxL ] & 0x00FF ) + ( arrL[ idxL ] >> 8 ) + ( arrL[ idxL + w20L ] & 0x00FF ) + ( arrL[ idxL + w20L ] >> 8 ) + 2 ) >> 2;
+			*d1L = ( ( s0L[ 0 ] & 0x00FF ) + ( s0L[ 0 ] >> 8 ) + ( s1L[ 0 ] & 0x00FF ) + ( s1L[ 0 ] >> 8 ) + 2 ) >> 2;
+		}
+	}
+#endif
+}
+
+/* ------------------------------------------------------------------------- */
+
+/** goes to next level of the work image pyramid */
+void bbf_Scanner_downscale( struct bbs_Context* cpA, struct bbf_Scanner* ptrA )
+{
+	bbs_DEF_fNameL( "void bbf_Scanner_downscale( struct bbs_Context* cpA, struct bbf_Scanner* ptrA )" )
+
+	uint32 levelL = ptrA->scaleExpE + 1;
+
+	if( ptrA->pyrSrcPtrE != NULL )
+	{
+		if( levelL >= ptrA->pyrSrcPtrE->levelsE )
+		{
+			bbs_ERROR1( "%s:\n pyramid level of source scanner is not computed", fNameL );
+			return;
 		}
 	}
+	else if( levelL >= ptrA->levelsE )
+	{
+		bbf_Scanner_addLevel( cpA, ptrA );
+		if( bbs_Context_error( cpA ) ) return;
+	}
 
-	ptrA->workWidthE = w1L;
-	ptrA->workHeightE = h1L;
+	ptrA->workWidthE >>= 1;
+	ptrA->workHeightE >>= 1;
 	ptrA->scaleExpE++;
 }
 
@@ -318,7 +423,7 @@ void bbf_Scanner_createBitImage( struct bbs_Context* cpA, struct bbf_Scanner* pt
 			uint32 ypL = ( yfL >> 16 );
 			uint32 yoff1L = yfL & 0x0FFFF;
 			uint32 yoff0L = 0x010000 - yoff1L;
-			const uint16* arr0L = ptrA->workImageE.arrPtrE + ypL * wi2L;
+			const uint16* arr0L = bbf_Scanner_workImagePtr( ptrA ) + ypL * wi2L;
 			const uint16* arr1L = arr0L + wi2L;
 
 			
@@ -331,13 +436,71 @@ void bbf_Scanner_createBitImage( struct bbs_Context* cpA, struct bbf_Scanner* pt
 			swi2L += iL;
 
 			/* fill line buffer */
-			for( iL = 0; iL < wi2L; iL++ )
+			iL = 0;
+#ifdef bbf_SCANNER_NEON
+			{
+				uint16x4_t y1L = vdup_n_u16( yoff1L );
+				uint16x8_t lowMaskL = vdupq_n_u16( 0x0FF );
+				for( ; iL + 8 <= wi2L; iL += 8 )
+				{
+					uint16x8_t a0L = vld1q_u16( arr0L + iL );
+					uint16x8_t a1L = vld1q_u16( arr1L + iL );
+					uint16x8_t l0L = vandq_u16( a0L, lowMaskL );
+					uint16x8_t l1L = vandq_u16( a1L, lowMaskL );
+					uint16x8_t h0L = vshrq_n_u16( a0L, 8 );
+					uint16x8_t h1L = vshrq_n_u16( a1L, 8 );
+					uint16x8x2_t lineL;
+					lineL.val[ 0 ] = vcombine_u16( vshrn_n_u32( bbf_SCANNER_LERP_U16X4( vget_low_u16( l0L ), vget_low_u16( l1L ), y1L ), 10 ),
+												   vshrn_n_u32( bbf_SCANNER_LERP_U16X4( vget_high_u16( l0L ), vget_high_u16( l1L ), y1L ), 10 ) );
+					lineL.val[ 1 ] = vcombine_u16( vshrn_n_u32( bbf_SCANNER_LERP_U16X4( vget_low_u16( h0L ), vget_low_u16( h1L ), y1L ), 10 ),
+												   vshrn_n_u32( bbf_SCANNER_LERP_U16X4( vget_high_u16( h0L ), vget_high_u16( h1L ), y1L ), 10 ) );
+					vst2q_u16( lBufL + iL * 2, lineL ); /* interleaves even and odd pixels */
+				}
+			}
+#endif
+			for( ; iL < wi2L; iL++ )
 			{
 				lBufL[ iL * 2     ] = ( ( ( arr0L[ iL ] & 0x0FF ) * yoff0L ) + ( ( arr1L[ iL ] & 0x0FF ) * yoff1L ) ) >> 10;
 				lBufL[ iL * 2 + 1 ] = ( ( ( arr0L[ iL ] >> 8    ) * yoff0L ) + ( ( arr1L[ iL ] >> 8    ) * yoff1L ) ) >> 10;
 			}
 
-			for( iL = 0; iL < woL; iL++ )
+			iL = 0;
+#ifdef bbf_SCANNER_NEON
+			/* 4 pixels at a time: interpolate, prefix sum and add the previous row */
+			{
+				uint32x4_t zeroL = vdupq_n_u32( 0 );
+				uint32x4_t hSumVecL = zeroL;
+				uint32x4_t xfVecL = vmlaq_n_u32( vdupq_n_u32( xfL ), vcombine_u32( vcreate_u32( 0x100000000ULL ), vcreate_u32( 0x300000002ULL ) ), stepL );
+				uint32x4_t xoffMaskL = vdupq_n_u32( 0x0FFFF );
+				for( ; iL + 4 <= woL; iL += 4 )
+				{
+					uint16x4_t p0L = vdup_n_u16( 0 ), p1L = vdup_n_u16( 0 );
+					uint16x4_t xoff1L = vmovn_u32( vandq_u32( xfVecL, xoffMaskL ) );
+					uint32x4_t sumL;
+					p0L = vld1_lane_u16( lBufL + (   xfL               >> 16 ),     p0L, 0 );
+					p1L = vld1_lane_u16( lBufL + (   xfL               >> 16 ) + 1, p1L, 0 );
+					p0L = vld1_lane_u16( lBufL + ( ( xfL +     stepL ) >> 16 ),     p0L, 1 );
+					p1L = vld1_lane_u16( lBufL + ( ( xfL +     stepL ) >> 16 ) + 1, p1L, 1 );
+					p0L = vld1_lane_u16( lBufL + ( ( xfL + 2 * stepL ) >> 16 ),     p0L, 2 );
+					p1L = vld1_lane_u16( lBufL + ( ( xfL + 2 * stepL ) >> 16 ) + 1, p1L, 2 );
+					p0L = vld1_lane_u16( lBufL + ( ( xfL + 3 * stepL ) >> 16 ),     p0L, 3 );
+					p1L = vld1_lane_u16( lBufL + ( ( xfL + 3 * stepL ) >> 16 ) + 1, p1L, 3 );
+					xfL += 4 * stepL;
+					xfVecL = vaddq_u32( xfVecL, vdupq_n_u32( 4 * stepL ) );
+
+					sumL = vshrq_n_u32( bbf_SCANNER_LERP_U16X4( p0L, p1L, xoff1L ), 22 );
+					sumL = vaddq_u32( sumL, vextq_u32( zeroL, sumL, 3 ) );
+					sumL = vaddq_u32( sumL, vextq_u32( zeroL, sumL, 2 ) );
+					sumL = vaddq_u32( sumL, hSumVecL );
+					hSumVecL = vdupq_lane_u32( vget_high_u32( sumL ), 1 );
+					vst1q_u32( satL + swi1L, vaddq_u32( sumL, vld1q_u32( satL + swi2L ) ) );
+					swi1L += 4;
+					swi2L += 4;
+				}
+				hSumL = vgetq_lane_u32( hSumVecL, 0 );
+			}
+#endif
+			for( ; iL < woL; iL++ )
 			{
 				uint32 xpL = ( xfL >> 16 );
 				uint32 xoff1L = xfL & 0x0FFFF;
@@ -385,7 +548,23 @@ void bbf_Scanner_createBitImage( struct bbs_Context* cpA, struct bbf_Scanner* pt
 			sriL += wsL;
 			if( sriL == satSizeL ) sriL = 0;
 
-			for( iL = 0; iL < woL; iL++ )
+			iL = 0;
+#ifdef bbf_SCANNER_NEON
+			{
+				uint32x4_t bitMaskVecL = vdupq_n_u32( bitMaskL );
+				for( ; iL + 4 <= woL; iL += 4 )
+				{
+					uint32x4_t oAvgL = vmulq_n_u32( vaddq_u32( vsubq_u32( vsubq_u32( vld1q_u32( rSatL + siL[ 0 ] ), vld1q_u32( rSatL + siL[ 1 ] ) ), 
+																		   vld1q_u32( rSatL + siL[ 2 ] ) ), vld1q_u32( rSatL + siL[ 3 ] ) ), piAreaL );
+					uint32x4_t iAvgL = vmulq_n_u32( vaddq_u32( vsubq_u32( vsubq_u32( vld1q_u32( rSatL + siL[ 4 ] ), vld1q_u32( rSatL + siL[ 5 ] ) ), 
+																		   vld1q_u32( rSatL + siL[ 6 ] ) ), vld1q_u32( rSatL + siL[ 7 ] ) ), poAreaL );
+					uint32x4_t bitsL = vandq_u32( vcgtq_u32( iAvgL, oAvgL ), bitMaskVecL );
+					vst1q_u32( bitRowL + iL, vorrq_u32( vld1q_u32( bitRowL + iL ), bitsL ) );
+					rSatL += 4;
+				}
+			}
+#endif
+			for( ; iL < woL; iL++ )
 			{
 				uint32 oAvgL = ( rSatL[ siL[ 0 ] ] - rSatL[ siL[ 1 ] ] - rSatL[ siL[ 2 ] ] + rSatL[ siL[ 3 ] ] ) * piAreaL;
 				uint32 iAvgL = ( rSatL[ siL[ 4 ] ] - rSatL[ siL[ 5 ] ] - rSatL[ siL[ 6 ] ] + rSatL[ siL[ 7 ] ] ) * poAreaL;
@@ -434,6 +613,10 @@ void bbf_Scanner_init( struct bbs_Context* cpA,
 	ptrA->workHeightE = 0;
 	bbf_BitParam_init( cpA, &ptrA->bitParamE );
 	bbs_UInt16Arr_init( cpA, &ptrA->workImageE );
+	ptrA->levelsE = 0;
+	ptrA->pyrWidthE = 0;
+	ptrA->pyrHeightE = 0;
+	ptrA->pyrSrcPtrE = NULL;
 	bim_UInt32Image_init( cpA, &ptrA->satE );
 	bim_UInt32Image_init( cpA, &ptrA->bitImageE );
 	bbs_UInt32Arr_init( cpA, &ptrA->patchBufferE );
@@ -474,6 +657,10 @@ void bbf_Scanner_exit( struct bbs_Context* cpA,
 	ptrA->workHeightE = 0;
 	bbf_BitParam_exit( cpA, &ptrA->bitParamE );
 	bbs_UInt16Arr_exit( cpA, &ptrA->workImageE );
+	ptrA->levelsE = 0;
+	ptrA->pyrWidthE = 0;
+	ptrA->pyrHeightE = 0;
+	ptrA->pyrSrcPtrE = NULL;
 	bim_UInt32Image_exit( cpA, &ptrA->satE );
 	bim_UInt32Image_exit( cpA, &ptrA->bitImageE );
 	bbs_UInt32Arr_exit( cpA, &ptrA->patchBufferE );
@@ -524,6 +711,11 @@ void bbf_Scanner_copy( struct bbs_Context* cpA,
 
 	bbf_BitParam_copy( cpA, &ptrA->bitParamE, &srcPtrA->bitParamE );
 	bbs_UInt16Arr_copy( cpA, &ptrA->workImageE, &srcPtrA->workImageE );
+	ptrA->levelsE = srcPtrA->levelsE;
+	bbs_memcpy32( ptrA->levelOffsArrE, srcPtrA->levelOffsArrE, bbf_SCANNER_MAX_LEVELS );
+	ptrA->pyrWidthE = srcPtrA->pyrWidthE;
+	ptrA->pyrHeightE = srcPtrA->pyrHeightE;
+	ptrA->pyrSrcPtrE = srcPtrA->pyrSrcPtrE;
 	bim_UInt32Image_copy( cpA, &ptrA->satE, &srcPtrA->satE );
 	bim_UInt32Image_copy( cpA, &ptrA->bitImageE, &srcPtrA->bitImageE );
 	bbs_UInt32Arr_copy( cpA, &ptrA->patchBufferE, &srcPtrA->patchBufferE );
@@ -653,7 +845,29 @@ void bbf_Scanner_create( struct bbs_Context* cpA,
 	ptrA->borderWidthE = borderWidthA;
 	ptrA->borderHeightE = borderHeightA;
 	ptrA->bufferSizeE = bufferSizeA;
-	bbf_Scanner_alloc( cpA, ptrA, mtpA, maximizeSharedMemoryA );
+	bbf_Scanner_alloc( cpA, ptrA, mtpA, maximizeSharedMemoryA, FALSE );
+}
+
+/* ------------------------------------------------------------------------- */
+	
+void bbf_Scanner_createWorker( struct bbs_Context* cpA,
+							   struct bbf_Scanner* ptrA, 
+							   const struct bbf_Scanner* srcPtrA,
+							   struct bbs_MemTbl* mtpA )
+{
+	ptrA->maxImageWidthE = srcPtrA->maxImageWidthE;
+	ptrA->maxImageHeightE = srcPtrA->maxImageHeightE;
+	ptrA->maxRadiusE = srcPtrA->maxRadiusE;
+	ptrA->patchWidthE = srcPtrA->patchWidthE;
+	ptrA->patchHeightE = srcPtrA->patchHeightE;
+	ptrA->minScaleE = srcPtrA->minScaleE;
+	ptrA->maxScaleE = srcPtrA->maxScaleE;
+	ptrA->scaleStepE = srcPtrA->scaleStepE;
+	ptrA->borderWidthE = srcPtrA->borderWidthE;
+	ptrA->borderHeightE = srcPtrA->borderHeightE;
+	ptrA->bufferSizeE = srcPtrA->bufferSizeE;
+	ptrA->pyrSrcPtrE = srcPtrA;
+	bbf_Scanner_alloc( cpA, ptrA, mtpA, FALSE, TRUE );
 }
 
 /* ------------------------------------------------------------------------- */
@@ -755,7 +969,7 @@ uint32 bbf_Scanner_memRead( struct bbs_Context* cpA,
 	if( bbs_Context_error( cpA ) ) return 0;
 
 	/* allocate arrays */
-	bbf_Scanner_alloc( cpA, ptrA, mtpA, FALSE );
+	bbf_Scanner_alloc( cpA, ptrA, mtpA, FALSE, FALSE );
 
 	if( bbs_Context_error( cpA ) ) return 0;
 
@@ -788,41 +1002,119 @@ void bbf_Scanner_assign( struct bbs_Context* cpA, struct bbf_Scanner* ptrA,
 						 const struct bts_Int16Rect* roiPtrA,
 						 const struct bbf_BitParam* paramPtrA )
 {
+	bbf_Scanner_assignLevel( cpA, ptrA, imagePtrA, imageWidthA, imageHeightA, roiPtrA, paramPtrA, 0 );
+}
+
+/* ------------------------------------------------------------------------- */
+
+flag bbf_Scanner_assignLevel( struct bbs_Context* cpA, struct bbf_Scanner* ptrA,
+							  const void* imagePtrA,
+							  uint32 imageWidthA,
+							  uint32 imageHeightA,
+							  const struct bts_Int16Rect* roiPtrA,
+							  const struct bbf_BitParam* paramPtrA,
+							  uint32 levelA )
+{
+	bbf_Scanner_assignImage( cpA, ptrA, imagePtrA, imageWidthA, imageHeightA, roiPtrA );
+	if( bbs_Context_error( cpA ) ) return FALSE;
+	return bbf_Scanner_assignPyramidLevel( cpA, ptrA, paramPtrA, levelA );
+}
+
+/* ------------------------------------------------------------------------- */
+
+void bbf_Scanner_assignImage( struct bbs_Context* cpA, struct bbf_Scanner* ptrA,
+							  const void* imagePtrA,
+							  uint32 imageWidthA,
+							  uint32 imageHeightA,
+							  const struct bts_Int16Rect* roiPtrA )
+{
+	bbs_DEF_fNameL( "void bbf_Scanner_assignImage( struct bbs_Context* cpA, struct bbf_Scanner* ptrA, ... )" )
+
+	if( ptrA->pyrSrcPtrE != NULL )
+	{
+		bbs_ERROR1( "%s:\n Scanner has no own work image", fNameL );
+		return;
+	}
+
 	/* copy image */
 	bbf_Scanner_copyImage( cpA, ptrA, imagePtrA, imageWidthA, imageHeightA, roiPtrA );
+	if( bbs_Context_error( cpA ) ) return;
 
-	ptrA->scaleE = ptrA->minScaleE;
-	bbf_BitParam_copy( cpA, &ptrA->bitParamE, paramPtrA );
+	ptrA->levelsE = 1;
+	ptrA->levelOffsArrE[ 0 ] = 0;
+	ptrA->pyrWidthE = ptrA->workWidthE;
+	ptrA->pyrHeightE = ptrA->workHeightE;
+	ptrA->scaleExpE = 0;
+}
+
+/* ------------------------------------------------------------------------- */
 
-	/* compute effective max scale */
+void bbf_Scanner_buildPyramid( struct bbs_Context* cpA, struct bbf_Scanner* ptrA )
+{
+	/* level n is used from scale 2^n on */
+	uint32 maxScaleL = bbf_Scanner_effMaxScale( ptrA, ptrA->pyrWidthE, ptrA->pyrHeightE );
+	while( ptrA->levelsE < bbf_SCANNER_MAX_LEVELS && 
+		   ( ( ( uint32 )1 << ptrA->levelsE ) << 20 ) < maxScaleL &&
+		   ( ptrA->pyrWidthE  >> ptrA->levelsE ) > 0 &&
+		   ( ptrA->pyrHeightE >> ptrA->levelsE ) > 0 )
 	{
-		/* 16.16 */
-		uint32 maxHScaleL = ( ptrA->workWidthE << 16 ) / ( ptrA->patchWidthE + 1 );
-		uint32 maxVScaleL = ( ptrA->workHeightE << 16 ) / ( ptrA->patchHeightE + 1 );
-
-		/* 12.20 */
-		ptrA->effMaxScaleE = maxHScaleL < maxVScaleL ? ( maxHScaleL << 4 ) : ( maxVScaleL << 4 );
-		
-		if( ptrA->maxScaleE > 0 ) ptrA->effMaxScaleE = ptrA->effMaxScaleE < ptrA->maxScaleE ? ptrA->effMaxScaleE : ptrA->maxScaleE;
+		bbf_Scanner_addLevel( cpA, ptrA );
+		if( bbs_Context_error( cpA ) ) return;
 	}
+}
+
+/* ------------------------------------------------------------------------- */
+
+flag bbf_Scanner_assignPyramidLevel( struct bbs_Context* cpA, struct bbf_Scanner* ptrA,
+									 const struct bbf_BitParam* paramPtrA,
+									 uint32 levelA )
+{
+	const struct bbf_Scanner* pyrL = ( ptrA->pyrSrcPtrE != NULL ) ? ptrA->pyrSrcPtrE : ptrA;
+
+	ptrA->workWidthE  = pyrL->pyrWidthE;
+	ptrA->workHeightE = pyrL->pyrHeightE;
+
+	ptrA->scaleE = ptrA->minScaleE;
+	bbf_BitParam_copy( cpA, &ptrA->bitParamE, paramPtrA );
+
+	ptrA->effMaxScaleE = bbf_Scanner_effMaxScale( ptrA, ptrA->workWidthE, ptrA->workHeightE );
 
 	ptrA->scaleExpE = 0;
 
+	/* skipped levels are not computed */
+	if( levelA > 0 ) return bbf_Scanner_nextScales( cpA, ptrA, levelA );
+
 	/* downscale work image if necessary */
 	while( ptrA->scaleE > ( ( uint32 )( 2 << ptrA->scaleExpE ) << 20 ) ) bbf_Scanner_downscale( cpA, ptrA );
 
 	bbf_Scanner_createBitImage( cpA, ptrA );
 	bbf_Scanner_resetScan( cpA, ptrA );
+	return TRUE;
 }
 
 /* ------------------------------------------------------------------------- */
 
 flag bbf_Scanner_nextScale( struct bbs_Context* cpA, struct bbf_Scanner* ptrA )
 {
-	if( ptrA->scaleE + bbf_Scanner_scalePrd( ptrA->scaleE, ptrA->scaleStepE ) >= ptrA->effMaxScaleE ) return FALSE;
-	ptrA->scaleE += bbf_Scanner_scalePrd( ptrA->scaleE, ptrA->scaleStepE );
+	return bbf_Scanner_nextScales( cpA, ptrA, 1 );
+}
 
-	/* downscale work image if necessary */
+/* ------------------------------------------------------------------------- */
+
+flag bbf_Scanner_nextScales( struct bbs_Context* cpA, struct bbf_Scanner* ptrA, uint32 stepsA )
+{
+	uint32 scaleL = ptrA->scaleE;
+	uint32 iL;
+
+	for( iL = 0; iL < stepsA; iL++ )
+	{
+		if( scaleL + bbf_Scanner_scalePrd( scaleL, ptrA->scaleStepE ) >= ptrA->effMaxScaleE ) return FALSE;
+		scaleL += bbf_Scanner_scalePrd( scaleL, ptrA->scaleStepE );
+	}
+
+	ptrA->scaleE = scaleL;
+
+	/* downscale work image if necessary (work image of a skipped level is the same) */
 	while( ptrA->scaleE > ( ( uint32 )( 2 << ptrA->scaleExpE ) << 20 ) ) bbf_Scanner_downscale( cpA, ptrA );
 
 	bbf_Scanner_createBitImage( cpA, ptrA );
@@ -1092,10 +1384,10 @@ void bbf_Scanner_addOutPos( struct bbs_Context* cpA,
 
 		if( actA > minActL )
 		{
-			ptrA->idxArrE.arrPtrE[ minIdxL * 4 + 0 ] = xA;
-			ptrA->idxArrE.arrPtrE[ minIdxL * 4 + 1 ] = yA;
-			ptrA->idxArrE.arrPtrE[ minIdxL * 4 + 2 ] = scaleA;
-			ptrA->idxArrE.arrPtrE[ minIdxL * 4 + 3 ] = actA;
+			ptrA->outArrE.arrPtrE[ minIdxL * 4 + 0 ] = xA;
+			ptrA->outArrE.arrPtrE[ minIdxL * 4 + 1 ] = yA;
+			ptrA->outArrE.arrPtrE[ minIdxL * 4 + 2 ] = scaleA;
+			ptrA->outArrE.arrPtrE[ minIdxL * 4 + 3 ] = actA;
 		}
 	}
 }
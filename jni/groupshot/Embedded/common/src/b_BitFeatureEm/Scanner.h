@@ -37,6 +37,9 @@
 
 /* ---- constants ---------------------------------------------------------- */
 
+/** maximum number of work image pyramid levels */
+#define bbf_SCANNER_MAX_LEVELS 16
+
 /* data format version number */
 #define bbf_SCANNER_VERSION 100
 
@@ -77,9 +80,25 @@ struct bbf_Scanner
 	/** parameter for bit generation */
 	struct bbf_BitParam bitParamE;
 
-	/** work image (two pixels per uint16)*/
+	/** pyramid of work images (two pixels per uint16, rows of uneven width are padded);
+	 *  level n is level n-1 downscaled by 2 and is computed once per image */
 	struct bbs_UInt16Arr workImageE;
 
+	/** number of pyramid levels computed */
+	uint32 levelsE;
+
+	/** offsets of pyramid levels in workImageE */
+	uint32 levelOffsArrE[ bbf_SCANNER_MAX_LEVELS ];
+
+	/** width of pyramid level 0 */
+	uint32 pyrWidthE;
+
+	/** height of pyramid level 0 */
+	uint32 pyrHeightE;
+
+	/** scanner whose pyramid is used (NULL: own pyramid) */
+	const struct bbf_Scanner* pyrSrcPtrE;
+
 	/** summed-area table (ring buffer) */
 	struct bim_UInt32Image satE;
 
@@ -212,6 +231,14 @@ void bbf_Scanner_create( struct bbs_Context* cpA,
 						 uint32 bufferSizeA,
 						 struct bbs_MemTbl* mtpA );
 
+/** creates & initializes object with the configuration of srcPtrA;
+ *  no shared memory is used, so that the object can scan in parallel to srcPtrA.
+ *  The object has no own work image, it scans the pyramid of srcPtrA. */
+void bbf_Scanner_createWorker( struct bbs_Context* cpA,
+							   struct bbf_Scanner* ptrA, 
+							   const struct bbf_Scanner* srcPtrA,
+							   struct bbs_MemTbl* mtpA );
+
 /** parameter for bit generation + recomputing bit image */
 void bbf_Scanner_bitParam( struct bbs_Context* cpA,
 						   struct bbf_Scanner* ptrA,
@@ -253,9 +280,41 @@ void bbf_Scanner_assign( struct bbs_Context* cpA, struct bbf_Scanner* ptrA,
 						 const struct bts_Int16Rect* roiPtrA,
 						 const struct bbf_BitParam* paramPtrA );
 
+/** copies image (see bbf_Scanner_assign) as level 0 of the work image pyramid; 
+ *  further levels are computed as scanning reaches them */
+void bbf_Scanner_assignImage( struct bbs_Context* cpA, struct bbf_Scanner* ptrA,
+							  const void* imagePtrA,
+							  uint32 imageWidthA,
+							  uint32 imageHeightA,
+							  const struct bts_Int16Rect* roiPtrA );
+
+/** computes all pyramid levels the assigned image can be scanned at,
+ *  so that other scanners can use the pyramid concurrently */
+void bbf_Scanner_buildPyramid( struct bbs_Context* cpA, struct bbf_Scanner* ptrA );
+
+/** resets scanner to the image of the pyramid (own or of the source scanner) 
+ *  and goes to scale position levelA (0: minimum scale);
+ *  returns FALSE if the image has no such scale position */
+flag bbf_Scanner_assignPyramidLevel( struct bbs_Context* cpA, struct bbf_Scanner* ptrA,
+									 const struct bbf_BitParam* paramPtrA,
+									 uint32 levelA );
+
+/** same as bbf_Scanner_assign but goes to scale position levelA (0: minimum scale);
+ *  returns FALSE if the image has no such scale position */
+flag bbf_Scanner_assignLevel( struct bbs_Context* cpA, struct bbf_Scanner* ptrA,
+							  const void* imagePtrA,
+							  uint32 imageWidthA,
+							  uint32 imageHeightA,
+							  const struct bts_Int16Rect* roiPtrA,
+							  const struct bbf_BitParam* paramPtrA,
+							  uint32 levelA );
+
 /** goes to next scale position */
 flag bbf_Scanner_nextScale( struct bbs_Context* cpA, struct bbf_Scanner* ptrA );
 
+/** goes stepsA scale positions further; returns FALSE if there is no such scale position */
+flag bbf_Scanner_nextScales( struct bbs_Context* cpA, struct bbf_Scanner* ptrA, uint32 stepsA );
+
 /** returns pointer to patch data */
 const uint32* bbf_Scanner_getPatch( const struct bbf_Scanner* ptrA );
 
@@ -18,6 +18,11 @@
 
 #include "b_ImageEm/Functions.h"
 
+#if defined( __ARM_NEON__ ) || defined( __ARM_NEON )
+#include <arm_neon.h>
+#define bim_FUNCTIONS_NEON
+#endif
+
 /* ---- related objects  --------------------------------------------------- */
 
 /* ---- typedefs ----------------------------------------------------------- */
@@ -40,6 +45,18 @@ void bim_downscaleBy2( uint8*       dstPtrA,
 					   uint32 srcWidthA,
 					   uint32 effWidthA,
 					   uint32 effHeightA )
+{
+	bim_downscaleBy2Stride( dstPtrA, effWidthA >> 1, srcPtrA, srcWidthA, effWidthA, effHeightA );
+}
+
+/* ------------------------------------------------------------------------- */
+
+void bim_downscaleBy2Stride( uint8*       dstPtrA, 
+							 uint32 dstWidthA,
+							 const uint8* srcPtrA,
+							 uint32 srcWidthA,
+							 uint32 effWidthA,
+							 uint32 effHeightA )
 {
 	uint32 wsL = srcWidthA;
 	uint32 w0L = effWidthA;
@@ -47,19 +64,32 @@ void bim_downscaleBy2( uint8*       dstPtrA,
 	uint32 w1L = w0L >> 1;
 	uint32 h1L = h0L >> 1;
 
-	const uint8* srcL = srcPtrA;
-	uint8* dstL = dstPtrA;
-
 	uint32 iL, jL;
 	for( jL = 0; jL < h1L; jL++ )
 	{
-		for( iL = 0; iL < w1L; iL++ )
+		const uint8* srcL = srcPtrA + jL * 2 * wsL;
+		uint8* dstL = dstPtrA + jL * dstWidthA;
+
+		iL = 0;
+
+#ifdef bim_FUNCTIONS_NEON
+		/* 16 pixels at a time; in place each store is behind all data still to be read */
+		for( ; iL + 16 <= w1L; iL += 16 )
+		{
+			uint16x8_t sum0L = vaddq_u16( vpaddlq_u8( vld1q_u8( srcL ) ),      vpaddlq_u8( vld1q_u8( srcL + wsL ) ) );
+			uint16x8_t sum1L = vaddq_u16( vpaddlq_u8( vld1q_u8( srcL + 16 ) ), vpaddlq_u8( vld1q_u8( srcL + wsL + 16 ) ) );
+			vst1q_u8( dstL, vcombine_u8( vrshrn_n_u16( sum0L, 2 ), vrshrn_n_u16( sum1L, 2 ) ) );
+			dstL += 16;
+			srcL += 32;
+		}
+#endif
+
+		for( ; iL < w1L; iL++ )
 		{
 			*dstL = ( ( uint32 )srcL[ 0 ] + srcL[ 1 ] + srcL[ wsL ] + srcL[ wsL + 1 ] + 2 ) >> 2;
 			dstL++;
 			srcL += 2;
 		}
-		srcL += ( wsL - w1L ) * 2;
 	}
 }
 
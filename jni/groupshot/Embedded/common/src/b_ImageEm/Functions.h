@@ -42,6 +42,26 @@ enum bim_PyramidalImageType
 
 /* ---- external functions ------------------------------------------------- */
 
+/** Downscales by factor 2 averaging 2x2 pixels (dstPtrA and srcPtrA may be identical)
+ *  srcWidthA is the row length of the source, effWidthA x effHeightA the area downscaled;
+ *  the result is stored with row length effWidthA / 2
+ */
+void bim_downscaleBy2( uint8*       dstPtrA, 
+					   const uint8* srcPtrA,
+					   uint32 srcWidthA,
+					   uint32 effWidthA,
+					   uint32 effHeightA );
+
+/** Same as bim_downscaleBy2 with result stored at row length dstWidthA ( >= effWidthA / 2 ) 
+ *  dstPtrA and srcPtrA may be identical if dstWidthA <= srcWidthA
+ */
+void bim_downscaleBy2Stride( uint8*       dstPtrA, 
+							 uint32 dstWidthA,
+							 const uint8* srcPtrA,
+							 uint32 srcWidthA,
+							 uint32 effWidthA,
+							 uint32 effHeightA );
+
 /** Warps an image with intermediate pyramidal downscaling if possible in order to minimize aliasing
  *  The actual warping happens using pixel interpolation
  *  *bufPtrA is an intermediate byte array that holds downscaled data (only needed when pyramidal downscaling happens; can be NULL otherwise)
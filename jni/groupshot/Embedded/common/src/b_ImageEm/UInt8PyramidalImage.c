@@ -348,26 +348,16 @@ void bim_UInt8PyramidalImage_overlayUInt8( struct bbs_Context* cpA,
 void bim_UInt8PyramidalImage_recompute( struct bbs_Context* cpA,
 									    struct bim_UInt8PyramidalImage* dstPtrA )
 {
-	uint32 iL, jL, layerL, widthL, heightL;
-	uint8 *srcL, *dstL;
+	uint32 layerL, widthL, heightL;
 
 	/* process remaining layers */
 	widthL = dstPtrA->widthE;
 	heightL = dstPtrA->heightE;
-	srcL = dstPtrA->arrE.arrPtrE;
-	dstL = srcL + widthL * heightL;
 	for( layerL = 1; layerL < dstPtrA->depthE; layerL++ )
 	{
-		for( jL = ( heightL >> 1 ); jL > 0; jL-- )
-		{
-			for( iL = ( widthL >> 1 ); iL > 0; iL-- )
-			{
-				/* averaging with roundig */
-				*dstL++ = ( ( *srcL + *( srcL + 1 ) + *( srcL + widthL ) + *( srcL + widthL + 1 ) ) + 2 ) >> 2;
-				srcL += 2;
-			}
-			srcL += widthL;
-		}
+		bim_downscaleBy2( bim_UInt8PyramidalImage_arrPtr( cpA, dstPtrA, layerL ),
+						  bim_UInt8PyramidalImage_arrPtr( cpA, dstPtrA, layerL - 1 ),
+						  widthL, widthL, heightL );
 		widthL >>= 1;
 		heightL >>= 1;
 	}
@@ -66,7 +66,7 @@ int32 bts_CompactMat_fltDotPrdRow( struct bbs_Context* cpA,
 		{
 			case 16:
 			{
-				for( iL = sizeL; iL > 0; iL-- ) sumL += ( ( int32 )*rowPtrL++ * ( int32 )*inPtrL++ );
+				sumL = bbs_dotProductInt16( rowPtrL, inPtrL, sizeL );
 			}
 			break;
 
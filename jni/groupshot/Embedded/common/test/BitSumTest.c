@@ -0,0 +1,184 @@
+/*
+ * Copyright (C) 2008 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+/* Checks the bit sums of the bit feature activities (bbf_BIT_SUM_32,
+ * bbf_BIT_SUM_MASKED_4/6 and the L01Tld1x1 activity) against the table
+ * reference bbf_BIT_SUM_32_TBL and a plain loop over the bits, on random
+ * and edge bit patterns. Exits with 0 when all sums are equal.
+ */
+
+/* ---- includes ----------------------------------------------------------- */
+
+#include <stdio.h>
+
+#include "b_BitFeatureEm/Functions.h"
+#include "b_BitFeatureEm/L01Tld1x1Ftr.h"
+
+/* ---- constants ---------------------------------------------------------- */
+
+#define bbf_TEST_ROUNDS 100000
+
+/* patch width of the L01Tld1x1 test feature, the activity takes 4 words per step */
+#define bbf_TEST_PATCH_WIDTH 32
+
+/* ---- functions ---------------------------------------------------------- */
+
+static uint32 bbf_testRandG = 2463534242u;
+
+/** xorshift generator, deterministic on all platforms */
+static uint32 bbf_testRand( void )
+{
+	bbf_testRandG ^= bbf_testRandG << 13;
+	bbf_testRandG ^= bbf_testRandG >> 17;
+	bbf_testRandG ^= bbf_testRandG << 5;
+	return bbf_testRandG;
+}
+
+/** random word; every 8th is an edge pattern */
+static uint32 bbf_testWord( void )
+{
+	static const uint32 edgeArrL[ 8 ] = { 0x00000000, 0xFFFFFFFF, 0x80000000, 0x00000001,
+										  0x55555555, 0xAAAAAAAA, 0x0000FFFF, 0xFF00FF00 };
+	uint32 rL = bbf_testRand();
+	return ( rL & 7 ) == 0 ? edgeArrL[ ( rL >> 3 ) & 7 ] : bbf_testRand();
+}
+
+/** bit sum as a loop over the bits */
+static uint32 bbf_testBitSumLoop( uint32 vA )
+{
+	uint32 sL = 0;
+	while( vA != 0 )
+	{
+		sL += vA & 1;
+		vA >>= 1;
+	}
+	return sL;
+}
+
+/* ------------------------------------------------------------------------- */
+
+static int bbf_testBitSum32( void )
+{
+	uint32 nL;
+	for( nL = 0; nL < bbf_TEST_ROUNDS; nL++ )
+	{
+		uint32 vL = bbf_testWord();
+		uint32 refL = bbf_testBitSumLoop( vL );
+		if( bbf_BIT_SUM_32( vL ) != refL || bbf_BIT_SUM_32_TBL( vL ) != refL )
+		{
+			printf( "bbf_BIT_SUM_32( 0x%08x ) = %u, table %u, expected %u\n",
+					vL, ( uint32 )bbf_BIT_SUM_32( vL ), ( uint32 )bbf_BIT_SUM_32_TBL( vL ), refL );
+			return 1;
+		}
+	}
+	return 0;
+}
+
+/* ------------------------------------------------------------------------- */
+
+static int bbf_testBitSumMasked( void )
+{
+	uint32 nL, iL;
+	for( nL = 0; nL < bbf_TEST_ROUNDS; nL++ )
+	{
+		/* sums accumulate, as in the activities */
+		uint32 b4ArrL[ 4 ] = { 0 }, b6ArrL[ 6 ] = { 0 }, refArrL[ 6 ] = { 0 };
+		uint32 maskArrL[ 6 ];
+		uint32 vL = bbf_testWord();
+		uint32 kL;
+
+		for( iL = 0; iL < 6; iL++ ) maskArrL[ iL ] = bbf_testWord();
+
+		for( kL = 0; kL < 3; kL++ )
+		{
+			bbf_BIT_SUM_MASKED_4( b4ArrL, vL, maskArrL );
+			bbf_BIT_SUM_MASKED_6( b6ArrL, vL, maskArrL );
+			for( iL = 0; iL < 6; iL++ ) refArrL[ iL ] += bbf_BIT_SUM_32_TBL( vL & maskArrL[ iL ] );
+		}
+
+		for( iL = 0; iL < 6; iL++ )
+		{
+			if( ( iL < 4 && b4ArrL[ iL ] != refArrL[ iL ] ) || b6ArrL[ iL ] != refArrL[ iL ] )
+			{
+				printf( "bbf_BIT_SUM_MASKED_4/6: sum %u of 0x%08x & 0x%08x is %u/%u, expected %u\n",
+						iL, vL, maskArrL[ iL ], iL < 4 ? b4ArrL[ iL ] : 0, b6ArrL[ iL ], refArrL[ iL ] );
+				return 1;
+			}
+		}
+	}
+	return 0;
+}
+
+/* ------------------------------------------------------------------------- */
+
+static int bbf_testL01Tld1x1Activity( void )
+{
+	struct bbs_Context contextL;
+	struct bbf_L01Tld1x1Ftr ftrL;
+	uint32 dataArrL[ 2 * bbf_TEST_PATCH_WIDTH ];
+	uint32 patchArrL[ bbf_TEST_PATCH_WIDTH ];
+	uint32 nL, iL;
+
+	bbs_Context_init( &contextL );
+	bbf_L01Tld1x1Ftr_init( &contextL, &ftrL );
+
+	/* data is set up in place, the feature is not exited */
+	ftrL.baseE.patchWidthE = bbf_TEST_PATCH_WIDTH;
+	ftrL.dataArrE.arrPtrE = dataArrL;
+	ftrL.dataArrE.sizeE = 2 * bbf_TEST_PATCH_WIDTH;
+	ftrL.activityFactorE = 1;
+
+	for( nL = 0; nL < bbf_TEST_ROUNDS / 10; nL++ )
+	{
+		uint32 refL = 0;
+		int32 actL;
+
+		for( iL = 0; iL < 2 * bbf_TEST_PATCH_WIDTH; iL++ ) dataArrL[ iL ] = bbf_testWord();
+		for( iL = 0; iL < bbf_TEST_PATCH_WIDTH; iL++ ) patchArrL[ iL ] = bbf_testWord();
+
+		/* scalar loop the activity was computed with */
+		for( iL = 0; iL < bbf_TEST_PATCH_WIDTH; iL++ )
+		{
+			refL += bbf_BIT_SUM_32_TBL( ( patchArrL[ iL ] ^ dataArrL[ 2 * iL ] ) & dataArrL[ 2 * iL + 1 ] );
+		}
+
+		actL = bbf_L01Tld1x1Ftr_activity( &ftrL.baseE, patchArrL );
+		if( ( uint32 )actL != refL )
+		{
+			printf( "bbf_L01Tld1x1Ftr_activity = %i, expected %u\n", actL, refL );
+			return 1;
+		}
+	}
+
+	bbs_Context_exit( &contextL );
+	return 0;
+}
+
+/* ------------------------------------------------------------------------- */
+
+int main( void )
+{
+	int errL = 0;
+
+	errL |= bbf_testBitSum32();
+	errL |= bbf_testBitSumMasked();
+	errL |= bbf_testL01Tld1x1Activity();
+
+	printf( "BitSumTest: %s\n", errL ? "FAILED" : "passed" );
+	return errL;
+}
+
+/* ------------------------------------------------------------------------- */
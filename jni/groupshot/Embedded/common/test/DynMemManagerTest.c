@@ -0,0 +1,243 @@
+/*
+ * Copyright (C) 2008 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+/* Runs random alloc/free sequences on bbs_DynMemManager, with and without
+ * arena blocks. Between them it frees memory that was not allocated: pointers
+ * into allocated blocks holding random data, blocks that were just freed and
+ * foreign memory. These must be reported as errors without reading memory
+ * outside the manager's blocks and without changing the allocated blocks.
+ * Exits with 0 when all checks pass (best run under a memory checker).
+ */
+
+/* ---- includes ----------------------------------------------------------- */
+
+#include <stdio.h>
+#include <stdlib.h>
+
+#include "b_BasicEm/Context.h"
+#include "b_BasicEm/DynMemManager.h"
+
+/* ---- constants ---------------------------------------------------------- */
+
+#define bbs_TEST_ROUNDS 20000
+
+/* maximum number of allocated blocks */
+#define bbs_TEST_MAX_BLOCKS 64
+
+/* maximum block size in 16-bit units */
+#define bbs_TEST_MAX_SIZE 200
+
+/* ---- functions ---------------------------------------------------------- */
+
+static uint32 bbs_testRandG = 2463534242u;
+
+/** xorshift generator, deterministic on all platforms */
+static uint32 bbs_testRand( void )
+{
+	bbs_testRandG ^= bbs_testRandG << 13;
+	bbs_testRandG ^= bbs_testRandG >> 17;
+	bbs_testRandG ^= bbs_testRandG << 5;
+	return bbs_testRandG;
+}
+
+/* ------------------------------------------------------------------------- */
+
+/** number of memory blocks allocated by the malloc handler and not yet freed */
+static int32 bbs_testMallocCountG = 0;
+
+static void* bbs_testMalloc( struct bbs_Context* cpA, const struct bbs_MemSeg* memSegPtrA, uint32 sizeA )
+{
+	bbs_testMallocCountG++;
+	return malloc( sizeA );
+}
+
+static void bbs_testFree( void* memPtrA )
+{
+	bbs_testMallocCountG--;
+	free( memPtrA );
+}
+
+/* ------------------------------------------------------------------------- */
+
+/** allocated block with the seed of its random content */
+struct bbs_TestBlock
+{
+	uint16* memPtrE;
+	uint32 sizeE;
+	uint32 seedE;
+};
+
+/** fills a block with random data; header-sized parts of it look like invalid links */
+static void bbs_testFill( struct bbs_TestBlock* blockPtrA )
+{
+	uint32 randL = bbs_testRandG;
+	uint32 iL;
+	bbs_testRandG = blockPtrA->seedE;
+	for( iL = 0; iL < blockPtrA->sizeE; iL++ ) blockPtrA->memPtrE[ iL ] = ( uint16 )bbs_testRand();
+	bbs_testRandG = randL;
+}
+
+/** returns TRUE if the block still holds its random data */
+static flag bbs_testCheck( const struct bbs_TestBlock* blockPtrA )
+{
+	uint32 randL = bbs_testRandG;
+	flag okL = TRUE;
+	uint32 iL;
+	bbs_testRandG = blockPtrA->seedE;
+	for( iL = 0; iL < blockPtrA->sizeE; iL++ ) okL = okL && blockPtrA->memPtrE[ iL ] == ( uint16 )bbs_testRand();
+	bbs_testRandG = randL;
+	return okL;
+}
+
+/* ------------------------------------------------------------------------- */
+
+/** frees memPtrA, which was not allocated; returns 0 if that is reported and nothing changes */
+static int bbs_testFreeInvalid( struct bbs_Context* cpA, struct bbs_DynMemManager* mgrPtrA,
+								uint16* memPtrA, const char* caseA )
+{
+	uint32 freeCountL = mgrPtrA->freeCountE;
+	uint32 sizeL = mgrPtrA->sizeE;
+
+	bbs_DynMemManager_free( cpA, mgrPtrA, memPtrA );
+
+	if( !bbs_Context_error( cpA ) || mgrPtrA->freeCountE != freeCountL || mgrPtrA->sizeE != sizeL )
+	{
+		printf( "bbs_DynMemManager_free: freeing %s was not rejected\n", caseA );
+		return 1;
+	}
+	bbs_Context_popError( cpA );
+	return 0;
+}
+
+/* ------------------------------------------------------------------------- */
+
+static int bbs_testDynMemManager( uint32 arenaBlockSizeA )
+{
+	struct bbs_Context contextL;
+	struct bbs_DynMemManager mgrL;
+	struct bbs_TestBlock blockArrL[ bbs_TEST_MAX_BLOCKS ];
+	uint16 foreignArrL[ 64 ];
+	uint32 blocksL = 0;
+	uint32 nL, iL;
+	int errL = 0;
+
+	bbs_Context_init( &contextL );
+	bbs_DynMemManager_init( &contextL, &mgrL );
+	mgrL.mallocFPtrE = bbs_testMalloc;
+	mgrL.freeFPtrE = bbs_testFree;
+	bbs_DynMemManager_setArenaBlockSize( &contextL, &mgrL, arenaBlockSizeA );
+
+	for( iL = 0; iL < 64; iL++ ) foreignArrL[ iL ] = ( uint16 )bbs_testRand();
+
+	for( nL = 0; nL < bbs_TEST_ROUNDS && errL == 0; nL++ )
+	{
+		uint32 opL = bbs_testRand() % 8;
+
+		if( blocksL < bbs_TEST_MAX_BLOCKS && ( blocksL == 0 || opL < 4 ) )
+		{
+			struct bbs_TestBlock* blockPtrL = &blockArrL[ blocksL ];
+			blockPtrL->sizeE = 1 + bbs_testRand() % bbs_TEST_MAX_SIZE;
+			blockPtrL->seedE = bbs_testRand() | 1;
+			blockPtrL->memPtrE = bbs_DynMemManager_alloc( &contextL, &mgrL, NULL, blockPtrL->sizeE );
+			if( blockPtrL->memPtrE == NULL )
+			{
+				printf( "bbs_DynMemManager_alloc: allocation of %u words failed\n", blockPtrL->sizeE );
+				errL = 1;
+				break;
+			}
+			bbs_testFill( blockPtrL );
+			blocksL++;
+		}
+		else if( opL < 7 )
+		{
+			/* mostly the last block, as the library does */
+			uint32 idxL = opL < 5 ? blocksL - 1 : bbs_testRand() % blocksL;
+			struct bbs_TestBlock blockL = blockArrL[ idxL ];
+
+			if( !bbs_testCheck( &blockL ) )
+			{
+				printf( "bbs_DynMemManager: block %u of %u words was overwritten\n", idxL, blockL.sizeE );
+				errL = 1;
+				break;
+			}
+
+			bbs_DynMemManager_free( &contextL, &mgrL, blockL.memPtrE );
+			if( bbs_Context_error( &contextL ) )
+			{
+				printf( "bbs_DynMemManager_free: freeing block %u of %u words failed\n", idxL, blockL.sizeE );
+				errL = 1;
+				break;
+			}
+			blockArrL[ idxL ] = blockArrL[ --blocksL ];
+
+			/* the memory of the block is no longer allocated */
+			errL |= bbs_testFreeInvalid( &contextL, &mgrL, blockL.memPtrE, "a freed block" );
+		}
+		else
+		{
+			/* memory areas that are no blocks; the data in front of them holds random links */
+			struct bbs_TestBlock* blockPtrL = &blockArrL[ bbs_testRand() % blocksL ];
+			uint32 offsL = 4 * ( 1 + bbs_testRand() % 8 );
+			if( offsL < blockPtrL->sizeE )
+			{
+				errL |= bbs_testFreeInvalid( &contextL, &mgrL, blockPtrL->memPtrE + offsL, "memory inside a block" );
+			}
+			errL |= bbs_testFreeInvalid( &contextL, &mgrL, foreignArrL + 16 + 4 * ( bbs_testRand() % 8 ), "foreign memory" );
+		}
+
+		if( errL == 0 && mgrL.allocCountE - mgrL.freeCountE != blocksL )
+		{
+			printf( "bbs_DynMemManager: %u blocks allocated, expected %u\n", mgrL.allocCountE - mgrL.freeCountE, blocksL );
+			errL = 1;
+		}
+	}
+
+	for( iL = 0; iL < blocksL && errL == 0; iL++ )
+	{
+		if( !bbs_testCheck( &blockArrL[ iL ] ) )
+		{
+			printf( "bbs_DynMemManager: block %u of %u words was overwritten\n", iL, blockArrL[ iL ].sizeE );
+			errL = 1;
+		}
+	}
+
+	bbs_DynMemManager_freeAll( &contextL, &mgrL );
+	if( bbs_testMallocCountG != 0 )
+	{
+		printf( "bbs_DynMemManager_freeAll: %i blocks of the malloc handler were not freed\n", bbs_testMallocCountG );
+		errL = 1;
+	}
+
+	bbs_DynMemManager_exit( &contextL, &mgrL );
+	bbs_Context_exit( &contextL );
+	return errL;
+}
+
+/* ------------------------------------------------------------------------- */
+
+int main( void )
+{
+	int errL = 0;
+
+	errL |= bbs_testDynMemManager( 0 );
+	errL |= bbs_testDynMemManager( 256 );
+	errL |= bbs_testDynMemManager( 2048 );
+
+	printf( "DynMemManagerTest: %s\n", errL ? "FAILED" : "passed" );
+	return errL;
+}
+
+/* ------------------------------------------------------------------------- */
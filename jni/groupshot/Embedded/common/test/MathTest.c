@@ -0,0 +1,262 @@
+/*
+ * Copyright (C) 2008 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+/* Checks bbs_dotProductInt16, bbs_vecSqrNorm16 and bbs_matMultiplyFlt16
+ * (NEON or SSE2 versions, depending on the build) against bbs_dotProduct_stdc
+ * and the scalar loops, on random and extreme int16 values, with lengths and
+ * column counts that are no multiple of the vector width and unaligned vectors.
+ * Sums wrap around like the int32 loops. Exits with 0 when all results are equal.
+ */
+
+/* ---- includes ----------------------------------------------------------- */
+
+#include <stdio.h>
+
+#include "b_BasicEm/Math.h"
+
+/* ---- constants ---------------------------------------------------------- */
+
+#define bbs_TEST_ROUNDS 20000
+
+/* maximum vector length (several blocks of 16 plus tail) */
+#define bbs_TEST_MAX_SIZE 300
+
+/* maximum matrix dimensions */
+#define bbs_TEST_MAX_ROWS 12
+#define bbs_TEST_MAX_COLS 40
+
+/* ---- functions ---------------------------------------------------------- */
+
+static uint32 bbs_testRandG = 2463534242u;
+
+/** xorshift generator, deterministic on all platforms */
+static uint32 bbs_testRand( void )
+{
+	bbs_testRandG ^= bbs_testRandG << 13;
+	bbs_testRandG ^= bbs_testRandG >> 17;
+	bbs_testRandG ^= bbs_testRandG << 5;
+	return bbs_testRandG;
+}
+
+/** random value of the given kind:
+ *  0: any int16, 1: small values, 2: extreme values, 3: any with frequent -32768
+ */
+static int16 bbs_testValue( uint32 kindA )
+{
+	static const int16 edgeArrL[ 4 ] = { -32768, 32767, -32767, 0 };
+	uint32 rL = bbs_testRand();
+	switch( kindA )
+	{
+		case 0:  return ( int16 )rL;
+		case 1:  return ( int16 )( ( int32 )( rL % 201 ) - 100 );
+		case 2:  return edgeArrL[ rL & 3 ];
+		default: return ( rL & 3 ) == 0 ? -32768 : ( int16 )( rL >> 16 );
+	}
+}
+
+/* ------------------------------------------------------------------------- */
+
+/** dot product as a plain loop, summed modulo 2^32 */
+static int32 bbs_testDotProductRef( const int16* vec1A, const int16* vec2A, uint32 sizeA )
+{
+	uint32 sumL = 0;
+	uint32 iL;
+	for( iL = 0; iL < sizeA; iL++ ) sumL += ( uint32 )( ( int32 )vec1A[ iL ] * vec2A[ iL ] );
+	return ( int32 )sumL;
+}
+
+/* ------------------------------------------------------------------------- */
+
+/** square norm as computed by the scalar loop of bbs_vecSqrNorm16 */
+static void bbs_testVecSqrNormRef( const int16* vecA, uint32 sizeA, uint32* manPtrA, uint32* expPtrA )
+{
+	uint32 sumL = 0;
+	int32 sumExpL = 0;
+	uint32 iL;
+
+	for( iL = 0; iL < sizeA; iL++ )
+	{
+		int32 vL = vecA[ iL ];
+		uint32 prdL = vL * vL;
+
+		if( sumExpL > 0 )
+		{
+			uint32 shrL = sumExpL;
+			prdL = ( ( prdL >> ( shrL - 1 ) ) + 1 ) >> 1;
+		}
+
+		sumL += prdL;
+
+		if( sumL > 0x80000000 )
+		{
+			sumL = ( sumL + 1 ) >> 1;
+			sumExpL++;
+		}
+	}
+
+	if( ( sumExpL & 1 ) != 0 )
+	{
+		sumL = ( sumL + 1 ) >> 1;
+		sumExpL++;
+	}
+
+	*manPtrA = sumL;
+	*expPtrA = sumExpL;
+}
+
+/* ------------------------------------------------------------------------- */
+
+/** matrix multiply as the scalar loop of bbs_matMultiplyFlt16, summed modulo 2^32 */
+static void bbs_testMatMultiplyRef( const int16 *x1A, int32 row1A, int32 col1A,
+									const int16 *x2A, int32 col2A, int16 *rA )
+{
+	int32 iL, jL, kL;
+	for( iL = 0; iL < row1A; iL++ )
+	{
+		for( jL = 0; jL < col2A; jL++ )
+		{
+			uint32 sumL = 0;
+			for( kL = 0; kL < col1A; kL++ )
+			{
+				sumL += ( uint32 )( ( int32 )x1A[ iL * col1A + kL ] * x2A[ kL * col2A + jL ] );
+			}
+			*rA++ = ( int16 )( ( int32 )( sumL + ( 1 << 14 ) ) >> 15 );
+		}
+	}
+}
+
+/* ------------------------------------------------------------------------- */
+
+static int bbs_testDotProduct( void )
+{
+	/* room for an offset of up to 7 elements */
+	int16 vec1ArrL[ bbs_TEST_MAX_SIZE + 8 ];
+	int16 vec2ArrL[ bbs_TEST_MAX_SIZE + 8 ];
+	uint32 nL, iL;
+
+	for( nL = 0; nL < bbs_TEST_ROUNDS; nL++ )
+	{
+		uint32 kindL = nL & 3;
+		uint32 sizeL = bbs_testRand() % ( bbs_TEST_MAX_SIZE + 1 );
+		const int16* vec1L = vec1ArrL + bbs_testRand() % 8;
+		const int16* vec2L = vec2ArrL + bbs_testRand() % 8;
+		int32 refL, dotL;
+
+		for( iL = 0; iL < bbs_TEST_MAX_SIZE + 8; iL++ )
+		{
+			vec1ArrL[ iL ] = bbs_testValue( kindL );
+			vec2ArrL[ iL ] = bbs_testValue( kindL );
+		}
+
+		refL = bbs_testDotProductRef( vec1L, vec2L, sizeL );
+		dotL = bbs_dotProductInt16( vec1L, vec2L, sizeL );
+
+		/* small values do not overflow, the standard C version must match too */
+		if( dotL != refL || ( kindL == 1 && bbs_dotProduct_stdc( vec1L, vec2L, sizeL ) != refL ) )
+		{
+			printf( "bbs_dotProductInt16: size %u, kind %u is %i, stdc %i, expected %i\n",
+					sizeL, kindL, dotL, bbs_dotProduct_stdc( vec1L, vec2L, sizeL ), refL );
+			return 1;
+		}
+	}
+	return 0;
+}
+
+/* ------------------------------------------------------------------------- */
+
+static int bbs_testVecSqrNorm( void )
+{
+	int16 vecArrL[ bbs_TEST_MAX_SIZE + 8 ];
+	uint32 nL, iL;
+
+	for( nL = 0; nL < bbs_TEST_ROUNDS; nL++ )
+	{
+		uint32 kindL = nL & 3;
+		uint32 sizeL = bbs_testRand() % ( bbs_TEST_MAX_SIZE + 1 );
+		const int16* vecL = vecArrL + bbs_testRand() % 8;
+		uint32 manL, expL, refManL, refExpL;
+
+		/* every 8th round grows the vector slowly, so the sum crosses 2^31 within the blocks */
+		for( iL = 0; iL < bbs_TEST_MAX_SIZE + 8; iL++ )
+		{
+			vecArrL[ iL ] = ( nL & 7 ) == 7 ? ( int16 )( iL * ( 1 + nL % 97 ) ) : bbs_testValue( kindL );
+		}
+
+		bbs_testVecSqrNormRef( vecL, sizeL, &refManL, &refExpL );
+		bbs_vecSqrNorm16( vecL, sizeL, &manL, &expL );
+
+		if( manL != refManL || expL != refExpL )
+		{
+			printf( "bbs_vecSqrNorm16: size %u, kind %u is %u * 2^%u, expected %u * 2^%u\n",
+					sizeL, kindL, manL, expL, refManL, refExpL );
+			return 1;
+		}
+	}
+	return 0;
+}
+
+/* ------------------------------------------------------------------------- */
+
+static int bbs_testMatMultiply( void )
+{
+	int16 x1ArrL[ bbs_TEST_MAX_ROWS * bbs_TEST_MAX_COLS ];
+	int16 x2ArrL[ bbs_TEST_MAX_COLS * bbs_TEST_MAX_COLS ];
+	int16 rArrL[ bbs_TEST_MAX_ROWS * bbs_TEST_MAX_COLS ];
+	int16 refArrL[ bbs_TEST_MAX_ROWS * bbs_TEST_MAX_COLS ];
+	uint32 nL;
+	int32 iL;
+
+	for( nL = 0; nL < bbs_TEST_ROUNDS; nL++ )
+	{
+		uint32 kindL = nL & 3;
+		int32 row1L = 1 + bbs_testRand() % bbs_TEST_MAX_ROWS;
+		int32 col1L = 1 + bbs_testRand() % bbs_TEST_MAX_COLS;
+		int32 col2L = 1 + bbs_testRand() % bbs_TEST_MAX_COLS;
+
+		for( iL = 0; iL < row1L * col1L; iL++ ) x1ArrL[ iL ] = bbs_testValue( kindL );
+		for( iL = 0; iL < col1L * col2L; iL++ ) x2ArrL[ iL ] = bbs_testValue( kindL );
+
+		bbs_testMatMultiplyRef( x1ArrL, row1L, col1L, x2ArrL, col2L, refArrL );
+		bbs_matMultiplyFlt16( x1ArrL, ( int16 )row1L, ( int16 )col1L, x2ArrL, ( int16 )col2L, rArrL );
+
+		for( iL = 0; iL < row1L * col2L; iL++ )
+		{
+			if( rArrL[ iL ] != refArrL[ iL ] )
+			{
+				printf( "bbs_matMultiplyFlt16: %i x %i * %i x %i, kind %u, element %i is %i, expected %i\n",
+						row1L, col1L, col1L, col2L, kindL, iL, rArrL[ iL ], refArrL[ iL ] );
+				return 1;
+			}
+		}
+	}
+	return 0;
+}
+
+/* ------------------------------------------------------------------------- */
+
+int main( void )
+{
+	int errL = 0;
+
+	errL |= bbs_testDotProduct();
+	errL |= bbs_testVecSqrNorm();
+	errL |= bbs_testMatMultiply();
+
+	printf( "MathTest: %s\n", errL ? "FAILED" : "passed" );
+	return errL;
+}
+
+/* ------------------------------------------------------------------------- */
@@ -0,0 +1,198 @@
+/*
+ * Copyright (C) 2008 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+/* Checks the pca projection of bbf_LocalScanDetector (dot products over the
+ * pca matrix and its transposed copy) against the nested loops it replaced,
+ * for all cluster sizes and subspace dimensions.
+ * Centered coordinates and projection coefficients are saturated to int16 by
+ * the dot product version: with values in the range of landmark clusters the
+ * results are equal to the loops, with extreme values they are equal to the
+ * loops saturating at the same points. Exits with 0 when all results match.
+ */
+
+/* ---- includes ----------------------------------------------------------- */
+
+#include <stdio.h>
+
+#include "b_BasicEm/Math.h"
+#include "b_BitFeatureEm/LocalScanDetector.h"
+
+/* ---- constants ---------------------------------------------------------- */
+
+#define bbf_TEST_ROUNDS 2000
+
+/* ---- functions ---------------------------------------------------------- */
+
+static uint32 bbf_testRandG = 2463534242u;
+
+/** xorshift generator, deterministic on all platforms */
+static uint32 bbf_testRand( void )
+{
+	bbf_testRandG ^= bbf_testRandG << 13;
+	bbf_testRandG ^= bbf_testRandG >> 17;
+	bbf_testRandG ^= bbf_testRandG << 5;
+	return bbf_testRandG;
+}
+
+/** random value in [ -rangeA, rangeA ], extreme int16 values if rangeA is 0 */
+static int16 bbf_testValue( int32 rangeA )
+{
+	static const int16 edgeArrL[ 4 ] = { -32768, 32767, -32767, 0 };
+	if( rangeA == 0 ) return edgeArrL[ bbf_testRand() & 3 ];
+	return ( int16 )( ( int32 )( bbf_testRand() % ( 2 * rangeA + 1 ) ) - rangeA );
+}
+
+/* ------------------------------------------------------------------------- */
+
+/** projection as computed before (nested loops over the pca matrix);
+ *  satA saturates the intermediate values like the dot product version
+ */
+static void bbf_testPcaProjectRef( const int16* matA, const int16* avgA, uint32 dimA,
+								   struct bts_Int16Vec2D* vecArrA, uint32 sizeA, flag satA )
+{
+	int32 prjVecL[ bpi_LOCAL_SCAN_DETECTOR_MAX_PCA_DIM ];
+	uint32 matWidthL = sizeA * 2;
+	uint32 iL, jL;
+
+	for( iL = 0; iL < dimA; iL++ )
+	{
+		int32 sumL = 0;
+		const int16* matPtrL = matA + iL * matWidthL;
+		for( jL = 0; jL < sizeA; jL++ )
+		{
+			int32 dxL = vecArrA[ jL ].xE - avgA[ 2 * jL + 0 ];
+			int32 dyL = vecArrA[ jL ].yE - avgA[ 2 * jL + 1 ];
+			if( satA ) dxL = bbs_satS16( dxL );
+			if( satA ) dyL = bbs_satS16( dyL );
+			sumL += matPtrL[ 2 * jL + 0 ] * dxL;
+			sumL += matPtrL[ 2 * jL + 1 ] * dyL;
+		}
+		prjVecL[ iL ] = ( sumL + 128 ) >> 8;
+		if( satA ) prjVecL[ iL ] = bbs_satS16( prjVecL[ iL ] );
+	}
+
+	for( jL = 0; jL < sizeA; jL++ )
+	{
+		int32 sumXL = 0, sumYL = 0;
+		for( iL = 0; iL < dimA; iL++ )
+		{
+			sumXL += matA[ iL * matWidthL + 2 * jL + 0 ] * prjVecL[ iL ];
+			sumYL += matA[ iL * matWidthL + 2 * jL + 1 ] * prjVecL[ iL ];
+		}
+		vecArrA[ jL ].xE = ( ( sumXL + 128 ) >> 8 ) + avgA[ 2 * jL + 0 ];
+		vecArrA[ jL ].yE = ( ( sumYL + 128 ) >> 8 ) + avgA[ 2 * jL + 1 ];
+	}
+}
+
+/* ------------------------------------------------------------------------- */
+
+/** compares projections of random clusters; coordinates and average are in
+ *  [ -crdRangeA, crdRangeA ], matrix elements in [ -matRangeA, matRangeA ];
+ *  0 selects extreme values
+ */
+static int bbf_testPcaProject( int32 crdRangeA, int32 matRangeA, flag satA )
+{
+	struct bbs_Context contextL;
+	struct bbf_LocalScanDetector detL;
+	struct bts_Cluster2D clusterL;
+
+	int16 matArrL[ bpi_LOCAL_SCAN_DETECTOR_MAX_PCA_DIM * bpi_LOCAL_SCAN_DETECTOR_MAX_CLUSTER_SIZE * 2 ];
+	int16 matTrArrL[ bpi_LOCAL_SCAN_DETECTOR_MAX_PCA_DIM * bpi_LOCAL_SCAN_DETECTOR_MAX_CLUSTER_SIZE * 2 ];
+	int16 avgArrL[ bpi_LOCAL_SCAN_DETECTOR_MAX_CLUSTER_SIZE * 2 ];
+	struct bts_Int16Vec2D vecArrL[ bpi_LOCAL_SCAN_DETECTOR_MAX_CLUSTER_SIZE ];
+	struct bts_Int16Vec2D refArrL[ bpi_LOCAL_SCAN_DETECTOR_MAX_CLUSTER_SIZE ];
+	uint32 nL, iL, jL;
+	int errL = 0;
+
+	bbs_Context_init( &contextL );
+	bbf_LocalScanDetector_init( &contextL, &detL );
+
+	/* arrays are set up in place, the detector is not exited */
+	detL.pcaMatE.arrPtrE = matArrL;
+	detL.pcaMatTrE.arrPtrE = matTrArrL;
+	detL.pcaAvgE.arrPtrE = avgArrL;
+	clusterL.vecArrE = vecArrL;
+	clusterL.bbpE = 6;
+
+	for( nL = 0; nL < bbf_TEST_ROUNDS && errL == 0; nL++ )
+	{
+		/* all sizes and dimensions, most of them no multiple of the vector width */
+		uint32 sizeL = 1 + nL % bpi_LOCAL_SCAN_DETECTOR_MAX_CLUSTER_SIZE;
+		uint32 dimL = 1 + ( nL / bpi_LOCAL_SCAN_DETECTOR_MAX_CLUSTER_SIZE ) % bpi_LOCAL_SCAN_DETECTOR_MAX_PCA_DIM;
+		uint32 widthL = sizeL * 2;
+
+		detL.pcaDimSubSpaceE = dimL;
+		detL.pcaMatE.sizeE = dimL * widthL;
+		detL.pcaMatTrE.sizeE = dimL * widthL;
+		detL.pcaAvgE.sizeE = widthL;
+		clusterL.sizeE = sizeL;
+
+		for( iL = 0; iL < dimL * widthL; iL++ ) matArrL[ iL ] = bbf_testValue( matRangeA );
+		for( iL = 0; iL < dimL; iL++ )
+		{
+			for( jL = 0; jL < widthL; jL++ ) matTrArrL[ jL * dimL + iL ] = matArrL[ iL * widthL + jL ];
+		}
+		for( iL = 0; iL < widthL; iL++ ) avgArrL[ iL ] = bbf_testValue( crdRangeA );
+		for( iL = 0; iL < sizeL; iL++ )
+		{
+			vecArrL[ iL ].xE = bbf_testValue( crdRangeA );
+			vecArrL[ iL ].yE = bbf_testValue( crdRangeA );
+			refArrL[ iL ] = vecArrL[ iL ];
+		}
+
+		bbf_testPcaProjectRef( matArrL, avgArrL, dimL, refArrL, sizeL, satA );
+		bbf_LocalScanDetector_pcaProject( &contextL, &detL, &clusterL );
+
+		if( bbs_Context_error( &contextL ) )
+		{
+			printf( "bbf_LocalScanDetector_pcaProject: error for size %u, dim %u\n", sizeL, dimL );
+			errL = 1;
+		}
+
+		for( iL = 0; iL < sizeL && errL == 0; iL++ )
+		{
+			if( vecArrL[ iL ].xE != refArrL[ iL ].xE || vecArrL[ iL ].yE != refArrL[ iL ].yE )
+			{
+				printf( "bbf_LocalScanDetector_pcaProject: size %u, dim %u, vector %u is ( %i, %i ), expected ( %i, %i )\n",
+						sizeL, dimL, iL, vecArrL[ iL ].xE, vecArrL[ iL ].yE, refArrL[ iL ].xE, refArrL[ iL ].yE );
+				errL = 1;
+			}
+		}
+	}
+
+	bbs_Context_exit( &contextL );
+	return errL;
+}
+
+/* ------------------------------------------------------------------------- */
+
+int main( void )
+{
+	int errL = 0;
+
+	/* landmark clusters (10.6) and matrix (8.8) in their usual range: results as before */
+	errL |= bbf_testPcaProject( 1000, 64, FALSE );
+
+	/* extreme coordinates: centered values and projection saturate at int16 
+	 * (matrix kept small enough for the sums not to overflow int32)
+	 */
+	errL |= bbf_testPcaProject( 0, 16, TRUE );
+
+	printf( "PcaProjectTest: %s\n", errL ? "FAILED" : "passed" );
+	return errL;
+}
+
+/* ------------------------------------------------------------------------- */
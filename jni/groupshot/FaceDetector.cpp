@@ -18,6 +18,8 @@
 #include <stdio.h>
 #include <fcntl.h>
 #include <unistd.h>
+#include <string.h>
+#include <pthread.h>
 
 
 extern "C"
@@ -44,6 +46,12 @@ typedef struct
 	int height;
 } fdInstance;
 
+#define FD_POOL_SIZE	8
+
+static pthread_mutex_t pool_lock = PTHREAD_MUTEX_INITIALIZER;
+static fdInstance *pool[FD_POOL_SIZE];
+static int pool_busy[FD_POOL_SIZE];
+
 
 unsigned char initData[] = {	// RFFstd_501.bmd
 	0x41,0x26,0x00,0x00,0x01,0x00,0x00,0x00,0x3C,0x26,0x00,0x00,0x64,0x00,0x00,0x00,0x01,0x00,0x00,0x00,
@@ -1157,3 +1165,116 @@ void FaceDetector_get_face(void *instance, float *confid, float *midx, float *mi
     *midy    = faceData.midpointy;
     *eyedist = faceData.eyedist;
 }
+
+void FaceDetector_setTracking(void *instance, int interval)
+{
+	fdInstance *f = (fdInstance *)instance;
+
+	btk_FaceFinder_setTracking(f->fd, interval);
+}
+
+// ---------------------------------------------------------------------------
+
+void *FaceDetector_acquire(int w, int h, int maxFaces)
+{
+	fdInstance *victim = NULL;
+	void *inst = NULL;
+	int i, slot = -1;
+
+	pthread_mutex_lock(&pool_lock);
+	for (i = 0; i < FD_POOL_SIZE; ++i)
+		if (pool[i] && !pool_busy[i]
+			&& (pool[i]->width == w) && (pool[i]->height == h) && (pool[i]->maxFaces == maxFaces))
+		{
+			pool_busy[i] = 1;
+			inst = pool[i];
+			break;
+		}
+
+	if (inst == NULL)
+	{
+		// reserve an empty slot or take over an idle context of other resolution
+		for (i = 0; i < FD_POOL_SIZE; ++i)
+			if ((pool[i] == NULL) && !pool_busy[i])
+			{
+				slot = i;
+				break;
+			}
+		if (slot < 0)
+			for (i = 0; i < FD_POOL_SIZE; ++i)
+				if (!pool_busy[i])
+				{
+					slot = i;
+					victim = pool[i];
+					pool[i] = NULL;
+					break;
+				}
+		if (slot >= 0)
+			pool_busy[slot] = 1;
+	}
+	pthread_mutex_unlock(&pool_lock);
+
+	if (inst)
+		return inst;
+
+	// created out of the lock, parsing the model takes a while
+	FaceDetector_destroy(victim);
+	if (!FaceDetector_initialize(&inst, w, h, maxFaces))
+	{
+		FaceDetector_destroy(inst);
+		inst = NULL;
+	}
+
+	// all slots busy: the context is not pooled and is destroyed on release
+	if (slot >= 0)
+	{
+		pthread_mutex_lock(&pool_lock);
+		pool[slot] = (fdInstance *)inst;
+		if (inst == NULL)
+			pool_busy[slot] = 0;
+		pthread_mutex_unlock(&pool_lock);
+	}
+
+	return inst;
+}
+
+void FaceDetector_release(void * instance)
+{
+	int i;
+
+	if (instance == NULL)
+		return;
+
+	// pooled contexts are handed out with tracking off
+	FaceDetector_setTracking(instance, 0);
+
+	pthread_mutex_lock(&pool_lock);
+	for (i = 0; i < FD_POOL_SIZE; ++i)
+		if (pool[i] == instance)
+		{
+			pool_busy[i] = 0;
+			break;
+		}
+	pthread_mutex_unlock(&pool_lock);
+
+	if (i == FD_POOL_SIZE)
+		FaceDetector_destroy(instance);
+}
+
+void FaceDetector_freePool()
+{
+	fdInstance *idle[FD_POOL_SIZE];
+	int i, nIdle = 0;
+
+	pthread_mutex_lock(&pool_lock);
+	for (i = 0; i < FD_POOL_SIZE; ++i)
+		if (pool[i] && !pool_busy[i])
+		{
+			idle[nIdle++] = pool[i];
+			pool[i] = NULL;
+		}
+	pthread_mutex_unlock(&pool_lock);
+
+	for (i = 0; i < nIdle; ++i)
+		FaceDetector_destroy(idle[i]);
+}
@@ -24,5 +24,18 @@ void FaceDetector_destroy(void * instance);
 int  FaceDetector_detect(void * instance, unsigned char *bwbuffer);
 void FaceDetector_get_face(void *instance, float *confid, float *midx, float *midy, float *eyedist);
 
+// For a sequence of similar frames (burst): only one in interval+1 frames is
+// scanned fully, the others around the faces of the previous frame. Starts over
+// with a full scan, interval 0 turns tracking off
+void FaceDetector_setTracking(void *instance, int interval);
+
+// Detector contexts kept for reuse: creating one sets up the SDK and parses
+// the model. A context taken with FaceDetector_acquire is used by one thread
+// until it is given back with FaceDetector_release.
+void *FaceDetector_acquire(int w, int h, int maxFaces);
+void FaceDetector_release(void *instance);
+// destroy idle contexts of the pool
+void FaceDetector_freePool();
+
 
 #endif // __FACEDETECTOR_H__
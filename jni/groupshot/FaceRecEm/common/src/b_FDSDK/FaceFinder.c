@@ -163,6 +163,23 @@ btk_Status btk_FaceFinder_setRange( btk_HFaceFinder hFaceFinderA,
 
 /* ------------------------------------------------------------------------- */
 
+btk_Status btk_FaceFinder_setTracking( btk_HFaceFinder hFaceFinderA,
+									   u32 intervalA )
+{
+	btk_HSDK hsdkL = NULL;
+	if( hFaceFinderA == NULL )				return btk_STATUS_INVALID_HANDLE;
+	if( hFaceFinderA->hidE != btk_HID_FF )	return btk_STATUS_INVALID_HANDLE;
+	hsdkL = hFaceFinderA->hsdkE;
+	if( bbs_Context_error( &hsdkL->contextE ) ) return btk_STATUS_PREEXISTING_ERROR;
+
+	bpi_FaceFinderRef_setTracking( &hsdkL->contextE, &hFaceFinderA->ffE, intervalA );
+	if( bbs_Context_error( &hsdkL->contextE ) ) return btk_STATUS_ERROR;
+
+	return btk_STATUS_OK;
+}
+
+/* ------------------------------------------------------------------------- */
+
 btk_Status btk_FaceFinder_putDCR( btk_HFaceFinder hFaceFinderA,
 								  btk_HDCR hdcrA )
 {
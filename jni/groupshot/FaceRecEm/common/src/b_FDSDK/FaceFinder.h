@@ -80,6 +80,17 @@ btk_Status btk_FaceFinder_setRange( btk_HFaceFinder hFaceFinderA,
 								    u32 minDistA,
 									u32 maxDistA );
 
+/** Enables tracking for a sequence of similar images (e.g. burst frames):
+ *  btk_FaceFinder_putDCR then scans only one in intervalA + 1 images fully,
+ *  the others around the faces found in the previous image. An image is scanned
+ *  fully as well when a face got lost or its confidence dropped. Faces appearing
+ *  meanwhile are found with the next full scan.
+ *  Each call starts over with a full scan; intervalA = 0 disables tracking.
+ */
+btk_DECLSPEC
+btk_Status btk_FaceFinder_setTracking( btk_HFaceFinder hFaceFinderA,
+									   u32 intervalA );
+
 /** passes a DCR object and triggers image processing */
 btk_DECLSPEC
 btk_Status btk_FaceFinder_putDCR( btk_HFaceFinder hFaceFinderA,
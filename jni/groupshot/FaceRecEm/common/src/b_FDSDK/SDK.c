@@ -93,6 +93,7 @@ btk_SDKCreateParam btk_SDK_defaultParam()
 	paramL.fpError = NULL;
 	paramL.fpMalloc = NULL;
 	paramL.fpFree = NULL;
+	paramL.sizeArenaBlock = 0;
 	paramL.pExMem = NULL;
 	paramL.sizeExMem = 0;
 	paramL.pShMem = NULL;
@@ -129,6 +130,7 @@ btk_Status btk_SDK_create( const btk_SDKCreateParam* pCreateParamA,
 
 		/* initialize core context */
 		bbs_Context_quickInit( &hsdkL->contextE, btk_malloc, pCreateParamA->fpFree, btk_error );
+		bbs_Context_setArenaBlockSize( &hsdkL->contextE, pCreateParamA->sizeArenaBlock >> 1 );
 		if( bbs_Context_error( &hsdkL->contextE ) ) return btk_STATUS_ERROR;
 	}
 	else
@@ -252,6 +254,45 @@ u32 btk_SDK_allocSize( btk_HSDK hsdkA )
 
 /* ------------------------------------------------------------------------- */
 
+/* copies statistics of a dynamic memory manager (NULL for static memory) */
+void btk_SDK_copyMemStat( const struct bbs_DynMemManager* mgrPtrA, btk_MemStat* pStatA )
+{
+	if( pStatA == NULL ) return;
+
+	if( mgrPtrA == NULL )
+	{
+		pStatA->allocCount = 0;
+		pStatA->freeCount = 0;
+		pStatA->mallocCount = 0;
+		pStatA->size = 0;
+		pStatA->peakSize = 0;
+		pStatA->arenaSize = 0;
+		return;
+	}
+
+	pStatA->allocCount = mgrPtrA->allocCountE;
+	pStatA->freeCount = mgrPtrA->freeCountE;
+	pStatA->mallocCount = mgrPtrA->mallocCountE;
+	pStatA->size = mgrPtrA->sizeE * 2;
+	pStatA->peakSize = mgrPtrA->peakSizeE * 2;
+	pStatA->arenaSize = mgrPtrA->arenaSizeE * 2;
+}
+
+/* ------------------------------------------------------------------------- */
+
+btk_Status btk_SDK_memStat( btk_HSDK hsdkA, btk_MemStat* pExStatA, btk_MemStat* pShStatA )
+{
+	if( hsdkA == NULL )					return btk_STATUS_INVALID_HANDLE;
+	if( hsdkA->hidE != btk_HID_SDK )	return btk_STATUS_INVALID_HANDLE;
+
+	btk_SDK_copyMemStat( hsdkA->contextE.memTblE.esArrE[ 0 ].dynMemManagerPtrE, pExStatA );
+	btk_SDK_copyMemStat( hsdkA->contextE.memTblE.ssArrE[ 0 ].dynMemManagerPtrE, pShStatA );
+
+	return btk_STATUS_OK;
+}
+
+/* ------------------------------------------------------------------------- */
+
 btk_Status btk_SDK_paramConsistencyTest( struct btk_SDK* hsdkA,
 										 const void* memPtrA,
 										 u32 memSizeA,
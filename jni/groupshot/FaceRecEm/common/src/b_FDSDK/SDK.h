@@ -61,6 +61,12 @@ typedef struct
 	/** handler to free function */
 	btk_fpFree   fpFree;
 
+	/** (optional) minimum size of arena blocks in bytes (used with fpMalloc)
+	 *  memory is then taken from larger blocks allocated with fpMalloc and released in bulk;
+	 *  0: each memory block is allocated with fpMalloc
+	 */
+	u32 sizeArenaBlock;
+
 	/** pointer to preallocated exclusive (=persistent) memory (alternative to fpMalloc) */
 	void* pExMem;
 
@@ -84,6 +90,29 @@ typedef struct
 
 } btk_SDKCreateParam;
 
+/** dynamic memory statistics (sizes in bytes) */
+typedef struct
+{
+	/** number of allocated memory blocks */
+	u32 allocCount;
+
+	/** number of freed memory blocks */
+	u32 freeCount;
+
+	/** number of calls of fpMalloc */
+	u32 mallocCount;
+
+	/** size of currently allocated memory blocks */
+	u32 size;
+
+	/** peak of size; with arena blocks: peak of memory used in arena blocks */
+	u32 peakSize;
+
+	/** size of all arena blocks */
+	u32 arenaSize;
+
+} btk_MemStat;
+
 /* ---- constants ---------------------------------------------------------- */
 
 /* ---- functions ---------------------------------------------------------- */
@@ -119,6 +148,15 @@ u32 btk_SDK_shAllocSize( btk_HSDK hsdkA );
 btk_DECLSPEC
 u32 btk_SDK_allocSize( btk_HSDK hsdkA );
 
+/** returns dynamic memory statistics of exclusive and shared memory (either pointer can be NULL);
+ *  measured with arena blocks, the larger peakSize is a sizeArenaBlock
+ *  for which no further arena blocks are allocated
+ */
+btk_DECLSPEC
+btk_Status btk_SDK_memStat( btk_HSDK hsdkA,
+						    btk_MemStat* pExStatA,
+						    btk_MemStat* pShStatA );
+
 #ifdef __cplusplus
 }
 #endif
@@ -22,6 +22,9 @@
 #include <android/log.h>
 
 #include "ImageConversionUtils.h"
+#include "MemoryBudget.h"
+#include "FrameHandle.h"
+#include "FramePool.h"
 #include "FaceDetector.h"
 
 #include "almashot.h"
@@ -50,9 +53,15 @@ void __attribute__((destructor)) release_openmp() {
 
 #define MAX_GS_FRAMES	20
 #define MAX_FACE_DETECTED	20
+// burst frames detected by tracking the faces of the previous frame between full scans
+#define FD_TRACK_INTERVAL	7
 
 static unsigned char *inputFrame[MAX_GS_FRAMES] = { NULL, NULL, NULL, NULL,
 		NULL, NULL, NULL, NULL };
+//size of each input frame, as reserved in the memory budget
+static int inputFrameSize = 0;
+// input frames as seen from java, owned by this module
+static FrameHandle inputHandle[MAX_GS_FRAMES] = {0};
 
 static void *instance = NULL;
 static int almashot_inited = 0;
@@ -103,9 +112,14 @@ extern "C" JNIEXPORT jint JNICALL Java_com_almalence_plugins_processing_groupsho
 	LOGD("Release - start");
 	int i;
 
+	if (nFrames > MAX_GS_FRAMES)
+		nFrames = MAX_GS_FRAMES;
+
 	for (int i=0; i<nFrames; ++i)
 	{
-		if (inputFrame[i]) free(inputFrame[i]);
+		FrameHandle_Release(inputHandle[i]);
+		inputHandle[i] = 0;
+		MemoryBudget_Free(MEMBUDGET_GROUPSHOT, inputFrame[i], inputFrameSize);
 		inputFrame[i] = NULL;
 	}
 
@@ -121,16 +135,33 @@ extern "C" JNIEXPORT jint JNICALL Java_com_almalence_plugins_processing_groupsho
 		almashot_inited = 0;
 	}
 
+	FaceDetector_freePool();
+
 	LOGD("Release - end")
 ;
 	return 0;
 }
 
+// detect faces of inputFrame[i] into fd_* storage, grayFrame is fd_sx*fd_sy work buffer
+static void DetectFaces(void *inst, unsigned char *grayFrame, int i, int sx, int sy, int fd_sx, int fd_sy, int rotationDegree)
+{
+	if(rotationDegree == 0 || rotationDegree == 180)
+		NV21_to_Gray_scaled(inputFrame[i], sx, sy, 0, 0, sx, sy, fd_sx, fd_sy, grayFrame);
+	else
+		NV21_to_Gray_scaled(inputFrame[i], sy, sx, 0, 0, sy, sx, fd_sx, fd_sy, grayFrame);
+
+	fd_nFaces[i] = FaceDetector_detect(inst, grayFrame);
+	if (fd_nFaces[i] > MAX_FACE_DETECTED)
+		fd_nFaces[i] = MAX_FACE_DETECTED;
+	for (int f=0; f<fd_nFaces[i]; ++f)
+		FaceDetector_get_face(inst, &fd_confid[i][f], &fd_midx[i][f], &fd_midy[i][f], &fd_eyedist[i][f]);
+}
+
 extern "C" JNIEXPORT jint JNICALL Java_com_almalence_plugins_processing_groupshot_AlmaShotGroupShot_DetectFacesFromYUVs
 (
 	JNIEnv* env,
 	jobject thiz,
-	jintArray in,
+	jlongArray in,
 	jintArray in_len,
 	jint nFrames,
 	jint sx,
@@ -143,20 +174,33 @@ extern "C" JNIEXPORT jint JNICALL Java_com_almalence_plugins_processing_groupsho
 {
 	int i;
 	int *yuv_length;
-	unsigned char **yuv;
+	jlong *handles;
+	unsigned char *yuv[MAX_GS_FRAMES];
 	char status[1024];
 	int isFoundinInput = 255;
 
 	int x, y;
 	int x0_out, y0_out, w_out, h_out;
 
-	yuv = (unsigned char**)env->GetIntArrayElements(in, NULL);
-	yuv_length = (int*)env->GetIntArrayElements(in_len, NULL);
+	if (nFrames > MAX_GS_FRAMES)
+		nFrames = MAX_GS_FRAMES;
+
+	inputFrameSize = sx*sy+2*((sx+1)/2)*((sy+1)/2);
+
+	// input frames are only read, java releases them
+	handles = env->GetLongArrayElements(in, NULL);
+	for (i=0; i<nFrames; ++i)
+		if ((yuv[i] = (unsigned char*)FrameHandle_Data(handles[i], inputFrameSize)) == NULL)
+			break;
+	env->ReleaseLongArrayElements(in, handles, JNI_ABORT);
+
+	if (i < nFrames)
+		return i;
 
 	// pre-allocate uncompressed yuv buffers
 	for (i=0; i<nFrames; ++i)
 	{
-		inputFrame[i] = (unsigned char*)malloc(sx*sy+2*((sx+1)/2)*((sy+1)/2));
+		inputFrame[i] = (unsigned char*)MemoryBudget_Alloc(MEMBUDGET_GROUPSHOT, inputFrameSize);
 
 		if (inputFrame[i]==NULL)
 		{
@@ -164,15 +208,17 @@ extern "C" JNIEXPORT jint JNICALL Java_com_almalence_plugins_processing_groupsho
 			i--;
 			for (;i>=0;--i)
 			{
-				free(inputFrame[i]);
+				MemoryBudget_Free(MEMBUDGET_GROUPSHOT, inputFrame[i], inputFrameSize);
 				inputFrame[i] = NULL;
 			}
 			return -1;
 		}
 	}
 
-	// prepare down-scaled gray frames for face detection analisys and detect faces
-	#pragma omp parallel for
+	yuv_length = (int*)env->GetIntArrayElements(in_len, NULL);
+
+	// rotate frames as they are to be processed
+	#pragma omp parallel for schedule(static)
 	for (i=0; i<nFrames; ++i)
 	{
 		bool mirrored = cameraMirrored;
@@ -192,35 +238,36 @@ extern "C" JNIEXPORT jint JNICALL Java_com_almalence_plugins_processing_groupsho
 		}
 		else
 		{
-			memcpy(inputFrame[i], yuv[i], yuv_length[i]);
+			memcpy(inputFrame[i], yuv[i], yuv_length[i] < inputFrameSize ? yuv_length[i] : inputFrameSize);
 		}
+	}
+
+	env->ReleaseIntArrayElements(in_len, (jint*)yuv_length, JNI_ABORT);
 
+	// Frames are detected in order with one detector and a down-scaled gray buffer:
+	// the first frame is a full scan, the detector spreads it over all threads by itself,
+	// faces of the following frames are tracked from the previous one between full scans
+	if (nFrames > 0)
+	{
+		void *inst = FaceDetector_acquire(fd_sx, fd_sy, MAX_FACE_DETECTED);
 		unsigned char * grayFrame = (unsigned char *)malloc(fd_sx*fd_sy);
-		if (grayFrame == NULL)
-			isFoundinInput = i;
+
+		if ((grayFrame == NULL) || (inst == NULL))
+			isFoundinInput = 0;
 		else
 		{
-			void *inst;
-
-			if(rotationDegree == 0 || rotationDegree == 180)
-				NV21_to_Gray_scaled(inputFrame[i], sx, sy, 0, 0, sx, sy, fd_sx, fd_sy, grayFrame);
-			else
-				NV21_to_Gray_scaled(inputFrame[i], sy, sx, 0, 0, sy, sx, fd_sx, fd_sy, grayFrame);
-
-			FaceDetector_initialize(&inst, fd_sx, fd_sy, MAX_FACE_DETECTED);
-			fd_nFaces[i] = FaceDetector_detect(inst, grayFrame);
-			if (fd_nFaces[i] > MAX_FACE_DETECTED)
-				fd_nFaces[i] = MAX_FACE_DETECTED;
-			for (int f=0; f<fd_nFaces[i]; ++f)
-				FaceDetector_get_face(inst, &fd_confid[i][f], &fd_midx[i][f], &fd_midy[i][f], &fd_eyedist[i][f]);
-			FaceDetector_destroy(inst);
-
-			free(grayFrame);
+			FaceDetector_setTracking(inst, FD_TRACK_INTERVAL);
+			for (i=0; i<nFrames; ++i)
+				DetectFaces(inst, grayFrame, i, sx, sy, fd_sx, fd_sy, rotationDegree);
 		}
+
+		free(grayFrame);
+		FaceDetector_release(inst);
 	}
 
-	env->ReleaseIntArrayElements(in, (jint*)yuv, JNI_ABORT);
-	env->ReleaseIntArrayElements(in_len, (jint*)yuv_length, JNI_ABORT);
+	// frames are rotated when transformed, width and height are not tracked for them
+	for (i=0; i<nFrames; ++i)
+		inputHandle[i] = FrameHandle_Wrap(inputFrame[i], inputFrameSize, FRAME_FORMAT_NV21, 0, 0, 0);
 
 	LOGD("frames total: %d\n", (int)nFrames);
 	return isFoundinInput;
@@ -261,21 +308,24 @@ extern "C" JNIEXPORT jint JNICALL Java_com_almalence_plugins_processing_groupsho
 }
 
 
-extern "C" JNIEXPORT jint JNICALL Java_com_almalence_plugins_processing_groupshot_AlmaShotGroupShot_getInputFrame
+extern "C" JNIEXPORT jlong JNICALL Java_com_almalence_plugins_processing_groupshot_AlmaShotGroupShot_getInputFrame
 (
 	JNIEnv* env,
 	jobject thiz,
 	jint index
 )
 {
-	return (jint)inputFrame[index];
+	if ((index < 0) || (index >= MAX_GS_FRAMES))
+		return 0;
+
+	return inputHandle[index];
 }
 
 extern "C" JNIEXPORT jintArray JNICALL Java_com_almalence_plugins_processing_groupshot_AlmaShotGroupShot_NV21toARGB
 (
 	JNIEnv* env,
 	jobject thiz,
-	jint inptr,
+	jlong inptr,
 	jint width,
 	jint height,
 	jobject rect,
@@ -298,7 +348,11 @@ extern "C" JNIEXPORT jintArray JNICALL Java_com_almalence_plugins_processing_gro
 	jfieldID id_bottom = env->GetFieldID(class_rect, "bottom", "I");
 	jint bottom = env->GetIntField(rect,id_bottom);
 
-	LOGD("inptr = %d srwW = %d srcH = %d ", inptr, width,
+	Uint8 *in = (Uint8 *)FrameHandle_Data(inptr, width*height+width*((height+1)/2));
+	if (in == NULL)
+		return NULL;
+
+	LOGD("inptr = %llx srwW = %d srcH = %d ", (long long)inptr, width,
 		height);
 	LOGD("left = %d top = %d right = %d bottom = %d ", left, top,
 		right, bottom);
@@ -309,7 +363,7 @@ extern "C" JNIEXPORT jintArray JNICALL Java_com_almalence_plugins_processing_gro
 		"Memory alloc size = %d * %d", dstWidth, dstHeight);
 	pixels = (Uint32 *)env->GetIntArrayElements(jpixels, NULL);
 
-	NV21_to_RGB_scaled((Uint8 *)inptr, width, height, left, top, right - left, bottom - top, dstWidth, dstHeight, 4, (Uint8 *)pixels);
+	NV21_to_RGB_scaled(in, width, height, left, top, right - left, bottom - top, dstWidth, dstHeight, 4, (Uint8 *)pixels);
 
 	env->ReleaseIntArrayElements(jpixels, (jint*)pixels, 0);
 
@@ -375,7 +429,7 @@ extern "C" JNIEXPORT void JNICALL Java_com_almalence_plugins_processing_groupsho
 
 	layout = (Uint8 *)env->GetByteArrayElements(jlayout, NULL);
 
-	outBuffer = (Uint8 *)malloc(inWidth * inHeight * 3 / 2);
+	outBuffer = (Uint8 *)FramePool_Alloc(inWidth * inHeight * 3 / 2);
 	LOGD("alloc %d byte yvu memory", inWidth * inHeight * 3 / 2);
 	LOGD("base frame = %d", baseFrame);
 
@@ -391,14 +445,14 @@ extern "C" JNIEXPORT void JNICALL Java_com_almalence_plugins_processing_groupsho
 
 	Uint32 * pixels = (Uint32 *)env->GetIntArrayElements(jpixels, NULL);;
 	NV21_to_RGB_scaled(outBuffer, inWidth, inHeight, 0, 0, inWidth, inHeight, outWidth, outHeight, 4, (Uint8 *)pixels);
-	free(outBuffer);
+	FramePool_Free(outBuffer);
 
 	env->ReleaseIntArrayElements(jpixels, (jint*)pixels, 0);
 
 	LOGD("Preview - end");
 }
 
-extern "C" JNIEXPORT jint JNICALL Java_com_almalence_plugins_processing_groupshot_AlmaShotGroupShot_RealView
+extern "C" JNIEXPORT jlong JNICALL Java_com_almalence_plugins_processing_groupshot_AlmaShotGroupShot_RealView
 (
 	JNIEnv* env,
 	jobject thiz,
@@ -415,7 +469,7 @@ int *crop;
 
 LOGE("alloc %d byte yvu memory", width * height * 3 / 2);
 
-Uint8 *outBuffer = (Uint8 *)malloc(width * height * 3 / 2);
+Uint8 *outBuffer = (Uint8 *)FramePool_Alloc(width * height * 3 / 2);
 
 crop = (int*)env->GetIntArrayElements(jcrop, NULL);
 layout = (Uint8 *)env->GetByteArrayElements(jlayout, NULL);
@@ -439,5 +493,5 @@ env->ReleaseIntArrayElements(jcrop, (jint*)crop, 0);
 env->ReleaseByteArrayElements(jlayout, (jbyte*)layout, JNI_ABORT);
 
 LOGD("RealView - end");
-return (jint)outBuffer;
+return FrameHandle_Create(outBuffer, width * height * 3 / 2, FRAME_FORMAT_NV21, width, height, width, NULL);
 }
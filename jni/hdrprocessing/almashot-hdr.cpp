@@ -26,6 +26,8 @@ by Almalence Inc. All Rights Reserved.
 #include <android/log.h>
 
 #include "ImageConversionUtils.h"
+#include "FrameHandle.h"
+#include "FramePool.h"
 
 #include "almashot.h"
 #include "hdr.h"
@@ -100,7 +102,7 @@ extern "C" JNIEXPORT jstring JNICALL Java_com_almalence_plugins_processing_hdr_A
 (
 	JNIEnv* env,
 	jobject thiz,
-	jintArray in,
+	jlongArray in,
 	jintArray in_len,
 	jint nFrames,
 	jint sx,
@@ -109,19 +111,28 @@ extern "C" JNIEXPORT jstring JNICALL Java_com_almalence_plugins_processing_hdr_A
 {
 	int i;
 	int *jpeg_length;
-	unsigned char * *jpeg;
+	jlong *handles;
+	unsigned char *jpeg[MAX_HDR_FRAMES];
 	char status[1024];
 
 	Uint8 *inp[4];
 	int x, y;
 	int x0_out, y0_out, w_out, h_out;
 
-	jpeg = (unsigned char**)env->GetIntArrayElements(in, NULL);
+	if (nFrames > MAX_HDR_FRAMES)
+		nFrames = MAX_HDR_FRAMES;
+
+	handles = env->GetLongArrayElements(in, NULL);
 	jpeg_length = (int*)env->GetIntArrayElements(in_len, NULL);
 
-	DecodeAndRotateMultipleJpegs(yuv, jpeg, jpeg_length, sx, sy, nFrames, 0, 0, 0, true);
+	for (i=0; i<nFrames; ++i)
+		if ((jpeg[i] = (unsigned char*)FrameHandle_Data(handles[i], jpeg_length[i])) == NULL)
+			break;
+
+	if (i == nFrames)
+		DecodeAndRotateMultipleJpegs(yuv, jpeg, jpeg_length, sx, sy, nFrames, 0, 0, 0, true);
 
-	env->ReleaseIntArrayElements(in, (jint*)jpeg, JNI_ABORT);
+	env->ReleaseLongArrayElements(in, handles, JNI_ABORT);
 	env->ReleaseIntArrayElements(in_len, (jint*)jpeg_length, JNI_ABORT);
 
 	//sprintf (status, "frames total: %d\nsize0: %d\nsize1: %d\nsize2: %d\n", (int)nFrames, jpeg_length[0], jpeg_length[1], jpeg_length[2]);
@@ -134,21 +145,24 @@ extern "C" JNIEXPORT jstring JNICALL Java_com_almalence_plugins_processing_hdr_A
 (
 	JNIEnv* env,
 	jobject thiz,
-	jintArray in,
+	jlongArray in,
 	jint nFrames,
 	jint sx,
 	jint sy
 )
 {
 	int i;
-	unsigned char * *yuvIn;
+	jlong *yuvIn;
 	char status[1024];
 
 //	Uint8 *inp[4];
 //	int x, y;
 //	int x0_out, y0_out, w_out, h_out;
 
-	yuvIn = (unsigned char**)env->GetIntArrayElements(in, NULL);
+	if (nFrames > MAX_HDR_FRAMES)
+		nFrames = MAX_HDR_FRAMES;
+
+	yuvIn = env->GetLongArrayElements(in, NULL);
 
 //	__android_log_print(ANDROID_LOG_ERROR, "CameraTest", "START INPUT SAVE");
 //	for (int i=0; i<nFrames; ++i)
@@ -180,10 +194,11 @@ extern "C" JNIEXPORT jstring JNICALL Java_com_almalence_plugins_processing_hdr_A
 //		yuv[i] = yuvIn[i];
 //	}
 
+	// frames are freed by the library, take them over from the registry
 	for (i=0; i<nFrames; ++i)
-			yuv[i] = yuvIn[i];
+		yuv[i] = (unsigned char*)FrameHandle_Detach(yuvIn[i], NULL);
 
-	env->ReleaseIntArrayElements(in, (jint*)yuvIn, JNI_ABORT);
+	env->ReleaseLongArrayElements(in, yuvIn, JNI_ABORT);
 
 	//sprintf (status, "frames total: %d\nsize0: %d\nsize1: %d\nsize2: %d\n", (int)nFrames, jpeg_length[0], jpeg_length[1], jpeg_length[2]);
 	sprintf (status, "frames total: %d\n", (int)nFrames);
@@ -475,13 +490,13 @@ extern "C" JNIEXPORT jbyteArray JNICALL Java_com_almalence_plugins_processing_hd
 	if (OutPic)
 	{
 		//__android_log_print(ANDROID_LOG_INFO, "HDR", "OutPic is not NULL, freeing");
-		free(OutPic);
+		FramePool_Free(OutPic);
 		//__android_log_print(ANDROID_LOG_INFO, "HDR", "OutPic successfuly freed");
 	}
 
 	allocSize = sx*sy+(sx+1)*(sy+1)/2;
 
-	OutPic = (Uint8 *)malloc(allocSize);
+	OutPic = (Uint8 *)FramePool_Alloc(allocSize);
 
 	crop = (int*)env->GetIntArrayElements(jcrop, NULL);
 
@@ -498,13 +513,13 @@ extern "C" JNIEXPORT jbyteArray JNICALL Java_com_almalence_plugins_processing_hd
 
 	OutNV21 = OutPic;
 	if (rotate90)
-		OutNV21 = (Uint8 *)malloc(allocSize);
+		OutNV21 = (Uint8 *)FramePool_Alloc(allocSize);
 
 	TransformNV21(OutPic, OutNV21, sx, sy, crop, flipLeftRight, flipUpDown, rotate90);
 
 	if (rotate90)
 	{
-		free(OutPic);
+		FramePool_Free(OutPic);
 		OutPic = OutNV21;
 	}
 
@@ -536,7 +551,7 @@ extern "C" JNIEXPORT jint JNICALL Java_com_almalence_plugins_processing_hdr_Alma
 	if (OutPic)
 	{
 		//__android_log_print(ANDROID_LOG_INFO, "HDR", "OutPic is not NULL, calling free()");
-		free(OutPic);
+		FramePool_Free(OutPic);
 		//__android_log_print(ANDROID_LOG_INFO, "HDR", "free() returned");
 		
 		OutPic = NULL;
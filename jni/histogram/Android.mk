@@ -4,6 +4,7 @@ include $(LOCAL_PATH)/../Flags.mk
 
 LOCAL_MODULE    := histogram
 LOCAL_SRC_FILES := histogram.cpp
+LOCAL_STATIC_LIBRARIES := utils-image gomp
 LOCAL_LDLIBS := -ldl -llog
 
 include $(BUILD_SHARED_LIBRARY)
@@ -17,97 +17,374 @@ by Almalence Inc. All Rights Reserved.
 */
 
 #include <stdio.h>
+#include <stdlib.h>
 #include <string.h>
 #include <jni.h>
 #include <android/log.h>
+#include <omp.h>
 
-#define	CLIP8(x)			( (x)<0 ? 0 : (x)>255 ? 255 : (x) )
-#define CSC_R(Y,V)			CLIP8((128*(Y)+176*((V)-128)) >> 7 )
-#define CSC_B(Y,U)			CLIP8((128*(Y)+222*((U)-128)) >> 7 )
-#define CSC_G(Y,U,V)		CLIP8((128*(Y)-89*((V)-128)-43*((U)-128)) >> 7 )
+#if defined(__ARM_NEON__) || defined(__ARM_NEON)
+#include <arm_neon.h>
+#define HIST_NEON
+#elif defined(__SSE2__)
+#include <emmintrin.h>
+#define HIST_SSE2
+#endif
 
-#define get_Ysz(in, x,y)	((in)[(x)+(y)*w])
-#define get_Usz(in, x, y)	((in)[w*h+((x)|1)+((y)/2)*w])
-#define get_Vsz(in, x, y)	((in)[w*h+((x)&~1)+((y)/2)*w])
+#include "ColorConversion.h"
 
+typedef unsigned int Uint32;
+typedef unsigned short Uint16;
+typedef unsigned char Uint8;
 
-inline void makeHistogram(unsigned char *yuv420sp, int width, int height, int histHeight, int *histFacts)
+// independent histograms filled in turn, so that runs of equal values
+// do not wait for the previous increment of the same counter to be stored
+#define HIST_PARTIALS			4
+
+// Every pixel is counted. Frames with more pixels are split into tiles of
+// HIST_TILE_ROWS rows, histogrammed in parallel into per-thread tables
+#define HIST_PARALLEL_PIXELS	(128*1024)
+#define HIST_TILE_ROWS			32
+
+// RGB bin indices are prepared for this many pixels at once, then counted
+#define HIST_CHUNK				256
+
+// RGB is binned before clipping: Y + chroma offset lies within -256..511
+#define HIST_RGB_BINS			768
+#define HIST_RGB_ZERO			256
+
+
+// chroma offsets of R, G and B, see CSC_RV/CSC_GUV/CSC_BU
+static int tabRV[256], tabGU[256], tabGV[256], tabBU[256];
+static int tablesReady = 0;
+
+static void initTables()
 {
-	int i, j;
-	int maxY;
+	int i;
+
+	if (tablesReady)
+		return;
+
+	for (i = 0; i < 256; i++)
+	{
+		tabRV[i] = CSC_RV(i-128);
+		tabBU[i] = CSC_BU(i-128);
+		// G offset is shifted after summing, keep both parts unshifted
+		tabGV[i] = -89*(i-128);
+		tabGU[i] = -43*(i-128);
+	}
+
+	tablesReady = 1;
+}
 
-	memset(histFacts, 0, 256*sizeof(int));
 
-	for (i=0; i < height*width; i+=8)		// analyze one pixel out of 8 (for speed-up)
-		histFacts[yuv420sp[i]]++;
+// dst[i] += src[i]
+static void addHistogram(Uint32 *dst, const Uint32 *src, int bins)
+{
+	int i = 0;
 
-	maxY = 0;
-	for(i = 0; i < 256; i++)
-		if(histFacts[i] > maxY)
-			maxY = histFacts[i];
+#if defined(HIST_NEON)
+	for (; i+4 <= bins; i+=4)
+		vst1q_u32(dst+i, vaddq_u32(vld1q_u32(dst+i), vld1q_u32(src+i)));
+#elif defined(HIST_SSE2)
+	for (; i+4 <= bins; i+=4)
+		_mm_storeu_si128((__m128i*)(dst+i), _mm_add_epi32(_mm_loadu_si128((const __m128i*)(dst+i)), _mm_loadu_si128((const __m128i*)(src+i))));
+#endif
 
-	int maxNorm = 256 * histHeight / maxY;
-	for(i = 0; i < 256; i++)
-		histFacts[i] = (histFacts[i]*maxNorm) >> 8;
+	for (; i < bins; i++)
+		dst[i] += src[i];
 }
 
 
-inline void makeRGBHistogram(unsigned char *yuv420sp, int w, int h, int histHeight, int *histFactsR, int *histFactsG, int *histFactsB)
+// histogram of n luma values, added to hist[256]
+static void accumulateY(const Uint8 *y, int n, Uint32 *hist)
 {
-	int i, j, x, y;
-	int r,g,b;
-	int Y, U, V;
-	int maxY;
+	Uint32 part[HIST_PARTIALS][256];
+	int i = 0, k;
 
-	memset(histFactsR, 0, 256*sizeof(int));
-	memset(histFactsG, 0, 256*sizeof(int));
-	memset(histFactsB, 0, 256*sizeof(int));
+	memset(part, 0, sizeof(part));
 
-	for (y=0; y<h; y+=2)		// analyze one pixel out of 8 (for speed-up)
+	// 8 values per two word loads, their byte order does not matter for counting
+	for (; i+8 <= n; i+=8)
 	{
-		for (x=0; x<w; x+=4)
-		{
-			Y = get_Ysz(yuv420sp, x, y);
-			U = get_Usz(yuv420sp, x, y);
-			V = get_Vsz(yuv420sp, x, y);
+		Uint32 w0, w1;
+
+		memcpy(&w0, y+i, 4);
+		memcpy(&w1, y+i+4, 4);
+
+		++part[0][w0 & 0xff];
+		++part[1][(w0 >> 8) & 0xff];
+		++part[2][(w0 >> 16) & 0xff];
+		++part[3][w0 >> 24];
+		++part[0][w1 & 0xff];
+		++part[1][(w1 >> 8) & 0xff];
+		++part[2][(w1 >> 16) & 0xff];
+		++part[3][w1 >> 24];
+	}
+
+	for (; i < n; i++)
+		++part[0][y[i]];
+
+	for (k = 0; k < HIST_PARTIALS; k++)
+		addHistogram(hist, part[k], 256);
+}
+
 
-			r = CSC_R(Y, V);
-			g = CSC_G(Y, U, V);
-			b = CSC_B(Y, U);
+// unclipped R, G and B bin indices of n pixels of a luma row ya, with the
+// chroma row vu (V, U pairs) of that row; n even
+static void prepareRGB(const Uint8 *ya, const Uint8 *vu, int n, Uint16 *ir, Uint16 *ig, Uint16 *ib)
+{
+	int x = 0;
 
-			histFactsR[r]++;
-			histFactsG[g]++;
-			histFactsB[b]++;
+	// chroma offsets of 8 pixel pairs at once, each used by both pixels of its pair
+#if defined(HIST_NEON)
+	const int16x8_t zero = vdupq_n_s16(HIST_RGB_ZERO);
+
+	for (; x+16 <= n; x+=16)
+	{
+		uint8x8x2_t c = vld2_u8(vu+x);
+		uint8x16_t yv = vld1q_u8(ya+x);
+		int16x8_t v = vreinterpretq_s16_u16(vsubl_u8(c.val[0], vdup_n_u8(128)));
+		int16x8_t u = vreinterpretq_s16_u16(vsubl_u8(c.val[1], vdup_n_u8(128)));
+		int16x8_t y0 = vaddq_s16(vreinterpretq_s16_u16(vmovl_u8(vget_low_u8(yv))), zero);
+		int16x8_t y1 = vaddq_s16(vreinterpretq_s16_u16(vmovl_u8(vget_high_u8(yv))), zero);
+		int16x8_t ro = vshrq_n_s16(vmulq_n_s16(v, 176), 7);
+		int16x8_t go = vshrq_n_s16(vmlaq_n_s16(vmulq_n_s16(v, -89), u, -43), 7);
+		int16x8_t bo = vshrq_n_s16(vmulq_n_s16(u, 222), 7);
+		int16x8x2_t r = vzipq_s16(ro, ro);
+		int16x8x2_t g = vzipq_s16(go, go);
+		int16x8x2_t b = vzipq_s16(bo, bo);
+
+		vst1q_u16(ir+x, vreinterpretq_u16_s16(vaddq_s16(y0, r.val[0])));
+		vst1q_u16(ir+x+8, vreinterpretq_u16_s16(vaddq_s16(y1, r.val[1])));
+		vst1q_u16(ig+x, vreinterpretq_u16_s16(vaddq_s16(y0, g.val[0])));
+		vst1q_u16(ig+x+8, vreinterpretq_u16_s16(vaddq_s16(y1, g.val[1])));
+		vst1q_u16(ib+x, vreinterpretq_u16_s16(vaddq_s16(y0, b.val[0])));
+		vst1q_u16(ib+x+8, vreinterpretq_u16_s16(vaddq_s16(y1, b.val[1])));
+	}
+#elif defined(HIST_SSE2)
+	const __m128i mask = _mm_set1_epi16(0xff);
+	const __m128i half = _mm_set1_epi16(128);
+	const __m128i zero = _mm_set1_epi16(HIST_RGB_ZERO);
+
+	for (; x+16 <= n; x+=16)
+	{
+		__m128i c = _mm_loadu_si128((const __m128i*)(vu+x));
+		__m128i yv = _mm_loadu_si128((const __m128i*)(ya+x));
+		__m128i v = _mm_sub_epi16(_mm_and_si128(c, mask), half);
+		__m128i u = _mm_sub_epi16(_mm_srli_epi16(c, 8), half);
+		__m128i y0 = _mm_add_epi16(_mm_unpacklo_epi8(yv, _mm_setzero_si128()), zero);
+		__m128i y1 = _mm_add_epi16(_mm_unpackhi_epi8(yv, _mm_setzero_si128()), zero);
+		__m128i r = _mm_srai_epi16(_mm_mullo_epi16(v, _mm_set1_epi16(176)), 7);
+		__m128i g = _mm_srai_epi16(_mm_add_epi16(_mm_mullo_epi16(v, _mm_set1_epi16(-89)), _mm_mullo_epi16(u, _mm_set1_epi16(-43))), 7);
+		__m128i b = _mm_srai_epi16(_mm_mullo_epi16(u, _mm_set1_epi16(222)), 7);
+
+		_mm_storeu_si128((__m128i*)(ir+x), _mm_add_epi16(y0, _mm_unpacklo_epi16(r, r)));
+		_mm_storeu_si128((__m128i*)(ir+x+8), _mm_add_epi16(y1, _mm_unpackhi_epi16(r, r)));
+		_mm_storeu_si128((__m128i*)(ig+x), _mm_add_epi16(y0, _mm_unpacklo_epi16(g, g)));
+		_mm_storeu_si128((__m128i*)(ig+x+8), _mm_add_epi16(y1, _mm_unpackhi_epi16(g, g)));
+		_mm_storeu_si128((__m128i*)(ib+x), _mm_add_epi16(y0, _mm_unpacklo_epi16(b, b)));
+		_mm_storeu_si128((__m128i*)(ib+x+8), _mm_add_epi16(y1, _mm_unpackhi_epi16(b, b)));
+	}
+#endif
+
+	for (; x < n; x+=2)
+	{
+		int V = vu[x];
+		int U = vu[x+1];
+		int r = HIST_RGB_ZERO + tabRV[V];
+		int g = HIST_RGB_ZERO + ((tabGV[V] + tabGU[U]) >> 7);
+		int b = HIST_RGB_ZERO + tabBU[U];
+
+		ir[x] = ya[x] + r;
+		ig[x] = ya[x] + g;
+		ib[x] = ya[x] + b;
+		ir[x+1] = ya[x+1] + r;
+		ig[x+1] = ya[x+1] + g;
+		ib[x+1] = ya[x+1] + b;
+	}
+}
+
+
+// unclipped R, G, B histograms (3 x HIST_RGB_BINS) of luma rows y0..y1-1
+// (y0 even), added to hist
+//
+// The chroma sample gives the R, G and B offsets of the pixel, so the
+// per-pixel work is an add and an increment - no colour conversion.
+static void accumulateRGB(const Uint8 *yuv, int w, int h, int y0, int y1, Uint32 *hist)
+{
+	// alternate pixels go to separate partial histograms
+	Uint32 part[2][3*HIST_RGB_BINS];
+	Uint32 *r0 = part[0], *g0 = part[0]+HIST_RGB_BINS, *b0 = part[0]+2*HIST_RGB_BINS;
+	Uint32 *r1 = part[1], *g1 = part[1]+HIST_RGB_BINS, *b1 = part[1]+2*HIST_RGB_BINS;
+	Uint16 ir[HIST_CHUNK], ig[HIST_CHUNK], ib[HIST_CHUNK];
+	int y, x, k, n;
+
+	memset(part, 0, sizeof(part));
+
+	for (y = y0; y < y1; y++)
+	{
+		const Uint8 *vu = yuv + w*h + (y/2)*w;
+		const Uint8 *ya = yuv + y*w;
+
+		for (x = 0; x < w; x+=HIST_CHUNK)
+		{
+			n = w-x < HIST_CHUNK ? w-x : HIST_CHUNK;
+			prepareRGB(ya+x, vu+x, n, ir, ig, ib);
+
+			for (k = 0; k+2 <= n; k+=2)
+			{
+				++r0[ir[k]];
+				++g0[ig[k]];
+				++b0[ib[k]];
+				++r1[ir[k+1]];
+				++g1[ig[k+1]];
+				++b1[ib[k+1]];
+			}
 		}
 	}
 
-	maxY = 0;
-	for(i = 0; i < 256; i++)
+	addHistogram(hist, part[0], 3*HIST_RGB_BINS);
+	addHistogram(hist, part[1], 3*HIST_RGB_BINS);
+}
+
+
+// fold the out-of-range bins of an unclipped histogram into 0 and 255
+static void clipHistogram(const Uint32 *unclipped, Uint32 *hist)
+{
+	int i;
+
+	memcpy(hist, unclipped + HIST_RGB_ZERO, 256*sizeof(Uint32));
+	for (i = 0; i < HIST_RGB_ZERO; i++)
+		hist[0] += unclipped[i];
+	for (i = HIST_RGB_ZERO+256; i < HIST_RGB_BINS; i++)
+		hist[255] += unclipped[i];
+}
+
+
+static int useParallel(int pixels)
+{
+	return (pixels >= HIST_PARALLEL_PIXELS) && (omp_get_num_procs() > 1);
+}
+
+
+// scale histograms so that the highest bin of all of them is histHeight
+static void normalizeHistograms(Uint32 **hist, int **facts, int n, int histHeight)
+{
+	Uint32 maxY = 0;
+	int i, k;
+
+	for (k = 0; k < n; k++)
+		for (i = 0; i < 256; i++)
+			if (hist[k][i] > maxY)
+				maxY = hist[k][i];
+
+	for (k = 0; k < n; k++)
+		for (i = 0; i < 256; i++)
+			facts[k][i] = maxY ? (int)((long long)hist[k][i] * histHeight / maxY) : 0;
+}
+
+
+// luma histogram of the frame
+inline void makeHistogram(unsigned char *yuv420sp, int width, int height, int histHeight, int *histFacts)
+{
+	Uint32 hist[256];
+	Uint32 *h = hist;
+
+	memset(hist, 0, sizeof(hist));
+
+	if (useParallel(width*height))
 	{
-		if(histFactsR[i] > maxY) maxY = histFactsR[i];
-		if(histFactsG[i] > maxY) maxY = histFactsG[i];
-		if(histFactsB[i] > maxY) maxY = histFactsB[i];
+		int tiles = (height + HIST_TILE_ROWS - 1) / HIST_TILE_ROWS;
+
+		#pragma omp parallel
+		{
+			Uint32 local[256];
+			int t;
+
+			memset(local, 0, sizeof(local));
+
+			#pragma omp for schedule(dynamic)
+			for (t = 0; t < tiles; t++)
+			{
+				int y0 = t*HIST_TILE_ROWS;
+				int y1 = y0+HIST_TILE_ROWS < height ? y0+HIST_TILE_ROWS : height;
+				accumulateY(yuv420sp + y0*width, (y1-y0)*width, local);
+			}
+
+			#pragma omp critical
+			addHistogram(hist, local, 256);
+		}
 	}
+	else
+		accumulateY(yuv420sp, width*height, hist);
+
+	normalizeHistograms(&h, &histFacts, 1, histHeight);
+}
 
-	int maxNorm = 256 * histHeight / maxY;
-	for(i = 0; i < 256; i++)
+
+// R, G and B histograms of the frame, derived from YUV tables
+inline void makeRGBHistogram(unsigned char *yuv420sp, int w, int h, int histHeight, int *histFactsR, int *histFactsG, int *histFactsB)
+{
+	Uint32 unclipped[3*HIST_RGB_BINS];
+	Uint32 hist[3][256];
+	Uint32 *hists[3] = {hist[0], hist[1], hist[2]};
+	int *facts[3] = {histFactsR, histFactsG, histFactsB};
+	int k;
+
+	initTables();
+	memset(unclipped, 0, sizeof(unclipped));
+
+	if (useParallel(w*h))
 	{
-		histFactsR[i] = (histFactsR[i]*maxNorm) >> 8;
-		histFactsG[i] = (histFactsG[i]*maxNorm) >> 8;
-		histFactsB[i] = (histFactsB[i]*maxNorm) >> 8;
+		int tiles = (h + HIST_TILE_ROWS - 1) / HIST_TILE_ROWS;
+
+		#pragma omp parallel
+		{
+			Uint32 local[3*HIST_RGB_BINS];
+			int t;
+
+			memset(local, 0, sizeof(local));
+
+			// tiles start on even rows, the first row of a chroma row
+			#pragma omp for schedule(dynamic)
+			for (t = 0; t < tiles; t++)
+			{
+				int y0 = t*HIST_TILE_ROWS;
+				int y1 = y0+HIST_TILE_ROWS < h ? y0+HIST_TILE_ROWS : h;
+				accumulateRGB(yuv420sp, w, h, y0, y1, local);
+			}
+
+			#pragma omp critical
+			addHistogram(unclipped, local, 3*HIST_RGB_BINS);
+		}
 	}
+	else
+		accumulateRGB(yuv420sp, w, h, 0, h, unclipped);
+
+	for (k = 0; k < 3; k++)
+		clipHistogram(unclipped + k*HIST_RGB_BINS, hist[k]);
+
+	normalizeHistograms(hists, facts, 3, histHeight);
 }
 
 
+// Preview frames are only read here: image arrays are pinned with
+// GetPrimitiveArrayCritical and released with JNI_ABORT, so no frame copy is
+// made in either direction. No JNI calls are allowed while the frame is pinned,
+// so the output arrays are acquired before and released after it.
 extern "C" JNIEXPORT void JNICALL Java_com_almalence_plugins_vf_histogram_Histogram_createHistogram(
 		JNIEnv *env, jclass clazz, jbyteArray ain, jintArray afacts, jint width,	jint height, jint histWidth, jint histHeight)
 {
-	jbyte *cImageIn = env->GetByteArrayElements(ain, 0);
 	jint *cFacts = env->GetIntArrayElements(afacts, 0);
+	jbyte *cImageIn = (jbyte*)env->GetPrimitiveArrayCritical(ain, 0);
 
-	makeHistogram((unsigned char*)cImageIn, width, height, histHeight, cFacts);
+	if (cImageIn != NULL)
+	{
+		makeHistogram((unsigned char*)cImageIn, width, height, histHeight, cFacts);
+		env->ReleasePrimitiveArrayCritical(ain, cImageIn, JNI_ABORT);
+	}
 
-	env->ReleaseByteArrayElements(ain, cImageIn, 0);
 	env->ReleaseIntArrayElements(afacts, cFacts, 0);
 }
 
@@ -115,14 +392,17 @@ extern "C" JNIEXPORT void JNICALL Java_com_almalence_plugins_vf_histogram_Histog
 extern "C" JNIEXPORT void JNICALL Java_com_almalence_plugins_vf_histogram_Histogram_createRGBHistogram(
 		JNIEnv *env, jclass clazz, jbyteArray ain, jintArray afactsR, jintArray afactsG, jintArray afactsB, jint width, jint height, jint histWidth, jint histHeight)
 {
-	jbyte *cImageIn = env->GetByteArrayElements(ain, 0);
 	jint *cFactsR = env->GetIntArrayElements(afactsR, 0);
 	jint *cFactsG = env->GetIntArrayElements(afactsG, 0);
 	jint *cFactsB = env->GetIntArrayElements(afactsB, 0);
+	jbyte *cImageIn = (jbyte*)env->GetPrimitiveArrayCritical(ain, 0);
 
-	makeRGBHistogram((unsigned char*)cImageIn, width, height, histHeight, cFactsR, cFactsG, cFactsB);
+	if (cImageIn != NULL)
+	{
+		makeRGBHistogram((unsigned char*)cImageIn, width, height, histHeight, cFactsR, cFactsG, cFactsB);
+		env->ReleasePrimitiveArrayCritical(ain, cImageIn, JNI_ABORT);
+	}
 
-	env->ReleaseByteArrayElements(ain, cImageIn, 0);
 	env->ReleaseIntArrayElements(afactsR, cFactsR, 0);
 	env->ReleaseIntArrayElements(afactsG, cFactsG, 0);
 	env->ReleaseIntArrayElements(afactsB, cFactsB, 0);
@@ -25,6 +25,8 @@ by Almalence Inc. All Rights Reserved.
 #include "movobj.h"
 
 #include "ImageConversionUtils.h"
+#include "FrameHandle.h"
+#include "FramePool.h"
 
 #ifdef LOG_ON
 #define LOG_TAG "MovingObjects"
@@ -49,6 +51,8 @@ void __attribute__((destructor)) release_openmp() {}
 
 
 static unsigned char *inputFrame[MAX_MOV_FRAMES] = {NULL, NULL, NULL, NULL, NULL, NULL, NULL, NULL, NULL, NULL};
+// input frames as seen from java, owned by this module
+static FrameHandle inputHandle[MAX_MOV_FRAMES] = {0};
 static void *instance = NULL;
 static int almashot_inited = 0;
 static Uint8 *OutPic = NULL;
@@ -86,9 +90,14 @@ extern "C" JNIEXPORT jint JNICALL Java_com_almalence_plugins_processing_multisho
 {
 	int i;
 
+	if (nFrames > MAX_MOV_FRAMES)
+		nFrames = MAX_MOV_FRAMES;
+
 	for (int i=0; i<nFrames; ++i)
 	{
-		free(inputFrame[i]);
+		FrameHandle_Release(inputHandle[i]);
+		inputHandle[i] = 0;
+		FramePool_Free(inputFrame[i]);
 		inputFrame[i] = NULL;
 	}
 
@@ -107,23 +116,38 @@ extern "C" JNIEXPORT jint JNICALL Java_com_almalence_plugins_processing_multisho
 (
 	JNIEnv* env,
 	jobject thiz,
-	jintArray in,
+	jlongArray in,
 	jintArray in_len,
 	jint nFrames,
 	jint sx,
 	jint sy
 )
 {
+	int i;
 	int *jpeg_length;
-	unsigned char * *jpeg;
-	int isFoundinInput;
+	jlong *handles;
+	unsigned char *jpeg[MAX_MOV_FRAMES];
+	int isFoundinInput = -1;
 
-	jpeg = (unsigned char**)env->GetIntArrayElements(in, NULL);
+	if (nFrames > MAX_MOV_FRAMES)
+		nFrames = MAX_MOV_FRAMES;
+
+	handles = env->GetLongArrayElements(in, NULL);
 	jpeg_length = (int*)env->GetIntArrayElements(in_len, NULL);
 
-	isFoundinInput = DecodeAndRotateMultipleJpegs(inputFrame, jpeg, jpeg_length, sx, sy, nFrames, 0, 0, 0, true);
+	for (i=0; i<nFrames; ++i)
+		if ((jpeg[i] = (unsigned char*)FrameHandle_Data(handles[i], jpeg_length[i])) == NULL)
+			break;
 
-	env->ReleaseIntArrayElements(in, (jint*)jpeg, JNI_ABORT);
+	if (i == nFrames)
+	{
+		isFoundinInput = DecodeAndRotateMultipleJpegs(inputFrame, jpeg, jpeg_length, sx, sy, nFrames, 0, 0, 0, true);
+
+		for (i=0; i<nFrames; ++i)
+			inputHandle[i] = FrameHandle_Wrap(inputFrame[i], sx*sy+2*((sx+1)/2)*((sy+1)/2), FRAME_FORMAT_NV21, sx, sy, sx);
+	}
+
+	env->ReleaseLongArrayElements(in, handles, JNI_ABORT);
 	env->ReleaseIntArrayElements(in_len, (jint*)jpeg_length, JNI_ABORT);
 
 	return isFoundinInput;
@@ -134,7 +158,7 @@ extern "C" JNIEXPORT jint JNICALL Java_com_almalence_plugins_processing_multisho
 (
 	JNIEnv* env,
 	jobject thiz,
-	jintArray in,
+	jlongArray in,
 	jintArray in_len,
 	jint nFrames,
 	jint sx,
@@ -142,16 +166,26 @@ extern "C" JNIEXPORT jint JNICALL Java_com_almalence_plugins_processing_multisho
 )
 {
 	int i;
-	unsigned char * *yuv;
+	jlong *yuv;
 	char status[1024];
 	int isFoundinInput = 255;
 
-	yuv = (unsigned char**)env->GetIntArrayElements(in, NULL);
+	if (nFrames > MAX_MOV_FRAMES)
+		nFrames = MAX_MOV_FRAMES;
+
+	yuv = env->GetLongArrayElements(in, NULL);
 
+	// frames are taken over from java and freed on Release, java only gets
+	// handles to them back from getInputFrame
 	for (i=0; i<nFrames; ++i)
-		inputFrame[i] = yuv[i];
+	{
+		inputFrame[i] = (unsigned char*)FrameHandle_Detach(yuv[i], NULL);
+		inputHandle[i] = FrameHandle_Wrap(inputFrame[i], sx*sy+2*((sx+1)/2)*((sy+1)/2), FRAME_FORMAT_NV21, sx, sy, sx);
+		if ((inputFrame[i] == NULL) && (isFoundinInput > i))
+			isFoundinInput = i;
+	}
 
-	env->ReleaseIntArrayElements(in, (jint*)yuv, JNI_ABORT);
+	env->ReleaseLongArrayElements(in, yuv, JNI_ABORT);
 
 	LOGD("frames total: %d\n", (int)nFrames);
 	return isFoundinInput;
@@ -162,7 +196,7 @@ extern "C" JNIEXPORT jintArray JNICALL Java_com_almalence_plugins_processing_mul
 (
 	JNIEnv* env,
 	jobject thiz,
-	jint inptr,
+	jlong inptr,
 	jobject srcSize,
 	jobject rect,
 	jobject dstSize
@@ -195,7 +229,11 @@ extern "C" JNIEXPORT jintArray JNICALL Java_com_almalence_plugins_processing_mul
 	jfieldID id_dstH = env->GetFieldID(dst_size, "height", "I");
 	jint dstH = env->GetIntField(dstSize,id_dstH);
 
-	LOGD("inptr = %d srcW = %d srcH = %d ", inptr, srcW, srcH);
+	Uint8 *in = (Uint8 *)FrameHandle_Data(inptr, srcW*srcH+srcW*((srcH+1)/2));
+	if (in == NULL)
+		return NULL;
+
+	LOGD("inptr = %llx srcW = %d srcH = %d ", (long long)inptr, srcW, srcH);
 	LOGD("left = %d top = %d right = %d bottom = %d ", left, top, right, bottom);
 	LOGD("dstW = %d dstH = %d", dstW, dstH);
 
@@ -203,7 +241,7 @@ extern "C" JNIEXPORT jintArray JNICALL Java_com_almalence_plugins_processing_mul
 	LOGD("Memory alloc size = %d * %d", dstW, dstH);
 	pixels = (Uint32 *)env->GetIntArrayElements(jpixels, NULL);
 
-	NV21_to_RGB_scaled((Uint8 *)inptr, srcW, srcH, left, top, right - left, bottom - top, dstW, dstH, 4, (Uint8 *)pixels);
+	NV21_to_RGB_scaled(in, srcW, srcH, left, top, right - left, bottom - top, dstW, dstH, 4, (Uint8 *)pixels);
 
 	env->ReleaseIntArrayElements(jpixels, (jint*)pixels, 0);
 
@@ -212,18 +250,21 @@ extern "C" JNIEXPORT jintArray JNICALL Java_com_almalence_plugins_processing_mul
 	return jpixels;
 }
 
-extern "C" JNIEXPORT jint JNICALL Java_com_almalence_plugins_processing_multishot_AlmaCLRShot_getInputFrame
+extern "C" JNIEXPORT jlong JNICALL Java_com_almalence_plugins_processing_multishot_AlmaCLRShot_getInputFrame
 (
 	JNIEnv* env,
 	jobject thiz,
 	jint index
 )
 {
-	return (jint)inputFrame[index];
+	if ((index < 0) || (index >= MAX_MOV_FRAMES))
+		return 0;
+
+	return inputHandle[index];
 }
 
 
-extern "C" JNIEXPORT jint JNICALL Java_com_almalence_plugins_processing_multishot_AlmaCLRShot_MovObjProcess
+extern "C" JNIEXPORT jlong JNICALL Java_com_almalence_plugins_processing_multishot_AlmaCLRShot_MovObjProcess
 (
 	JNIEnv* env,
 	jobject thiz,
@@ -254,7 +295,7 @@ extern "C" JNIEXPORT jint JNICALL Java_com_almalence_plugins_processing_multisho
 	jfieldID id_srcH = env->GetFieldID(src_size, "height", "I");
 	jint sy = env->GetIntField(size,id_srcH);
 
-	OutPic = (Uint8 *)malloc(sx*sy+2*((sx+1)/2)*((sy+1)/2));
+	OutPic = (Uint8 *)FramePool_Alloc(sx*sy+2*((sx+1)/2)*((sy+1)/2));
 
 	crop = (int*)env->GetIntArrayElements(jcrop, NULL);
 
@@ -322,7 +363,8 @@ extern "C" JNIEXPORT jint JNICALL Java_com_almalence_plugins_processing_multisho
 
 	LOGE("MovObjProcess - end");
 
-	return (jint)OutPic;
+	// result is handed over to java
+	return FrameHandle_Create(OutPic, sx*sy+2*((sx+1)/2)*((sy+1)/2), FRAME_FORMAT_NV21, sx, sy, sx, NULL);
 }
 
 extern "C" JNIEXPORT jint JNICALL Java_com_almalence_plugins_processing_multishot_AlmaCLRShot_MovObjFixHoles
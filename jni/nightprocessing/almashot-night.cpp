@@ -28,6 +28,8 @@ by Almalence Inc. All Rights Reserved.
 #include "superzoom.h"
 
 #include "ImageConversionUtils.h"
+#include "FrameHandle.h"
+#include "FramePool.h"
 
 // currently - no concurrent processing, using same instance for all processing types
 static unsigned char *yuv[MAX_FRAMES] = {NULL};
@@ -82,16 +84,19 @@ extern "C" JNIEXPORT void JNICALL Java_com_almalence_plugins_processing_night_Al
 (
 	JNIEnv* env,
 	jobject thiz,
-	jintArray in,
+	jlongArray in,
 	jint nFrames,
 	jint sx,
 	jint sy
 )
 {
 	int i;
-	unsigned char **yuvIn;
+	jlong *yuvIn;
 
-	yuvIn = (unsigned char**)env->GetIntArrayElements(in, NULL);
+	if (nFrames > MAX_FRAMES)
+		nFrames = MAX_FRAMES;
+
+	yuvIn = env->GetLongArrayElements(in, NULL);
 
 	/*
 	for (int i=0; i<nFrames; ++i)
@@ -104,10 +109,11 @@ extern "C" JNIEXPORT void JNICALL Java_com_almalence_plugins_processing_night_Al
 	} //*/
 
 	// pre-allocate uncompressed yuv buffers
+	// frames are freed by the library, take them over from the registry
 	for (i=0; i<nFrames; ++i)
-		yuv[i] = yuvIn[i];
+		yuv[i] = (unsigned char*)FrameHandle_Detach(yuvIn[i], NULL);
 
-	env->ReleaseIntArrayElements(in, (jint*)yuvIn, JNI_ABORT);
+	env->ReleaseLongArrayElements(in, yuvIn, JNI_ABORT);
 }
 
 
@@ -115,7 +121,7 @@ extern "C" JNIEXPORT jboolean JNICALL Java_com_almalence_plugins_processing_nigh
 (
 	JNIEnv* env,
 	jobject thiz,
-	jint in,
+	jlong in,
 	jint sx,
 	jint sy,
 	jint x0,
@@ -124,13 +130,16 @@ extern "C" JNIEXPORT jboolean JNICALL Java_com_almalence_plugins_processing_nigh
 	jint h
 )
 {
-	Uint8 *yuv = (Uint8 *)in;
+	Uint8 *yuv = (Uint8 *)FrameHandle_Data(in, sx*sy);
+
+	if (yuv == NULL)
+		return false;
 
 	return Super_ExposureVerification(yuv, sx, sy, x0, y0, w, h);
 }
 
 
-extern "C" JNIEXPORT jint JNICALL Java_com_almalence_plugins_processing_night_AlmaShotNight_Process
+extern "C" JNIEXPORT jlong JNICALL Java_com_almalence_plugins_processing_night_AlmaShotNight_Process
 (
 	JNIEnv* env,
 	jobject thiz,
@@ -323,17 +332,21 @@ extern "C" JNIEXPORT jint JNICALL Java_com_almalence_plugins_processing_night_Al
 	// 90/270-degree rotations are out-ot-place
 	OutNV21 = OutPic;
 	if (rotate90)
-		OutNV21 = (Uint8 *)malloc(sxo*syo+2*((sxo+1)/2)*((syo+1)/2));
+		OutNV21 = (Uint8 *)FramePool_Alloc(sxo*syo+2*((sxo+1)/2)*((syo+1)/2));
 
 	TransformNV21(OutPic, OutNV21, sxo, syo, crop, flipLeftRight, flipUpDown, rotate90);
 
 	if (rotate90)
 	{
-		free(OutPic);
+		FramePool_Free(OutPic);
 		OutPic = OutNV21;
 	}
 
 	env->ReleaseIntArrayElements(jcrop, (jint*)crop, JNI_ABORT);
 
-	return (jint)OutPic;
+	// result is handed over to java
+	if (rotate90)
+		return FrameHandle_Create(OutPic, sxo*syo+2*((sxo+1)/2)*((syo+1)/2), FRAME_FORMAT_NV21, syo, sxo, syo, NULL);
+	else
+		return FrameHandle_Create(OutPic, sxo*syo+2*((sxo+1)/2)*((syo+1)/2), FRAME_FORMAT_NV21, sxo, syo, sxo, NULL);
 }
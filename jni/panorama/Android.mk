@@ -6,7 +6,7 @@ include $(LOCAL_PATH)/../Flags.mk
 
 LOCAL_MODULE    := almashot-pano
 LOCAL_SRC_FILES := almashot-pano.cpp VFGyro-jni.cpp
-LOCAL_STATIC_LIBRARIES := almalib gomp jpeg
+LOCAL_STATIC_LIBRARIES := almalib gomp jpeg utils-image
 LOCAL_LDLIBS := -ldl -lz -llog
 
 include $(BUILD_SHARED_LIBRARY)
@@ -209,30 +209,11 @@ int getTimeNsec() {
 		}
 
 
-JNIEXPORT void JNICALL Java_com_almalence_plugins_capture_panoramaaugmented_VfGyroSensor_Update
-(
-	JNIEnv* env,
-	jobject thiz,
-	jbyteArray data,
-	jlong stamp,
-	jboolean justStability
-)
+// only the luma plane of the frame is read, and only here - callers need
+// to keep the frame pinned just for the duration of this call
+static void DownsampleFrame(const Uint8 *cur_frame_in)
 {
-	int i, j, y;
-	Uint8 *cur_frame_in;
-	Uint8 *in[2];
-	Int32 dx[2]={0,0};
-	Int32 dy[2]={0,0};
-	Int32 rot[2]={0,0};
-	Int32 sharp[2]={0,0};
-	Uint32 diff;
-	__int64_t dt;
-	int prev_idx, old_base_idx;
-	Int32 best_sharp;
-
-	if (!almashot_inited) return;
-
-	cur_frame_in = (unsigned char*)env->GetByteArrayElements(data, NULL);
+	int y;
 
 	//__android_log_print(ANDROID_LOG_INFO, "AlmaShot", "Update enter: %d\n", getTimeNsec());
 
@@ -262,6 +243,20 @@ JNIEXPORT void JNICALL Java_com_almalence_plugins_capture_panoramaaugmented_VfGy
 	}
 	else
 		memcpy (frame_buf[frame_idx], cur_frame_in, frame_width_ds*frame_height_ds);
+}
+
+static void UpdateFrame(jlong stamp, jboolean justStability)
+{
+	int i, j;
+	Uint8 *in[2];
+	Int32 dx[2]={0,0};
+	Int32 dy[2]={0,0};
+	Int32 rot[2]={0,0};
+	Int32 sharp[2]={0,0};
+	Uint32 diff;
+	__int64_t dt;
+	int prev_idx, old_base_idx;
+	Int32 best_sharp;
 
 	//__android_log_print(ANDROID_LOG_INFO, "AlmaShot", "Downsampling complete: %d\n", getTimeNsec());
 
@@ -431,8 +426,67 @@ JNIEXPORT void JNICALL Java_com_almalence_plugins_capture_panoramaaugmented_VfGy
 	timestamp = stamp;
 
 	//__android_log_print(ANDROID_LOG_INFO, "AlmaShot", "Update exit: %d\n", getTimeNsec());
+}
+
+
+// Preview frame is pinned without a copy (GetPrimitiveArrayCritical) and only
+// while it is being downsampled, motion estimation runs on the internal copy
+JNIEXPORT void JNICALL Java_com_almalence_plugins_capture_panoramaaugmented_VfGyroSensor_Update
+(
+	JNIEnv* env,
+	jobject thiz,
+	jbyteArray data,
+	jlong stamp,
+	jboolean justStability
+)
+{
+	Uint8 *cur_frame_in;
+
+	if (!almashot_inited) return;
+
+	cur_frame_in = (Uint8*)env->GetPrimitiveArrayCritical(data, NULL);
+	if (cur_frame_in == NULL) return;
+
+	DownsampleFrame(cur_frame_in);
+
+	env->ReleasePrimitiveArrayCritical(data, cur_frame_in, JNI_ABORT);
+
+	UpdateFrame(stamp, justStability);
+}
+
+// Update in two steps: the frame is downsampled on the caller's thread, so
+// that motion estimation can run later on another thread without keeping a
+// copy of the frame
+JNIEXPORT void JNICALL Java_com_almalence_plugins_capture_panoramaaugmented_VfGyroSensor_Downsample
+(
+	JNIEnv* env,
+	jobject thiz,
+	jbyteArray data
+)
+{
+	Uint8 *cur_frame_in;
+
+	if (!almashot_inited) return;
+
+	cur_frame_in = (Uint8*)env->GetPrimitiveArrayCritical(data, NULL);
+	if (cur_frame_in == NULL) return;
+
+	DownsampleFrame(cur_frame_in);
+
+	env->ReleasePrimitiveArrayCritical(data, cur_frame_in, JNI_ABORT);
+}
+
+JNIEXPORT void JNICALL Java_com_almalence_plugins_capture_panoramaaugmented_VfGyroSensor_UpdateDownsampled
+(
+	JNIEnv* env,
+	jobject thiz,
+	jlong stamp,
+	jboolean justStability
+)
+{
+	if (!almashot_inited) return;
 
-	env->ReleaseByteArrayElements(data, (jbyte*)cur_frame_in, JNI_ABORT);
+	UpdateFrame(stamp, justStability);
 }
 
 
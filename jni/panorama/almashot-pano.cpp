@@ -24,6 +24,9 @@ by Almalence Inc. All Rights Reserved.
 #include "almashot.h"
 #include "panorama.h"
 
+#include "FrameHandle.h"
+#include "FramePool.h"
+
 #define LOG_ON
 #ifdef LOG_ON
 #define LOG_TAG "PANO_JNI"
@@ -174,13 +177,13 @@ static int write_jpeg(void *image, void *imgUV, int stride,
 	return 1;
 }
 
-extern "C" JNIEXPORT jintArray JNICALL Java_com_almalence_plugins_processing_panorama_AlmashotPanorama_process
+extern "C" JNIEXPORT jlongArray JNICALL Java_com_almalence_plugins_processing_panorama_AlmashotPanorama_process
 (
 	JNIEnv* env,
 	jclass,
 	jint width,
 	jint height,
-	jintArray jframes,
+	jlongArray jframes,
 	jobjectArray jtrs,
 	jint cameraFOV,
 	jboolean useAll,
@@ -196,6 +199,7 @@ extern "C" JNIEXPORT jintArray JNICALL Java_com_almalence_plugins_processing_pan
 	int nFramesSelected;
 	Uint8* framesSelected[nframesCount];
 	Uint8* framesRelevant[nframesCount];
+	Uint8* frames[nframesCount];
 	int crop[4];
 	Uint8* out;
 	int out_width;
@@ -235,7 +239,30 @@ extern "C" JNIEXPORT jintArray JNICALL Java_com_almalence_plugins_processing_pan
 		}
 	}
 
-	jint* nframes = env->GetIntArrayElements(jframes, 0);
+	// library frees input frames itself with freeInput, they are taken over
+	// from the registry then
+	jlong* nframes = env->GetLongArrayElements(jframes, 0);
+
+	for (int i = 0; i < nframesCount; i++)
+	{
+		if (freeInput)
+			frames[i] = (Uint8*)FrameHandle_Detach(nframes[i], NULL);
+		else
+			frames[i] = (Uint8*)FrameHandle_Data(nframes[i], width*height*3/2);
+	}
+
+	env->ReleaseLongArrayElements(jframes, nframes, JNI_ABORT);
+
+	for (int i = 0; i < nframesCount; i++)
+	{
+		if (frames[i] == NULL)
+		{
+			if (freeInput)
+				for (int j = 0; j < nframesCount; j++)
+					FramePool_Free(frames[j]);
+			return NULL;
+		}
+	}
 
 	//__android_log_print(ANDROID_LOG_ERROR, "Almalence", "input w x h:  %d x %d",
 	//		width, height);
@@ -270,7 +297,7 @@ extern "C" JNIEXPORT jintArray JNICALL Java_com_almalence_plugins_processing_pan
 			sprintf(fn, "pano%i.yuv", i);
 			fo = fopen(path, "wb");
 			if (fo) {
-				fwrite((void*)nframes[i], 1, width*height*3/2, fo);
+				fwrite(frames[i], 1, width*height*3/2, fo);
 				fclose(fo);
 			}
 		}
@@ -278,7 +305,7 @@ extern "C" JNIEXPORT jintArray JNICALL Java_com_almalence_plugins_processing_pan
 	}
 #endif
 
-	Pano_PrepareFrames((Uint8**)nframes, width, height, nframesCount, framesSelected,
+	Pano_PrepareFrames(frames, width, height, nframesCount, framesSelected,
 			trs, framesRelevant, fx0, fy0, fsx, fsy, &nFramesSelected, &out_width, &out_height,
 			&crop[0], &crop[1], &crop[2], &crop[3], cameraFOV, 1, 1,
 			useAll, freeInput);
@@ -286,8 +313,6 @@ extern "C" JNIEXPORT jintArray JNICALL Java_com_almalence_plugins_processing_pan
 	//__android_log_print(ANDROID_LOG_ERROR, "Almalence", "panorama w x h:  %d x %d",
 	//		out_width, out_height);
 
-	env->ReleaseIntArrayElements(jframes, nframes, JNI_ABORT);
-
 	//for (int i=0; i<nframesCount; ++i)
 	//	free(framesRelevant[i]);
 
@@ -320,8 +345,8 @@ extern "C" JNIEXPORT jintArray JNICALL Java_com_almalence_plugins_processing_pan
 
 	instance = NULL;
 
-	jintArray jresult = env->NewIntArray(1 + 2 + 4 + 1 + nFramesSelected);
-	jint* nresult = env->GetIntArrayElements(jresult, 0);
+	jlongArray jresult = env->NewLongArray(1 + 2 + 4 + 1 + nFramesSelected);
+	jlong* nresult = env->GetLongArrayElements(jresult, 0);
 
 	/*
 	out = (Uint8*) malloc(16*16*3/2);
@@ -331,7 +356,8 @@ extern "C" JNIEXPORT jintArray JNICALL Java_com_almalence_plugins_processing_pan
 	//*/
 
 	int result_cursor = 0;
-	nresult[result_cursor++] = (int)out;
+	nresult[result_cursor++] = FrameHandle_Create(out, out_width*out_height+2*((out_width+1)/2)*((out_height+1)/2),
+			FRAME_FORMAT_NV21, out_width, out_height, out_width, NULL);
 	nresult[result_cursor++] = out_width;
 	nresult[result_cursor++] = out_height;
 	nresult[result_cursor++] = crop[0];
@@ -341,11 +367,16 @@ extern "C" JNIEXPORT jintArray JNICALL Java_com_almalence_plugins_processing_pan
 	nresult[result_cursor++] = nFramesSelected;
 	for (int i = 0; i < nFramesSelected; i++)
 	{
-		nresult[result_cursor++] = (int)framesSelected[i];
+		// selected frames are reported by their index in input
+		int idx = -1;
+		for (int j = 0; j < nframesCount; j++)
+			if (frames[j] == framesSelected[i])
+				idx = j;
+		nresult[result_cursor++] = idx;
 	}
 
 
-	env->ReleaseIntArrayElements(jresult, nresult, 0);
+	env->ReleaseLongArrayElements(jresult, nresult, 0);
 
 	return jresult;
 }
@@ -6,8 +6,9 @@ LOCAL_CFLAGS += -D__STDC_CONSTANT_MACROS
 
 LOCAL_ALLOW_UNDEFINED_SYMBOLS=false
 LOCAL_MODULE    := preshot
-LOCAL_SRC_FILES := preshot.cpp
-LOCAL_STATIC_LIBRARIES := utils-image
+LOCAL_SRC_FILES := preshot.cpp FrameRing.cpp FrameArena.cpp FrameCompressor.cpp ../yuvimage/YuvToJpegEncoderMT.cpp
+LOCAL_C_INCLUDES += $(LOCAL_PATH)/../yuvimage
+LOCAL_STATIC_LIBRARIES := utils-image jpeg gomp
 
 LOCAL_LDLIBS := -llog
 
@@ -0,0 +1,197 @@
+/*
+The contents of this file are subject to the Mozilla Public License
+Version 1.1 (the "License"); you may not use this file except in
+compliance with the License. You may obtain a copy of the License at
+http://www.mozilla.org/MPL/
+
+Software distributed under the License is distributed on an "AS IS"
+basis, WITHOUT WARRANTY OF ANY KIND, either express or implied. See the
+License for the specific language governing rights and limitations
+under the License.
+
+The Original Code is collection of files collectively known as Open Camera.
+
+The Initial Developer of the Original Code is Almalence Inc.
+Portions created by Initial Developer are Copyright (C) 2013
+by Almalence Inc. All Rights Reserved.
+*/
+
+#include <stdlib.h>
+#include <string.h>
+#include <pthread.h>
+
+#include "FrameArena.h"
+
+
+typedef struct
+{
+	size_t offset;
+	int length;
+	int tag;
+} ArenaRecord;
+
+struct FrameArena
+{
+	pthread_mutex_t lock;
+	unsigned char *data;
+	size_t size;
+	size_t tail;			// end of the newest record
+	ArenaRecord *rec;		// cyclic list of records, oldest first
+	int maxRecords;
+	int first;
+	int count;
+};
+
+
+FrameArena *FrameArena_Create(size_t size, int maxRecords)
+{
+	FrameArena *arena;
+
+	if ((size == 0) || (maxRecords <= 0))
+		return NULL;
+
+	arena = (FrameArena*)malloc(sizeof(FrameArena));
+	if (arena == NULL)
+		return NULL;
+
+	arena->data = (unsigned char*)malloc(size);
+	arena->rec = (ArenaRecord*)malloc(maxRecords*sizeof(ArenaRecord));
+	if ((arena->data == NULL) || (arena->rec == NULL))
+	{
+		free(arena->data);
+		free(arena->rec);
+		free(arena);
+		return NULL;
+	}
+
+	pthread_mutex_init(&arena->lock, NULL);
+	arena->size = size;
+	arena->tail = 0;
+	arena->maxRecords = maxRecords;
+	arena->first = 0;
+	arena->count = 0;
+
+	return arena;
+}
+
+
+void FrameArena_Destroy(FrameArena *arena)
+{
+	if (arena == NULL)
+		return;
+
+	pthread_mutex_destroy(&arena->lock);
+	free(arena->rec);
+	free(arena->data);
+	free(arena);
+}
+
+
+static void DropOldest(FrameArena *arena)
+{
+	arena->first = (arena->first+1) % arena->maxRecords;
+	--arena->count;
+}
+
+
+static int OldestOverlaps(const FrameArena *arena, size_t pos, int length)
+{
+	const ArenaRecord *r = arena->rec + arena->first;
+
+	return (r->offset < pos+length) && (r->offset+r->length > pos);
+}
+
+
+int FrameArena_Append(FrameArena *arena, const unsigned char *data, int length, int tag)
+{
+	ArenaRecord *r;
+	size_t pos;
+
+	if ((length <= 0) || ((size_t)length > arena->size))
+		return -1;
+
+	pthread_mutex_lock(&arena->lock);
+
+	pos = arena->count ? arena->tail : 0;
+
+	if (pos+length > arena->size)
+	{
+		// records from the tail to the end of the block are left from the previous
+		// pass and are the oldest ones, the space they hold is skipped this pass
+		while (arena->count && (arena->rec[arena->first].offset >= arena->tail))
+			DropOldest(arena);
+		pos = 0;
+	}
+
+	if (arena->count == arena->maxRecords)
+		DropOldest(arena);
+
+	// records following the tail are in the order of their age
+	while (arena->count && OldestOverlaps(arena, pos, length))
+		DropOldest(arena);
+
+	memcpy(arena->data+pos, data, length);
+
+	r = arena->rec + (arena->first+arena->count) % arena->maxRecords;
+	r->offset = pos;
+	r->length = length;
+	r->tag = tag;
+	++arena->count;
+	arena->tail = pos+length;
+
+	pthread_mutex_unlock(&arena->lock);
+
+	return 0;
+}
+
+
+int FrameArena_Count(FrameArena *arena)
+{
+	int count;
+
+	pthread_mutex_lock(&arena->lock);
+	count = arena->count;
+	pthread_mutex_unlock(&arena->lock);
+
+	return count;
+}
+
+
+int FrameArena_Copy(FrameArena *arena, int idx, unsigned char *dst, int dstSize, int *tag)
+{
+	const ArenaRecord *r;
+	int length = -1;
+
+	pthread_mutex_lock(&arena->lock);
+
+	if ((idx >= 0) && (idx < arena->count))
+	{
+		r = arena->rec + (arena->first+idx) % arena->maxRecords;
+		if (r->length <= dstSize)
+		{
+			memcpy(dst, arena->data+r->offset, r->length);
+			length = r->length;
+			if (tag)
+				*tag = r->tag;
+		}
+	}
+
+	pthread_mutex_unlock(&arena->lock);
+
+	return length;
+}
+
+
+int FrameArena_Length(FrameArena *arena, int idx)
+{
+	int length = -1;
+
+	pthread_mutex_lock(&arena->lock);
+
+	if ((idx >= 0) && (idx < arena->count))
+		length = arena->rec[(arena->first+idx) % arena->maxRecords].length;
+
+	pthread_mutex_unlock(&arena->lock);
+
+	return length;
+}
@@ -0,0 +1,52 @@
+/*
+The contents of this file are subject to the Mozilla Public License
+Version 1.1 (the "License"); you may not use this file except in
+compliance with the License. You may obtain a copy of the License at
+http://www.mozilla.org/MPL/
+
+Software distributed under the License is distributed on an "AS IS"
+basis, WITHOUT WARRANTY OF ANY KIND, either express or implied. See the
+License for the specific language governing rights and limitations
+under the License.
+
+The Original Code is collection of files collectively known as Open Camera.
+
+The Initial Developer of the Original Code is Almalence Inc.
+Portions created by Initial Developer are Copyright (C) 2013
+by Almalence Inc. All Rights Reserved.
+*/
+
+#ifndef __FRAMEARENA_H__
+#define __FRAMEARENA_H__
+
+#include <stddef.h>
+
+// Cyclic store of variable-length records (compressed frames) packed into one
+// contiguous memory block. Records are placed one after another, wrapping to
+// the start of the block when the next one does not fit before its end;
+// oldest records are dropped to make room.
+//
+// Appends and reads are serialized by a mutex, readers get a copy of the
+// record so it can not change while they use it.
+
+typedef struct FrameArena FrameArena;
+
+// returns NULL if out of memory
+FrameArena *FrameArena_Create(size_t size, int maxRecords);
+
+// no other thread may be using the arena at this point
+void FrameArena_Destroy(FrameArena *arena);
+
+// Returns 0 on success, -1 if record is larger than the arena
+int FrameArena_Append(FrameArena *arena, const unsigned char *data, int length, int tag);
+
+int FrameArena_Count(FrameArena *arena);
+
+// copy idx-th record counting from the oldest one into dst (of dstSize bytes).
+// Returns length of the record, -1 if there is no such record or it does not fit
+int FrameArena_Copy(FrameArena *arena, int idx, unsigned char *dst, int dstSize, int *tag);
+
+// length of idx-th record, -1 if there is no such record
+int FrameArena_Length(FrameArena *arena, int idx);
+
+#endif // __FRAMEARENA_H__
@@ -0,0 +1,344 @@
+/*
+The contents of this file are subject to the Mozilla Public License
+Version 1.1 (the "License"); you may not use this file except in
+compliance with the License. You may obtain a copy of the License at
+http://www.mozilla.org/MPL/
+
+Software distributed under the License is distributed on an "AS IS"
+basis, WITHOUT WARRANTY OF ANY KIND, either express or implied. See the
+License for the specific language governing rights and limitations
+under the License.
+
+The Original Code is collection of files collectively known as Open Camera.
+
+The Initial Developer of the Original Code is Almalence Inc.
+Portions created by Initial Developer are Copyright (C) 2013
+by Almalence Inc. All Rights Reserved.
+*/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <pthread.h>
+#include <jni.h>
+#include <android/log.h>
+
+#include "YuvToJpegEncoderMT.h"
+#include "ImageConversionUtils.h"
+#include "FrameArena.h"
+#include "FrameCompressor.h"
+
+#define LOG_TAG "FrameCompressor"
+#define LOGE(...) __android_log_print(ANDROID_LOG_ERROR, LOG_TAG, __VA_ARGS__)
+
+#define ImageFormat_NV21 0x11
+
+// staging entry states
+#define RAW_FILLING		0
+#define RAW_FILLED		1
+#define RAW_UNUSED		2
+
+
+struct FrameCompressor
+{
+	int width;
+	int height;
+	int quality;
+	int frameSize;
+
+	FrameArena *arena;
+
+	// staged frames, FIFO of nStaged entries starting at firstStaged,
+	// followed by nReserved entries being filled by inserts
+	pthread_mutex_t lock;
+	pthread_cond_t staged;		// signalled when a frame is staged or on stop
+	pthread_cond_t idle;		// signalled when worker finished a frame
+	unsigned char *raw[FRAME_COMPRESSOR_STAGING];
+	int rawTag[FRAME_COMPRESSOR_STAGING];
+	int rawState[FRAME_COMPRESSOR_STAGING];
+	int firstStaged;
+	int nStaged;
+	int nReserved;
+	unsigned int stagedSeq;		// frames staged so far
+	unsigned int doneSeq;		// frames finished by the worker so far
+	int stop;
+
+	unsigned char *jpeg;		// encoder output, frameSize bytes
+	int offsets[2];
+	int strides[2];				// encoder keeps a pointer to these
+
+	pthread_t worker;
+};
+
+// encoder keeps its format and strides in globals
+static pthread_mutex_t encoder_lock = PTHREAD_MUTEX_INITIALIZER;
+
+
+static int Encode(FrameCompressor *comp, unsigned char *nv21)
+{
+	jpeg_mt_sink sink;
+	boolean ok;
+
+	pthread_mutex_lock(&encoder_lock);
+
+	YuvToJpegEncoderMT_initMemorySink(&sink, comp->jpeg, comp->frameSize);
+	YuvToJpegEncoderMT_init(ImageFormat_NV21, comp->strides);
+	ok = YuvToJpegEncoderMT_encodeToSink(&sink, nv21, comp->width, comp->height,
+			comp->offsets, comp->strides, comp->quality, ImageFormat_NV21);
+
+	pthread_mutex_unlock(&encoder_lock);
+
+	return ok ? (int)sink.written : -1;
+}
+
+
+static void *WorkerProc(void *arg)
+{
+	FrameCompressor *comp = (FrameCompressor*)arg;
+	unsigned char *nv21;
+	int tag;
+	int length;
+
+	pthread_mutex_lock(&comp->lock);
+
+	for (;;)
+	{
+		while (!comp->stop && (comp->nStaged == 0))
+			pthread_cond_wait(&comp->staged, &comp->lock);
+
+		if (comp->stop)
+			break;
+
+		// staged frame stays in place until encoded, inserts only fill free entries
+		nv21 = comp->raw[comp->firstStaged];
+		tag = comp->rawTag[comp->firstStaged];
+
+		if (comp->rawState[comp->firstStaged] == RAW_FILLED)
+		{
+			pthread_mutex_unlock(&comp->lock);
+
+			length = Encode(comp, nv21);
+			if (length > 0)
+				FrameArena_Append(comp->arena, comp->jpeg, length, tag);
+			else
+				LOGE("frame dropped, encoding failed");
+
+			pthread_mutex_lock(&comp->lock);
+		}
+
+		comp->firstStaged = (comp->firstStaged+1) % FRAME_COMPRESSOR_STAGING;
+		--comp->nStaged;
+		++comp->doneSeq;
+		pthread_cond_broadcast(&comp->idle);
+	}
+
+	pthread_mutex_unlock(&comp->lock);
+
+	return NULL;
+}
+
+
+static void FreeBuffers(FrameCompressor *comp)
+{
+	int i;
+
+	for (i = 0; i < FRAME_COMPRESSOR_STAGING; ++i)
+		free(comp->raw[i]);
+	free(comp->jpeg);
+	FrameArena_Destroy(comp->arena);
+	free(comp);
+}
+
+
+FrameCompressor *FrameCompressor_Create(int width, int height, int quality, size_t arenaSize, int maxFrames)
+{
+	FrameCompressor *comp;
+	int allocated;
+	int i;
+
+	if ((width <= 0) || (height <= 0) || (width & 1) || (height & 1))
+		return NULL;
+
+	comp = (FrameCompressor*)calloc(1, sizeof(FrameCompressor));
+	if (comp == NULL)
+		return NULL;
+
+	comp->width = width;
+	comp->height = height;
+	comp->quality = quality;
+	comp->frameSize = width*height+width*height/2;
+	comp->offsets[0] = 0;
+	comp->offsets[1] = width*height;
+	comp->strides[0] = width;
+	comp->strides[1] = width;
+
+	comp->arena = FrameArena_Create(arenaSize, maxFrames);
+	comp->jpeg = (unsigned char*)malloc(comp->frameSize);
+	allocated = (comp->arena != NULL) && (comp->jpeg != NULL);
+	for (i = 0; i < FRAME_COMPRESSOR_STAGING; ++i)
+	{
+		comp->raw[i] = (unsigned char*)malloc(comp->frameSize);
+		allocated = allocated && (comp->raw[i] != NULL);
+	}
+
+	if (!allocated)
+	{
+		FreeBuffers(comp);
+		return NULL;
+	}
+
+	pthread_mutex_init(&comp->lock, NULL);
+	pthread_cond_init(&comp->staged, NULL);
+	pthread_cond_init(&comp->idle, NULL);
+
+	if (pthread_create(&comp->worker, NULL, WorkerProc, comp) != 0)
+	{
+		pthread_cond_destroy(&comp->idle);
+		pthread_cond_destroy(&comp->staged);
+		pthread_mutex_destroy(&comp->lock);
+		FreeBuffers(comp);
+		return NULL;
+	}
+
+	return comp;
+}
+
+
+void FrameCompressor_Destroy(FrameCompressor *comp)
+{
+	if (comp == NULL)
+		return;
+
+	pthread_mutex_lock(&comp->lock);
+	comp->stop = 1;
+	pthread_cond_signal(&comp->staged);
+	pthread_mutex_unlock(&comp->lock);
+
+	pthread_join(comp->worker, NULL);
+
+	pthread_cond_destroy(&comp->idle);
+	pthread_cond_destroy(&comp->staged);
+	pthread_mutex_destroy(&comp->lock);
+	FreeBuffers(comp);
+}
+
+
+int FrameCompressor_Reserve(FrameCompressor *comp, int length, unsigned char **nv21)
+{
+	int entry;
+
+	if (length != comp->frameSize)
+		return -1;
+
+	pthread_mutex_lock(&comp->lock);
+
+	if (comp->nStaged+comp->nReserved == FRAME_COMPRESSOR_STAGING)
+	{
+		pthread_mutex_unlock(&comp->lock);
+		return -2;
+	}
+
+	entry = (comp->firstStaged+comp->nStaged+comp->nReserved) % FRAME_COMPRESSOR_STAGING;
+	comp->rawState[entry] = RAW_FILLING;
+	++comp->nReserved;
+
+	pthread_mutex_unlock(&comp->lock);
+
+	// filled by the caller without the lock, inserts may come from several camera threads
+	*nv21 = comp->raw[entry];
+
+	return entry;
+}
+
+
+void FrameCompressor_Stage(FrameCompressor *comp, int entry, int tag, int filled)
+{
+	int entries = 0;
+	int first;
+
+	pthread_mutex_lock(&comp->lock);
+
+	comp->rawTag[entry] = tag;
+	comp->rawState[entry] = filled ? RAW_FILLED : RAW_UNUSED;
+
+	// entries reserved earlier and still being filled hold back the later ones,
+	// unused entries go through the worker too and are skipped there
+	while (comp->nReserved > 0)
+	{
+		first = (comp->firstStaged+comp->nStaged) % FRAME_COMPRESSOR_STAGING;
+		if (comp->rawState[first] == RAW_FILLING)
+			break;
+
+		++comp->nStaged;
+		--comp->nReserved;
+		++comp->stagedSeq;
+		++entries;
+	}
+
+	if (entries)
+		pthread_cond_signal(&comp->staged);
+	pthread_mutex_unlock(&comp->lock);
+}
+
+
+void FrameCompressor_Flush(FrameCompressor *comp)
+{
+	unsigned int seq;
+
+	// frames staged meanwhile are not waited for, so a steady stream of
+	// inserts can not hold this call
+	pthread_mutex_lock(&comp->lock);
+	seq = comp->stagedSeq;
+	while (!comp->stop && ((int)(comp->doneSeq-seq) < 0))
+		pthread_cond_wait(&comp->idle, &comp->lock);
+	pthread_mutex_unlock(&comp->lock);
+}
+
+
+int FrameCompressor_Count(FrameCompressor *comp)
+{
+	return FrameArena_Count(comp->arena);
+}
+
+
+unsigned char *FrameCompressor_GetJpeg(FrameCompressor *comp, int idx, int *length, int *tag)
+{
+	unsigned char *jpeg;
+	int len;
+
+	// record may be replaced between the two calls, then its copy fails below
+	len = FrameArena_Length(comp->arena, idx);
+	if (len <= 0)
+		return NULL;
+
+	jpeg = (unsigned char*)malloc(len);
+	if (jpeg == NULL)
+		return NULL;
+
+	len = FrameArena_Copy(comp->arena, idx, jpeg, len, tag);
+	if (len <= 0)
+	{
+		free(jpeg);
+		return NULL;
+	}
+
+	*length = len;
+	return jpeg;
+}
+
+
+int FrameCompressor_Decode(FrameCompressor *comp, int idx, unsigned char *nv21, int *tag)
+{
+	unsigned char *jpeg;
+	int length;
+	int res;
+
+	jpeg = FrameCompressor_GetJpeg(comp, idx, &length, tag);
+	if (jpeg == NULL)
+		return -1;
+
+	res = JPEG2NV21(nv21, jpeg, length, comp->width, comp->height, false, false, 0);
+	free(jpeg);
+
+	return res ? 0 : -1;
+}
@@ -0,0 +1,67 @@
+/*
+The contents of this file are subject to the Mozilla Public License
+Version 1.1 (the "License"); you may not use this file except in
+compliance with the License. You may obtain a copy of the License at
+http://www.mozilla.org/MPL/
+
+Software distributed under the License is distributed on an "AS IS"
+basis, WITHOUT WARRANTY OF ANY KIND, either express or implied. See the
+License for the specific language governing rights and limitations
+under the License.
+
+The Original Code is collection of files collectively known as Open Camera.
+
+The Initial Developer of the Original Code is Almalence Inc.
+Portions created by Initial Developer are Copyright (C) 2013
+by Almalence Inc. All Rights Reserved.
+*/
+
+#ifndef __FRAMECOMPRESSOR_H__
+#define __FRAMECOMPRESSOR_H__
+
+#include <stddef.h>
+
+// Frame history kept as jpegs in a FrameArena.
+//
+// Inserted NV21 frames are staged and returned immediately, a background
+// thread compresses them with the multithreaded jpeg encoder and appends the
+// result to the arena. If the encoder falls behind the frame rate, frames
+// arriving while all staging buffers are taken are dropped.
+//
+// A frame is inserted by reserving a staging buffer, filling it without any
+// lock held and staging it. Reserved buffers are staged in reservation order.
+
+typedef struct FrameCompressor FrameCompressor;
+
+// raw NV21 frames waiting for the encoder
+#define FRAME_COMPRESSOR_STAGING	3
+
+// returns NULL if out of memory or the worker thread could not be started
+FrameCompressor *FrameCompressor_Create(int width, int height, int quality, size_t arenaSize, int maxFrames);
+
+// stops the worker, frames still staged are discarded
+void FrameCompressor_Destroy(FrameCompressor *comp);
+
+// reserve a staging buffer for a frame of length bytes, *nv21 is set to it.
+// Returns the entry to pass to FrameCompressor_Stage, -1 if frame has wrong
+// size, -2 if it is dropped
+int FrameCompressor_Reserve(FrameCompressor *comp, int length, unsigned char **nv21);
+
+// queue the reserved entry for encoding, or give it back unused if filled is 0
+void FrameCompressor_Stage(FrameCompressor *comp, int entry, int tag, int filled);
+
+// wait until the frames staged before the call are in the arena
+void FrameCompressor_Flush(FrameCompressor *comp);
+
+// number of compressed frames
+int FrameCompressor_Count(FrameCompressor *comp);
+
+// decode idx-th frame counting from the oldest one into width*height*3/2 NV21.
+// Returns 0 on success, -1 if there is no such frame or it can not be decoded
+int FrameCompressor_Decode(FrameCompressor *comp, int idx, unsigned char *nv21, int *tag);
+
+// copy idx-th jpeg into a malloc'ed buffer, caller frees it.
+// Returns NULL if there is no such frame
+unsigned char *FrameCompressor_GetJpeg(FrameCompressor *comp, int idx, int *length, int *tag);
+
+#endif // __FRAMECOMPRESSOR_H__
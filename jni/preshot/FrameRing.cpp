@@ -0,0 +1,216 @@
+/*
+The contents of this file are subject to the Mozilla Public License
+Version 1.1 (the "License"); you may not use this file except in
+compliance with the License. You may obtain a copy of the License at
+http://www.mozilla.org/MPL/
+
+Software distributed under the License is distributed on an "AS IS"
+basis, WITHOUT WARRANTY OF ANY KIND, either express or implied. See the
+License for the specific language governing rights and limitations
+under the License.
+
+The Original Code is collection of files collectively known as Open Camera.
+
+The Initial Developer of the Original Code is Almalence Inc.
+Portions created by Initial Developer are Copyright (C) 2013
+by Almalence Inc. All Rights Reserved.
+*/
+
+#include <stdlib.h>
+#include <string.h>
+
+#include "FrameRing.h"
+
+
+typedef struct
+{
+	unsigned int seq;		// 0 - empty, 2p+1 - frame p being written, 2p+2 - frame p complete
+	int readers;			// number of readers holding the slot pinned
+	int length;
+	int tag;
+} FrameSlot;
+
+struct FrameRing
+{
+	unsigned int head;		// next position to be taken by an insert
+	int nSlots;
+	int slotSize;
+	FrameSlot *slots;
+	unsigned char *data;
+};
+
+
+#define SEQ_WRITING(p)		(2*(p)+1)
+#define SEQ_COMPLETE(p)		(2*(p)+2)
+
+
+FrameRing *FrameRing_Create(int nSlots, int slotSize)
+{
+	FrameRing *ring;
+
+	if ((nSlots < 2) || (slotSize <= 0))
+		return NULL;
+
+	ring = (FrameRing*)malloc(sizeof(FrameRing));
+	if (ring == NULL)
+		return NULL;
+
+	ring->slots = (FrameSlot*)calloc(nSlots, sizeof(FrameSlot));
+	ring->data = (unsigned char*)malloc((size_t)nSlots*slotSize);
+	if ((ring->slots == NULL) || (ring->data == NULL))
+	{
+		free(ring->slots);
+		free(ring->data);
+		free(ring);
+		return NULL;
+	}
+
+	ring->head = 0;
+	ring->nSlots = nSlots;
+	ring->slotSize = slotSize;
+
+	return ring;
+}
+
+
+void FrameRing_Destroy(FrameRing *ring)
+{
+	if (ring == NULL)
+		return;
+
+	free(ring->data);
+	free(ring->slots);
+	free(ring);
+}
+
+
+int FrameRing_Slots(const FrameRing *ring)
+{
+	return ring->nSlots;
+}
+
+
+int FrameRing_SlotSize(const FrameRing *ring)
+{
+	return ring->slotSize;
+}
+
+
+int FrameRing_Insert(FrameRing *ring, const unsigned char *data, int length, int tag)
+{
+	int attempt;
+
+	if (length > ring->slotSize)
+		return -1;
+
+	// each attempt takes a new position, so a pinned or lapped slot costs one
+	// extra old frame rather than the new one
+	for (attempt = 0; attempt < ring->nSlots; ++attempt)
+	{
+		unsigned int pos = __atomic_fetch_add(&ring->head, 1, __ATOMIC_RELAXED);
+		int islot = pos % ring->nSlots;
+		FrameSlot *slot = ring->slots + islot;
+		unsigned int old = __atomic_load_n(&slot->seq, __ATOMIC_ACQUIRE);
+
+		// another insert is still writing here, or a newer one got here first
+		if ((old & 1) || ((int)(old - SEQ_WRITING(pos)) > 0))
+			continue;
+
+		if (!__atomic_compare_exchange_n(&slot->seq, &old, SEQ_WRITING(pos), 0, __ATOMIC_SEQ_CST, __ATOMIC_RELAXED))
+			continue;
+
+		// readers pin before checking seq, we check readers after taking seq:
+		// with both in sequential order one of the sides always backs off
+		if (__atomic_load_n(&slot->readers, __ATOMIC_SEQ_CST) != 0)
+		{
+			// slot content was not touched yet, give the previous frame back
+			__atomic_store_n(&slot->seq, old, __ATOMIC_RELEASE);
+			continue;
+		}
+
+		memcpy(ring->data + (size_t)islot*ring->slotSize, data, length);
+		slot->length = length;
+		slot->tag = tag;
+
+		__atomic_store_n(&slot->seq, SEQ_COMPLETE(pos), __ATOMIC_RELEASE);
+
+		return 0;
+	}
+
+	return -2;
+}
+
+
+// oldest position visible to readers, given the head
+static unsigned int FirstVisible(const FrameRing *ring, unsigned int head)
+{
+	return head > (unsigned int)(ring->nSlots-1) ? head - (ring->nSlots-1) : 0;
+}
+
+
+int FrameRing_Count(FrameRing *ring)
+{
+	unsigned int head = __atomic_load_n(&ring->head, __ATOMIC_ACQUIRE);
+	unsigned int pos;
+	int count = 0;
+
+	for (pos = FirstVisible(ring, head); pos != head; ++pos)
+		if (__atomic_load_n(&ring->slots[pos % ring->nSlots].seq, __ATOMIC_ACQUIRE) == SEQ_COMPLETE(pos))
+			++count;
+
+	return count;
+}
+
+
+// pin slot if it still holds the expected complete frame
+static int PinIfComplete(FrameRing *ring, int islot, unsigned int expected, FrameRingView *view)
+{
+	FrameSlot *slot = ring->slots + islot;
+	unsigned int seq;
+
+	__atomic_add_fetch(&slot->readers, 1, __ATOMIC_SEQ_CST);
+	seq = __atomic_load_n(&slot->seq, __ATOMIC_SEQ_CST);
+
+	if (seq != expected)
+	{
+		__atomic_sub_fetch(&slot->readers, 1, __ATOMIC_RELEASE);
+		return -1;
+	}
+
+	view->slot = islot;
+	view->data = ring->data + (size_t)islot*ring->slotSize;
+	view->length = slot->length;
+	view->tag = slot->tag;
+
+	return 0;
+}
+
+
+int FrameRing_Pin(FrameRing *ring, int idx, FrameRingView *view)
+{
+	unsigned int head = __atomic_load_n(&ring->head, __ATOMIC_ACQUIRE);
+	unsigned int pos;
+
+	if (idx < 0)
+		return -1;
+
+	for (pos = FirstVisible(ring, head); pos != head; ++pos)
+	{
+		int islot = pos % ring->nSlots;
+
+		if (__atomic_load_n(&ring->slots[islot].seq, __ATOMIC_ACQUIRE) != SEQ_COMPLETE(pos))
+			continue;
+
+		if (idx-- == 0)
+			return PinIfComplete(ring, islot, SEQ_COMPLETE(pos), view);
+	}
+
+	return -1;
+}
+
+
+void FrameRing_Unpin(FrameRing *ring, FrameRingView *view)
+{
+	__atomic_sub_fetch(&ring->slots[view->slot].readers, 1, __ATOMIC_RELEASE);
+	view->data = NULL;
+}
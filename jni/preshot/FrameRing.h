@@ -0,0 +1,69 @@
+/*
+The contents of this file are subject to the Mozilla Public License
+Version 1.1 (the "License"); you may not use this file except in
+compliance with the License. You may obtain a copy of the License at
+http://www.mozilla.org/MPL/
+
+Software distributed under the License is distributed on an "AS IS"
+basis, WITHOUT WARRANTY OF ANY KIND, either express or implied. See the
+License for the specific language governing rights and limitations
+under the License.
+
+The Original Code is collection of files collectively known as Open Camera.
+
+The Initial Developer of the Original Code is Almalence Inc.
+Portions created by Initial Developer are Copyright (C) 2013
+by Almalence Inc. All Rights Reserved.
+*/
+
+#ifndef __FRAMERING_H__
+#define __FRAMERING_H__
+
+// Fixed-size cyclic store of frames, safe for any number of concurrent
+// inserting and reading threads without locks.
+//
+// Every insert takes the next position from an atomic head counter, position p
+// goes to slot p % nSlots. Each slot has a sequence number: 2p+1 while frame p
+// is being written, 2p+2 once it is complete. Readers pin a slot before using
+// its data and a pinned slot is never overwritten - an insert that lands on it
+// moves on to the next position instead.
+//
+// The newest nSlots-1 positions are visible to readers, the spare slot is the
+// one the next insert goes to, so reading the oldest frame does not hold back
+// inserts at full frame rate.
+
+typedef struct FrameRing FrameRing;
+
+// pinned frame, data stays valid until FrameRing_Unpin
+typedef struct
+{
+	int slot;
+	const unsigned char *data;
+	int length;
+	int tag;
+} FrameRingView;
+
+// returns NULL if out of memory
+FrameRing *FrameRing_Create(int nSlots, int slotSize);
+
+// no other thread may be using the ring at this point
+void FrameRing_Destroy(FrameRing *ring);
+
+int FrameRing_Slots(const FrameRing *ring);
+int FrameRing_SlotSize(const FrameRing *ring);
+
+// copy a frame into the ring, tag is stored along (e.g. orientation).
+// Returns 0 on success, -1 if frame is larger than a slot,
+// -2 if no slot could be taken (all pinned or being written)
+int FrameRing_Insert(FrameRing *ring, const unsigned char *data, int length, int tag);
+
+// number of complete frames currently visible to readers
+int FrameRing_Count(FrameRing *ring);
+
+// pin idx-th complete frame counting from the oldest one.
+// Returns 0 on success, -1 if there is no such frame
+int FrameRing_Pin(FrameRing *ring, int idx, FrameRingView *view);
+
+void FrameRing_Unpin(FrameRing *ring, FrameRingView *view);
+
+#endif // __FRAMERING_H__
@@ -16,14 +16,20 @@ Portions created by Initial Developer are Copyright (C) 2013
 by Almalence Inc. All Rights Reserved.
 */
 
+#include <stdlib.h>
 #include <string.h>
 #include <stdio.h>
 #include <jni.h>
 #include <pthread.h>
+#include <sched.h>
 #include <android/log.h>
 
 
 #include "ImageConversionUtils.h"
+#include "FrameRing.h"
+#include "FrameCompressor.h"
+#include "MemoryBudget.h"
+#include "FrameHandle.h"
 
 typedef int Int32;
 typedef short Int16;
@@ -34,16 +40,16 @@ typedef signed char Int8;
 
 static int FPS = 1;
 
-//cyclic buffer for storing data
-static unsigned char *frame_buffer = NULL;
-static int buf_size = 0;
+//cyclic buffer for storing data, orientation (as frame tag) and data length.
+//camera callbacks insert while saver reads older frames, see FrameRing.h
+static FrameRing *ring = NULL;
+//same history kept as jpegs of variable length, see FrameCompressor.h.
+//only one of ring and packed is allocated at a time
+static FrameCompressor *packed = NULL;
+//number of calls currently using the ring or packed, FreeBuffer waits for them to leave
+static int ring_users = 0;
 
-//cyclic buffer for storing image orientation
-static unsigned char *orient_buffer = NULL;
 //static unsigned char *reserved_orient_buffer = NULL;
-
-//cyclic buffer for storing data length
-static unsigned int *len_buffer = NULL;
 //static unsigned int *reserved_len_buffer = NULL;
 
 //reserved cyclic buffer for storing data. reserved used while saving
@@ -59,41 +65,165 @@ static int image_h = 0;
 //static int image_wReserved = 0;
 //static int image_hReserved = 0;
 
-static int idxIN = 0;
-static int idxOUT = 0;
 static int elemSize = 0;
-static long mem_free = 0;
+//bytes of ring or packed reserved in the memory budget
+static size_t budget_reserved = 0;
 
 
 extern "C" {
 
 
-//checks available heap memory
-void mem_usage(long *mem_free)
+//take ring for the duration of a call, NULL if buffer is not allocated
+static FrameRing *AcquireRing()
+{
+	FrameRing *r;
+
+	__atomic_add_fetch(&ring_users, 1, __ATOMIC_SEQ_CST);
+	r = __atomic_load_n(&ring, __ATOMIC_SEQ_CST);
+	if (r == NULL)
+		__atomic_sub_fetch(&ring_users, 1, __ATOMIC_SEQ_CST);
+
+	return r;
+}
+
+static void ReleaseRing()
+{
+	__atomic_sub_fetch(&ring_users, 1, __ATOMIC_SEQ_CST);
+}
+
+//unpublish the ring and free it once no call is using it
+static int DestroyRing()
+{
+	FrameRing *r = __atomic_exchange_n(&ring, (FrameRing*)NULL, __ATOMIC_SEQ_CST);
+
+	if (r == NULL)
+		return 0;
+
+	while (__atomic_load_n(&ring_users, __ATOMIC_SEQ_CST) != 0)
+		sched_yield();
+
+	FrameRing_Destroy(r);
+	MemoryBudget_Release(MEMBUDGET_PRESHOT, budget_reserved);
+	budget_reserved = 0;
+
+	return 1;
+}
+
+static FrameCompressor *AcquirePacked()
+{
+	FrameCompressor *p;
+
+	__atomic_add_fetch(&ring_users, 1, __ATOMIC_SEQ_CST);
+	p = __atomic_load_n(&packed, __ATOMIC_SEQ_CST);
+	if (p == NULL)
+		__atomic_sub_fetch(&ring_users, 1, __ATOMIC_SEQ_CST);
+
+	return p;
+}
+
+static int DestroyPacked()
 {
-	FILE *f;
-	char dummy[1024];
-
-	// the fields we want
-	unsigned long curr_mem_used;
-	unsigned long curr_mem_free;
-	unsigned long curr_mem_buffers;
-	unsigned long curr_mem_cached;
-
-	*mem_free = 0;
-
-	// 'file' stat seems to give the most reliable results
-	f = fopen ("/proc/meminfo", "r");
-	if (f==NULL) return;
-	fscanf(f, "%s %ld %s ", dummy, &curr_mem_used, dummy);
-	fscanf(f, "%s %ld %s ", dummy, &curr_mem_free, dummy);
-	fscanf(f, "%s %ld %s ", dummy, &curr_mem_buffers, dummy);
-	fscanf(f, "%s %ld %s ", dummy, &curr_mem_cached, dummy);
-	fclose(f);
-
-	*mem_free = (curr_mem_free + curr_mem_cached) * 1024;
+	FrameCompressor *p = __atomic_exchange_n(&packed, (FrameCompressor*)NULL, __ATOMIC_SEQ_CST);
+
+	if (p == NULL)
+		return 0;
+
+	while (__atomic_load_n(&ring_users, __ATOMIC_SEQ_CST) != 0)
+		sched_yield();
+
+	FrameCompressor_Destroy(p);
+	MemoryBudget_Release(MEMBUDGET_PRESHOT, budget_reserved);
+	budget_reserved = 0;
+
+	return 1;
 }
 
+//frame taken from the buffer for the duration of a call
+typedef struct
+{
+	FrameRing *ring;				//frame is pinned in the ring
+	FrameRingView view;
+	unsigned char *decoded;			//or decoded from packed
+	const unsigned char *data;
+	int length;
+	int tag;
+} FrameRef;
+
+//idx-th frame counting from the oldest one. Returns 0 on success, -1 if there is no such frame
+static int GetFrame(int idx, FrameRef *f)
+{
+	FrameCompressor *p;
+	int res = -1;
+
+	f->decoded = NULL;
+
+	f->ring = AcquireRing();
+	if (f->ring != NULL)
+	{
+		//frame stays pinned (can not be overwritten by inserts) while it is used
+		if (FrameRing_Pin(f->ring, idx, &f->view))
+		{
+			ReleaseRing();
+			return -1;
+		}
+
+		f->data = f->view.data;
+		f->length = f->view.length;
+		f->tag = f->view.tag;
+
+		return 0;
+	}
+
+	p = AcquirePacked();
+	if (p == NULL)
+		return -1;
+
+	f->decoded = (unsigned char*)malloc(elemSize);
+	if (f->decoded != NULL)
+	{
+		res = FrameCompressor_Decode(p, idx, f->decoded, &f->tag);
+		if (res)
+		{
+			free(f->decoded);
+			f->decoded = NULL;
+		}
+	}
+	ReleaseRing();
+
+	f->data = f->decoded;
+	f->length = elemSize;
+
+	return res;
+}
+
+static void PutFrame(FrameRef *f)
+{
+	if (f->ring != NULL)
+	{
+		FrameRing_Unpin(f->ring, &f->view);
+		ReleaseRing();
+	}
+	free(f->decoded);
+}
+
+//orientation in degrees <-> frame tag
+static int OrientationToTag(int orientation)
+{
+	if(90 == orientation)
+		return 1;
+	else if(180 == orientation)
+		return 2;
+	else if(270 == orientation)
+		return 3;
+	return 0;
+}
+
+static int TagToOrientation(int tag)
+{
+	return tag*90;
+}
+
+
 //max amount of elements which can be allocated
 JNIEXPORT jint JNICALL Java_com_almalence_plugins_capture_preshot_PreShot_AvailableMemory
 (
@@ -101,8 +231,10 @@ JNIEXPORT jint JNICALL Java_com_almalence_plugins_capture_preshot_PreShot_Availa
 	jobject pObj
 )
 {
-	//count amount of elements. we can't use all available memory. take just 80%
-	return mem_free*0.8/elemSize;
+	if (elemSize == 0)
+		return 0;
+
+	return MemoryBudget_Available(MEMBUDGET_PRESHOT)/elemSize;
 }
 
 
@@ -119,84 +251,135 @@ JNIEXPORT jint JNICALL Java_com_almalence_plugins_capture_preshot_PreShot_Alloca
 	jint isJPG
 )
 {
-	int i=0;
-
 	int desiredBufSize = 0;
 	int maxBufSize = 0;
+	int buf_size;
+	FrameRing *r;
+
+	//drop previous buffer (and its frames) if any
+	DestroyRing();
+	DestroyPacked();
 
 	image_w = jimgw;
 	image_h = jimgh;
 	FPS = jfps;
 
-	//zero buf head&tail
-	idxIN=0;
-	idxOUT=0;
-
 	if (isJPG==1)
 		elemSize = jimgw*jimgh/2;
 	else
 		elemSize = jimgw*jimgh*3/2;
-	//long mem_free;
-	mem_usage(&mem_free);
 
 	desiredBufSize = secondsToAllocate*FPS+1;
 //	if (!isReservedAllocated)
 //		maxBufSize = mem_free/2/elemSize;
 //	else
-		maxBufSize = mem_free*0.8/elemSize;
+		maxBufSize = MemoryBudget_Available(MEMBUDGET_PRESHOT)/elemSize;
 
 	//count buf_size
 	buf_size = (desiredBufSize<maxBufSize)?desiredBufSize:maxBufSize;
 
-	frame_buffer = (unsigned char *)malloc(sizeof(unsigned char)*buf_size*elemSize);
-	if (!frame_buffer)
+	if (MemoryBudget_Reserve(MEMBUDGET_PRESHOT, (size_t)buf_size*elemSize))
 		return 0;
 
-	orient_buffer = (unsigned char *)malloc(sizeof(unsigned char)*buf_size);
-	if (!orient_buffer)
+	r = FrameRing_Create(buf_size, elemSize);
+	if (!r)
+	{
+		MemoryBudget_Release(MEMBUDGET_PRESHOT, (size_t)buf_size*elemSize);
 		return 0;
+	}
+	budget_reserved = (size_t)buf_size*elemSize;
 
-	len_buffer = (unsigned int *)malloc(sizeof(unsigned int)*buf_size);
-	if (!len_buffer)
-		return 0;
+	__atomic_store_n(&ring, r, __ATOMIC_SEQ_CST);
 
 	__android_log_print(ANDROID_LOG_ERROR, "Allocation", "Allocated %d bufers of %d size", buf_size, elemSize);
 
 	return buf_size/FPS;
 }
 
-//free allocated bufer
-JNIEXPORT jboolean JNICALL Java_com_almalence_plugins_capture_preshot_PreShot_FreeBuffer
+//expected compression of a preview frame, NV21 size to jpeg size.
+//actual ratio varies with the scene and quality
+#define PACKED_RATIO		5
+
+//allocate buffer storing preview (NV21) frames compressed into jpeg of given quality.
+//arena is sized for frames compressed to half of PACKED_RATIO at worst, so it takes
+//several times less memory than AllocateBuffer for the same seconds, and can hold
+//history several times longer within the same pre-shot memory budget
+JNIEXPORT jint JNICALL Java_com_almalence_plugins_capture_preshot_PreShot_AllocateCompressedBuffer
 (
 	JNIEnv* env,
-	jobject pObj
+	jobject pObj,
+	jint jimgw,
+	jint jimgh,
+	jint jfps,
+	jint secondsToAllocate,
+	jint quality
 )
 {
-	int i;
+	int desiredFrames;
+	size_t desiredSize;
+	size_t maxSize;
+	size_t arenaSize;
+	size_t budget;
+	size_t total;
+	FrameCompressor *p;
+
+	//drop previous buffer (and its frames) if any
+	DestroyRing();
+	DestroyPacked();
+
+	image_w = jimgw;
+	image_h = jimgh;
+	FPS = jfps;
 
-	idxIN = 0;
-	idxOUT = 0;
+	elemSize = jimgw*jimgh*3/2;
+	budget = MemoryBudget_Available(MEMBUDGET_PRESHOT);
 
-	if (!frame_buffer)
-	{
+	//staging frames and encoder output are taken from the same budget
+	if (budget < (size_t)(FRAME_COMPRESSOR_STAGING+2)*elemSize)
 		return 0;
-	}
-	free(frame_buffer);
-	frame_buffer = 0;
 
-	if (!orient_buffer)
+	desiredFrames = secondsToAllocate*FPS+1;
+	desiredSize = (size_t)desiredFrames*elemSize*2/PACKED_RATIO;
+	maxSize = budget - (FRAME_COMPRESSOR_STAGING+1)*elemSize;
+
+	arenaSize = (desiredSize<maxSize)?desiredSize:maxSize;
+
+	total = arenaSize + (FRAME_COMPRESSOR_STAGING+1)*elemSize;
+	if (MemoryBudget_Reserve(MEMBUDGET_PRESHOT, total))
+		return 0;
+
+	p = FrameCompressor_Create(jimgw, jimgh, quality, arenaSize, desiredFrames);
+	if (!p)
 	{
+		MemoryBudget_Release(MEMBUDGET_PRESHOT, total);
 		return 0;
 	}
-	free(orient_buffer);
-	orient_buffer = 0;
+	budget_reserved = total;
+
+	__atomic_store_n(&packed, p, __ATOMIC_SEQ_CST);
+
+	__android_log_print(ANDROID_LOG_ERROR, "Allocation", "Allocated %d bytes for %d compressed frames of %d size", (int)arenaSize, desiredFrames, elemSize);
+
+	if (arenaSize < desiredSize)
+		return arenaSize*PACKED_RATIO/2/elemSize/FPS;
+
+	return secondsToAllocate;
+}
+
+//free allocated bufer
+JNIEXPORT jboolean JNICALL Java_com_almalence_plugins_capture_preshot_PreShot_FreeBuffer
+(
+	JNIEnv* env,
+	jobject pObj
+)
+{
+	int freed = DestroyRing();
 
-	if (!len_buffer)
+	freed |= DestroyPacked();
+	if (!freed)
 	{
 		return 0;
 	}
-	free(len_buffer);
-	len_buffer = 0;
 
 
 	__android_log_print(ANDROID_LOG_ERROR, "Allocation", "Buffers freed");
@@ -204,6 +387,47 @@ JNIEXPORT jboolean JNICALL Java_com_almalence_plugins_capture_preshot_PreShot_Fr
 	return 1;
 }
 
+// copy frame into the cyclic buffer, oldest frame is dropped if the buffer is full.
+// Returns 0 on success, -1 if frame does not fit, -2 if it was dropped
+static int InsertFrame(JNIEnv* env, jbyteArray jdata, int data_length, int orientation)
+{
+	FrameRing *r = AcquireRing();
+	FrameCompressor *p;
+	unsigned char *data;
+	int res;
+
+	if (r != NULL)
+	{
+		// pinned, not copied - ring inserts take no lock, frame is copied straight into it
+		data = (unsigned char*)env->GetPrimitiveArrayCritical(jdata, NULL);
+		if (data != NULL)
+		{
+			res = FrameRing_Insert(r, data, data_length, OrientationToTag(orientation));
+			env->ReleasePrimitiveArrayCritical(jdata, data, JNI_ABORT);
+		}
+		else
+			res = -1;
+		ReleaseRing();
+	}
+	else if ((p = AcquirePacked()) != NULL)
+	{
+		//only staged here, compressed on the worker thread. Frame is copied
+		//straight into the reserved staging buffer, no lock or pin is held meanwhile
+		res = FrameCompressor_Reserve(p, data_length, &data);
+		if (res >= 0)
+		{
+			env->GetByteArrayRegion(jdata, 0, data_length, (jbyte*)data);
+			FrameCompressor_Stage(p, res, OrientationToTag(orientation), !env->ExceptionCheck());
+			res = 0;
+		}
+		ReleaseRing();
+	}
+	else
+		res = -1;
+
+	return res;
+}
+
 //insert data into buffer specifying if image is in portrait/landscape orientation
 JNIEXPORT jint JNICALL Java_com_almalence_plugins_capture_preshot_PreShot_InsertToBuffer
 (
@@ -214,7 +438,6 @@ JNIEXPORT jint JNICALL Java_com_almalence_plugins_capture_preshot_PreShot_Insert
 	jint orientation
 )
 {
-	unsigned char *data;
 	int data_length;
 
 //	if (!isBuffering)
@@ -224,46 +447,10 @@ JNIEXPORT jint JNICALL Java_com_almalence_plugins_capture_preshot_PreShot_Insert
 	//__android_log_print(ANDROID_LOG_ERROR, "Insert", "Buffer size %d data size %d", elemSize, data_length);
 	if (data_length > elemSize)
 		return -1;
-	data = (unsigned char*)env->GetByteArrayElements(jdata, NULL);
-
-	memcpy ((void*)(frame_buffer+ idxIN*elemSize), (void*)data, data_length);
-
-//	if (1==isPortrait)
-//		*(orient_buffer+ idxIN) = 1;
-//	else
-//		*(orient_buffer+ idxIN) = 0;
-	if(0 == orientation)
-		*(orient_buffer+ idxIN) = 0;
-	else if(90 == orientation)
-		*(orient_buffer+ idxIN) = 1;
-	else if(180 == orientation)
-		*(orient_buffer+ idxIN) = 2;
-	else if(270 == orientation)
-		*(orient_buffer+ idxIN) = 3;
 
-	*(len_buffer+ idxIN) = data_length;
-
-	env->ReleaseByteArrayElements(jdata, (jbyte*)data, JNI_ABORT);
-
-	//move head
-	idxIN++;
-	if(idxIN == (buf_size))
-		idxIN=0;
-
-	//move tail
-	if (idxIN == idxOUT)
-	{
-		idxOUT++;
-		if(idxOUT == (buf_size))
-			idxOUT=0;
-	}
-
-	return 0;
+	return InsertFrame(env, jdata, data_length, orientation);
 }
 
-
-//get image converted from yuv to JPEG (to show preview)
-//specify orientation or use orientation from orient_buffer
 JNIEXPORT jintArray JNICALL Java_com_almalence_plugins_capture_preshot_PreShot_GetFromBufferRGBA
 (
 	JNIEnv* env,
@@ -274,37 +461,26 @@ JNIEXPORT jintArray JNICALL Java_com_almalence_plugins_capture_preshot_PreShot_G
 )
 {
 	unsigned int *data;
-	int TempidxOUT = idxOUT;
-	jintArray jdata = env->NewIntArray(0);
-
-	if (idxIN == idxOUT)
-	{
-		env->ReleaseIntArrayElements(jdata, (jint*)data, 0);
-		return jdata;
-	}
-
-	TempidxOUT +=idx;
+	FrameRef frame;
+	jintArray jdata;
 
-	if(TempidxOUT == (buf_size))
-		TempidxOUT=0;
-	if (idxIN == TempidxOUT)
-	{
-		env->ReleaseIntArrayElements(jdata, (jint*)data, 0);
-		return jdata;
-	}
-	if(TempidxOUT > (buf_size-1))
-		TempidxOUT = idx - (buf_size - idxOUT);
+	if (GetFrame(idx, &frame))
+		return env->NewIntArray(0);
 
 	jdata = env->NewIntArray(elemSize);
+	if (jdata != NULL)
+	{
+		data = (unsigned int*)env->GetIntArrayElements(jdata, NULL);
 
-	data = (unsigned int*)env->GetIntArrayElements(jdata, NULL);
+		//bool rotate = (manualOrientation ? orientation : (1 == frame.tag));
 
-	//bool rotate = (manualOrientation ? orientation : (1 == *(orient_buffer+TempidxOUT)));
+		bool rotate = (manualOrientation ? orientation : (1 == frame.tag || 3 == frame.tag));
+		NV21_to_RGB((unsigned char*)frame.data, (int*)data, image_w, image_h, rotate);
 
-	bool rotate = (manualOrientation ? orientation : (1 == *(orient_buffer+TempidxOUT) || 3 == *(orient_buffer+TempidxOUT)));
-	NV21_to_RGB(frame_buffer+TempidxOUT*elemSize, (int*)data, image_w, image_h, rotate);
+		env->ReleaseIntArrayElements(jdata, (jint*)data, 0);
+	}
 
-	env->ReleaseIntArrayElements(jdata, (jint*)data, 0);
+	PutFrame(&frame);
 
 	return jdata;
 }
@@ -324,45 +500,17 @@ JNIEXPORT jbyteArray JNICALL Java_com_almalence_plugins_capture_preshot_PreShot_
 	jint previewH
 )
 {
-	unsigned char *data;
-	int TempidxOUT = idxOUT;
-	jbyteArray jdata = env->NewByteArray(0);
-
-	if (idxIN == idxOUT)
-	{
-		//env->ReleaseIntArrayElements(jdata, (jint*)data, JNI_ABORT);
-		env->ReleaseByteArrayElements(jdata, (jbyte*)data, 0);
-		return jdata;
-	}
-
-	TempidxOUT +=idx;
-
-	if(TempidxOUT == (buf_size))
-		TempidxOUT=0;
-	if (idxIN == TempidxOUT)
-	{
-		//env->ReleaseIntArrayElements(jdata, (jint*)data, JNI_ABORT);
-		env->ReleaseByteArrayElements(jdata, (jbyte*)data, 0);
-		return jdata;
-	}
-	if(TempidxOUT > (buf_size-1))
-		TempidxOUT = idx - (buf_size - idxOUT);
-
-
+	FrameRef frame;
+	jbyteArray jdata;
 
+	if (GetFrame(idx, &frame))
+		return env->NewByteArray(0);
 
-	size_t size_src = *(len_buffer+ TempidxOUT);
-	//size_t size = image_h*image_w;
-	//jdata = env->NewIntArray(size);
-	jdata = env->NewByteArray(size_src);
-	data = (unsigned char*)env->GetByteArrayElements(jdata, NULL);
+	jdata = env->NewByteArray(frame.length);
+	if (jdata != NULL)
+		env->SetByteArrayRegion(jdata, 0, frame.length, (const jbyte*)frame.data);
 
-//	jdata = env->NewIntArray(size_src/sizeof(int));
-//	data = (unsigned int*)env->GetIntArrayElements(jdata, NULL);
-	memcpy (data, frame_buffer+TempidxOUT*elemSize, size_src);
-	//memcpy (data, frame_buffer+TempidxOUT*elemSize, size*sizeof(int));
-	//env->ReleaseIntArrayElements(jdata, (jint*)data, JNI_ABORT);
-	env->ReleaseByteArrayElements(jdata, (jbyte*)data, 0);
+	PutFrame(&frame);
 
 	return jdata;
 }
@@ -376,32 +524,36 @@ JNIEXPORT jint JNICALL Java_com_almalence_plugins_capture_preshot_PreShot_getOri
 	jint idx
 )
 {
-	int TempidxOUT = idxOUT;
-
-	TempidxOUT +=idx;
-
-	if(TempidxOUT == (buf_size))
-		TempidxOUT=0;
-	if (idxIN == TempidxOUT)
+	FrameRing *r = AcquireRing();
+	FrameCompressor *p;
+	FrameRingView view;
+	int orientation = 0;
+	int tag;
+	int length;
+	unsigned char *jpeg;
+
+	if (r != NULL)
 	{
-		return 0;
+		if (FrameRing_Pin(r, idx, &view) == 0)
+		{
+			orientation = TagToOrientation(view.tag);
+			FrameRing_Unpin(r, &view);
+		}
+		ReleaseRing();
+	}
+	else if ((p = AcquirePacked()) != NULL)
+	{
+		//tag is kept along the jpeg, no need to decode it
+		jpeg = FrameCompressor_GetJpeg(p, idx, &length, &tag);
+		if (jpeg != NULL)
+		{
+			orientation = TagToOrientation(tag);
+			free(jpeg);
+		}
+		ReleaseRing();
 	}
-	if(TempidxOUT > (buf_size-1))
-		TempidxOUT = idx - (buf_size - idxOUT);
 
-//	if (1 == *(orient_buffer+TempidxOUT))
-//		return 1;
-//	else
-//		return 0;
-	if(0 == *(orient_buffer+TempidxOUT))
-		return 0;
-	else if(1 == *(orient_buffer+TempidxOUT))
-		return 90;
-	else if(2 == *(orient_buffer+TempidxOUT))
-		return 180;
-	else if(3 == *(orient_buffer+TempidxOUT))
-		return 270;
-	//return *(orient_buffer+TempidxOUT);
+	return orientation;
 }
 
 ////check image orientation by index in reserved buffer
@@ -435,19 +587,23 @@ JNIEXPORT jint JNICALL Java_com_almalence_plugins_capture_preshot_PreShot_GetIma
 	jobject pObj
 )
 {
+	FrameRing *r = AcquireRing();
+	FrameCompressor *p;
 	int imgCnt=0;
 
-	if (idxIN == 0 && idxOUT == 0)
-		return 0;
-
-	if (idxIN > idxOUT)
+	if (r != NULL)
 	{
-		imgCnt = idxIN - idxOUT;
+		imgCnt = FrameRing_Count(r);
+		ReleaseRing();
 	}
-	else
+	else if ((p = AcquirePacked()) != NULL)
 	{
-		imgCnt = buf_size - idxOUT + idxIN;
+		//frames still being compressed are counted as well
+		FrameCompressor_Flush(p);
+		imgCnt = FrameCompressor_Count(p);
+		ReleaseRing();
 	}
+
 	return imgCnt;
 }
 
@@ -528,50 +684,62 @@ JNIEXPORT jint JNICALL Java_com_almalence_plugins_capture_preshot_PreShot_GetIma
 //	return 1;
 //}
 
-//get data from buffer
-JNIEXPORT jbyteArray JNICALL Java_com_almalence_plugins_capture_preshot_PreShot_GetFromBufferNV21
+//get data from buffer into a native heap frame, returns its handle or 0
+JNIEXPORT jlong JNICALL Java_com_almalence_plugins_capture_preshot_PreShot_GetFromBufferToHeap
 (
 	JNIEnv* env,
 	jobject pObj,
 	jint idx,
-	jint W,
-	jint H,
 	jint mirrored
 )
 {
 	unsigned char *data;
+	unsigned char *src;
+	FrameRef frame;
+	FrameHandle h;
+	int rotate90;
 
-	jbyteArray jdata;
+	if (GetFrame(idx, &frame))
+		return 0;
 
-	jdata = env->NewByteArray(elemSize);
-	data = (unsigned char*)env->GetByteArrayElements(jdata, NULL);
+	src = (unsigned char*)frame.data;
 
-	if (1 != mirrored)
-	{
-		if (1 == *(orient_buffer+idx))
-			TransformNV21(frame_buffer+idx*elemSize, data, image_w, image_h, NULL, 0, 0, 1);
-		else if(3 == *(orient_buffer+idx))
-			TransformNV21(frame_buffer+idx*elemSize, data, image_w, image_h, NULL, 1, 1, 1);
-		else if(2 == *(orient_buffer+idx))
-			TransformNV21(frame_buffer+idx*elemSize, data, image_w, image_h, NULL, 1, 1, 0);
-		else
-			memcpy (data, frame_buffer+idx*elemSize, elemSize);
-	}
+	rotate90 = (1 == frame.tag) || (3 == frame.tag);
+	if (rotate90)
+		h = FrameHandle_Alloc(elemSize, FRAME_FORMAT_NV21, image_h, image_w, image_h);
 	else
+		h = FrameHandle_Alloc(elemSize, FRAME_FORMAT_NV21, image_w, image_h, image_w);
+
+	data = (unsigned char*)FrameHandle_Data(h, elemSize);
+	if (data != NULL)
 	{
-		if (1 == *(orient_buffer+idx))
-			TransformNV21(frame_buffer+idx*elemSize, data, image_w, image_h, NULL, 1, 1, 1);
-		else if(3 == *(orient_buffer+idx))
-			TransformNV21(frame_buffer+idx*elemSize, data, image_w, image_h, NULL, 0, 0, 1);
-		else if(2 == *(orient_buffer+idx))
-			TransformNV21(frame_buffer+idx*elemSize, data, image_w, image_h, NULL, 1, 1, 0);
+		if (1 != mirrored)
+		{
+			if (1 == frame.tag)
+				TransformNV21(src, data, image_w, image_h, NULL, 0, 0, 1);
+			else if(3 == frame.tag)
+				TransformNV21(src, data, image_w, image_h, NULL, 1, 1, 1);
+			else if(2 == frame.tag)
+				TransformNV21(src, data, image_w, image_h, NULL, 1, 1, 0);
+			else
+				memcpy (data, src, elemSize);
+		}
 		else
-			memcpy (data, frame_buffer+idx*elemSize, elemSize);
+		{
+			if (1 == frame.tag)
+				TransformNV21(src, data, image_w, image_h, NULL, 1, 1, 1);
+			else if(3 == frame.tag)
+				TransformNV21(src, data, image_w, image_h, NULL, 0, 0, 1);
+			else if(2 == frame.tag)
+				TransformNV21(src, data, image_w, image_h, NULL, 1, 1, 0);
+			else
+				memcpy (data, src, elemSize);
+		}
 	}
 
-	env->ReleaseByteArrayElements(jdata, (jbyte*)data, 0);
+	PutFrame(&frame);
 
-	return jdata;
+	return h;
 }
 
 ////get data from reserved buffer in JPEG format
@@ -645,24 +813,27 @@ JNIEXPORT jbyteArray JNICALL Java_com_almalence_plugins_capture_preshot_PreShot_
 //	return jdata;
 //}
 
-//get data from buffer in JPEG format without any rotation. ONLY FOR SLOW!!!
-JNIEXPORT jbyteArray JNICALL Java_com_almalence_plugins_capture_preshot_PreShot_GetFromBufferSimpleNV21
+//get data from buffer in JPEG format without any rotation into a native heap frame. ONLY FOR SLOW!!!
+JNIEXPORT jlong JNICALL Java_com_almalence_plugins_capture_preshot_PreShot_GetFromBufferSimpleToHeap
 (
 	JNIEnv* env,
 	jobject pObj,
 	jint idx
 )
 {
-	unsigned char *data;
-	jbyteArray jdata = env->NewByteArray(0);
+	FrameRef frame;
+	FrameHandle h;
 
-	jdata = env->NewByteArray(*(len_buffer + idx));
-	data = (unsigned char*)env->GetByteArrayElements(jdata, NULL);
-	memcpy (data, frame_buffer+idx*elemSize, *(len_buffer + idx));
+	if (GetFrame(idx, &frame))
+		return 0;
 
-	env->ReleaseByteArrayElements(jdata, (jbyte*)data, 0);
+	h = FrameHandle_Alloc(frame.length, FRAME_FORMAT_BYTES, 0, 0, 0);
+	if (h != 0)
+		memcpy (FrameHandle_Data(h, frame.length), frame.data, frame.length);
 
-	return jdata;
+	PutFrame(&frame);
+
+	return h;
 }
 
 ////free reserved buffer
@@ -4,6 +4,7 @@ include $(LOCAL_PATH)/../Flags.mk
 
 LOCAL_MODULE    := swapheap
 LOCAL_SRC_FILES := swapheap.cpp
+LOCAL_STATIC_LIBRARIES := utils-image
 LOCAL_LDLIBS := -llog
 
 include $(BUILD_SHARED_LIBRARY)
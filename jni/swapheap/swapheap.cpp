@@ -16,17 +16,22 @@ Portions created by Initial Developer are Copyright (C) 2013
 by Almalence Inc. All Rights Reserved.
 */
 
+#include <stdlib.h>
 #include <string.h>
 #include <stdio.h>
 #include <jni.h>
 #include <pthread.h>
 #include <android/log.h>
 
+#include "MemoryBudget.h"
+#include "FrameHandle.h"
+#include "FramePool.h"
+
 
 extern "C" {
 
 
-JNIEXPORT jint JNICALL Java_com_almalence_SwapHeap_SwapToHeap
+JNIEXPORT jlong JNICALL Java_com_almalence_SwapHeap_SwapToHeap
 (
 	JNIEnv* env,
 	jobject,
@@ -35,37 +40,126 @@ JNIEXPORT jint JNICALL Java_com_almalence_SwapHeap_SwapToHeap
 {
 	int data_length;
 	unsigned char *heap, *data;
+	FrameHandle h;
 
 	data_length = env->GetArrayLength(jdata);
-	data = (unsigned char*)env->GetByteArrayElements(jdata, NULL);
-
 
-	heap = (unsigned char *)malloc(data_length);
-	if (heap != NULL)
-		memcpy (heap, data, data_length);
-	else
+	// swapped frames are freed by processing plugins directly, so they are not
+	// reserved in the budget, only checked against it
+	if ((size_t)data_length > MemoryBudget_Available(MEMBUDGET_SWAPHEAP))
+	{
+		__android_log_print(ANDROID_LOG_ERROR, "SwapToHeap", "%d bytes exceed memory budget", data_length);
+		return 0;
+	}
+
+	heap = (unsigned char *)FramePool_Alloc(data_length);
+	if (heap == NULL)
+	{
 		__android_log_print(ANDROID_LOG_ERROR, "SwapToHeap", "heap is NULL");
+		return 0;
+	}
 
+	data = (unsigned char*)env->GetByteArrayElements(jdata, NULL);
+	memcpy (heap, data, data_length);
 	env->ReleaseByteArrayElements(jdata, (jbyte*)data, JNI_ABORT);
 
-	return (jint)heap;
+	h = FrameHandle_Create(heap, data_length, FRAME_FORMAT_BYTES, 0, 0, 0, NULL);
+	if (h == 0)
+		FramePool_Free(heap);
+
+	return h;
+}
+
+// Copies from a direct buffer, e.g. a camera2 image plane, without going
+// through a java array
+JNIEXPORT jlong JNICALL Java_com_almalence_SwapHeap_SwapDirectToHeap
+(
+	JNIEnv* env,
+	jobject,
+	jobject jbuffer,
+	jint offset,
+	jint data_length
+)
+{
+	unsigned char *heap, *data;
+	FrameHandle h;
+
+	data = (unsigned char*)env->GetDirectBufferAddress(jbuffer);
+	if ((data == NULL) || (offset < 0) || (data_length <= 0)
+		|| (offset + (jlong)data_length > env->GetDirectBufferCapacity(jbuffer)))
+		return 0;
+
+	if ((size_t)data_length > MemoryBudget_Available(MEMBUDGET_SWAPHEAP))
+	{
+		__android_log_print(ANDROID_LOG_ERROR, "SwapDirectToHeap", "%d bytes exceed memory budget", data_length);
+		return 0;
+	}
+
+	heap = (unsigned char *)FramePool_Alloc(data_length);
+	if (heap == NULL)
+	{
+		__android_log_print(ANDROID_LOG_ERROR, "SwapDirectToHeap", "heap is NULL");
+		return 0;
+	}
+
+	memcpy (heap, data + offset, data_length);
+
+	h = FrameHandle_Create(heap, data_length, FRAME_FORMAT_BYTES, 0, 0, 0, NULL);
+	if (h == 0)
+		FramePool_Free(heap);
+
+	return h;
+}
+
+// Frame is shared rather than duplicated: the returned handle is the same and
+// has to be released once more
+JNIEXPORT jlong JNICALL Java_com_almalence_SwapHeap_SwapYuvToHeap
+(
+	JNIEnv* env,
+	jobject,
+	jlong jdata,
+	jint jdata_length
+)
+{
+	if ((FrameHandle_Data(jdata, jdata_length) == NULL) || FrameHandle_Retain(jdata))
+		return 0;
+
+	return jdata;
+}
+
+// size of the frame in bytes, 0 if handle is not valid
+JNIEXPORT jint JNICALL Java_com_almalence_SwapHeap_GetLength
+(
+	JNIEnv* env,
+	jobject,
+	jlong jheap
+)
+{
+	FrameDesc desc;
+
+	if (FrameHandle_Get(jheap, &desc))
+		return 0;
+
+	return desc.size;
 }
 
-JNIEXPORT jint JNICALL Java_com_almalence_SwapHeap_SwapYuvToHeap
+// Direct buffer over the frame. Frame stays owned by the handle: the buffer
+// must not be used once the handle is released
+JNIEXPORT jobject JNICALL Java_com_almalence_SwapHeap_GetBuffer
 (
 	JNIEnv* env,
 	jobject,
-	jint jdata,
+	jlong jheap,
 	jint jdata_length
 )
 {
-	unsigned char *heap;
+	void *heap;
 
-	heap = (unsigned char *)malloc(jdata_length);
-	if (heap)
-		memcpy (heap, (unsigned char*)jdata, jdata_length);
+	heap = FrameHandle_Data(jheap, jdata_length);
+	if (heap == NULL)
+		return NULL;
 
-	return (jint)heap;
+	return env->NewDirectByteBuffer(heap, jdata_length);
 }
 
 
@@ -73,22 +167,24 @@ JNIEXPORT jbyteArray JNICALL Java_com_almalence_SwapHeap_CopyFromHeap
 (
 	JNIEnv* env,
 	jobject,
-	jint jheap,
+	jlong jheap,
 	jint jdata_length
 )
 {
 	unsigned char *heap, *data;
 	jbyteArray jdata;
 
-	jdata = env->NewByteArray(jdata_length);
+	heap = (unsigned char *)FrameHandle_Data(jheap, jdata_length);
+	if (heap == NULL)
+		return NULL;
 
-	heap = (unsigned char *)jheap;
-
-	data = (unsigned char*)env->GetByteArrayElements(jdata, NULL);
+	jdata = env->NewByteArray(jdata_length);
+	if (jdata == NULL)
+		return NULL;
 
+	data = (unsigned char*)env->GetPrimitiveArrayCritical(jdata, NULL);
 	memcpy (data, heap, jdata_length);
-
-	env->ReleaseByteArrayElements(jdata, (jbyte*)data, 0);
+	env->ReleasePrimitiveArrayCritical(jdata, data, 0);
 
 	return jdata;
 }
@@ -97,13 +193,13 @@ JNIEXPORT jbyteArray JNICALL Java_com_almalence_SwapHeap_SwapFromHeap
 (
 	JNIEnv* env,
 	jobject thiz,
-	jint jheap,
+	jlong jheap,
 	jint jdata_length
 )
 {
 	jbyteArray jdata = Java_com_almalence_SwapHeap_CopyFromHeap(env, thiz, jheap, jdata_length);
 
-	free ((void*)jheap);
+	FrameHandle_Release(jheap);
 
 	return jdata;
 }
@@ -112,12 +208,10 @@ JNIEXPORT jboolean JNICALL Java_com_almalence_SwapHeap_FreeFromHeap
 (
 	JNIEnv* env,
 	jobject,
-	jint jheap
+	jlong jheap
 )
 {
-	free ((void*)jheap);
-
-	return 1;
+	return FrameHandle_Release(jheap) == 0;
 }
 
 
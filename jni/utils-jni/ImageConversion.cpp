@@ -23,6 +23,9 @@ by Almalence Inc. All Rights Reserved.
 #include <android/log.h>
 
 #include "ImageConversionUtils.h"
+#include "MemoryBudget.h"
+#include "FrameHandle.h"
+#include "FramePool.h"
 
 #define BMP_R(p)	((p) & 0xFF)
 #define BMP_G(p)	(((p)>>8) & 0xFF)
@@ -50,21 +53,15 @@ jbyte NightGamma[511] =
 
 // summation with tone-curve applied after
 // used in night-mode viewfinder
-extern "C" JNIEXPORT void JNICALL Java_com_almalence_util_ImageConversion_sumByteArraysNV21
+static void SumFramesNV21
 (
-	JNIEnv* env,
-	jobject thiz,
-	jbyteArray data1,
-	jbyteArray data2,
-	jbyteArray out,
+	const jbyte* frame1,
+	const jbyte* frame2,
+	jbyte* frame_res,
 	jint width,
 	jint height
 )
 {
-	jbyte* frame1 = env->GetByteArrayElements(data1, 0);
-	jbyte* frame2 = env->GetByteArrayElements(data2, 0);
-	jbyte* frame_res = env->GetByteArrayElements(out, 0);
-
 	jint frameSize = width * height;
 
 	for (jint j = 0, yp = 0; j < height; j++) {
@@ -93,10 +90,30 @@ extern "C" JNIEXPORT void JNICALL Java_com_almalence_util_ImageConversion_sumByt
 		frame_res[yp] = NightGamma[y1+y2]; // (jbyte)(y0);
 	  }
 	}
+}
 
-	env->ReleaseByteArrayElements(out, frame_res, 0);
-	env->ReleaseByteArrayElements(data2, frame2, 0);
-	env->ReleaseByteArrayElements(data1, frame1, 0);
+// frames are pinned rather than copied, inputs are not written back
+extern "C" JNIEXPORT void JNICALL Java_com_almalence_util_ImageConversion_sumByteArraysNV21
+(
+	JNIEnv* env,
+	jobject thiz,
+	jbyteArray data1,
+	jbyteArray data2,
+	jbyteArray out,
+	jint width,
+	jint height
+)
+{
+	jbyte* frame1 = (jbyte*)env->GetPrimitiveArrayCritical(data1, 0);
+	jbyte* frame2 = (jbyte*)env->GetPrimitiveArrayCritical(data2, 0);
+	jbyte* frame_res = (jbyte*)env->GetPrimitiveArrayCritical(out, 0);
+
+	if (frame1 && frame2 && frame_res)
+		SumFramesNV21(frame1, frame2, frame_res, width, height);
+
+	if (frame_res) env->ReleasePrimitiveArrayCritical(out, frame_res, 0);
+	if (frame2) env->ReleasePrimitiveArrayCritical(data2, frame2, JNI_ABORT);
+	if (frame1) env->ReleasePrimitiveArrayCritical(data1, frame1, JNI_ABORT);
 }
 
 
@@ -131,8 +148,8 @@ extern "C" JNIEXPORT void JNICALL Java_com_almalence_util_ImageConversion_Transf
 (
 	JNIEnv* env,
 	jobject thiz,
-	int InPic,
-	int OutPic,
+	jlong InPic,
+	jlong OutPic,
 	int sx,
 	int sy,
 	int flipLR,
@@ -140,11 +157,40 @@ extern "C" JNIEXPORT void JNICALL Java_com_almalence_util_ImageConversion_Transf
 	int rotate90
 )
 {
-	TransformNV21((unsigned char*)InPic, (unsigned char*)OutPic, sx, sy, NULL, flipLR, flipUD, rotate90);
+	int size = sx*sy+2*((sx+1)/2)*((sy+1)/2);
+	unsigned char *in = (unsigned char*)FrameHandle_Data(InPic, size);
+	unsigned char *out = (unsigned char*)FrameHandle_Data(OutPic, size);
+
+	if ((in != NULL) && (out != NULL))
+		TransformNV21(in, out, sx, sy, NULL, flipLR, flipUD, rotate90);
+}
+
+// returns (tiled, reference) microseconds per call for each benchmark case
+// followed by 1 if outputs matched, null if memory could not be allocated
+extern "C" JNIEXPORT jintArray JNICALL Java_com_almalence_util_ImageConversion_benchmarkTransformNV21
+(
+	JNIEnv* env,
+	jclass,
+	jint sx,
+	jint sy,
+	jint iterations
+)
+{
+	int results[2*TRANSFORM_BENCHMARK_CASES+1];
+
+	results[2*TRANSFORM_BENCHMARK_CASES] = BenchmarkTransformNV21(sx, sy, iterations, results);
+	if (results[2*TRANSFORM_BENCHMARK_CASES] < 0)
+		return NULL;
+
+	jintArray res = env->NewIntArray(2*TRANSFORM_BENCHMARK_CASES+1);
+	if (res)
+		env->SetIntArrayRegion(res, 0, 2*TRANSFORM_BENCHMARK_CASES+1, (jint*)results);
+
+	return res;
 }
 
 
-extern "C" JNIEXPORT jint JNICALL Java_com_almalence_util_ImageConversion_JpegConvert
+extern "C" JNIEXPORT jlong JNICALL Java_com_almalence_util_ImageConversion_JpegConvert
 (
 	JNIEnv* env,
 	jobject thiz,
@@ -162,27 +208,27 @@ extern "C" JNIEXPORT jint JNICALL Java_com_almalence_util_ImageConversion_JpegCo
 	data_length = env->GetArrayLength(jdata);
 	data = (unsigned char*)env->GetByteArrayElements(jdata, NULL);
 
-	unsigned char* out = (unsigned char*)malloc(sx*sy+2*((sx+1)/2)*((sy+1)/2));
+	unsigned char* out = (unsigned char*)FramePool_Alloc(sx*sy+2*((sx+1)/2)*((sy+1)/2));
 
 	if (out != NULL)
 	{
 		if (JPEG2NV21(out, data, data_length, sx, sy, jrot, mirror, rotationDegree) == 0)
 		{
-			free(out);
+			FramePool_Free(out);
 			out = NULL;
 		}
 	}
 
 	env->ReleaseByteArrayElements(jdata, (jbyte*)data, JNI_ABORT);
 
-	return (jint)out;
+	return FrameHandle_Create(out, sx*sy+2*((sx+1)/2)*((sy+1)/2), FRAME_FORMAT_NV21, sx, sy, sx, NULL);
 }
 
-extern "C" JNIEXPORT jint JNICALL Java_com_almalence_util_ImageConversion_JpegConvertN
+extern "C" JNIEXPORT jlong JNICALL Java_com_almalence_util_ImageConversion_JpegConvertN
 (
 	JNIEnv* env,
 	jobject thiz,
-	jint jpeg,
+	jlong jpeg,
 	jint jpeg_length,
 	jint sx,
 	jint sy,
@@ -191,29 +237,38 @@ extern "C" JNIEXPORT jint JNICALL Java_com_almalence_util_ImageConversion_JpegCo
 	jint rotationDegree
 )
 {
-	int data_length;
 	unsigned char *data;
+	unsigned char *out;
+
+	data = (unsigned char*)FrameHandle_Data(jpeg, jpeg_length);
+	if (data == NULL)
+		return 0;
 
-	unsigned char* out = (unsigned char*)malloc(sx*sy+2*((sx+1)/2)*((sy+1)/2));
+	out = (unsigned char*)FramePool_Alloc(sx*sy+2*((sx+1)/2)*((sy+1)/2));
 
 	if (out != NULL)
 	{
-		if (JPEG2NV21(out, (unsigned char*)jpeg, jpeg_length, sx, sy, jrot, mirror, rotationDegree) == 0)
+		if (JPEG2NV21(out, data, jpeg_length, sx, sy, jrot, mirror, rotationDegree) == 0)
 		{
-			free(out);
+			FramePool_Free(out);
 			out = NULL;
 		}
 	}
 
-	return (jint)out;
+	return FrameHandle_Create(out, sx*sy+2*((sx+1)/2)*((sy+1)/2), FRAME_FORMAT_NV21, sx, sy, sx, NULL);
 }
 
 extern "C" JNIEXPORT void JNICALL Java_com_almalence_util_ImageConversion_convertNV21toGLN(
-		JNIEnv *env, jclass clazz, jint ain, jbyteArray aout, jint width,	jint height, jint outWidth, jint outHeight)
+		JNIEnv *env, jclass clazz, jlong ain, jbyteArray aout, jint width,	jint height, jint outWidth, jint outHeight)
 {
+	unsigned char *in = (unsigned char*)FrameHandle_Data(ain, width*height+2*((width+1)/2)*((height+1)/2));
+
+	if (in == NULL)
+		return;
+
 	jbyte *cImageOut = env->GetByteArrayElements(aout, 0);
 
-	NV21_to_RGB_scaled_rotated((unsigned char*)ain, width, height, 0, 0, width, height, outWidth, outHeight, 4, (unsigned char*)cImageOut);
+	NV21_to_RGB_scaled_rotated(in, width, height, 0, 0, width, height, outWidth, outHeight, 4, (unsigned char*)cImageOut);
 
 	env->ReleaseByteArrayElements(aout, cImageOut, 0);
 }
@@ -232,71 +287,29 @@ extern "C" JNIEXPORT void JNICALL Java_com_almalence_util_ImageConversion_conver
 
 extern "C" JNIEXPORT void JNICALL Java_com_almalence_util_ImageConversion_resizeJpeg2RGBA(
 		JNIEnv *env, jclass clazz,
-		jint jpeg,
+		jlong jpeg,
 		jint jpeg_length,
 		jbyteArray rgb_out,
 		jint inHeight, jint inWidth,
 		jint outWidth, jint outHeight,
 		jboolean mirror)
 {
-	unsigned int * data_rgba = (unsigned int*)malloc(inHeight*inWidth*sizeof(unsigned int));
-	if (data_rgba == NULL)
-	{
-		__android_log_print(ANDROID_LOG_ERROR, "Almalence", "nativeresizeJpeg2RGBA(): malloc() returned NULL");
-		return;
-	}
+	unsigned char *jpeg_bytes = (unsigned char*)FrameHandle_Data(jpeg, jpeg_length);
 
-	JPEG2RGBA((unsigned char*)data_rgba, (unsigned char*)jpeg, jpeg_length);
+	if (jpeg_bytes == NULL)
+		return;
 
 	unsigned char * rgb_bytes = (unsigned char*)env->GetByteArrayElements(rgb_out, 0);
 
-	const int tripleHeight = (outHeight - 1) * 4;
-	int yoffset = tripleHeight;
-	int cr, cb, cg;
-	int offset;
-
-	// down-scaling with area averaging gives a higher-quality result comparing to skia scaling
-	int navg = max(1, 3*max(inWidth/outWidth, inHeight/outHeight)/2);
-	int norm = 65536/(navg*navg);
-
-	for (int i = 0; i < outHeight; i++)
+	// down-scaling with area averaging gives a higher-quality result comparing to skia scaling,
+	// jpeg is decoded at reduced size, no full resolution frame is allocated
+	if (!JPEG2RGBA_downscaled_rotated(rgb_bytes, jpeg_bytes, jpeg_length, outWidth, outHeight))
 	{
-		offset = yoffset;
-
-		int ys = i*inHeight/outHeight;
-		int ye = min(ys+navg, inHeight);
-
-		for (int j = 0; j < outWidth; j++)
-		{
-			int xs = j*inWidth/outWidth;
-			int xe = min(xs+navg, inWidth);
-
-			cr = cb = cg = 0;
-			for (int ii=ys; ii<ye; ++ii)
-				for (int jj=xs; jj<xe; ++jj)
-				{
-					cr += BMP_R(data_rgba[ii * inWidth + jj]);
-					cg += BMP_G(data_rgba[ii * inWidth + jj]);
-					cb += BMP_B(data_rgba[ii * inWidth + jj]);
-				}
-
-			cr = norm*cr/65536;
-			cg = norm*cg/65536;
-			cb = norm*cb/65536;
-
-			rgb_bytes[offset++] = cr;
-			rgb_bytes[offset++] = cg;
-			rgb_bytes[offset++] = cb;
-			rgb_bytes[offset++] = 255;
-
-			offset += tripleHeight;
-		}
-
-		yoffset -= 4;
+		__android_log_print(ANDROID_LOG_ERROR, "Almalence", "nativeresizeJpeg2RGBA(): jpeg decoding failed");
+		env->ReleaseByteArrayElements(rgb_out, (jbyte*)rgb_bytes, JNI_ABORT);
+		return;
 	}
 
-	free (data_rgba);
-
 	addRoundCornersRGBA8888(rgb_bytes, outWidth, outHeight);
 
 	if (mirror)
@@ -317,27 +330,16 @@ extern "C" JNIEXPORT void JNICALL Java_com_almalence_util_ImageConversion_addCor
 
 extern "C" JNIEXPORT jintArray JNICALL Java_com_almalence_util_HeapUtil_getMemoryInfo(JNIEnv* env, jclass)
 {
-	FILE *f;
-	char dummy[1024];
 	int MbInfo[2];
+	size_t total, available;
 
-	// the fields we want
-	unsigned long curr_mem_used;
-	unsigned long curr_mem_free;
-	unsigned long curr_mem_buffers;
-	unsigned long curr_mem_cached;
+	total = MemoryBudget_SystemTotal();
+	// idle pooled frames are reused before any new memory is taken
+	available = MemoryBudget_SystemAvailable() + FramePool_IdleBytes();
+	if (total == 0) return 0;
 
-	// 'file' stat seems to give the most reliable results
-	f = fopen ("/proc/meminfo", "r");
-	if (f==NULL) return 0;
-	fscanf(f, "%s %ld %s ", dummy, &curr_mem_used, dummy);
-	fscanf(f, "%s %ld %s ", dummy, &curr_mem_free, dummy);
-	fscanf(f, "%s %ld %s ", dummy, &curr_mem_buffers, dummy);
-	fscanf(f, "%s %ld %s ", dummy, &curr_mem_cached, dummy);
-	fclose(f);
-
-	MbInfo[0] = curr_mem_used / 1024;
-	MbInfo[1] = (curr_mem_free + curr_mem_cached) / 1024;
+	MbInfo[0] = (total - available) / (1024*1024);
+	MbInfo[1] = available / (1024*1024);
 
 	//LOGI ("memory used: %ld  free: %ld", MbInfo[0], MbInfo[1]);
 
@@ -347,3 +349,30 @@ extern "C" JNIEXPORT jintArray JNICALL Java_com_almalence_util_HeapUtil_getMemor
 
     return memInfo;
 }
+
+extern "C" JNIEXPORT jintArray JNICALL Java_com_almalence_util_HeapUtil_getFramePoolStats(JNIEnv* env, jclass)
+{
+	FramePoolStats stats;
+	jint values[6];
+	jintArray jstats;
+
+	FramePool_GetStats(&stats);
+
+	values[0] = stats.hits;
+	values[1] = stats.misses;
+	values[2] = stats.returned;
+	values[3] = stats.dropped;
+	values[4] = stats.idleBuffers;
+	values[5] = stats.idleBytes / (1024*1024);
+
+	jstats = env->NewIntArray(6);
+	if (jstats != NULL)
+		env->SetIntArrayRegion(jstats, 0, 6, values);
+
+	return jstats;
+}
+
+extern "C" JNIEXPORT void JNICALL Java_com_almalence_util_HeapUtil_trimFramePool(JNIEnv*, jclass)
+{
+	FramePool_Trim();
+}
@@ -2,8 +2,12 @@ LOCAL_PATH := $(call my-dir)
 
 include $(LOCAL_PATH)/../Flags.mk
 
+ifeq ($(TARGET_ARCH_ABI),armeabi-v7a)
+LOCAL_ARM_NEON := true
+endif
+
 LOCAL_MODULE    := utils-image
-LOCAL_SRC_FILES := ImageConversionUtils.cpp
+LOCAL_SRC_FILES := ImageConversionUtils.cpp ColorConversion.cpp MemoryBudget.cpp FrameHandle.cpp FramePool.cpp
 LOCAL_STATIC_LIBRARIES := jpeg gomp
 LOCAL_EXPORT_C_INCLUDES := $(LOCAL_PATH)
 LOCAL_LDLIBS := -ldl -llog
@@ -0,0 +1,329 @@
+/*
+The contents of this file are subject to the Mozilla Public License
+Version 1.1 (the "License"); you may not use this file except in
+compliance with the License. You may obtain a copy of the License at
+http://www.mozilla.org/MPL/
+
+Software distributed under the License is distributed on an "AS IS"
+basis, WITHOUT WARRANTY OF ANY KIND, either express or implied. See the
+License for the specific language governing rights and limitations
+under the License.
+
+The Original Code is collection of files collectively known as Open Camera.
+
+The Initial Developer of the Original Code is Almalence Inc.
+Portions created by Initial Developer are Copyright (C) 2013
+by Almalence Inc. All Rights Reserved.
+*/
+
+#include <string.h>
+#include <stdlib.h>
+#include <omp.h>
+
+#if defined(__ARM_NEON__) || defined(__ARM_NEON)
+#include <arm_neon.h>
+#define CSC_NEON
+#elif defined(__SSE2__)
+#include <emmintrin.h>
+#define CSC_SSE2
+#endif
+
+#include "ColorConversion.h"
+
+
+typedef unsigned char Uint8;
+
+
+// 128*Y is a multiple of 128, so it is taken out of the shift in CSC_RV/GUV/BU.
+// This keeps all intermediate values within 16 bits and gives bit-exact results in SIMD.
+#define	CLIP8(x)			( (x)<0 ? 0 : (x)>255 ? 255 : (x) )
+
+// rows converted at once before being written out as columns in rotate mode
+#define CSC_ROTATE_ROWS		8
+
+
+static inline void StorePixel(Uint8 *out, int format, int r, int g, int b)
+{
+	switch (format)
+	{
+	case CSC_FORMAT_BGRA:
+		out[0] = b; out[1] = g; out[2] = r; out[3] = 255;
+		break;
+	case CSC_FORMAT_RGBA:
+		out[0] = r; out[1] = g; out[2] = b; out[3] = 255;
+		break;
+	case CSC_FORMAT_RGB:
+		out[0] = r; out[1] = g; out[2] = b;
+		break;
+	default:
+		out[0] = b; out[1] = g; out[2] = r;
+		break;
+	}
+}
+
+
+#if defined(CSC_SSE2)
+// 8 pixels, results as 16 bit values
+static inline void ConvertSSE2(const Uint8 *y, const Uint8 *u, const Uint8 *v, __m128i *r, __m128i *g, __m128i *b)
+{
+	const __m128i zero = _mm_setzero_si128();
+	const __m128i c128 = _mm_set1_epi16(128);
+
+	__m128i yy = _mm_unpacklo_epi8(_mm_loadl_epi64((const __m128i*)y), zero);
+	__m128i uu = _mm_sub_epi16(_mm_unpacklo_epi8(_mm_loadl_epi64((const __m128i*)u), zero), c128);
+	__m128i vv = _mm_sub_epi16(_mm_unpacklo_epi8(_mm_loadl_epi64((const __m128i*)v), zero), c128);
+
+	*r = _mm_add_epi16(yy, _mm_srai_epi16(_mm_mullo_epi16(vv, _mm_set1_epi16(176)), 7));
+	*g = _mm_add_epi16(yy, _mm_srai_epi16(_mm_add_epi16(
+			_mm_mullo_epi16(vv, _mm_set1_epi16(-89)),
+			_mm_mullo_epi16(uu, _mm_set1_epi16(-43))), 7));
+	*b = _mm_add_epi16(yy, _mm_srai_epi16(_mm_mullo_epi16(uu, _mm_set1_epi16(222)), 7));
+}
+
+// interleave 16 pixels of 4 planes into 4-byte pixels
+static inline void Store4SSE2(Uint8 *out, __m128i c0, __m128i c1, __m128i c2, __m128i c3)
+{
+	__m128i lo01 = _mm_unpacklo_epi8(c0, c1);
+	__m128i hi01 = _mm_unpackhi_epi8(c0, c1);
+	__m128i lo23 = _mm_unpacklo_epi8(c2, c3);
+	__m128i hi23 = _mm_unpackhi_epi8(c2, c3);
+
+	_mm_storeu_si128((__m128i*)(out), _mm_unpacklo_epi16(lo01, lo23));
+	_mm_storeu_si128((__m128i*)(out+16), _mm_unpackhi_epi16(lo01, lo23));
+	_mm_storeu_si128((__m128i*)(out+32), _mm_unpacklo_epi16(hi01, hi23));
+	_mm_storeu_si128((__m128i*)(out+48), _mm_unpackhi_epi16(hi01, hi23));
+}
+#endif
+
+
+void YUV_to_RGB_row
+(
+	const unsigned char *y,
+	const unsigned char *u,
+	const unsigned char *v,
+	int n,
+	int format,
+	unsigned char *out
+)
+{
+	const int bpp = CSC_FORMAT_BPP(format);
+	int x = 0;
+
+#if defined(CSC_NEON)
+	const int16x8_t c128 = vdupq_n_s16(128);
+
+	for (; x+8<=n; x+=8)
+	{
+		int16x8_t yy = vreinterpretq_s16_u16(vmovl_u8(vld1_u8(y+x)));
+		int16x8_t uu = vsubq_s16(vreinterpretq_s16_u16(vmovl_u8(vld1_u8(u+x))), c128);
+		int16x8_t vv = vsubq_s16(vreinterpretq_s16_u16(vmovl_u8(vld1_u8(v+x))), c128);
+
+		uint8x8_t r = vqmovun_s16(vaddq_s16(yy, vshrq_n_s16(vmulq_n_s16(vv, 176), 7)));
+		uint8x8_t g = vqmovun_s16(vaddq_s16(yy, vshrq_n_s16(vmlaq_n_s16(vmulq_n_s16(vv, -89), uu, -43), 7)));
+		uint8x8_t b = vqmovun_s16(vaddq_s16(yy, vshrq_n_s16(vmulq_n_s16(uu, 222), 7)));
+
+		if (bpp == 4)
+		{
+			uint8x8x4_t p;
+			p.val[0] = format == CSC_FORMAT_BGRA ? b : r;
+			p.val[1] = g;
+			p.val[2] = format == CSC_FORMAT_BGRA ? r : b;
+			p.val[3] = vdup_n_u8(255);
+			vst4_u8(out+x*4, p);
+		}
+		else
+		{
+			uint8x8x3_t p;
+			p.val[0] = format == CSC_FORMAT_RGB ? r : b;
+			p.val[1] = g;
+			p.val[2] = format == CSC_FORMAT_RGB ? b : r;
+			vst3_u8(out+x*3, p);
+		}
+	}
+#elif defined(CSC_SSE2)
+	const __m128i alpha = _mm_set1_epi8(-1);
+
+	for (; x+16<=n; x+=16)
+	{
+		__m128i r0, g0, b0, r1, g1, b1;
+
+		ConvertSSE2(y+x, u+x, v+x, &r0, &g0, &b0);
+		ConvertSSE2(y+x+8, u+x+8, v+x+8, &r1, &g1, &b1);
+
+		__m128i r = _mm_packus_epi16(r0, r1);
+		__m128i g = _mm_packus_epi16(g0, g1);
+		__m128i b = _mm_packus_epi16(b0, b1);
+
+		if (format == CSC_FORMAT_BGRA)
+			Store4SSE2(out+x*4, b, g, r, alpha);
+		else if (format == CSC_FORMAT_RGBA)
+			Store4SSE2(out+x*4, r, g, b, alpha);
+		else
+		{
+			// no byte shuffles in SSE2, interleave 3-byte pixels in scalar code
+			Uint8 rr[16], gg[16], bb[16];
+			int i;
+
+			_mm_storeu_si128((__m128i*)rr, r);
+			_mm_storeu_si128((__m128i*)gg, g);
+			_mm_storeu_si128((__m128i*)bb, b);
+			for (i=0; i<16; ++i)
+				StorePixel(out+(x+i)*3, format, rr[i], gg[i], bb[i]);
+		}
+	}
+#endif
+
+	for (; x<n; ++x)
+	{
+		int Y = y[x];
+		int U = u[x]-128;
+		int V = v[x]-128;
+
+		StorePixel(out+x*bpp, format, CLIP8(Y+CSC_RV(V)), CLIP8(Y+CSC_GUV(U, V)), CLIP8(Y+CSC_BU(U)));
+	}
+}
+
+
+// split a row of interleaved VU pairs into per-pixel U and V
+static void SplitVURow(const Uint8 *vu, Uint8 *u, Uint8 *v, int n)
+{
+	int x = 0;
+
+#if defined(CSC_NEON)
+	for (; x+16<=n; x+=16)
+	{
+		uint8x8x2_t p = vld2_u8(vu+x);
+		uint8x8x2_t vv, uu;
+
+		vv.val[0] = vv.val[1] = p.val[0];
+		uu.val[0] = uu.val[1] = p.val[1];
+		vst2_u8(v+x, vv);
+		vst2_u8(u+x, uu);
+	}
+#elif defined(CSC_SSE2)
+	const __m128i mask = _mm_set1_epi16(0x00FF);
+
+	for (; x+16<=n; x+=16)
+	{
+		__m128i p = _mm_loadu_si128((const __m128i*)(vu+x));
+		__m128i vv = _mm_and_si128(p, mask);
+		__m128i uu = _mm_srli_epi16(p, 8);
+
+		_mm_storeu_si128((__m128i*)(v+x), _mm_or_si128(vv, _mm_slli_epi16(vv, 8)));
+		_mm_storeu_si128((__m128i*)(u+x), _mm_or_si128(uu, _mm_slli_epi16(uu, 8)));
+	}
+#endif
+
+	for (; x<n; ++x)
+	{
+		v[x] = vu[x&~1];
+		u[x] = vu[x|1];
+	}
+}
+
+
+void NV21_to_RGB_convert
+(
+	const unsigned char *nv21,
+	int width,
+	int height,
+	int x0,
+	int y0,
+	int wCrop,
+	int hCrop,
+	int outWidth,
+	int outHeight,
+	int format,
+	int rotate90,
+	unsigned char *out
+)
+{
+	const int bpp = CSC_FORMAT_BPP(format);
+	const unsigned char *pUV = nv21 + width*height;
+	// no horizontal scaling and crop on a chroma pair boundary - rows can be read directly
+	const int direct = (wCrop == outWidth) && !(x0&1);
+	int *xidx = NULL;
+	int j;
+
+	if (!direct)
+	{
+		xidx = (int*)malloc(outWidth*sizeof(int));
+		if (xidx == NULL)
+			return;
+		for (j=0; j<outWidth; ++j)
+			xidx[j] = x0 + j*wCrop/outWidth;
+	}
+
+	#pragma omp parallel
+	{
+		int i0;
+		Uint8 *yrow = (Uint8*)malloc(outWidth*3 + (rotate90 ? CSC_ROTATE_ROWS*outWidth*bpp : 0));
+		Uint8 *urow = yrow + outWidth;
+		Uint8 *vrow = urow + outWidth;
+		Uint8 *tmp = vrow + outWidth;
+
+		#pragma omp for schedule(static)
+		for (i0=0; i0<outHeight; i0+=CSC_ROTATE_ROWS)
+		{
+			int i, j, k;
+			int nrows = outHeight-i0 < CSC_ROTATE_ROWS ? outHeight-i0 : CSC_ROTATE_ROWS;
+
+			if (yrow == NULL)
+				continue;
+
+			for (k=0; k<nrows; ++k)
+			{
+				i = i0+k;
+
+				int is = y0 + i*hCrop/outHeight;
+				const Uint8 *srcY = nv21 + is*width;
+				const Uint8 *srcVU = pUV + (is/2)*width;
+				const Uint8 *py;
+
+				if (direct)
+				{
+					py = srcY + x0;
+					SplitVURow(srcVU + x0, urow, vrow, outWidth);
+				}
+				else
+				{
+					for (j=0; j<outWidth; ++j)
+					{
+						int js = xidx[j];
+						yrow[j] = srcY[js];
+						vrow[j] = srcVU[js&~1];
+						urow[j] = srcVU[js|1];
+					}
+					py = yrow;
+				}
+
+				YUV_to_RGB_row(py, urow, vrow, outWidth, format,
+					rotate90 ? tmp + k*outWidth*bpp : out + i*outWidth*bpp);
+			}
+
+			if (rotate90)
+			{
+				// input row i becomes output column outHeight-1-i, so the group
+				// of rows fills a contiguous run in every output row
+				for (j=0; j<outWidth; ++j)
+				{
+					Uint8 *dst = out + (j*outHeight + outHeight-i0-nrows)*bpp;
+
+					if (bpp == 4)
+						for (k=nrows-1; k>=0; --k, dst+=4)
+							memcpy(dst, tmp + (k*outWidth + j)*4, 4);
+					else
+						for (k=nrows-1; k>=0; --k, dst+=3)
+						{
+							const Uint8 *src = tmp + (k*outWidth + j)*3;
+							dst[0] = src[0]; dst[1] = src[1]; dst[2] = src[2];
+						}
+				}
+			}
+		}
+
+		free(yrow);
+	}
+
+	free(xidx);
+}
@@ -0,0 +1,77 @@
+/*
+The contents of this file are subject to the Mozilla Public License
+Version 1.1 (the "License"); you may not use this file except in
+compliance with the License. You may obtain a copy of the License at
+http://www.mozilla.org/MPL/
+
+Software distributed under the License is distributed on an "AS IS"
+basis, WITHOUT WARRANTY OF ANY KIND, either express or implied. See the
+License for the specific language governing rights and limitations
+under the License.
+
+The Original Code is collection of files collectively known as Open Camera.
+
+The Initial Developer of the Original Code is Almalence Inc.
+Portions created by Initial Developer are Copyright (C) 2013
+by Almalence Inc. All Rights Reserved.
+*/
+
+#ifndef __COLORCONVERSION_H__
+#define __COLORCONVERSION_H__
+
+// output pixel layouts, in memory byte order
+#define CSC_FORMAT_BGRA		0	// Android Bitmap ARGB_8888 / int[] 0xAARRGGBB, alpha = 255
+#define CSC_FORMAT_RGBA		1	// GL RGBA, alpha = 255
+#define CSC_FORMAT_RGB		2	// GL RGB
+#define CSC_FORMAT_BGR		3
+
+// bytes per pixel of a CSC_FORMAT_*
+#define CSC_FORMAT_BPP(f)	((f) <= CSC_FORMAT_RGBA ? 4 : 3)
+
+// YUV -> RGB, same coefficients as used across the project:
+//   R = (128*Y + 176*(V-128)) >> 7
+//   G = (128*Y - 89*(V-128) - 43*(U-128)) >> 7
+//   B = (128*Y + 222*(U-128)) >> 7
+// expressed as offsets added to Y before clipping, u = U-128, v = V-128
+#define CSC_RV(v)			((176*(v)) >> 7)
+#define CSC_GUV(u,v)		((-89*(v)-43*(u)) >> 7)
+#define CSC_BU(u)			((222*(u)) >> 7)
+
+
+// convert a crop of NV21 image into RGB with nearest-neighbour scaling
+// and optional 90 degree clockwise rotation
+//
+// Input crop (x0, y0, wCrop, hCrop) is scaled to outWidth x outHeight.
+// With rotate90 the output is outHeight pixels wide and outWidth pixels high.
+// Output rows are packed (no padding).
+//
+void NV21_to_RGB_convert
+(
+	const unsigned char *nv21,
+	int width,
+	int height,
+	int x0,
+	int y0,
+	int wCrop,
+	int hCrop,
+	int outWidth,
+	int outHeight,
+	int format,
+	int rotate90,
+	unsigned char *out
+);
+
+
+// convert a row of n pixels given as separate Y, U and V samples
+// (one U and V per pixel) into the given format
+void YUV_to_RGB_row
+(
+	const unsigned char *y,
+	const unsigned char *u,
+	const unsigned char *v,
+	int n,
+	int format,
+	unsigned char *out
+);
+
+#endif // __COLORCONVERSION_H__
@@ -0,0 +1,271 @@
+/*
+The contents of this file are subject to the Mozilla Public License
+Version 1.1 (the "License"); you may not use this file except in
+compliance with the License. You may obtain a copy of the License at
+http://www.mozilla.org/MPL/
+
+Software distributed under the License is distributed on an "AS IS"
+basis, WITHOUT WARRANTY OF ANY KIND, either express or implied. See the
+License for the specific language governing rights and limitations
+under the License.
+
+The Original Code is collection of files collectively known as Open Camera.
+
+The Initial Developer of the Original Code is Almalence Inc.
+Portions created by Initial Developer are Copyright (C) 2013
+by Almalence Inc. All Rights Reserved.
+*/
+
+#include <stdlib.h>
+#include <string.h>
+#include <pthread.h>
+#include <android/log.h>
+
+#include "FrameHandle.h"
+#include "FramePool.h"
+
+#define LOG_TAG "FrameHandle"
+#define LOGE(...) __android_log_print(ANDROID_LOG_ERROR, LOG_TAG, __VA_ARGS__)
+
+
+typedef struct
+{
+	FrameDesc desc;
+	FrameFreeProc freeProc;
+	int owned;
+	int refs;			// 0 - entry is free
+	unsigned int gen;	// incremented each time the entry is freed
+	int nextFree;
+} HandleEntry;
+
+// handle = gen << 32 | (index + 1)
+#define HANDLE_INDEX(h)		((int)((unsigned long long)(h) & 0xffffffffu) - 1)
+#define HANDLE_GEN(h)		((unsigned int)((unsigned long long)(h) >> 32))
+#define MAKE_HANDLE(i, g)	((FrameHandle)(((unsigned long long)(g) << 32) | (unsigned int)((i) + 1)))
+
+#define INITIAL_ENTRIES		64
+
+static pthread_mutex_t table_lock = PTHREAD_MUTEX_INITIALIZER;
+static HandleEntry *table = NULL;
+static int table_size = 0;
+static int first_free = -1;
+
+
+// table_lock is held
+static int NewEntry()
+{
+	int i;
+
+	if (first_free < 0)
+	{
+		int new_size = table_size ? table_size*2 : INITIAL_ENTRIES;
+		HandleEntry *t = (HandleEntry*)realloc(table, new_size*sizeof(HandleEntry));
+
+		if (t == NULL)
+			return -1;
+
+		memset(t+table_size, 0, (new_size-table_size)*sizeof(HandleEntry));
+		for (i = new_size-1; i >= table_size; --i)
+		{
+			t[i].gen = 1;
+			t[i].nextFree = first_free;
+			first_free = i;
+		}
+
+		table = t;
+		table_size = new_size;
+	}
+
+	i = first_free;
+	first_free = table[i].nextFree;
+
+	return i;
+}
+
+// table_lock is held
+static void FreeEntry(int i)
+{
+	table[i].refs = 0;
+	// generation 0 is never used, so no handle is 0
+	if (++table[i].gen == 0)
+		table[i].gen = 1;
+	table[i].nextFree = first_free;
+	first_free = i;
+}
+
+// table_lock is held, returns NULL for an invalid handle
+static HandleEntry *Lookup(FrameHandle h)
+{
+	int i = HANDLE_INDEX(h);
+
+	if ((i < 0) || (i >= table_size) || (table[i].refs == 0) || (table[i].gen != HANDLE_GEN(h)))
+	{
+		if (h != 0)
+			LOGE("invalid handle %llx", (unsigned long long)h);
+		return NULL;
+	}
+
+	return table + i;
+}
+
+
+static FrameHandle Register(void *data, size_t size, int format, int width, int height, int stride,
+	FrameFreeProc freeProc, int owned)
+{
+	HandleEntry *e;
+	int i;
+
+	if (data == NULL)
+		return 0;
+
+	pthread_mutex_lock(&table_lock);
+
+	i = NewEntry();
+	if (i < 0)
+	{
+		pthread_mutex_unlock(&table_lock);
+		LOGE("out of memory");
+		return 0;
+	}
+
+	e = table + i;
+	e->desc.data = data;
+	e->desc.size = size;
+	e->desc.format = format;
+	e->desc.width = width;
+	e->desc.height = height;
+	e->desc.stride = stride;
+	e->freeProc = freeProc;
+	e->owned = owned;
+	e->refs = 1;
+
+	pthread_mutex_unlock(&table_lock);
+
+	return MAKE_HANDLE(i, e->gen);
+}
+
+
+FrameHandle FrameHandle_Create(void *data, size_t size, int format, int width, int height, int stride, FrameFreeProc freeProc)
+{
+	return Register(data, size, format, width, height, stride, freeProc, 1);
+}
+
+
+FrameHandle FrameHandle_Wrap(void *data, size_t size, int format, int width, int height, int stride)
+{
+	return Register(data, size, format, width, height, stride, NULL, 0);
+}
+
+
+FrameHandle FrameHandle_Alloc(size_t size, int format, int width, int height, int stride)
+{
+	void *data = FramePool_Alloc(size);
+	FrameHandle h;
+
+	h = FrameHandle_Create(data, size, format, width, height, stride, NULL);
+	if (h == 0)
+		FramePool_Free(data);
+
+	return h;
+}
+
+
+int FrameHandle_Get(FrameHandle h, FrameDesc *desc)
+{
+	HandleEntry *e;
+
+	pthread_mutex_lock(&table_lock);
+	e = Lookup(h);
+	if (e != NULL)
+		*desc = e->desc;
+	pthread_mutex_unlock(&table_lock);
+
+	return e != NULL ? 0 : -1;
+}
+
+
+void *FrameHandle_Data(FrameHandle h, size_t minSize)
+{
+	FrameDesc desc;
+
+	if (FrameHandle_Get(h, &desc))
+		return NULL;
+
+	if (desc.size < minSize)
+	{
+		LOGE("handle %llx: %d bytes requested, %d available", (unsigned long long)h, (int)minSize, (int)desc.size);
+		return NULL;
+	}
+
+	return desc.data;
+}
+
+
+int FrameHandle_Retain(FrameHandle h)
+{
+	HandleEntry *e;
+
+	pthread_mutex_lock(&table_lock);
+	e = Lookup(h);
+	if (e != NULL)
+		++e->refs;
+	pthread_mutex_unlock(&table_lock);
+
+	return e != NULL ? 0 : -1;
+}
+
+
+int FrameHandle_Release(FrameHandle h)
+{
+	HandleEntry *e;
+	void *data = NULL;
+	FrameFreeProc freeProc = NULL;
+	int owned = 0;
+
+	pthread_mutex_lock(&table_lock);
+	e = Lookup(h);
+	if ((e != NULL) && (--e->refs == 0))
+	{
+		data = e->desc.data;
+		freeProc = e->freeProc;
+		owned = e->owned;
+		FreeEntry(e-table);
+	}
+	pthread_mutex_unlock(&table_lock);
+
+	// freed out of the lock, freeProc may take long or use the registry
+	if (owned)
+	{
+		if (freeProc)
+			freeProc(data);
+		else
+			FramePool_Free(data);
+	}
+
+	return e != NULL ? 0 : -1;
+}
+
+
+void *FrameHandle_Detach(FrameHandle h, FrameDesc *desc)
+{
+	HandleEntry *e;
+	void *data = NULL;
+
+	pthread_mutex_lock(&table_lock);
+	e = Lookup(h);
+	if (e != NULL)
+	{
+		if ((e->refs == 1) && e->owned && (e->freeProc == NULL))
+		{
+			data = e->desc.data;
+			if (desc)
+				*desc = e->desc;
+			FreeEntry(e-table);
+		}
+		else
+			LOGE("handle %llx can not be detached", (unsigned long long)h);
+	}
+	pthread_mutex_unlock(&table_lock);
+
+	return data;
+}
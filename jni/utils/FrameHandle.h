@@ -0,0 +1,86 @@
+/*
+The contents of this file are subject to the Mozilla Public License
+Version 1.1 (the "License"); you may not use this file except in
+compliance with the License. You may obtain a copy of the License at
+http://www.mozilla.org/MPL/
+
+Software distributed under the License is distributed on an "AS IS"
+basis, WITHOUT WARRANTY OF ANY KIND, either express or implied. See the
+License for the specific language governing rights and limitations
+under the License.
+
+The Original Code is collection of files collectively known as Open Camera.
+
+The Initial Developer of the Original Code is Almalence Inc.
+Portions created by Initial Developer are Copyright (C) 2013
+by Almalence Inc. All Rights Reserved.
+*/
+
+#ifndef __FRAMEHANDLE_H__
+#define __FRAMEHANDLE_H__
+
+#include <stddef.h>
+
+// Registry of native buffers (frames) and objects passed to java.
+//
+// Java holds a 64-bit handle (long) instead of a pointer cast to int, so the
+// same code works for 32 and 64-bit ABIs. A handle is a table index with a
+// generation number: every lookup checks both, so a stale, freed or garbage
+// handle is refused rather than dereferenced.
+//
+// Each entry is reference counted, the buffer is freed when the last
+// reference is released (malloc'ed buffers go back to FramePool). Entries created with FrameHandle_Wrap refer to
+// memory owned by someone else and never free it.
+
+// jlong on the java side, 0 is never a valid handle
+typedef long long FrameHandle;
+
+// frame formats
+#define FRAME_FORMAT_BYTES		0	// plain data: jpeg, raw sensor data etc.
+#define FRAME_FORMAT_NV21		1
+#define FRAME_FORMAT_RGBA		2
+#define FRAME_FORMAT_OBJECT		3	// native object, size is of no meaning
+
+typedef struct
+{
+	void *data;
+	size_t size;		// bytes
+	int format;			// FRAME_FORMAT_*
+	int width;			// 0 if not known
+	int height;
+	int stride;			// bytes per row of luma (or of the only) plane
+} FrameDesc;
+
+// called with the data when the last reference is released
+typedef void (*FrameFreeProc)(void *data);
+
+// Register buffer allocated with malloc (freeProc is NULL) or freed by freeProc.
+// Reference count is set to 1. Returns 0 if data is NULL or out of memory,
+// the buffer is then not freed.
+FrameHandle FrameHandle_Create(void *data, size_t size, int format, int width, int height, int stride, FrameFreeProc freeProc);
+
+// register buffer not owned by the registry, it must stay valid until released
+FrameHandle FrameHandle_Wrap(void *data, size_t size, int format, int width, int height, int stride);
+
+// allocate from FramePool and register a buffer of given size
+FrameHandle FrameHandle_Alloc(size_t size, int format, int width, int height, int stride);
+
+// Returns 0 and fills desc if handle is valid, -1 otherwise
+int FrameHandle_Get(FrameHandle h, FrameDesc *desc);
+
+// data of a valid handle of at least minSize bytes, NULL otherwise
+void *FrameHandle_Data(FrameHandle h, size_t minSize);
+
+// Returns 0 on success, -1 if handle is not valid
+int FrameHandle_Retain(FrameHandle h);
+
+// drop a reference, handle becomes invalid and buffer is freed with the last one.
+// Returns 0 on success, -1 if handle is not valid
+int FrameHandle_Release(FrameHandle h);
+
+// Invalidate handle and take its buffer over, the caller frees it.
+// Returns NULL if handle is not valid, is referenced more than once or
+// its buffer is not an owned malloc'ed one
+void *FrameHandle_Detach(FrameHandle h, FrameDesc *desc);
+
+#endif // __FRAMEHANDLE_H__
@@ -0,0 +1,296 @@
+/*
+The contents of this file are subject to the Mozilla Public License
+Version 1.1 (the "License"); you may not use this file except in
+compliance with the License. You may obtain a copy of the License at
+http://www.mozilla.org/MPL/
+
+Software distributed under the License is distributed on an "AS IS"
+basis, WITHOUT WARRANTY OF ANY KIND, either express or implied. See the
+License for the specific language governing rights and limitations
+under the License.
+
+The Original Code is collection of files collectively known as Open Camera.
+
+The Initial Developer of the Original Code is Almalence Inc.
+Portions created by Initial Developer are Copyright (C) 2013
+by Almalence Inc. All Rights Reserved.
+*/
+
+#include <stdlib.h>
+#include <malloc.h>
+#include <pthread.h>
+
+#include "MemoryBudget.h"
+#include "FramePool.h"
+
+
+typedef struct
+{
+	size_t size;		// 0 - class is not in use
+	void *idle[FRAMEPOOL_CLASS_DEPTH];
+	int nIdle;
+	unsigned int lastUse;
+} PoolClass;
+
+#define MAX_VICTIMS		(FRAMEPOOL_CLASSES*FRAMEPOOL_CLASS_DEPTH)
+
+static pthread_mutex_t pool_lock = PTHREAD_MUTEX_INITIALIZER;
+static PoolClass classes[FRAMEPOOL_CLASSES];
+static unsigned int use_clock = 0;
+static size_t idle_bytes = 0;
+static size_t idle_limit = 0;
+static FramePoolStats stats;
+
+
+static size_t ClassSize(size_t size)
+{
+	return (size + FRAMEPOOL_GRANULARITY-1) & ~(size_t)(FRAMEPOOL_GRANULARITY-1);
+}
+
+// pool_lock is held
+static int FindClass(size_t size)
+{
+	int i;
+
+	for (i = 0; i < FRAMEPOOL_CLASSES; ++i)
+		if (classes[i].size == size)
+			return i;
+
+	return -1;
+}
+
+// Smallest class with idle buffers of at least size bytes, up to
+// FRAMEPOOL_MAX_WASTE percent more. pool_lock is held
+static int FindFit(size_t size)
+{
+	size_t maxSize = size + size/100*FRAMEPOOL_MAX_WASTE;
+	int i, fit = -1;
+
+	for (i = 0; i < FRAMEPOOL_CLASSES; ++i)
+		if (classes[i].nIdle && (classes[i].size >= size) && (classes[i].size <= maxSize)
+			&& ((fit < 0) || (classes[i].size < classes[fit].size)))
+			fit = i;
+
+	return fit;
+}
+
+// Move all idle buffers of class c to victims, pool_lock is held
+static void DropClass(int c, void **victims, int *nVictims)
+{
+	PoolClass *pc = classes + c;
+
+	while (pc->nIdle)
+	{
+		victims[(*nVictims)++] = pc->idle[--pc->nIdle];
+		idle_bytes -= pc->size;
+		++stats.dropped;
+	}
+}
+
+// Drop least recently used classes, other than keep, until at least need bytes
+// are freed. pool_lock is held
+static void Evict(size_t need, int keep, void **victims, int *nVictims)
+{
+	size_t freed = 0;
+	int i, lru;
+
+	while (freed < need)
+	{
+		lru = -1;
+		for (i = 0; i < FRAMEPOOL_CLASSES; ++i)
+			if ((i != keep) && classes[i].nIdle
+				&& ((lru < 0) || (classes[i].lastUse < classes[lru].lastUse)))
+				lru = i;
+
+		if (lru < 0)
+			break;
+
+		freed += classes[lru].size*classes[lru].nIdle;
+		DropClass(lru, victims, nVictims);
+	}
+}
+
+// free out of the lock, unmapping large blocks takes a while
+static void FreeVictims(void **victims, int nVictims)
+{
+	int i;
+
+	for (i = 0; i < nVictims; ++i)
+		free(victims[i]);
+}
+
+static size_t IdleLimit()
+{
+	// MemTotal does not change, a race only computes it twice
+	if (idle_limit == 0)
+		idle_limit = (unsigned long long)MemoryBudget_SystemTotal()*FRAMEPOOL_IDLE_SHARE/100;
+
+	return idle_limit;
+}
+
+// Keep block of class size as idle, returns 0 if it is kept. pool_lock is held
+static int Put(void *ptr, size_t size, void **victims, int *nVictims)
+{
+	size_t limit = IdleLimit();
+	int c;
+
+	c = FindClass(size);
+	if (c < 0)
+	{
+		// take over the least recently used class
+		for (c = 0; c < FRAMEPOOL_CLASSES; ++c)
+			if (classes[c].size == 0)
+				break;
+		if (c == FRAMEPOOL_CLASSES)
+		{
+			c = 0;
+			for (int i = 1; i < FRAMEPOOL_CLASSES; ++i)
+				if (classes[i].lastUse < classes[c].lastUse)
+					c = i;
+			DropClass(c, victims, nVictims);
+		}
+		classes[c].size = size;
+	}
+
+	if (classes[c].nIdle == FRAMEPOOL_CLASS_DEPTH)
+		return -1;
+
+	if (idle_bytes + size > limit)
+		Evict(idle_bytes + size - limit, c, victims, nVictims);
+	if (idle_bytes + size > limit)
+		return -1;
+
+	classes[c].idle[classes[c].nIdle++] = ptr;
+	classes[c].lastUse = ++use_clock;
+	idle_bytes += size;
+
+	return 0;
+}
+
+
+void *FramePool_Alloc(size_t size)
+{
+	void *victims[MAX_VICTIMS];
+	int nVictims = 0;
+	size_t available;
+	void *ptr = NULL;
+	int c;
+
+	if (size < FRAMEPOOL_MIN_SIZE)
+		return malloc(size);
+
+	size = ClassSize(size);
+
+	pthread_mutex_lock(&pool_lock);
+	c = FindFit(size);
+	if (c >= 0)
+	{
+		ptr = classes[c].idle[--classes[c].nIdle];
+		classes[c].lastUse = ++use_clock;
+		idle_bytes -= classes[c].size;
+		++stats.hits;
+	}
+	else
+		++stats.misses;
+	pthread_mutex_unlock(&pool_lock);
+
+	if (ptr)
+		return ptr;
+
+	// idle buffers of other sizes are given up first if memory is short
+	if (idle_bytes)
+	{
+		available = MemoryBudget_SystemAvailable();
+		if (available < size + MEMBUDGET_KEEP_FREE)
+		{
+			pthread_mutex_lock(&pool_lock);
+			Evict(size + MEMBUDGET_KEEP_FREE - available, -1, victims, &nVictims);
+			pthread_mutex_unlock(&pool_lock);
+			FreeVictims(victims, nVictims);
+		}
+	}
+
+	ptr = malloc(size);
+	if (ptr == NULL)
+	{
+		FramePool_Trim();
+		ptr = malloc(size);
+	}
+
+	return ptr;
+}
+
+
+void FramePool_Free(void *ptr)
+{
+	void *victims[MAX_VICTIMS];
+	int nVictims = 0;
+	size_t size;
+
+	if (ptr == NULL)
+		return;
+
+	// class is chosen by what the block can actually hold, for blocks from
+	// FramePool_Alloc it is at least the class size they were requested with
+	size = malloc_usable_size(ptr);
+	if (size < FRAMEPOOL_MIN_SIZE)
+	{
+		free(ptr);
+		return;
+	}
+	size &= ~(size_t)(FRAMEPOOL_GRANULARITY-1);
+
+	pthread_mutex_lock(&pool_lock);
+	if (Put(ptr, size, victims, &nVictims) == 0)
+	{
+		++stats.returned;
+		ptr = NULL;
+	}
+	else
+		++stats.dropped;
+	pthread_mutex_unlock(&pool_lock);
+
+	FreeVictims(victims, nVictims);
+	free(ptr);
+}
+
+
+void FramePool_Trim()
+{
+	void *victims[MAX_VICTIMS];
+	int nVictims = 0;
+	int c;
+
+	pthread_mutex_lock(&pool_lock);
+	for (c = 0; c < FRAMEPOOL_CLASSES; ++c)
+		DropClass(c, victims, &nVictims);
+	pthread_mutex_unlock(&pool_lock);
+
+	FreeVictims(victims, nVictims);
+}
+
+
+size_t FramePool_IdleBytes()
+{
+	size_t bytes;
+
+	pthread_mutex_lock(&pool_lock);
+	bytes = idle_bytes;
+	pthread_mutex_unlock(&pool_lock);
+
+	return bytes;
+}
+
+
+void FramePool_GetStats(FramePoolStats *s)
+{
+	int c;
+
+	pthread_mutex_lock(&pool_lock);
+	*s = stats;
+	s->idleBuffers = 0;
+	for (c = 0; c < FRAMEPOOL_CLASSES; ++c)
+		s->idleBuffers += classes[c].nIdle;
+	s->idleBytes = idle_bytes;
+	pthread_mutex_unlock(&pool_lock);
+}
@@ -0,0 +1,74 @@
+/*
+The contents of this file are subject to the Mozilla Public License
+Version 1.1 (the "License"); you may not use this file except in
+compliance with the License. You may obtain a copy of the License at
+http://www.mozilla.org/MPL/
+
+Software distributed under the License is distributed on an "AS IS"
+basis, WITHOUT WARRANTY OF ANY KIND, either express or implied. See the
+License for the specific language governing rights and limitations
+under the License.
+
+The Original Code is collection of files collectively known as Open Camera.
+
+The Initial Developer of the Original Code is Almalence Inc.
+Portions created by Initial Developer are Copyright (C) 2013
+by Almalence Inc. All Rights Reserved.
+*/
+
+#ifndef __FRAMEPOOL_H__
+#define __FRAMEPOOL_H__
+
+#include <stddef.h>
+
+// Pool of large frame buffers recycled between captures.
+//
+// Every capture allocates and frees several frames of the same resolution and
+// format, each a multi-megabyte block which malloc maps and unmaps, so that
+// all its pages fault again on the next capture. Freed frames are kept here
+// instead, grouped in size classes (equal resolution and format give equal
+// size), and handed out again already faulted in.
+//
+// Pooled buffers are plain malloc blocks: one may still be released with free()
+// and any malloc block may be given to FramePool_Free. Blocks are filed by what
+// they can actually hold (malloc_usable_size), which malloc may round up well
+// past the requested size, so a request is served by the smallest idle class
+// that holds it. Idle buffers are limited to a share of the system memory and
+// are given back to the system when memory runs low.
+
+// smaller blocks are not pooled
+#define FRAMEPOOL_MIN_SIZE			(256*1024)
+// class size granularity, also lets jpeg frames of similar size share a class
+#define FRAMEPOOL_GRANULARITY		(64*1024)
+#define FRAMEPOOL_CLASSES			8
+#define FRAMEPOOL_CLASS_DEPTH		16		// idle buffers per class
+// percent a reused buffer may exceed the request by, covers the rounding of
+// large size classes by malloc
+#define FRAMEPOOL_MAX_WASTE			25
+// percent of MemTotal idle buffers may take
+#define FRAMEPOOL_IDLE_SHARE		10
+
+typedef struct
+{
+	unsigned int hits;		// served from the pool
+	unsigned int misses;	// newly allocated
+	unsigned int returned;	// kept on free
+	unsigned int dropped;	// given back to the system: over limit, evicted or trimmed
+	int idleBuffers;
+	size_t idleBytes;
+} FramePoolStats;
+
+// malloc replacement, NULL if out of memory
+void *FramePool_Alloc(size_t size);
+
+// free replacement for blocks from FramePool_Alloc or malloc, NULL is ignored
+void FramePool_Free(void *ptr);
+
+// give all idle buffers back to the system
+void FramePool_Trim();
+
+size_t FramePool_IdleBytes();
+
+void FramePool_GetStats(FramePoolStats *stats);
+
+#endif // __FRAMEPOOL_H__
@@ -24,10 +24,23 @@ by Almalence Inc. All Rights Reserved.
 #include <setjmp.h>
 #include "jpeglib.h"
 #include <math.h>
+#include <omp.h>
+#include <time.h>
+
+#if defined(__ARM_NEON__) || defined(__ARM_NEON)
+#include <arm_neon.h>
+#define TRANSFORM_NEON
+#elif defined(__SSE2__)
+#include <emmintrin.h>
+#define TRANSFORM_SSE2
+#endif
 
 #include <jni.h>
 
 #include "ImageConversionUtils.h"
+#include "ColorConversion.h"
+#include "FrameHandle.h"
+#include "FramePool.h"
 
 #define LOG_TAG "ImageConversion"
 #ifdef LOG_ON
@@ -52,16 +65,6 @@ typedef signed char Int8;
 
 
 
-#define get_Ysz(in, x,y)	((in)[(x)+(y)*sx])
-#define get_Usz(in, x, y)	((in)[sx*sy+((x)|1)+((y)/2)*sx])
-#define get_Vsz(in, x, y)	((in)[sx*sy+((x)&~1)+((y)/2)*sx])
-
-#define	CLIP8(x)			( (x)<0 ? 0 : (x)>255 ? 255 : (x) )
-#define CSC_R(Y,V)			CLIP8((128*(Y)+176*((V)-128)) >> 7 )
-#define CSC_B(Y,U)			CLIP8((128*(Y)+222*((U)-128)) >> 7 )
-#define CSC_G(Y,U,V)		CLIP8((128*(Y)-89*((V)-128)-43*((U)-128)) >> 7 )
-
-
 #define BMP_R(p)	((p) & 0xFF)
 #define BMP_G(p)	(((p)>>8) & 0xFF)
 #define BMP_B(p)	(((p)>>16)& 0xFF)
@@ -91,25 +94,134 @@ METHODDEF(void) my_error_exit (j_common_ptr cinfo)
   longjmp(myerr->setjmp_buffer, 1);
 }
 
-int JPEG2NV21(Uint8 *yuv, Uint8 *jpegdata, int jpeglen, int sx, int sy, bool needRotation, bool cameraMirrored, int rotationDegree)
+// transform flags for 4-side rotation, as used by TransformNV21
+static void GetNV21Transform(bool needRotation, bool cameraMirrored, int rotationDegree, int *flipLR, int *flipUD, int *rotate90)
 {
-	int i, y;
-	int inlen;
+	*flipLR = 0;
+	*flipUD = 0;
+	*rotate90 = 0;
 
-	struct jpeg_decompress_struct cinfo;
-	struct my_error_mgr jerr;
-	JSAMPARRAY scanline;
-	unsigned char  *wline;
-	unsigned char *y_buffer;
-	unsigned char *cbcr_buffer;
+	if (!needRotation && !cameraMirrored)
+		return;
 
-	Uint8* dst;
+	*flipLR = cameraMirrored;
+	if(rotationDegree == 180 || rotationDegree == 270)
+	{
+		*flipLR = !cameraMirrored; //used to support 4-side rotation
+		*flipUD = 1; //used to support 4-side rotation
+	}
+	if(rotationDegree == 90 || rotationDegree == 270)
+		*rotate90 = 1; //used to support 4-side rotation
+}
 
-	if (needRotation || cameraMirrored)
-	//if(rotationDegree != 0 || cameraMirrored)
-		dst = (unsigned char*)malloc(sx*sy+2*((sx+1)/2)*((sy+1)/2));
-	else
-		dst = yuv;
+// Store rows [y0, y0+nrows) of a sx*sy 8-bit plane into its transformed position.
+// Rotated strips are written column-wise, nrows consecutive bytes per output row.
+static void StoreStrip8bit(Uint8 **rows, int nrows, int y0, int sx, int sy, Uint8 *out, int flipLR, int flipUD, int rotate90)
+{
+	int x, k;
+
+	if (!rotate90)
+	{
+		for (k = 0; k < nrows; k++)
+		{
+			Uint8 *o = out + (flipUD ? sy-1-(y0+k) : y0+k) * sx;
+			Uint8 *in = rows[k];
+
+			if (!flipLR)
+				memcpy(o, in, sx);
+			else
+				for (x = 0; x < sx; x++)
+					o[sx-1-x] = in[x];
+		}
+		return;
+	}
+
+	// output is sy wide, source column x goes to output row (flipUD ? sx-1-x : x)
+	for (x = 0; x < sx; x++)
+	{
+		Uint8 *o = out + (flipUD ? sx-1-x : x) * sy;
+
+		if (flipLR)
+		{
+			o += y0;
+			for (k = 0; k < nrows; k++)
+				o[k] = rows[k][x];
+		}
+		else
+		{
+			o += sy-1-y0;
+			for (k = 0; k < nrows; k++)
+				o[-k] = rows[k][x];
+		}
+	}
+}
+
+// Same as StoreStrip8bit for the interleaved VU plane (csx*csy 16-bit elements),
+// V and U come from separate rows
+static void StoreStripVU(Uint8 **vrows, Uint8 **urows, int nrows, int y0, int csx, int csy, Uint8 *out, int flipLR, int flipUD, int rotate90)
+{
+	int x, k;
+
+	if (!rotate90)
+	{
+		for (k = 0; k < nrows; k++)
+		{
+			Uint8 *o = out + (flipUD ? csy-1-(y0+k) : y0+k) * csx * 2;
+			Uint8 *v = vrows[k];
+			Uint8 *u = urows[k];
+
+			if (!flipLR)
+				for (x = 0; x < csx; x++)
+				{
+					o[x*2] = v[x];
+					o[x*2+1] = u[x];
+				}
+			else
+				for (x = 0; x < csx; x++)
+				{
+					o[(csx-1-x)*2] = v[x];
+					o[(csx-1-x)*2+1] = u[x];
+				}
+		}
+		return;
+	}
+
+	for (x = 0; x < csx; x++)
+	{
+		Uint8 *o = out + (flipUD ? csx-1-x : x) * csy * 2;
+
+		if (flipLR)
+		{
+			o += y0*2;
+			for (k = 0; k < nrows; k++)
+			{
+				o[k*2] = vrows[k][x];
+				o[k*2+1] = urows[k][x];
+			}
+		}
+		else
+		{
+			o += (csy-1-y0)*2;
+			for (k = 0; k < nrows; k++)
+			{
+				o[-k*2] = vrows[k][x];
+				o[-k*2+1] = urows[k][x];
+			}
+		}
+	}
+}
+
+// Decode jpeg into rows [row0, row0 + jpeg height) of sx*sy NV21 image,
+// storing them already mirrored/rotated (see TransformNV21 for flags meaning)
+static int DecodeJpegRowsNV21(Uint8 *yuv, int sx, int sy, int row0, Uint8 *jpegdata, int jpeglen,
+		int flipLR, int flipUD, int rotate90)
+{
+	int i, k, n;
+	int y;
+
+	struct jpeg_decompress_struct cinfo;
+	struct my_error_mgr jerr;
+	Uint8 *vu = yuv + sx * sy;
 
 	cinfo.err = jpeg_std_error(&jerr.pub);
     jerr.pub.error_exit = my_error_exit;
@@ -123,60 +235,266 @@ int JPEG2NV21(Uint8 *yuv, Uint8 *jpegdata, int jpeglen, int sx, int sy, bool nee
 
 	jpeg_mem_src(&cinfo, jpegdata, jpeglen);
 	(void) jpeg_read_header(&cinfo, TRUE);
-	//cinfo.raw_data_out = TRUE;
-    cinfo.out_color_space = JCS_YCbCr;
 
-	(void) jpeg_start_decompress(&cinfo);
+	if ((cinfo.num_components == 3) && (cinfo.jpeg_color_space == JCS_YCbCr)
+		&& (cinfo.comp_info[0].h_samp_factor == 2) && (cinfo.comp_info[0].v_samp_factor == 2)
+		&& (cinfo.comp_info[1].h_samp_factor == 1) && (cinfo.comp_info[1].v_samp_factor == 1)
+		&& (cinfo.comp_info[2].h_samp_factor == 1) && (cinfo.comp_info[2].v_samp_factor == 1))
+	{
+		// 4:2:0 - take Y and subsampled Cb/Cr planes straight from the decoder, an MCU row at a time
+		JSAMPARRAY planes[3];
 
-	y_buffer = dst;
-	cbcr_buffer = y_buffer + cinfo.output_width * cinfo.output_height;
-	scanline = (*cinfo.mem->alloc_sarray)((j_common_ptr) &cinfo, JPOOL_IMAGE, cinfo.output_width * cinfo.output_components, 1);
-	wline = scanline[0];
+		cinfo.raw_data_out = TRUE;
+		(void) jpeg_start_decompress(&cinfo);
 
-	while (cinfo.output_scanline < cinfo.output_height)
+		for (i = 0; i < 3; i++)
+			planes[i] = (*cinfo.mem->alloc_sarray)((j_common_ptr) &cinfo, JPOOL_IMAGE,
+				cinfo.comp_info[i].width_in_blocks * DCTSIZE, cinfo.comp_info[i].v_samp_factor * DCTSIZE);
+
+		while (cinfo.output_scanline < cinfo.output_height)
+		{
+			y = cinfo.output_scanline;
+			jpeg_read_raw_data(&cinfo, planes, 2 * DCTSIZE);
+
+			// last MCU row may be partial
+			n = min(2 * DCTSIZE, cinfo.output_height - y);
+
+			StoreStrip8bit(planes[0], n, row0 + y, sx, sy, yuv, flipLR, flipUD, rotate90);
+			StoreStripVU(planes[2], planes[1], n / 2, (row0 + y) / 2, sx / 2, sy / 2, vu, flipLR, flipUD, rotate90);
+		}
+	}
+	else
 	{
-		jpeg_read_scanlines(&cinfo, scanline, (JDIMENSION)1);
+		// other subsampling - let the decoder upsample, take chroma of odd rows and even columns
+		JSAMPARRAY scanlines;
+		Uint8 *yrows[2], *vrow, *urow;
 
-		for (i = 0; i < cinfo.output_width; i++)
-			y_buffer[i] = wline[i*3];
+	    cinfo.out_color_space = JCS_YCbCr;
+	    // plain replication keeps chroma exact and makes restart parts decode
+	    // the same as the whole image (fancy upsampling looks across part borders)
+	    cinfo.do_fancy_upsampling = FALSE;
+
+		(void) jpeg_start_decompress(&cinfo);
 
-		y_buffer += cinfo.output_width;
+		scanlines = (*cinfo.mem->alloc_sarray)((j_common_ptr) &cinfo, JPOOL_IMAGE, cinfo.output_width * cinfo.output_components, 2);
+		yrows[0] = (Uint8*)(*cinfo.mem->alloc_small)((j_common_ptr) &cinfo, JPOOL_IMAGE, cinfo.output_width * 2);
+		yrows[1] = yrows[0] + cinfo.output_width;
+		vrow = (Uint8*)(*cinfo.mem->alloc_small)((j_common_ptr) &cinfo, JPOOL_IMAGE, cinfo.output_width);
+		urow = vrow + cinfo.output_width / 2;
 
-		if (y++ & 1)
+		while (cinfo.output_scanline < cinfo.output_height)
 		{
-			for (int i = 0; i < cinfo.output_width; i+=2)
+			y = cinfo.output_scanline;
+			n = 0;
+			while (n < 2 && cinfo.output_scanline < cinfo.output_height)
+				n += jpeg_read_scanlines(&cinfo, scanlines + n, (JDIMENSION)(2 - n));
+
+			for (k = 0; k < n; k++)
+				for (i = 0; i < cinfo.output_width; i++)
+					yrows[k][i] = scanlines[k][i*3];
+
+			for (i = 0; i < cinfo.output_width / 2; i++)
 			{
-				cbcr_buffer[i] = wline[(i*3) + 2];		// V
-				cbcr_buffer[i + 1] = wline[(i*3) + 1];	// U
+				vrow[i] = scanlines[n-1][(i*2*3) + 2];
+				urow[i] = scanlines[n-1][(i*2*3) + 1];
 			}
-			cbcr_buffer += cinfo.output_width;
+
+			StoreStrip8bit(yrows, n, row0 + y, sx, sy, yuv, flipLR, flipUD, rotate90);
+			if (n == 2)
+				StoreStripVU(&vrow, &urow, 1, (row0 + y) / 2, sx / 2, sy / 2, vu, flipLR, flipUD, rotate90);
 		}
 	}
 
 	(void) jpeg_finish_decompress(&cinfo);
 	jpeg_destroy_decompress(&cinfo);
 
+	return 1;
+}
+
+int JPEG2NV21(Uint8 *yuv, Uint8 *jpegdata, int jpeglen, int sx, int sy, bool needRotation, bool cameraMirrored, int rotationDegree)
+{
+	int flipLR, flipUD, rotate90;
+
+	GetNV21Transform(needRotation, cameraMirrored, rotationDegree, &flipLR, &flipUD, &rotate90);
+
+	return DecodeJpegRowsNV21(yuv, sx, sy, 0, jpegdata, jpeglen, flipLR, flipUD, rotate90);
+}
+
+
+// Position of restart intervals in a baseline single-scan jpeg
+typedef struct
+{
+	int sof_height_pos;			// offset of image height field in SOF
+	int header_len;				// all markers up to the end of SOS header
+	int height;
+	int interval_rows;			// pixel rows covered by one restart interval
+	int nIntervals;
+	int *interval_start;		// offsets of entropy-coded data of each interval
+	int *interval_end;
+} JpegRestartIndex;
+
+#define JPEG_WORD(p)	(((p)[0]<<8) | (p)[1])
+
+// returns 1 if jpeg can be decoded in independent parts starting at restart markers:
+// baseline, single interleaved scan, restart interval covering whole MCU rows
+static int IndexJpegRestarts(Uint8 *jpeg, int len, JpegRestartIndex *idx)
+{
+	int pos, seglen, marker;
+	int i, n;
+	int width = 0, height = 0, ncomp = 0;
+	int hmax = 1, vmax = 1;
+	int restart_interval = 0;
+	int mcus_per_row;
+
+	memset(idx, 0, sizeof(JpegRestartIndex));
+
+	if (len < 4 || jpeg[0] != 0xFF || jpeg[1] != 0xD8)
+		return 0;
 
-	if (needRotation || cameraMirrored)
+	// walk the markers up to the start of scan
+	pos = 2;
+	for (;;)
 	{
-		int nRotate = 0;
-		int flipUD = 0;
-		if(rotationDegree == 180 || rotationDegree == 270)
+		if (pos + 4 > len || jpeg[pos] != 0xFF)
+			return 0;
+		marker = jpeg[pos+1];
+		if (marker == 0xFF)		// fill byte
 		{
-			cameraMirrored = !cameraMirrored; //used to support 4-side rotation
-			flipUD = 1; //used to support 4-side rotation
+			pos++;
+			continue;
 		}
-		if(rotationDegree == 90 || rotationDegree == 270)
-			nRotate = 1; //used to support 4-side rotation
+		seglen = JPEG_WORD(jpeg+pos+2);
+		if (pos + 2 + seglen > len)
+			return 0;
 
-		// not sure if it should be 'cameraMirrored, 0,' or '0, cameraMirrored,'
-		TransformNV21(dst, yuv, sx, sy, NULL, cameraMirrored, flipUD, nRotate);
-		free(dst);
+		if (marker == 0xC0 || marker == 0xC1)
+		{
+			idx->sof_height_pos = pos + 5;
+			height = JPEG_WORD(jpeg+pos+5);
+			width = JPEG_WORD(jpeg+pos+7);
+			ncomp = jpeg[pos+9];
+			for (i = 0; i < ncomp; i++)
+			{
+				hmax = max(hmax, jpeg[pos+11+i*3] >> 4);
+				vmax = max(vmax, jpeg[pos+11+i*3] & 0xF);
+			}
+		}
+		else if (marker >= 0xC2 && marker <= 0xCF && marker != 0xC4 && marker != 0xC8 && marker != 0xCC)
+			return 0;			// progressive, lossless or arithmetic coded
+		else if (marker == 0xDD)
+			restart_interval = JPEG_WORD(jpeg+pos+4);
+		else if (marker == 0xDA)
+		{
+			if (jpeg[pos+4] != ncomp)
+				return 0;		// non-interleaved scans
+			idx->header_len = pos + 2 + seglen;
+			break;
+		}
+
+		pos += 2 + seglen;
+	}
+
+	if (width == 0 || height == 0 || restart_interval == 0)
+		return 0;
+
+	mcus_per_row = (width + hmax*8 - 1) / (hmax*8);
+	if (restart_interval % mcus_per_row)
+		return 0;
+
+	idx->height = height;
+	idx->interval_rows = (restart_interval / mcus_per_row) * vmax * 8;
+	n = (height + idx->interval_rows - 1) / idx->interval_rows;
+	if (n < 2)
+		return 0;
+
+	idx->interval_start = (int*)malloc(n * sizeof(int));
+	idx->interval_end = (int*)malloc(n * sizeof(int));
+	if (idx->interval_start == NULL || idx->interval_end == NULL)
+	{
+		free(idx->interval_start);
+		free(idx->interval_end);
+		idx->interval_start = idx->interval_end = NULL;
+		return 0;
 	}
 
+	// locate RSTn / EOI markers in entropy-coded data
+	i = 0;
+	idx->interval_start[0] = idx->header_len;
+	for (pos = idx->header_len; pos < len - 1; pos++)
+	{
+		if (jpeg[pos] != 0xFF)
+			continue;
+		marker = jpeg[pos+1];
+		if (marker >= 0xD0 && marker <= 0xD7)
+		{
+			if (i + 1 >= n)
+				break;
+			idx->interval_end[i] = pos;
+			idx->interval_start[++i] = pos + 2;
+			pos++;
+		}
+		else if (marker == 0xD9)
+		{
+			idx->interval_end[i] = pos;
+			break;
+		}
+		else if (marker != 0x00 && marker != 0xFF)
+			break;		// other markers (DNL, next scan) - not supported
+	}
+
+	if (i + 1 != n || pos >= len - 1 || jpeg[pos+1] != 0xD9)
+	{
+		free(idx->interval_start);
+		free(idx->interval_end);
+		idx->interval_start = idx->interval_end = NULL;
+		return 0;
+	}
+
+	idx->nIntervals = n;
+
 	return 1;
 }
 
+static void FreeJpegRestartIndex(JpegRestartIndex *idx)
+{
+	free(idx->interval_start);
+	free(idx->interval_end);
+	idx->interval_start = idx->interval_end = NULL;
+}
+
+// Build a standalone jpeg out of restart intervals [first, last)
+static Uint8 *MakeJpegPart(Uint8 *jpeg, JpegRestartIndex *idx, int first, int last, int *partlen)
+{
+	int i, len, rows;
+	Uint8 *part, *out;
+
+	len = idx->header_len + 2;
+	for (i = first; i < last; i++)
+		len += idx->interval_end[i] - idx->interval_start[i] + 2;
+
+	part = (Uint8*)malloc(len);
+	if (part == NULL)
+		return NULL;
+
+	memcpy(part, jpeg, idx->header_len);
+	rows = min(last * idx->interval_rows, idx->height) - first * idx->interval_rows;
+	part[idx->sof_height_pos] = rows >> 8;
+	part[idx->sof_height_pos+1] = rows & 0xFF;
+
+	// decoder expects restart markers to be numbered from RST0
+	out = part + idx->header_len;
+	for (i = first; i < last; i++)
+	{
+		memcpy(out, jpeg + idx->interval_start[i], idx->interval_end[i] - idx->interval_start[i]);
+		out += idx->interval_end[i] - idx->interval_start[i];
+		*out++ = 0xFF;
+		*out++ = (i == last-1) ? 0xD9 : 0xD0 + ((i - first) & 7);
+	}
+
+	*partlen = out - part;
+	return part;
+}
+
 int JPEG2RGBA(Uint8 *dst, Uint8 *jpegdata, int jpeglen)
 {
 	int i, y;
@@ -213,109 +531,776 @@ int JPEG2RGBA(Uint8 *dst, Uint8 *jpegdata, int jpeglen)
 	scanline = (*cinfo.mem->alloc_sarray)((j_common_ptr) &cinfo, JPOOL_IMAGE, cinfo.output_width * cinfo.output_components, 1);
 	wline = scanline[0];
 
-	while (cinfo.output_scanline < cinfo.output_height)
+	while (cinfo.output_scanline < cinfo.output_height)
+	{
+		jpeg_read_scanlines(&cinfo, scanline, (JDIMENSION)1);
+
+		for (i = 0; i < cinfo.output_width; i++)
+		{
+			buff_cursor[0] = wline[i * 4];
+			buff_cursor[1] = wline[i * 4 + 1];
+			buff_cursor[2] = wline[i * 4 + 2];
+			buff_cursor[3] = wline[i * 4 + 3];
+
+			buff_cursor += 4;
+		}
+	}
+
+	(void) jpeg_finish_decompress(&cinfo);
+	jpeg_destroy_decompress(&cinfo);
+
+	return 1;
+}
+
+// decode jpeg into RGBA scaled down to outWidth x outHeight and rotated 90 degree
+// clockwise (output is outHeight pixels wide, outWidth pixels high)
+//
+// The jpeg is decoded with DCT scaling to the largest power-of-two reduction
+// which is still not below the output size, the rest of the reduction is done
+// with an area-averaging box filter 1.5 times the remaining scale factor.
+// The filter is separable: every decoded row is turned into a running sum, so
+// each output column costs a single subtraction, and rows are accumulated
+// into the few output rows whose windows are open. No full-size frame is kept.
+//
+int JPEG2RGBA_downscaled_rotated(Uint8 *out, Uint8 *jpegdata, int jpeglen, int outWidth, int outHeight)
+{
+	struct jpeg_decompress_struct cinfo;
+	struct my_error_mgr jerr;
+	JSAMPARRAY scanline;
+	Uint32 *prefix, *acc;
+	int *xs, *xe;
+	int dw, dh, navg, nacc;
+	int denom, next, i, j, y;
+
+	cinfo.err = jpeg_std_error(&jerr.pub);
+	jerr.pub.error_exit = my_error_exit;
+	if (setjmp(jerr.setjmp_buffer))
+	{
+		jpeg_destroy_decompress(&cinfo);
+		return 0;
+	}
+	jpeg_create_decompress(&cinfo);
+
+	jpeg_mem_src(&cinfo, jpegdata, jpeglen);
+	(void) jpeg_read_header(&cinfo, TRUE);
+
+	denom = 1;
+	while ((denom < 8) && ((int)cinfo.image_width/(denom*2) >= outWidth) && ((int)cinfo.image_height/(denom*2) >= outHeight))
+		denom *= 2;
+
+	cinfo.scale_num = 1;
+	cinfo.scale_denom = denom;
+	cinfo.out_color_space = JCS_EXT_RGBA;
+	// area filter smooths the chroma anyway
+	cinfo.do_fancy_upsampling = FALSE;
+
+	(void) jpeg_start_decompress(&cinfo);
+
+	dw = cinfo.output_width;
+	dh = cinfo.output_height;
+
+	navg = max(1, 3*max(dw/outWidth, dh/outHeight)/2);
+	// output rows which can have their windows open at the same time
+	nacc = dh >= outHeight ? navg/(dh/outHeight) + 2 : outHeight;
+
+	scanline = (*cinfo.mem->alloc_sarray)((j_common_ptr) &cinfo, JPOOL_IMAGE, dw * 4, 1);
+	prefix = (Uint32*)(*cinfo.mem->alloc_large)((j_common_ptr) &cinfo, JPOOL_IMAGE, (dw+1) * 4 * sizeof(Uint32));
+	acc = (Uint32*)(*cinfo.mem->alloc_large)((j_common_ptr) &cinfo, JPOOL_IMAGE, nacc * outWidth * 4 * sizeof(Uint32));
+	xs = (int*)(*cinfo.mem->alloc_small)((j_common_ptr) &cinfo, JPOOL_IMAGE, 2 * outWidth * sizeof(int));
+	xe = xs + outWidth;
+
+	for (j = 0; j < outWidth; ++j)
+	{
+		xs[j] = j*dw/outWidth;
+		xe[j] = min(xs[j]+navg, dw);
+	}
+
+	memset(prefix, 0, 4*sizeof(Uint32));
+
+	next = 0;
+	while ((cinfo.output_scanline < cinfo.output_height) && (next < outHeight))
+	{
+		y = cinfo.output_scanline;
+		jpeg_read_scanlines(&cinfo, scanline, 1);
+
+		if (y < next*dh/outHeight)
+			continue;
+
+		// running sum of the row, one lane per channel
+		const Uint8 *row = scanline[0];
+		int x;
+#if defined(TRANSFORM_NEON)
+		uint32x4_t s = vdupq_n_u32(0);
+		for (x = 0; x < dw; ++x)
+		{
+			uint8x8_t p = vreinterpret_u8_u32(vld1_dup_u32((const uint32_t*)(row+x*4)));
+			s = vaddq_u32(s, vmovl_u16(vget_low_u16(vmovl_u8(p))));
+			vst1q_u32(prefix+(x+1)*4, s);
+		}
+#elif defined(TRANSFORM_SSE2)
+		const __m128i zero = _mm_setzero_si128();
+		__m128i s = zero;
+		for (x = 0; x < dw; ++x)
+		{
+			__m128i p = _mm_cvtsi32_si128(*(const int*)(row+x*4));
+			s = _mm_add_epi32(s, _mm_unpacklo_epi16(_mm_unpacklo_epi8(p, zero), zero));
+			_mm_storeu_si128((__m128i*)(prefix+(x+1)*4), s);
+		}
+#else
+		for (x = 0; x < dw; ++x)
+		{
+			prefix[(x+1)*4]   = prefix[x*4]   + row[x*4];
+			prefix[(x+1)*4+1] = prefix[x*4+1] + row[x*4+1];
+			prefix[(x+1)*4+2] = prefix[x*4+2] + row[x*4+2];
+			prefix[(x+1)*4+3] = prefix[x*4+3] + row[x*4+3];
+		}
+#endif
+
+		// add the row to every output row whose window covers it
+		for (i = next; (i < outHeight) && (i*dh/outHeight <= y); ++i)
+		{
+			int ys = i*dh/outHeight;
+			Uint32 *a = acc + (i%nacc)*outWidth*4;
+
+			if (y >= min(ys+navg, dh))
+				continue;
+			if (y == ys)
+				memset(a, 0, outWidth*4*sizeof(Uint32));
+
+			for (j = 0; j < outWidth; ++j)
+			{
+#if defined(TRANSFORM_NEON)
+				vst1q_u32(a+j*4, vaddq_u32(vld1q_u32(a+j*4), vsubq_u32(vld1q_u32(prefix+xe[j]*4), vld1q_u32(prefix+xs[j]*4))));
+#elif defined(TRANSFORM_SSE2)
+				_mm_storeu_si128((__m128i*)(a+j*4), _mm_add_epi32(_mm_loadu_si128((const __m128i*)(a+j*4)),
+					_mm_sub_epi32(_mm_loadu_si128((const __m128i*)(prefix+xe[j]*4)), _mm_loadu_si128((const __m128i*)(prefix+xs[j]*4)))));
+#else
+				a[j*4]   += prefix[xe[j]*4]   - prefix[xs[j]*4];
+				a[j*4+1] += prefix[xe[j]*4+1] - prefix[xs[j]*4+1];
+				a[j*4+2] += prefix[xe[j]*4+2] - prefix[xs[j]*4+2];
+#endif
+			}
+		}
+
+		// output rows whose windows are complete
+		while ((next < outHeight) && (min(next*dh/outHeight+navg, dh) <= y+1))
+		{
+			int ys = next*dh/outHeight;
+			int rows = min(ys+navg, dh) - ys;
+			const Uint32 *a = acc + (next%nacc)*outWidth*4;
+			Uint8 *o = out + (outHeight-1-next)*4;
+
+			for (j = 0; j < outWidth; ++j, o += outHeight*4)
+			{
+				Uint32 n = rows*(xe[j]-xs[j]);
+				o[0] = a[j*4]/n;
+				o[1] = a[j*4+1]/n;
+				o[2] = a[j*4+2]/n;
+				o[3] = 255;
+			}
+			++next;
+		}
+	}
+
+	if (cinfo.output_scanline < cinfo.output_height)
+		jpeg_abort_decompress(&cinfo);
+	else
+		(void) jpeg_finish_decompress(&cinfo);
+	jpeg_destroy_decompress(&cinfo);
+
+	return 1;
+}
+
+
+
+// returns:
+// -1 - not enough memory
+// 0<X<nFrames - X = frame index where error is happened during decoding
+// 255 - all ok
+//
+// Frames are decoded in parallel. If there are fewer frames than cores each frame
+// is split at restart markers into parts which are decoded in parallel too.
+int DecodeAndRotateMultipleJpegs
+(
+	unsigned char **yuvFrame,
+	unsigned char **jpeg,
+	int *jpeg_length,
+	int sx,
+	int sy,
+	int nFrames,
+	int needRotation,
+	int cameraMirrored,
+	int rotationDegree,
+	bool needFreeMem//true by default
+)
+{
+	int i;
+	int isFoundinInput = 255; // if error is found during decoding - the frame index will be here
+	int nThreads, partsPerFrame, nJobs;
+	int *jobFrame, *jobFirst, *jobLast;
+	int flipLR, flipUD, rotate90;
+	JpegRestartIndex *idx;
+
+	LOGD("ConvertFromJpeg - start");
+
+	// pre-allocate uncompressed yuv buffers
+	for (i=0; i<nFrames; ++i)
+	{
+		yuvFrame[i] = (unsigned char*)FramePool_Alloc(sx*sy+2*((sx+1)/2)*((sy+1)/2));
+
+		if (yuvFrame[i]==NULL)
+		{
+			LOGE("ConvertFromJpeg - not enough memory");
+
+			i--;
+			for (;i>=0;--i)
+			{
+				FramePool_Free(yuvFrame[i]);
+				yuvFrame[i] = NULL;
+			}
+			return -1;
+		}
+	}
+
+	nThreads = omp_get_num_procs();
+	// a couple of parts per core to even out the load
+	partsPerFrame = (nFrames >= nThreads) ? 1 : (2*nThreads + nFrames - 1) / nFrames;
+
+	GetNV21Transform(needRotation, cameraMirrored, rotationDegree, &flipLR, &flipUD, &rotate90);
+
+	idx = (JpegRestartIndex*)calloc(nFrames, sizeof(JpegRestartIndex));
+	jobFrame = (int*)malloc(nFrames * partsPerFrame * sizeof(int));
+	jobFirst = (int*)malloc(nFrames * partsPerFrame * sizeof(int));
+	jobLast = (int*)malloc(nFrames * partsPerFrame * sizeof(int));
+	if (idx == NULL || jobFrame == NULL || jobFirst == NULL || jobLast == NULL)
+	{
+		LOGE("ConvertFromJpeg - not enough memory");
+		free(idx); free(jobFrame); free(jobFirst); free(jobLast);
+		for (i=0; i<nFrames; ++i)
+		{
+			FramePool_Free(yuvFrame[i]);
+			yuvFrame[i] = NULL;
+		}
+		return -1;
+	}
+
+	// split frames into decoding jobs
+	nJobs = 0;
+	for (i=0; i<nFrames; ++i)
+	{
+		int parts = 1;
+
+		if ((partsPerFrame > 1) && IndexJpegRestarts(jpeg[i], jpeg_length[i], &idx[i]))
+			parts = min(partsPerFrame, idx[i].nIntervals);
+
+		if (parts > 1)
+		{
+			for (int k=0; k<parts; ++k)
+			{
+				jobFrame[nJobs] = i;
+				jobFirst[nJobs] = k * idx[i].nIntervals / parts;
+				jobLast[nJobs] = (k+1) * idx[i].nIntervals / parts;
+				nJobs++;
+			}
+		}
+		else
+		{
+			// whole frame
+			FreeJpegRestartIndex(&idx[i]);
+			jobFrame[nJobs] = i;
+			jobFirst[nJobs] = 0;
+			jobLast[nJobs] = 0;
+			nJobs++;
+		}
+	}
+
+	// parts are stored into their final (mirrored/rotated) place straight away
+	#pragma omp parallel for schedule(dynamic)
+	for (i=0; i<nJobs; ++i)
+	{
+		int frame = jobFrame[i];
+		int res;
+
+		if (jobLast[i] == 0)
+			res = DecodeJpegRowsNV21(yuvFrame[frame], sx, sy, 0, jpeg[frame], jpeg_length[frame], flipLR, flipUD, rotate90);
+		else
+		{
+			int partlen;
+			Uint8 *part = MakeJpegPart(jpeg[frame], &idx[frame], jobFirst[i], jobLast[i], &partlen);
+
+			res = 0;
+			if (part != NULL)
+			{
+				res = DecodeJpegRowsNV21(yuvFrame[frame], sx, sy, jobFirst[i] * idx[frame].interval_rows, part, partlen,
+						flipLR, flipUD, rotate90);
+				free(part);
+			}
+		}
+
+		// decode from jpeg
+		if (res == 0)
+		{
+			isFoundinInput = frame;
+			LOGE("Error Found in %d - jpeg frame\n", (int)frame);
+		}
+	}
+
+	for (i=0; i<nFrames; ++i)
+	{
+		FreeJpegRestartIndex(&idx[i]);
+
+		// release compressed memory
+		if (needFreeMem)
+			free (jpeg[i]);
+	}
+
+	free(idx);
+	free(jobFrame);
+	free(jobFirst);
+	free(jobLast);
+
+	LOGD("ConvertFromJpeg - end");
+
+	return isFoundinInput;
+}
+
+// mirror/rotate kernels
+//
+// Rotation is done as a tiled transpose: square tiles of NxN elements are
+// transposed in registers and the whole image is walked in TRANSFORM_BLOCK
+// sized blocks so that both the rows being read and the rows being written
+// stay in cache. Mirroring without rotation only reverses rows and/or
+// swaps them, which is done with a vector reverse.
+
+#define TRANSFORM_BLOCK		64
+
+static inline void ReverseRow(const Uint8 *in, Uint8 *out, int n)
+{
+	int x = 0;
+#if defined(TRANSFORM_NEON)
+	for (; x+16<=n; x+=16)
+	{
+		uint8x16_t v = vrev64q_u8(vld1q_u8(in+x));
+		vst1q_u8(out+n-16-x, vcombine_u8(vget_high_u8(v), vget_low_u8(v)));
+	}
+#elif defined(TRANSFORM_SSE2)
+	for (; x+16<=n; x+=16)
+	{
+		__m128i v = _mm_loadu_si128((const __m128i*)(in+x));
+		// swap bytes within 16bit words, then reverse the words
+		v = _mm_or_si128(_mm_slli_epi16(v, 8), _mm_srli_epi16(v, 8));
+		v = _mm_shufflelo_epi16(v, _MM_SHUFFLE(0,1,2,3));
+		v = _mm_shufflehi_epi16(v, _MM_SHUFFLE(0,1,2,3));
+		v = _mm_shuffle_epi32(v, _MM_SHUFFLE(1,0,3,2));
+		_mm_storeu_si128((__m128i*)(out+n-16-x), v);
+	}
+#endif
+	for (; x<n; ++x)
+		out[n-1-x] = in[x];
+}
+
+static inline void ReverseRow(const Uint16 *in, Uint16 *out, int n)
+{
+	int x = 0;
+#if defined(TRANSFORM_NEON)
+	for (; x+8<=n; x+=8)
+	{
+		uint16x8_t v = vrev64q_u16(vld1q_u16(in+x));
+		vst1q_u16(out+n-8-x, vcombine_u16(vget_high_u16(v), vget_low_u16(v)));
+	}
+#elif defined(TRANSFORM_SSE2)
+	for (; x+8<=n; x+=8)
+	{
+		__m128i v = _mm_loadu_si128((const __m128i*)(in+x));
+		v = _mm_shufflelo_epi16(v, _MM_SHUFFLE(0,1,2,3));
+		v = _mm_shufflehi_epi16(v, _MM_SHUFFLE(0,1,2,3));
+		v = _mm_shuffle_epi32(v, _MM_SHUFFLE(1,0,3,2));
+		_mm_storeu_si128((__m128i*)(out+n-8-x), v);
+	}
+#endif
+	for (; x<n; ++x)
+		out[n-1-x] = in[x];
+}
+
+static inline void ReverseRow(const Uint32 *in, Uint32 *out, int n)
+{
+	int x = 0;
+#if defined(TRANSFORM_NEON)
+	for (; x+4<=n; x+=4)
+	{
+		uint32x4_t v = vrev64q_u32(vld1q_u32(in+x));
+		vst1q_u32(out+n-4-x, vcombine_u32(vget_high_u32(v), vget_low_u32(v)));
+	}
+#elif defined(TRANSFORM_SSE2)
+	for (; x+4<=n; x+=4)
+	{
+		__m128i v = _mm_loadu_si128((const __m128i*)(in+x));
+		_mm_storeu_si128((__m128i*)(out+n-4-x), _mm_shuffle_epi32(v, _MM_SHUFFLE(0,1,2,3)));
+	}
+#endif
+	for (; x<n; ++x)
+		out[n-1-x] = in[x];
+}
+
+
+// transpose of NxN tile: out[j][i] = in[i][j]
+// tile size is 8 for 8 and 16 bit elements and 4 for 32 bit elements
+template <typename T> struct TransposeTileSize { enum { N = 8 }; };
+template <> struct TransposeTileSize<Uint32> { enum { N = 4 }; };
+
+static inline void TransposeTile(const Uint8 * const *in, Uint8 * const *out)
+{
+#if defined(TRANSFORM_NEON)
+	uint8x8x2_t t01 = vtrn_u8(vld1_u8(in[0]), vld1_u8(in[1]));
+	uint8x8x2_t t23 = vtrn_u8(vld1_u8(in[2]), vld1_u8(in[3]));
+	uint8x8x2_t t45 = vtrn_u8(vld1_u8(in[4]), vld1_u8(in[5]));
+	uint8x8x2_t t67 = vtrn_u8(vld1_u8(in[6]), vld1_u8(in[7]));
+
+	uint16x4x2_t u02 = vtrn_u16(vreinterpret_u16_u8(t01.val[0]), vreinterpret_u16_u8(t23.val[0]));
+	uint16x4x2_t u13 = vtrn_u16(vreinterpret_u16_u8(t01.val[1]), vreinterpret_u16_u8(t23.val[1]));
+	uint16x4x2_t u46 = vtrn_u16(vreinterpret_u16_u8(t45.val[0]), vreinterpret_u16_u8(t67.val[0]));
+	uint16x4x2_t u57 = vtrn_u16(vreinterpret_u16_u8(t45.val[1]), vreinterpret_u16_u8(t67.val[1]));
+
+	uint32x2x2_t v04 = vtrn_u32(vreinterpret_u32_u16(u02.val[0]), vreinterpret_u32_u16(u46.val[0]));
+	uint32x2x2_t v26 = vtrn_u32(vreinterpret_u32_u16(u02.val[1]), vreinterpret_u32_u16(u46.val[1]));
+	uint32x2x2_t v15 = vtrn_u32(vreinterpret_u32_u16(u13.val[0]), vreinterpret_u32_u16(u57.val[0]));
+	uint32x2x2_t v37 = vtrn_u32(vreinterpret_u32_u16(u13.val[1]), vreinterpret_u32_u16(u57.val[1]));
+
+	vst1_u8(out[0], vreinterpret_u8_u32(v04.val[0]));
+	vst1_u8(out[1], vreinterpret_u8_u32(v15.val[0]));
+	vst1_u8(out[2], vreinterpret_u8_u32(v26.val[0]));
+	vst1_u8(out[3], vreinterpret_u8_u32(v37.val[0]));
+	vst1_u8(out[4], vreinterpret_u8_u32(v04.val[1]));
+	vst1_u8(out[5], vreinterpret_u8_u32(v15.val[1]));
+	vst1_u8(out[6], vreinterpret_u8_u32(v26.val[1]));
+	vst1_u8(out[7], vreinterpret_u8_u32(v37.val[1]));
+#elif defined(TRANSFORM_SSE2)
+	__m128i b0 = _mm_unpacklo_epi8(_mm_loadl_epi64((const __m128i*)in[0]), _mm_loadl_epi64((const __m128i*)in[1]));
+	__m128i b1 = _mm_unpacklo_epi8(_mm_loadl_epi64((const __m128i*)in[2]), _mm_loadl_epi64((const __m128i*)in[3]));
+	__m128i b2 = _mm_unpacklo_epi8(_mm_loadl_epi64((const __m128i*)in[4]), _mm_loadl_epi64((const __m128i*)in[5]));
+	__m128i b3 = _mm_unpacklo_epi8(_mm_loadl_epi64((const __m128i*)in[6]), _mm_loadl_epi64((const __m128i*)in[7]));
+
+	__m128i c0 = _mm_unpacklo_epi16(b0, b1);
+	__m128i c1 = _mm_unpackhi_epi16(b0, b1);
+	__m128i c2 = _mm_unpacklo_epi16(b2, b3);
+	__m128i c3 = _mm_unpackhi_epi16(b2, b3);
+
+	__m128i d0 = _mm_unpacklo_epi32(c0, c2);
+	__m128i d1 = _mm_unpackhi_epi32(c0, c2);
+	__m128i d2 = _mm_unpacklo_epi32(c1, c3);
+	__m128i d3 = _mm_unpackhi_epi32(c1, c3);
+
+	_mm_storel_epi64((__m128i*)out[0], d0);
+	_mm_storel_epi64((__m128i*)out[1], _mm_unpackhi_epi64(d0, d0));
+	_mm_storel_epi64((__m128i*)out[2], d1);
+	_mm_storel_epi64((__m128i*)out[3], _mm_unpackhi_epi64(d1, d1));
+	_mm_storel_epi64((__m128i*)out[4], d2);
+	_mm_storel_epi64((__m128i*)out[5], _mm_unpackhi_epi64(d2, d2));
+	_mm_storel_epi64((__m128i*)out[6], d3);
+	_mm_storel_epi64((__m128i*)out[7], _mm_unpackhi_epi64(d3, d3));
+#else
+	int i, j;
+	for (i=0; i<8; ++i)
+		for (j=0; j<8; ++j)
+			out[j][i] = in[i][j];
+#endif
+}
+
+static inline void TransposeTile(const Uint16 * const *in, Uint16 * const *out)
+{
+#if defined(TRANSFORM_NEON)
+	uint16x8x2_t t01 = vtrnq_u16(vld1q_u16(in[0]), vld1q_u16(in[1]));
+	uint16x8x2_t t23 = vtrnq_u16(vld1q_u16(in[2]), vld1q_u16(in[3]));
+	uint16x8x2_t t45 = vtrnq_u16(vld1q_u16(in[4]), vld1q_u16(in[5]));
+	uint16x8x2_t t67 = vtrnq_u16(vld1q_u16(in[6]), vld1q_u16(in[7]));
+
+	uint32x4x2_t u02 = vtrnq_u32(vreinterpretq_u32_u16(t01.val[0]), vreinterpretq_u32_u16(t23.val[0]));
+	uint32x4x2_t u13 = vtrnq_u32(vreinterpretq_u32_u16(t01.val[1]), vreinterpretq_u32_u16(t23.val[1]));
+	uint32x4x2_t u46 = vtrnq_u32(vreinterpretq_u32_u16(t45.val[0]), vreinterpretq_u32_u16(t67.val[0]));
+	uint32x4x2_t u57 = vtrnq_u32(vreinterpretq_u32_u16(t45.val[1]), vreinterpretq_u32_u16(t67.val[1]));
+
+	vst1q_u16(out[0], vreinterpretq_u16_u32(vcombine_u32(vget_low_u32(u02.val[0]), vget_low_u32(u46.val[0]))));
+	vst1q_u16(out[1], vreinterpretq_u16_u32(vcombine_u32(vget_low_u32(u13.val[0]), vget_low_u32(u57.val[0]))));
+	vst1q_u16(out[2], vreinterpretq_u16_u32(vcombine_u32(vget_low_u32(u02.val[1]), vget_low_u32(u46.val[1]))));
+	vst1q_u16(out[3], vreinterpretq_u16_u32(vcombine_u32(vget_low_u32(u13.val[1]), vget_low_u32(u57.val[1]))));
+	vst1q_u16(out[4], vreinterpretq_u16_u32(vcombine_u32(vget_high_u32(u02.val[0]), vget_high_u32(u46.val[0]))));
+	vst1q_u16(out[5], vreinterpretq_u16_u32(vcombine_u32(vget_high_u32(u13.val[0]), vget_high_u32(u57.val[0]))));
+	vst1q_u16(out[6], vreinterpretq_u16_u32(vcombine_u32(vget_high_u32(u02.val[1]), vget_high_u32(u46.val[1]))));
+	vst1q_u16(out[7], vreinterpretq_u16_u32(vcombine_u32(vget_high_u32(u13.val[1]), vget_high_u32(u57.val[1]))));
+#elif defined(TRANSFORM_SSE2)
+	__m128i a0 = _mm_loadu_si128((const __m128i*)in[0]);
+	__m128i a1 = _mm_loadu_si128((const __m128i*)in[1]);
+	__m128i a2 = _mm_loadu_si128((const __m128i*)in[2]);
+	__m128i a3 = _mm_loadu_si128((const __m128i*)in[3]);
+	__m128i a4 = _mm_loadu_si128((const __m128i*)in[4]);
+	__m128i a5 = _mm_loadu_si128((const __m128i*)in[5]);
+	__m128i a6 = _mm_loadu_si128((const __m128i*)in[6]);
+	__m128i a7 = _mm_loadu_si128((const __m128i*)in[7]);
+
+	__m128i b0 = _mm_unpacklo_epi16(a0, a1);
+	__m128i b1 = _mm_unpackhi_epi16(a0, a1);
+	__m128i b2 = _mm_unpacklo_epi16(a2, a3);
+	__m128i b3 = _mm_unpackhi_epi16(a2, a3);
+	__m128i b4 = _mm_unpacklo_epi16(a4, a5);
+	__m128i b5 = _mm_unpackhi_epi16(a4, a5);
+	__m128i b6 = _mm_unpacklo_epi16(a6, a7);
+	__m128i b7 = _mm_unpackhi_epi16(a6, a7);
+
+	__m128i c0 = _mm_unpacklo_epi32(b0, b2);
+	__m128i c1 = _mm_unpackhi_epi32(b0, b2);
+	__m128i c2 = _mm_unpacklo_epi32(b1, b3);
+	__m128i c3 = _mm_unpackhi_epi32(b1, b3);
+	__m128i c4 = _mm_unpacklo_epi32(b4, b6);
+	__m128i c5 = _mm_unpackhi_epi32(b4, b6);
+	__m128i c6 = _mm_unpacklo_epi32(b5, b7);
+	__m128i c7 = _mm_unpackhi_epi32(b5, b7);
+
+	_mm_storeu_si128((__m128i*)out[0], _mm_unpacklo_epi64(c0, c4));
+	_mm_storeu_si128((__m128i*)out[1], _mm_unpackhi_epi64(c0, c4));
+	_mm_storeu_si128((__m128i*)out[2], _mm_unpacklo_epi64(c1, c5));
+	_mm_storeu_si128((__m128i*)out[3], _mm_unpackhi_epi64(c1, c5));
+	_mm_storeu_si128((__m128i*)out[4], _mm_unpacklo_epi64(c2, c6));
+	_mm_storeu_si128((__m128i*)out[5], _mm_unpackhi_epi64(c2, c6));
+	_mm_storeu_si128((__m128i*)out[6], _mm_unpacklo_epi64(c3, c7));
+	_mm_storeu_si128((__m128i*)out[7], _mm_unpackhi_epi64(c3, c7));
+#else
+	int i, j;
+	for (i=0; i<8; ++i)
+		for (j=0; j<8; ++j)
+			out[j][i] = in[i][j];
+#endif
+}
+
+static inline void TransposeTile(const Uint32 * const *in, Uint32 * const *out)
+{
+#if defined(TRANSFORM_NEON)
+	uint32x4x2_t t01 = vtrnq_u32(vld1q_u32(in[0]), vld1q_u32(in[1]));
+	uint32x4x2_t t23 = vtrnq_u32(vld1q_u32(in[2]), vld1q_u32(in[3]));
+
+	vst1q_u32(out[0], vcombine_u32(vget_low_u32(t01.val[0]), vget_low_u32(t23.val[0])));
+	vst1q_u32(out[1], vcombine_u32(vget_low_u32(t01.val[1]), vget_low_u32(t23.val[1])));
+	vst1q_u32(out[2], vcombine_u32(vget_high_u32(t01.val[0]), vget_high_u32(t23.val[0])));
+	vst1q_u32(out[3], vcombine_u32(vget_high_u32(t01.val[1]), vget_high_u32(t23.val[1])));
+#elif defined(TRANSFORM_SSE2)
+	__m128i a0 = _mm_loadu_si128((const __m128i*)in[0]);
+	__m128i a1 = _mm_loadu_si128((const __m128i*)in[1]);
+	__m128i a2 = _mm_loadu_si128((const __m128i*)in[2]);
+	__m128i a3 = _mm_loadu_si128((const __m128i*)in[3]);
+
+	__m128i b0 = _mm_unpacklo_epi32(a0, a1);
+	__m128i b1 = _mm_unpackhi_epi32(a0, a1);
+	__m128i b2 = _mm_unpacklo_epi32(a2, a3);
+	__m128i b3 = _mm_unpackhi_epi32(a2, a3);
+
+	_mm_storeu_si128((__m128i*)out[0], _mm_unpacklo_epi64(b0, b2));
+	_mm_storeu_si128((__m128i*)out[1], _mm_unpackhi_epi64(b0, b2));
+	_mm_storeu_si128((__m128i*)out[2], _mm_unpacklo_epi64(b1, b3));
+	_mm_storeu_si128((__m128i*)out[3], _mm_unpackhi_epi64(b1, b3));
+#else
+	int i, j;
+	for (i=0; i<4; ++i)
+		for (j=0; j<4; ++j)
+			out[j][i] = in[i][j];
+#endif
+}
+
+
+// in-place mirror by swapping pixels, needs no row buffers
+template <typename T>
+static void MirrorPlaneSwap(T *Buf, int sx, int sy, int flipLeftRight, int flipUpDown)
+{
+	int x, y;
+	T t;
+
+	for (y=0; y<(sy+1)/2; ++y)
+	{
+		T *a = Buf + y*sx;
+		T *b = Buf + (sy-1-y)*sx;
+
+		if (flipUpDown && flipLeftRight)
+		{
+			// the middle row is only reversed
+			if (a == b)
+				for (x=0; x<sx/2; ++x)
+				{
+					t = a[x]; a[x] = a[sx-1-x]; a[sx-1-x] = t;
+				}
+			else
+				for (x=0; x<sx; ++x)
+				{
+					t = a[x]; a[x] = b[sx-1-x]; b[sx-1-x] = t;
+				}
+		}
+		else if (flipUpDown)
+		{
+			for (x=0; x<sx; ++x)
+			{
+				t = a[x]; a[x] = b[x]; b[x] = t;
+			}
+		}
+		else if (flipLeftRight)
+		{
+			for (x=0; x<sx/2; ++x)
+			{
+				t = a[x]; a[x] = a[sx-1-x]; a[sx-1-x] = t;
+				if (a != b)
+				{
+					t = b[x]; b[x] = b[sx-1-x]; b[sx-1-x] = t;
+				}
+			}
+		}
+	}
+}
+
+
+// mirror (no rotation), row pairs y and sy-1-y are handled together
+// so that in-place operation is possible
+template <typename T>
+static void MirrorPlane(T *In, T *Out, int sx, int sy, int flipLeftRight, int flipUpDown)
+{
+	int inplace = (In == Out);
+	int nThreads = omp_get_max_threads();
+	T *rows = NULL;
+
+	// in-place operation takes two rows of scratch per thread
+	if (inplace)
+	{
+		rows = (T*)malloc(nThreads*2*sx*sizeof(T));
+		if (rows == NULL)
+		{
+			MirrorPlaneSwap(In, sx, sy, flipLeftRight, flipUpDown);
+			return;
+		}
+	}
+
+	#pragma omp parallel num_threads(nThreads)
 	{
-		jpeg_read_scanlines(&cinfo, scanline, (JDIMENSION)1);
+		int y;
+		T *tmp = inplace ? rows + omp_get_thread_num()*2*sx : NULL;
 
-		for (i = 0; i < cinfo.output_width; i++)
+		#pragma omp for schedule(guided)
+		for (y=0; y<(sy+1)/2; ++y)
 		{
-			buff_cursor[0] = wline[i * 4];
-			buff_cursor[1] = wline[i * 4 + 1];
-			buff_cursor[2] = wline[i * 4 + 2];
-			buff_cursor[3] = wline[i * 4 + 3];
+			int y2 = sy-1-y;
+			T *a = In + y*sx;
+			T *b = In + y2*sx;
+			T *oa = Out + (flipUpDown ? y2 : y)*sx;
+			T *ob = Out + (flipUpDown ? y : y2)*sx;
 
-			buff_cursor += 4;
+			if (inplace)
+			{
+				if (flipLeftRight)
+				{
+					ReverseRow(a, tmp, sx);
+					if (y2 != y) ReverseRow(b, tmp+sx, sx);
+				}
+				else
+				{
+					memcpy(tmp, a, sx*sizeof(T));
+					if (y2 != y) memcpy(tmp+sx, b, sx*sizeof(T));
+				}
+				memcpy(oa, tmp, sx*sizeof(T));
+				if (y2 != y) memcpy(ob, tmp+sx, sx*sizeof(T));
+			}
+			else if (flipLeftRight)
+			{
+				ReverseRow(a, oa, sx);
+				if (y2 != y) ReverseRow(b, ob, sx);
+			}
+			else
+			{
+				memcpy(oa, a, sx*sizeof(T));
+				if (y2 != y) memcpy(ob, b, sx*sizeof(T));
+			}
 		}
 	}
 
-	(void) jpeg_finish_decompress(&cinfo);
-	jpeg_destroy_decompress(&cinfo);
-
-	return 1;
+	free(rows);
 }
 
 
-// returns:
-// -1 - not enough memory
-// 0<X<nFrames - X = frame index where error is happened during decoding
-// 255 - all ok
-int DecodeAndRotateMultipleJpegs
-(
-	unsigned char **yuvFrame,
-	unsigned char **jpeg,
-	int *jpeg_length,
-	int sx,
-	int sy,
-	int nFrames,
-	int needRotation,
-	int cameraMirrored,
-	int rotationDegree,
-	bool needFreeMem//true by default
-)
+// rotate 90 degree clockwise with optional mirroring, Out is sy x sx
+//
+// input pixel (x,y) goes to output (ox,oy):
+//   ox = flipLeftRight ? y : sy-1-y
+//   oy = flipUpDown ? sx-1-x : x
+//
+// a tile of N input rows y..y+N-1 and N columns x..x+N-1 maps onto
+// N output rows; feeding input rows to the transpose in reverse order
+// when ox decreases with y keeps the output row segment contiguous
+template <typename T>
+static void RotatePlane(T *In, T *Out, int sx, int sy, int flipLeftRight, int flipUpDown)
 {
-	int i;
-	int isFoundinInput = 255; // if error is found during decoding - the frame index will be here
-
-	LOGD("ConvertFromJpeg - start");
-
-	// pre-allocate uncompressed yuv buffers
-	for (i=0; i<nFrames; ++i)
+	const int N = TransposeTileSize<T>::N;
+	const int osx = sy;
+	const int sxT = sx - sx%N;
+	const int syT = sy - sy%N;
+	int bx;
+
+	// blocks of input columns map to blocks of output rows,
+	// so every thread writes its own set of output rows
+	#pragma omp parallel for schedule(dynamic)
+	for (bx=0; bx<sxT; bx+=TRANSFORM_BLOCK)
 	{
-		yuvFrame[i] = (unsigned char*)malloc(sx*sy+2*((sx+1)/2)*((sy+1)/2));
+		int x, y, i;
+		int bxe = bx+TRANSFORM_BLOCK < sxT ? bx+TRANSFORM_BLOCK : sxT;
+		const T *in[N];
+		T *out[N];
 
-		if (yuvFrame[i]==NULL)
+		for (y=0; y<syT; y+=TRANSFORM_BLOCK)
 		{
-			LOGE("ConvertFromJpeg - not enough memory");
+			int bye = y+TRANSFORM_BLOCK < syT ? y+TRANSFORM_BLOCK : syT;
+			int ty;
 
-			i--;
-			for (;i>=0;--i)
+			for (ty=y; ty<bye; ty+=N)
 			{
-				free(yuvFrame[i]);
-				yuvFrame[i] = NULL;
+				int ox0 = flipLeftRight ? ty : sy-N-ty;
+
+				for (x=bx; x<bxe; x+=N)
+				{
+					for (i=0; i<N; ++i)
+					{
+						in[i] = In + x + (flipLeftRight ? ty+i : ty+N-1-i)*sx;
+						out[i] = Out + ox0 + (flipUpDown ? sx-1-(x+i) : x+i)*osx;
+					}
+					TransposeTile(in, out);
+				}
 			}
-			return -1;
+		}
+
+		// bottom rows which do not fill a whole tile
+		for (y=syT; y<sy; ++y)
+		{
+			int ox = flipLeftRight ? y : sy-1-y;
+			for (x=bx; x<bxe; ++x)
+				Out[ox + (flipUpDown ? sx-1-x : x)*osx] = In[x + y*sx];
 		}
 	}
 
-	#pragma omp parallel for num_threads(10)
-	for (i=0; i<nFrames; ++i)
+	// right columns which do not fill a whole tile
+	if (sxT < sx)
 	{
-		// decode from jpeg
-		if(JPEG2NV21(yuvFrame[i], jpeg[i], jpeg_length[i], sx, sy, needRotation, cameraMirrored, rotationDegree) == 0)
+		int y;
+		#pragma omp parallel for schedule(guided)
+		for (y=0; y<sy; ++y)
 		{
-			isFoundinInput = i;
-			LOGE("Error Found in %d - jpeg frame\n", (int)i);
+			int x;
+			int ox = flipLeftRight ? y : sy-1-y;
+			for (x=sxT; x<sx; ++x)
+				Out[ox + (flipUpDown ? sx-1-x : x)*osx] = In[x + y*sx];
 		}
-
-		// release compressed memory
-		if (needFreeMem)
-			free (jpeg[i]);
 	}
-
-	LOGD("ConvertFromJpeg - end");
-
-	return isFoundinInput;
 }
 
-void TransformPlane8bit
-(
-	unsigned char * In,
-	unsigned char * Out,
-	int sx,
-	int sy,
-	int flipLeftRight,
-	int flipUpDown,
-	int rotate90
-)
-{
-	int y;
-	int osx, osy;
 
+template <typename T>
+static void TransformPlane(T *In, T *Out, int sx, int sy, int flipLeftRight, int flipUpDown, int rotate90)
+{
 	// no transform case
 	if ((!flipLeftRight) && (!flipUpDown) && (!rotate90))
 	{
 		if (In!=Out)
-			memcpy (Out, In, sx*sy*sizeof(unsigned char));
+			memcpy (Out, In, sx*sy*sizeof(T));
 		return;
 	}
 
@@ -323,59 +1308,59 @@ void TransformPlane8bit
 	if (rotate90 && (In == Out))
 		return;
 
-	if (rotate90) {osx = sy; osy = sx;}
-		else {osx = sx; osy = sy;}
+	if (rotate90)
+		RotatePlane(In, Out, sx, sy, flipLeftRight, flipUpDown);
+	else
+		MirrorPlane(In, Out, sx, sy, flipLeftRight, flipUpDown);
+}
+
+
+// straightforward per-pixel version of TransformPlane, used as a reference
+// for correctness and speed in BenchmarkTransformNV21
+template <typename T>
+static void TransformPlaneRef(T *In, T *Out, int sx, int sy, int flipLeftRight, int flipUpDown, int rotate90)
+{
+	int y;
 
-	// processing 4 mirrored locations at once
-	// +1 here to cover case when image dimensions are odd
 	#pragma omp parallel for schedule(guided)
-	for (y=0; y<(sy+1)/2; ++y)
+	for (y=0; y<sy; ++y)
 	{
-		int x;
-		int ox, oy;
-		unsigned char t1, t2, t3, t4;
+		int x, ox, oy;
 
-		for (x=0; x<(sx+1)/2; ++x)
+		for (x=0; x<sx; ++x)
 		{
 			if (rotate90)
 			{
-				if (flipLeftRight) ox = y;
-					else ox = osx-1-y;
-				if (flipUpDown) oy = osy-1-x;
-					else oy = x;
-
-				t1 = In[x + y*sx];
-				t2 = In[sx-1-x + y*sx];
-				t3 = In[x + (sy-1-y)*sx];
-				t4 = In[sx-1-x + (sy-1-y)*sx];
-
-				Out[ox + oy*osx] = t1;
-				Out[osx-1-ox + oy*osx] = t3;
-				Out[ox + (osy-1-oy)*osx] = t2;
-				Out[osx-1-ox + (osy-1-oy)*osx] = t4;
+				ox = flipLeftRight ? y : sy-1-y;
+				oy = flipUpDown ? sx-1-x : x;
+				Out[ox + oy*sy] = In[x + y*sx];
 			}
 			else
 			{
-				if (flipLeftRight) ox = sx-1-x;
-					else ox = x;
-				if (flipUpDown) oy = sy-1-y;
-					else oy = y;
-
-				t1 = In[x + y*sx];
-				t2 = In[sx-1-x + y*sx];
-				t3 = In[x + (sy-1-y)*sx];
-				t4 = In[sx-1-x + (sy-1-y)*sx];
-
-				Out[ox + oy*osx] = t1;
-				Out[osx-1-ox + oy*osx] = t2;
-				Out[ox + (osy-1-oy)*osx] = t3;
-				Out[osx-1-ox + (osy-1-oy)*osx] = t4;
+				ox = flipLeftRight ? sx-1-x : x;
+				oy = flipUpDown ? sy-1-y : y;
+				Out[ox + oy*sx] = In[x + y*sx];
 			}
 		}
 	}
 }
 
 
+void TransformPlane8bit
+(
+	unsigned char * In,
+	unsigned char * Out,
+	int sx,
+	int sy,
+	int flipLeftRight,
+	int flipUpDown,
+	int rotate90
+)
+{
+	TransformPlane<Uint8>(In, Out, sx, sy, flipLeftRight, flipUpDown, rotate90);
+}
+
+
 void TransformPlane16bit
 (
 	unsigned short * In,
@@ -387,70 +1372,7 @@ void TransformPlane16bit
 	int rotate90
 )
 {
-	int y;
-	int osx, osy;
-
-	// no transform case
-	if ((!flipLeftRight) && (!flipUpDown) && (!rotate90))
-	{
-		if (In!=Out)
-			memcpy (Out, In, sx*sy*sizeof(unsigned short));
-		return;
-	}
-
-	// can't rotate in-place
-	if (rotate90 && (In == Out))
-		return;
-
-	if (rotate90) {osx = sy; osy = sx;}
-		else {osx = sx; osy = sy;}
-
-	// processing 4 mirrored locations at once
-	#pragma omp parallel for schedule(guided)
-	for (y=0; y<(sy+1)/2; ++y)
-	{
-		int x;
-		int ox, oy;
-		unsigned short t1, t2, t3, t4;
-
-		for (x=0; x<(sx+1)/2; ++x)
-		{
-			if (rotate90)
-			{
-				if (flipLeftRight) ox = y;
-					else ox = osx-1-y;
-				if (flipUpDown) oy = osy-1-x;
-					else oy = x;
-
-				t1 = In[x + y*sx];
-				t2 = In[sx-1-x + y*sx];
-				t3 = In[x + (sy-1-y)*sx];
-				t4 = In[sx-1-x + (sy-1-y)*sx];
-
-				Out[ox + oy*osx] = t1;
-				Out[osx-1-ox + oy*osx] = t3;
-				Out[ox + (osy-1-oy)*osx] = t2;
-				Out[osx-1-ox + (osy-1-oy)*osx] = t4;
-			}
-			else
-			{
-				if (flipLeftRight) ox = sx-1-x;
-					else ox = x;
-				if (flipUpDown) oy = sy-1-y;
-					else oy = y;
-
-				t1 = In[x + y*sx];
-				t2 = In[sx-1-x + y*sx];
-				t3 = In[x + (sy-1-y)*sx];
-				t4 = In[sx-1-x + (sy-1-y)*sx];
-
-				Out[ox + oy*osx] = t1;
-				Out[osx-1-ox + oy*osx] = t2;
-				Out[ox + (osy-1-oy)*osx] = t3;
-				Out[osx-1-ox + (osy-1-oy)*osx] = t4;
-			}
-		}
-	}
+	TransformPlane<Uint16>(In, Out, sx, sy, flipLeftRight, flipUpDown, rotate90);
 }
 
 
@@ -465,73 +1387,11 @@ void TransformPlane32bit
 	int rotate90
 )
 {
-	int y;
-	int osx, osy;
-
-	// no transform case
-	if ((!flipLeftRight) && (!flipUpDown) && (!rotate90))
-	{
-		if (In!=Out)
-			memcpy (Out, In, sx*sy*sizeof(unsigned int));
-		return;
-	}
-
-	// can't rotate in-place
-	if (rotate90 && (In == Out))
-		return;
-
-	if (rotate90) {osx = sy; osy = sx;}
-		else {osx = sx; osy = sy;}
-
-	// processing 4 mirrored locations at once
-	#pragma omp parallel for schedule(guided)
-	for (y=0; y<(sy+1)/2; ++y)
-	{
-		int x;
-		int ox, oy;
-		unsigned int t1, t2, t3, t4;
-
-		for (x=0; x<(sx+1)/2; ++x)
-		{
-			if (rotate90)
-			{
-				if (flipLeftRight) ox = y;
-					else ox = osx-1-y;
-				if (flipUpDown) oy = osy-1-x;
-					else oy = x;
-
-				t1 = In[x + y*sx];
-				t2 = In[sx-1-x + y*sx];
-				t3 = In[x + (sy-1-y)*sx];
-				t4 = In[sx-1-x + (sy-1-y)*sx];
-
-				Out[ox + oy*osx] = t1;
-				Out[osx-1-ox + oy*osx] = t3;
-				Out[ox + (osy-1-oy)*osx] = t2;
-				Out[osx-1-ox + (osy-1-oy)*osx] = t4;
-			}
-			else
-			{
-				if (flipLeftRight) ox = sx-1-x;
-					else ox = x;
-				if (flipUpDown) oy = sy-1-y;
-					else oy = y;
-
-				t1 = In[x + y*sx];
-				t2 = In[sx-1-x + y*sx];
-				t3 = In[x + (sy-1-y)*sx];
-				t4 = In[sx-1-x + (sy-1-y)*sx];
-
-				Out[ox + oy*osx] = t1;
-				Out[osx-1-ox + oy*osx] = t2;
-				Out[ox + (osy-1-oy)*osx] = t3;
-				Out[osx-1-ox + (osy-1-oy)*osx] = t4;
-			}
-		}
-	}
+	TransformPlane<Uint32>(In, Out, sx, sy, flipLeftRight, flipUpDown, rotate90);
 }
 
 
+
 // mirror and/or rotate NV21 image
 //
 // Note:
@@ -579,62 +1439,116 @@ void TransformNV21
 }
 
 
-void NV21_to_RGB
+static long long TransformTimeUs(void)
+{
+	struct timespec now;
+	clock_gettime(CLOCK_MONOTONIC, &now);
+	return (long long)now.tv_sec*1000000 + now.tv_nsec/1000;
+}
+
+static void TransformNV21Ref
 (
-	unsigned char * in,
-	int * out,
-	int   sx,
-	int   sy,
-	int   rotate
+	unsigned char * InNV21,
+	unsigned char * OutNV21,
+	int sx,
+	int sy,
+	int flipLeftRight,
+	int flipUpDown,
+	int rotate90
 )
 {
-	int x, y;
-	short Y1, Y2, u, v, vp, up, va, ua;
-	unsigned int R, G, B;
+	TransformPlaneRef<Uint8>(InNV21, OutNV21, sx, sy, flipLeftRight, flipUpDown, rotate90);
+	TransformPlaneRef<Uint16>((Uint16*)(InNV21+sx*sy), (Uint16*)(OutNV21+sx*sy), sx/2, sy/2, flipLeftRight, flipUpDown, rotate90);
+}
 
-	for (y=0; y<sy; ++y)
-	{
-		up=(short)get_Usz(in, 0, y);
-		vp=(short)get_Vsz(in, 0, y);
 
-		for (x=0; x<sx; x+=2)
-		{
-			Y1 = (short)get_Ysz(in, x, y);
-			Y2 = (short)get_Ysz(in, x+1, y);
-			v  = (short)get_Vsz(in, x, y);
-			if (x<sx-2)
-				u  = (short)get_Usz(in, x+2, y);
-			else
-				u = up;
+// microbenchmark for TransformNV21
+//
+// Times the tiled kernels against the per-pixel reference on a synthetic
+// sx x sy frame for the transforms used after capture: rotate 90 (back camera),
+// rotate 90 mirrored (front camera) and rotate 180.
+// results receives 2 values per case (tiled, reference), in microseconds per call.
+// Returns 1 if both versions produced identical output, 0 on mismatch
+// and -1 if memory could not be allocated.
+//
+int BenchmarkTransformNV21
+(
+	int sx,
+	int sy,
+	int iterations,
+	int *results
+)
+{
+	static const int cases[TRANSFORM_BENCHMARK_CASES][3] =
+	{
+		{0, 0, 1},
+		{1, 0, 1},
+		{1, 1, 0}
+	};
+	int i, c, match = 1;
+	int size = sx*sy*3/2;
+	unsigned char *in, *out, *ref;
+	long long t;
+
+	if (iterations < 1) iterations = 1;
+
+	in = (unsigned char*)malloc(size);
+	out = (unsigned char*)malloc(size);
+	ref = (unsigned char*)malloc(size);
+	if ((in == NULL) || (out == NULL) || (ref == NULL))
+	{
+		free(in);
+		free(out);
+		free(ref);
+		return -1;
+	}
 
-			ua = (u+up)/2;
-			va = (v+vp)/2;
+	for (i=0; i<size; ++i)
+		in[i] = (unsigned char)(i*7 + (i>>8)*13);
 
-			R = CSC_R(Y1, va);
-			G = CSC_G(Y1, up, va);
-			B = CSC_B(Y1, up);
+	for (c=0; c<TRANSFORM_BENCHMARK_CASES; ++c)
+	{
+		// warm up caches and the thread pool, also check correctness
+		TransformNV21(in, out, sx, sy, NULL, cases[c][0], cases[c][1], cases[c][2]);
+		TransformNV21Ref(in, ref, sx, sy, cases[c][0], cases[c][1], cases[c][2]);
+		if (memcmp(out, ref, size))
+			match = 0;
+
+		t = TransformTimeUs();
+		for (i=0; i<iterations; ++i)
+			TransformNV21(in, out, sx, sy, NULL, cases[c][0], cases[c][1], cases[c][2]);
+		results[2*c] = (int)((TransformTimeUs()-t)/iterations);
+
+		t = TransformTimeUs();
+		for (i=0; i<iterations; ++i)
+			TransformNV21Ref(in, ref, sx, sy, cases[c][0], cases[c][1], cases[c][2]);
+		results[2*c+1] = (int)((TransformTimeUs()-t)/iterations);
+
+		LOGD("TransformNV21 %dx%d case %d: tiled %d us, reference %d us", sx, sy, c, results[2*c], results[2*c+1]);
+	}
 
-			if (rotate)
-				out[x*sy+sy-1-y] = (R<<16) + (G<<8) + B + (255<<24);
-			else
-				out[y*sx+x] = (R<<16) + (G<<8) + B + (255<<24);
+	free(in);
+	free(out);
+	free(ref);
 
-			R = CSC_R(Y2, v);
-			G = CSC_G(Y2, ua, v);
-			B = CSC_B(Y2, ua);
+	return match;
+}
 
-			if (rotate)
-				out[(x+1)*sy+sy-1-y] = (R<<16) + (G<<8) + B + (255<<24);
-			else
-				out[y*sx+x+1] = (R<<16) + (G<<8) + B + (255<<24);
 
-			vp = v;
-			up = u;
-		}
-	}
+void NV21_to_RGB
+(
+	unsigned char * in,
+	int * out,
+	int   sx,
+	int   sy,
+	int   rotate
+)
+{
+	NV21_to_RGB_convert(in, sx, sy, 0, 0, sx, sy, sx, sy, CSC_FORMAT_BGRA, rotate, (unsigned char*)out);
 }
 
 
+// stride: 3 - BGR, 4 - RGBA, 5 - RGB (GL)
 void NV21_to_RGB_scaled_rotated
 (
 	unsigned char *pY,
@@ -650,66 +1564,20 @@ void NV21_to_RGB_scaled_rotated
 	unsigned char *buffer
 )
 {
-	unsigned char *pUV = pY + width * height;
-
-	int i, j, is, js;
-	int nY, nU, nV;
-	unsigned char *out = buffer;
-	int offset;
-	int bgr = 1;
+	int format;
 
-	if (stride >= 5)	// a special case for GL - RGBA
-	{
-		bgr = 0;
-		stride -= 2;
-	}
+	if (stride >= 5)
+		format = CSC_FORMAT_RGB;
 	else if (stride == 4)
-	{
-		bgr = 0;
-	}
-
-	const int tripleHeight = (outHeight - 1) * stride;
-	int yoffset = tripleHeight;
-
-	pY += x0 + y0 * width;
-	pUV += x0-(x0&1) + (y0/2) * width;
-
-	for (i = 0; i < outHeight; i++)
-	{
-		offset = yoffset;
-
-		is = i * hCrop / outHeight;
-
-		for (j = 0; j < outWidth; j++)
-		{
-			js = j * wCrop / outWidth;
-
-			nY = *(pY + is * width + js);
-			nV = *(pUV + (is / 2) * width + 2 * (js / 2));
-			nU = *(pUV + (is / 2) * width + 2 * (js / 2) + 1);
-
-			if (bgr)	// usual bitmap has BGRA format
-			{
-				out[offset++] = CSC_B(nY, nU);
-				out[offset++] = CSC_G(nY, nU, nV);
-				out[offset++] = CSC_R(nY, nV);
-			}
-			else		// a special case for GL - RGBA
-			{
-				out[offset++] = CSC_R(nY, nV);
-				out[offset++] = CSC_G(nY, nU, nV);
-				out[offset++] = CSC_B(nY, nU);
-			}
-			if (stride == 4) out[offset++] = 255;
-
-			offset += tripleHeight;
-		}
+		format = CSC_FORMAT_RGBA;
+	else
+		format = CSC_FORMAT_BGR;
 
-		yoffset -= stride;
-	}
+	NV21_to_RGB_convert(pY, width, height, x0, y0, wCrop, hCrop, outWidth, outHeight, format, 1, buffer);
 }
 
 
+// stride: 3 - BGR, 4 - BGRA (Android Bitmap)
 void NV21_to_RGB_scaled
 (
 	unsigned char *pY,
@@ -725,37 +1593,8 @@ void NV21_to_RGB_scaled
 	unsigned char *buffer
 )
 {
-    unsigned char *pUV = pY + width * height + (x0&~1) + (y0/2)*width;
-    pY += x0+y0*width;
-
-    int i, j, is, js;
-    unsigned char *out = buffer;
-    int offset = 0;
-    const float scaleWidth = wCrop / outWidth;
-    const float scaleHeight = hCrop / outHeight;
-
-    int Y, U, V;
-
-    for (i = 0; i < outHeight; i++)
-    {
-    	offset = i * outWidth * 4;
-
-        is = i * hCrop / outHeight;
-
-        for (j = 0; j < outWidth; j++)
-        {
-            js = j * wCrop / outWidth;
-
-            Y = *(pY + is * width + js);
-            V = *(pUV + (is / 2) * width + 2*(js / 2));
-            U = *(pUV + (is / 2) * width + 2*(js / 2) + 1);
-
-			out[offset++] = CSC_B(Y,U);
-			out[offset++] = CSC_G(Y, U, V);
-			out[offset++] = CSC_R(Y,V);
-			if (stride == 4) out[offset++] = 255;
-        }
-    }
+	NV21_to_RGB_convert(pY, width, height, x0, y0, wCrop, hCrop, outWidth, outHeight,
+		stride == 4 ? CSC_FORMAT_BGRA : CSC_FORMAT_BGR, 0, buffer);
 }
 
 
@@ -903,7 +1742,7 @@ extern "C" JNIEXPORT jintArray JNICALL Java_com_almalence_util_ImageConversion_N
 (
 	JNIEnv* env,
 	jobject thiz,
-	jint inptr,
+	jlong inptr,
 	jobject srcSize,
 	jobject rect,
 	jobject dstSize
@@ -936,7 +1775,11 @@ extern "C" JNIEXPORT jintArray JNICALL Java_com_almalence_util_ImageConversion_N
 	jfieldID id_dstH = env->GetFieldID(dst_size, "height", "I");
 	jint dstH = env->GetIntField(dstSize,id_dstH);
 
-	LOGD("inptr = %d srcW = %d srcH = %d ", inptr, srcW, srcH);
+	Uint8 *in = (Uint8 *)FrameHandle_Data(inptr, srcW*srcH+srcW*((srcH+1)/2));
+	if (in == NULL)
+		return NULL;
+
+	LOGD("inptr = %llx srcW = %d srcH = %d ", (long long)inptr, srcW, srcH);
 	LOGD("left = %d top = %d right = %d bottom = %d ", left, top, right, bottom);
 	LOGD("dstW = %d dstH = %d", dstW, dstH);
 
@@ -944,7 +1787,7 @@ extern "C" JNIEXPORT jintArray JNICALL Java_com_almalence_util_ImageConversion_N
 	LOGD("Memory alloc size = %d * %d", dstW, dstH);
 	pixels = (Uint32 *)env->GetIntArrayElements(jpixels, NULL);
 
-	NV21_to_RGB_scaled((Uint8 *)inptr, srcW, srcH, left, top, right - left, bottom - top, dstW, dstH, 4, (Uint8 *)pixels);
+	NV21_to_RGB_scaled(in, srcW, srcH, left, top, right - left, bottom - top, dstW, dstH, 4, (Uint8 *)pixels);
 
 	env->ReleaseIntArrayElements(jpixels, (jint*)pixels, 0);
 
@@ -53,6 +53,17 @@ int JPEG2RGBA
 	int jpeglen
 );
 
+// decode jpeg into RGBA of outWidth x outHeight rotated 90 degree clockwise,
+// using DCT-scaled decoding and area averaging
+int JPEG2RGBA_downscaled_rotated
+(
+	unsigned char *out,
+	unsigned char *jpegdata,
+	int jpeglen,
+	int outWidth,
+	int outHeight
+);
+
 int DecodeAndRotateMultipleJpegs
 (
 	unsigned char **yuvFrame,
@@ -102,6 +113,19 @@ void TransformNV21
 );
 
 
+// microbenchmark comparing TransformNV21 against a per-pixel reference,
+// results receives TRANSFORM_BENCHMARK_CASES pairs of (tiled, reference) times in microseconds
+#define TRANSFORM_BENCHMARK_CASES	3
+
+int BenchmarkTransformNV21
+(
+	int sx,
+	int sy,
+	int iterations,
+	int *results
+);
+
+
 void NV21_to_RGB
 (
 	unsigned char * in,
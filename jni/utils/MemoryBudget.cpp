@@ -0,0 +1,264 @@
+/*
+The contents of this file are subject to the Mozilla Public License
+Version 1.1 (the "License"); you may not use this file except in
+compliance with the License. You may obtain a copy of the License at
+http://www.mozilla.org/MPL/
+
+Software distributed under the License is distributed on an "AS IS"
+basis, WITHOUT WARRANTY OF ANY KIND, either express or implied. See the
+License for the specific language governing rights and limitations
+under the License.
+
+The Original Code is collection of files collectively known as Open Camera.
+
+The Initial Developer of the Original Code is Almalence Inc.
+Portions created by Initial Developer are Copyright (C) 2013
+by Almalence Inc. All Rights Reserved.
+*/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdint.h>
+#include <pthread.h>
+#include <android/log.h>
+
+#include "MemoryBudget.h"
+#include "FramePool.h"
+
+#define LOG_TAG "MemoryBudget"
+#define LOGE(...) __android_log_print(ANDROID_LOG_ERROR, LOG_TAG, __VA_ARGS__)
+
+
+// percent of memory each client may hold
+static const int client_share[MEMBUDGET_CLIENTS] =
+{
+	80,		// MEMBUDGET_PRESHOT, as was allocated by pre-shot before
+	60,		// MEMBUDGET_SWAPHEAP
+	60,		// MEMBUDGET_GROUPSHOT
+	50		// MEMBUDGET_OTHER
+};
+
+static pthread_mutex_t budget_lock = PTHREAD_MUTEX_INITIALIZER;
+static size_t reserved[MEMBUDGET_CLIENTS];
+static size_t reserved_total = 0;
+
+
+typedef struct
+{
+	unsigned long total;
+	unsigned long available;
+	unsigned long free;
+	unsigned long buffers;
+	unsigned long cached;
+	int hasAvailable;
+} MemInfo;
+
+// fields are looked up by name, their order differs between kernel versions
+static int ReadMemInfo(MemInfo *mi)
+{
+	FILE *f;
+	char line[256];
+	unsigned long kb;
+
+	memset(mi, 0, sizeof(MemInfo));
+
+	f = fopen("/proc/meminfo", "r");
+	if (f == NULL)
+		return -1;
+
+	while (fgets(line, sizeof(line), f))
+	{
+		char *colon = strchr(line, ':');
+		if (colon == NULL)
+			continue;
+		*colon = 0;
+		kb = strtoul(colon+1, NULL, 10);
+
+		if (!strcmp(line, "MemTotal"))
+			mi->total = kb;
+		else if (!strcmp(line, "MemAvailable"))
+		{
+			mi->available = kb;
+			mi->hasAvailable = 1;
+		}
+		else if (!strcmp(line, "MemFree"))
+			mi->free = kb;
+		else if (!strcmp(line, "Buffers"))
+			mi->buffers = kb;
+		else if (!strcmp(line, "Cached"))
+			mi->cached = kb;
+	}
+	fclose(f);
+
+	if (!mi->hasAvailable)
+		mi->available = mi->free + mi->buffers + mi->cached;
+
+	return 0;
+}
+
+
+// byte counts are summed in 64 bits, devices with 4GB and more overflow a
+// 32-bit size_t ((size_t)-1 is used as SIZE_MAX is not defined for C++
+// by older NDK headers)
+static size_t ClampSize(uint64_t bytes)
+{
+	return bytes > (uint64_t)(size_t)-1 ? (size_t)-1 : (size_t)bytes;
+}
+
+
+size_t MemoryBudget_SystemAvailable()
+{
+	MemInfo mi;
+
+	if (ReadMemInfo(&mi))
+		return 0;
+
+	return ClampSize((uint64_t)mi.available*1024);
+}
+
+
+size_t MemoryBudget_SystemTotal()
+{
+	MemInfo mi;
+
+	if (ReadMemInfo(&mi))
+		return 0;
+
+	return ClampSize((uint64_t)mi.total*1024);
+}
+
+
+// idle pooled frames are reused or given back before new memory is taken
+static size_t AppAvailable()
+{
+	return ClampSize((uint64_t)MemoryBudget_SystemAvailable() + FramePool_IdleBytes());
+}
+
+
+// budget_lock is held
+static size_t ClientAvailable(int client, size_t sysAvailable)
+{
+	uint64_t total = (uint64_t)sysAvailable + reserved_total;
+	uint64_t limit;
+
+	if (total <= MEMBUDGET_KEEP_FREE)
+		return 0;
+
+	limit = (total - MEMBUDGET_KEEP_FREE)*client_share[client]/100;
+
+	return limit > reserved_total ? ClampSize(limit - reserved_total) : 0;
+}
+
+
+static int ValidClient(int client)
+{
+	if ((client >= 0) && (client < MEMBUDGET_CLIENTS))
+		return 1;
+
+	LOGE("unknown client %d", client);
+	return 0;
+}
+
+
+size_t MemoryBudget_Available(int client)
+{
+	size_t sysAvailable;
+	size_t available;
+
+	if (!ValidClient(client))
+		return 0;
+
+	// meminfo is read outside of the lock, a reservation racing with it only
+	// makes the result a bit conservative
+	sysAvailable = AppAvailable();
+
+	pthread_mutex_lock(&budget_lock);
+	available = ClientAvailable(client, sysAvailable);
+	pthread_mutex_unlock(&budget_lock);
+
+	return available;
+}
+
+
+size_t MemoryBudget_Reserved(int client)
+{
+	size_t bytes;
+
+	if ((client != MEMBUDGET_CLIENTS) && !ValidClient(client))
+		return 0;
+
+	pthread_mutex_lock(&budget_lock);
+	bytes = (client == MEMBUDGET_CLIENTS) ? reserved_total : reserved[client];
+	pthread_mutex_unlock(&budget_lock);
+
+	return bytes;
+}
+
+
+int MemoryBudget_Reserve(int client, size_t bytes)
+{
+	size_t sysAvailable;
+	int res = -1;
+
+	if (!ValidClient(client))
+		return -1;
+
+	sysAvailable = AppAvailable();
+
+	pthread_mutex_lock(&budget_lock);
+	if (bytes <= ClientAvailable(client, sysAvailable))
+	{
+		reserved[client] += bytes;
+		reserved_total += bytes;
+		res = 0;
+	}
+	pthread_mutex_unlock(&budget_lock);
+
+	if (res)
+		LOGE("client %d: %d bytes over budget", client, (int)bytes);
+
+	return res;
+}
+
+
+void MemoryBudget_Release(int client, size_t bytes)
+{
+	if (!ValidClient(client))
+		return;
+
+	pthread_mutex_lock(&budget_lock);
+	if (bytes > reserved[client])
+	{
+		LOGE("client %d: releasing %d bytes, only %d reserved", client, (int)bytes, (int)reserved[client]);
+		bytes = reserved[client];
+	}
+	reserved[client] -= bytes;
+	reserved_total -= bytes;
+	pthread_mutex_unlock(&budget_lock);
+}
+
+
+void *MemoryBudget_Alloc(int client, size_t bytes)
+{
+	void *ptr;
+
+	if (MemoryBudget_Reserve(client, bytes))
+		return NULL;
+
+	ptr = malloc(bytes);
+	if (ptr == NULL)
+		MemoryBudget_Release(client, bytes);
+
+	return ptr;
+}
+
+
+void MemoryBudget_Free(int client, void *ptr, size_t bytes)
+{
+	if (ptr == NULL)
+		return;
+
+	free(ptr);
+	MemoryBudget_Release(client, bytes);
+}
@@ -0,0 +1,74 @@
+/*
+The contents of this file are subject to the Mozilla Public License
+Version 1.1 (the "License"); you may not use this file except in
+compliance with the License. You may obtain a copy of the License at
+http://www.mozilla.org/MPL/
+
+Software distributed under the License is distributed on an "AS IS"
+basis, WITHOUT WARRANTY OF ANY KIND, either express or implied. See the
+License for the specific language governing rights and limitations
+under the License.
+
+The Original Code is collection of files collectively known as Open Camera.
+
+The Initial Developer of the Original Code is Almalence Inc.
+Portions created by Initial Developer are Copyright (C) 2013
+by Almalence Inc. All Rights Reserved.
+*/
+
+#ifndef __MEMORYBUDGET_H__
+#define __MEMORYBUDGET_H__
+
+#include <stddef.h>
+
+// Native memory budget shared by all plugins.
+//
+// System memory is taken from MemAvailable of /proc/meminfo (kernel's estimate
+// of memory that can be allocated without swapping, page cache included).
+// Every client holding multi-frame buffers reserves them here, so that
+// allocations of one plugin are known to the others. A client may take up to
+// its share of the memory that would be available if no client held anything,
+// minus what all clients already hold; MEMBUDGET_KEEP_FREE is never given out.
+//
+// Buffers are assumed to be filled right after allocation, so reserved bytes
+// are already excluded from MemAvailable and are added back to get the total.
+// Idle buffers of FramePool are counted as available.
+
+// budget clients
+enum
+{
+	MEMBUDGET_PRESHOT = 0,		// pre-shot frame history
+	MEMBUDGET_SWAPHEAP,			// frames moved from java heap
+	MEMBUDGET_GROUPSHOT,		// group shot input frames
+	MEMBUDGET_OTHER,
+	MEMBUDGET_CLIENTS
+};
+
+// left to the system and java heap
+#define MEMBUDGET_KEEP_FREE		(32*1024*1024)
+
+// MemAvailable in bytes, on kernels without it estimated as MemFree+Buffers+Cached.
+// Returns 0 if /proc/meminfo can not be read
+size_t MemoryBudget_SystemAvailable();
+
+// MemTotal in bytes, 0 if /proc/meminfo can not be read
+size_t MemoryBudget_SystemTotal();
+
+// bytes client can reserve now
+size_t MemoryBudget_Available(int client);
+
+// bytes currently reserved by client, MEMBUDGET_CLIENTS for all clients together
+size_t MemoryBudget_Reserved(int client);
+
+// Returns 0 if bytes are reserved, -1 if client budget is exceeded
+int MemoryBudget_Reserve(int client, size_t bytes);
+
+void MemoryBudget_Release(int client, size_t bytes);
+
+// malloc within the budget, NULL if it is exceeded or out of memory
+void *MemoryBudget_Alloc(int client, size_t bytes);
+
+// free a block from MemoryBudget_Alloc, bytes is its requested size
+void MemoryBudget_Free(int client, void *ptr, size_t bytes);
+
+#endif // __MEMORYBUDGET_H__
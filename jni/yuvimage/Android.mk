@@ -4,7 +4,7 @@ include $(LOCAL_PATH)/../Flags.mk
     
 LOCAL_MODULE    := yuvimage
 LOCAL_SRC_FILES := yuvimage.cpp YuvToJpegEncoderMT.cpp
-LOCAL_STATIC_LIBRARIES := almalib jpeg gomp
+LOCAL_STATIC_LIBRARIES := almalib jpeg gomp utils-image
 LOCAL_LDLIBS := -llog \
 	$(call host-path, $(LOCAL_PATH)/../prebuilt/$(TARGET_ARCH_ABI)/libandroid_runtime.so)
 
@@ -1,5 +1,10 @@
 #include <stdio.h>
 #include <string.h>
+#include <errno.h>
+#include <limits.h>
+#include <unistd.h>
+#include <pthread.h>
+#include <sys/uio.h>
 #include <jni.h>
 #include <android/log.h>
 #include "jpeglib.h"
@@ -27,6 +32,10 @@ extern "C" {
 #define LOGW(...)
 #endif
 
+#ifndef IOV_MAX
+#define IOV_MAX 1024
+#endif
+
 #define ImageFormat_NV21 0x11
 #define ImageFormat_YUY2 0x14
 
@@ -34,18 +43,104 @@ extern "C" {
 void __attribute__((constructor)) initialize_openmp() {}
 void __attribute__((destructor)) release_openmp() {}
 
-/* Expanded data destination object for memory output */
+/* Double-buffered data destination object for memory output.
+ * Band N is flushed to the sink from one buffer while band N+1
+ * is compressed into the other one. */
 typedef struct {
   struct jpeg_destination_mgr pub; /* public fields */
 
-  unsigned char ** outbuffer;	/* target buffer */
-  unsigned long * outsize;
-  unsigned char * newbuffer;	/* newly allocated buffer */
-  JOCTET * buffer;		/* start of buffer */
-  size_t bufsize;
-} mem_destination_mgr;
+  JOCTET * buffer[2];		/* start of buffers */
+  size_t bufsize[2];
+  int active;			/* buffer currently receiving compressed data */
+} mt_destination_mgr;
+
+typedef mt_destination_mgr * mt_dest_ptr;
+
+void mt_init_destination(j_compress_ptr cinfo)
+{
+	// buffers are set up by mt_dest_init / mt_dest_reset
+}
+
+boolean mt_empty_output_buffer(j_compress_ptr cinfo)
+{
+	mt_dest_ptr dest = (mt_dest_ptr) cinfo->dest;
+	size_t oldsize = dest->bufsize[dest->active];
+	JOCTET * nextbuffer;
+
+	// grow only the active buffer, the other one may be in flight to the sink
+	nextbuffer = (JOCTET *)realloc(dest->buffer[dest->active], oldsize * 2);
+	if (nextbuffer == NULL)
+		ERREXIT1(cinfo, JERR_OUT_OF_MEMORY, 10);
 
-typedef mem_destination_mgr * mem_dest_ptr;
+	dest->buffer[dest->active] = nextbuffer;
+	dest->bufsize[dest->active] = oldsize * 2;
+	dest->pub.next_output_byte = nextbuffer + oldsize;
+	dest->pub.free_in_buffer = oldsize;
+
+	return TRUE;
+}
+
+void mt_term_destination(j_compress_ptr cinfo)
+{
+}
+
+// Returns non-zero if buffers could not be allocated
+int mt_dest_init(j_compress_ptr cinfo, mt_dest_ptr dest, size_t bufsize)
+{
+	dest->pub.init_destination = mt_init_destination;
+	dest->pub.empty_output_buffer = mt_empty_output_buffer;
+	dest->pub.term_destination = mt_term_destination;
+	dest->buffer[0] = (JOCTET *)malloc(bufsize);
+	dest->buffer[1] = (JOCTET *)malloc(bufsize);
+	dest->bufsize[0] = bufsize;
+	dest->bufsize[1] = bufsize;
+	dest->active = 0;
+	dest->pub.next_output_byte = dest->buffer[0];
+	dest->pub.free_in_buffer = bufsize;
+	cinfo->dest = &dest->pub;
+
+	return (dest->buffer[0] == NULL) || (dest->buffer[1] == NULL);
+}
+
+void mt_dest_free(mt_dest_ptr dest)
+{
+	free(dest->buffer[0]);
+	free(dest->buffer[1]);
+	dest->buffer[0] = NULL;
+	dest->buffer[1] = NULL;
+}
+
+// Switch to the buffer which will receive the next band. Keeps the data already
+// written if the buffer doesn't change (headers emitted by jpeg_start_compress).
+void mt_dest_select(j_compress_ptr cinfo, int active)
+{
+	mt_dest_ptr dest = (mt_dest_ptr) cinfo->dest;
+
+	if (dest->active == active)
+		return;
+
+	dest->active = active;
+	dest->pub.next_output_byte = dest->buffer[active];
+	dest->pub.free_in_buffer = dest->bufsize[active];
+}
+
+// Discard everything written to the active buffer
+void mt_dest_reset(j_compress_ptr cinfo)
+{
+	mt_dest_ptr dest = (mt_dest_ptr) cinfo->dest;
+
+	dest->pub.next_output_byte = dest->buffer[dest->active];
+	dest->pub.free_in_buffer = dest->bufsize[dest->active];
+}
+
+// Take the data compressed into the active buffer
+unsigned char* mt_dest_data(j_compress_ptr cinfo, unsigned long* outsize)
+{
+	mt_dest_ptr dest = (mt_dest_ptr) cinfo->dest;
+
+	*outsize = dest->bufsize[dest->active] - dest->pub.free_in_buffer;
+	return dest->buffer[dest->active];
+}
 
 //Error handler
 struct mt_jpeg_error_mgr : jpeg_error_mgr {
@@ -101,59 +196,250 @@ static int fNumPlanes;
 static int* fStrides;
 static int fFormat;
 
-int getThreadsNum()
+#define MAX_THREADS		16
+#define MIN_SLICE_ROWS	64
+// compressed bytes wanted per compressor and band, keeps a few bands in flight
+// for the write/compress overlap while restart marker overhead stays negligible
+#define SLICE_TARGET_SIZE	(256*1024)
+
+#define MAX_CPUS		(MAX_THREADS*2)
+
+static int fForcedThreads = 0;
+static pthread_once_t fCpuFreqOnce = PTHREAD_ONCE_INIT;
+static int fCpuMaxFreq[MAX_CPUS];	// max frequency per core, 0 - unknown
+static int fCpuMaxFreqTop = 0;
+
+static int readIntFile(const char *path)
 {
-	return 4;
+	FILE *f;
+	int value = 0;
+
+	f = fopen(path, "r");
+	if (f == NULL)
+		return 0;
+	if (fscanf(f, "%d", &value) != 1)
+		value = 0;
+	fclose(f);
+
+	return value;
 }
 
-int getBuffSize(int h, int w, int tn)
+// Read a core list such as "0-3,6" or "4 5 6 7" into cpus[], return number of cores or -1
+static int readCpuList(const char *path, char *cpus)
 {
-	return 1024*1024;
+	FILE *f;
+	int first, last, i, count = 0;
+	char sep;
+
+	memset(cpus, 0, MAX_CPUS);
+
+	f = fopen(path, "r");
+	if (f == NULL)
+		return -1;
+
+	while (fscanf(f, "%d", &first) == 1)
+	{
+		last = first;
+		if (fscanf(f, "%c", &sep) == 1 && sep == '-')
+		{
+			if (fscanf(f, "%d", &last) != 1)
+				break;
+			fscanf(f, "%c", &sep);
+		}
+		for (i = first; i <= last && i < MAX_CPUS; i++)
+		{
+			if (i >= 0 && !cpus[i])
+			{
+				cpus[i] = 1;
+				count++;
+			}
+		}
+	}
+	fclose(f);
+
+	return count;
 }
 
-int getOptHeight(int height, int width, int bufsize, int thread_num)
+// Max frequencies don't change while the process runs, read them once.
+// A cpufreq policy covers a whole cluster and stays readable while its cores are offline
+static void readCpuMaxFreqs()
 {
-	int thread_height;
-	int curr_height;
-	int estimated_height;
-	int diff;
-	int tmp_diff;
-	int i;
+	char path[128];
+	char related[MAX_CPUS];
+	int p, i, freq;
 
-	estimated_height = (bufsize*5)/width;
+	for (p = 0; p < MAX_CPUS; p++)
+	{
+		snprintf(path, sizeof(path), "/sys/devices/system/cpu/cpufreq/policy%d/cpuinfo_max_freq", p);
+		freq = readIntFile(path);
+		if (freq <= 0)
+			continue;
 
-	estimated_height += 0xf;
+		snprintf(path, sizeof(path), "/sys/devices/system/cpu/cpufreq/policy%d/related_cpus", p);
+		if (readCpuList(path, related) <= 0)
+		{
+			memset(related, 0, sizeof(related));
+			related[p] = 1;
+		}
 
-	estimated_height &= ~0xf;
+		for (i = 0; i < MAX_CPUS; i++)
+			if (related[i])
+				fCpuMaxFreq[i] = freq;
+	}
 
-	if (estimated_height*thread_num >= height)
+	// kernels without policy directories only have the nodes of the online cores
+	for (i = 0; i < MAX_CPUS; i++)
 	{
-		thread_height = height + thread_num - 1;
-		thread_height /= thread_num;
-		thread_height += 0xf;
-		thread_height &= ~0xf;
-		LOGD("thread_height 1 %d", (int)thread_height);
-		return thread_height;
+		if (fCpuMaxFreq[i] == 0)
+		{
+			snprintf(path, sizeof(path), "/sys/devices/system/cpu/cpu%d/cpufreq/cpuinfo_max_freq", i);
+			fCpuMaxFreq[i] = readIntFile(path);
+		}
+		if (fCpuMaxFreq[i] > fCpuMaxFreqTop)
+			fCpuMaxFreqTop = fCpuMaxFreq[i];
 	}
+}
+
+// Count the cores online now and split them into big (close to the highest max frequency)
+// and little ones; hotplug changes the online cores, so this is done for every plan
+static void detectCpuTopology(int *online, int *big, int *little)
+{
+	char cpus[MAX_CPUS];
+	int i;
+
+	pthread_once(&fCpuFreqOnce, readCpuMaxFreqs);
+
+	*online = sysconf(_SC_NPROCESSORS_ONLN);
+	if (*online < 1)
+		*online = 1;
+
+	// without frequency info treat all cores as equal
+	*big = *online;
+	*little = 0;
+
+	if (fCpuMaxFreqTop == 0 || readCpuList("/sys/devices/system/cpu/online", cpus) != *online)
+		return;
 
-	diff = curr_height*thread_num;
-	curr_height = estimated_height;
-	thread_height = estimated_height;
-	for (i = 0; i < 8, curr_height > 16; i++, curr_height -= 16)
+	for (i = 0; i < MAX_CPUS; i++)
 	{
-		tmp_diff = curr_height - (height % (curr_height*thread_num));
-		if (diff > tmp_diff)
+		if (!cpus[i])
+			continue;
+		if (fCpuMaxFreq[i] == 0)
 		{
-			diff = tmp_diff;
-			thread_height = curr_height;
-			LOGD("curr_height 2 %d", (int)curr_height);
+			*big = *online;
+			*little = 0;
+			return;
+		}
+		// cores close to the top frequency are as good as big ones for lock-step bands
+		if (fCpuMaxFreq[i]*3 < fCpuMaxFreqTop*2)
+		{
+			(*big)--;
+			(*little)++;
 		}
-
 	}
+}
+
+// 0 - choose automatically
+void YuvToJpegEncoderMT_setThreadsNum(int threads)
+{
+	fForcedThreads = threads < 0 ? 0 : (threads > MAX_THREADS ? MAX_THREADS : threads);
+}
 
-	LOGD( "estimated_height %d thread_height 3 %d", estimated_height, (int)thread_height);
+int getThreadsNum(int cpus_big, int cpus_little)
+{
+	int threads;
+
+	if (fForcedThreads)
+		return fForcedThreads;
+
+	// bands run in lock-step, so a slow little core holds back the whole band;
+	// use little cores only when there are too few big ones to be worth it
+	threads = cpus_big;
+	if (threads < 4)
+		threads += cpus_little;
+
+	if (threads > MAX_THREADS)
+		threads = MAX_THREADS;
+
+	return threads;
+}
+
+// Estimated compressed size per 1000 pixels of 4:2:0 camera data
+static int getBytesPerKPixel(int quality)
+{
+	if (quality >= 98) return 900;
+	if (quality >= 95) return 450;
+	if (quality >= 90) return 300;
+	if (quality >= 80) return 200;
+	if (quality >= 60) return 150;
+	return 100;
+}
+
+int getBuffSize(int h, int w, int quality)
+{
+	// slice estimate plus a quarter for detailed areas, the buffer grows if it is not enough
+	int size = (int)(((long long)w * h * getBytesPerKPixel(quality) / 1000) * 5 / 4);
+
+	if (size < 64*1024)
+		size = 64*1024;
+
+	return size;
+}
+
+int getOptHeight(int height, int width, int quality, int thread_num)
+{
+	int rows;
+	int bands;
+	long long row_size;
+
+	row_size = (long long)width * getBytesPerKPixel(quality) / 1000;
+	if (row_size < 1)
+		row_size = 1;
+
+	rows = (int)(SLICE_TARGET_SIZE / row_size);
+	if (rows < MIN_SLICE_ROWS)
+		rows = MIN_SLICE_ROWS;
+	rows = (rows + 0xf) & ~0xf;
+
+	// spread rows evenly over the bands, so the last band isn't mostly idle
+	bands = (height + rows*thread_num - 1) / (rows*thread_num);
+	rows = (height + bands*thread_num - 1) / (bands*thread_num);
+	rows = (rows + 0xf) & ~0xf;
+
+	LOGD("bands %d thread_height %d", bands, rows);
+
+	return rows;
+}
+
+void YuvToJpegEncoderMT_getPlan(jpeg_mt_plan* plan, int width, int height, int jpegQuality)
+{
+	int cpus_online, cpus_big, cpus_little;
+	int thread_num;
+	int thread_height;
+
+	detectCpuTopology(&cpus_online, &cpus_big, &cpus_little);
+	thread_num = getThreadsNum(cpus_big, cpus_little);
+
+	if (height < 64)
+	{
+		thread_num = 1;
+		thread_height = height;
+	}
+	else
+	{
+		// no more compressors than 16-row slices
+		if (thread_num > height/16)
+			thread_num = height/16;
+		thread_height = getOptHeight(height, width, jpegQuality, thread_num);
+	}
 
-	return thread_height;
+	plan->threads = thread_num;
+	plan->thread_height = thread_height;
+	plan->bands = (height + thread_height*thread_num - 1) / (thread_height*thread_num);
+	plan->bufsize = getBuffSize(thread_height, width, jpegQuality);
+	plan->cpus_online = cpus_online;
+	plan->cpus_big = cpus_big;
+	plan->cpus_little = cpus_little;
 }
 
 int YuvToJpegEncoderMT_init(int format, int* strides) {
@@ -195,56 +481,170 @@ int write_to_stream(JNIEnv* env, jobject jstream, jbyteArray jstorage, int stora
 		}
 		outsize -= size;
 		out_data += size;
-		env->CallVoidMethod(jstream, gOutputStream_flushMethodID);
 	}
 	return 0;
 }
 
+int write_to_fd(int fd, struct iovec* iov, int iovcnt)
+{
+	ssize_t res;
+
+	while (iovcnt > 0)
+	{
+		res = writev(fd, iov, iovcnt > IOV_MAX ? IOV_MAX : iovcnt);
+		if (res < 0)
+		{
+			if (errno == EINTR)
+				continue;
+			LOGE("writev failed, errno %d", errno);
+			return 1;
+		}
+
+		// skip fully written segments and advance into a partially written one
+		while (iovcnt > 0 && (size_t)res >= iov->iov_len)
+		{
+			res -= iov->iov_len;
+			iov++;
+			iovcnt--;
+		}
+		if (iovcnt > 0)
+		{
+			iov->iov_base = (uint8_t*)iov->iov_base + res;
+			iov->iov_len -= res;
+		}
+	}
+	return 0;
+}
+
+void YuvToJpegEncoderMT_initStreamSink(jpeg_mt_sink* sink, JNIEnv* env, jobject jstream, jbyteArray jstorage)
+{
+	memset(sink, 0, sizeof(jpeg_mt_sink));
+	sink->type = JPEG_MT_SINK_STREAM;
+	sink->env = env;
+	sink->jstream = jstream;
+	sink->jstorage = jstorage;
+	sink->storage_size = env->GetArrayLength(jstorage);
+	sink->fd = -1;
+}
+
+void YuvToJpegEncoderMT_initFdSink(jpeg_mt_sink* sink, int fd)
+{
+	memset(sink, 0, sizeof(jpeg_mt_sink));
+	sink->type = JPEG_MT_SINK_FD;
+	sink->fd = fd;
+}
+
+void YuvToJpegEncoderMT_initMemorySink(jpeg_mt_sink* sink, uint8_t* mem, size_t mem_size)
+{
+	memset(sink, 0, sizeof(jpeg_mt_sink));
+	sink->type = JPEG_MT_SINK_MEMORY;
+	sink->fd = -1;
+	sink->mem = mem;
+	sink->mem_size = mem_size;
+}
+
+// Pass the restart-marker-joined segments of one band to the sink.
+// Note: iov entries are modified by the fd sink.
+int sink_write(jpeg_mt_sink* sink, struct iovec* iov, int iovcnt)
+{
+	int i;
+	size_t total = 0;
+
+	for (i = 0; i < iovcnt; i++)
+		total += iov[i].iov_len;
+
+	switch (sink->type)
+	{
+	case JPEG_MT_SINK_FD:
+		if (write_to_fd(sink->fd, iov, iovcnt))
+			return 1;
+		break;
+	case JPEG_MT_SINK_MEMORY:
+		if (sink->written + total > sink->mem_size)
+		{
+			LOGE("output region too small: %d needed, %d available", (int)(sink->written + total), (int)sink->mem_size);
+			return 1;
+		}
+		for (i = 0; i < iovcnt; i++)
+		{
+			memcpy(sink->mem + sink->written, iov[i].iov_base, iov[i].iov_len);
+			sink->written += iov[i].iov_len;
+		}
+		return 0;
+	default:
+		for (i = 0; i < iovcnt; i++)
+			if (write_to_stream(sink->env, sink->jstream, sink->jstorage, sink->storage_size,
+					(uint8_t*)iov[i].iov_base, iov[i].iov_len))
+				return 1;
+		break;
+	}
+
+	sink->written += total;
+	return 0;
+}
+
+void sink_flush(jpeg_mt_sink* sink)
+{
+	if (sink->type == JPEG_MT_SINK_STREAM)
+	{
+		sink->env->CallVoidMethod(sink->jstream, gOutputStream_flushMethodID);
+		if (sink->env->ExceptionCheck()) {
+			sink->env->ExceptionDescribe();
+			sink->env->ExceptionClear();
+		}
+	}
+}
+
 boolean YuvToJpegEncoderMT_encode(JNIEnv* env, jobject jstream, jbyteArray jstorage, uint8_t* inYuv, int width,
         int height, int* offsets, int* strides, int jpegQuality, int format) {
+	jpeg_mt_sink sink;
+
+	YuvToJpegEncoderMT_initStreamSink(&sink, env, jstream, jstorage);
+
+	return YuvToJpegEncoderMT_encodeToSink(&sink, inYuv, width, height, offsets, strides, jpegQuality, format);
+}
+
+boolean YuvToJpegEncoderMT_encodeToSink(jpeg_mt_sink* sink, uint8_t* inYuv, int width,
+        int height, int* offsets, int* strides, int jpegQuality, int format) {
     unsigned char *out_data = NULL;
     unsigned long outsize = 0;
-    mem_dest_ptr dest;
-	int i, j;
+	int i, k;
 	struct jpeg_compress_struct* cinfo_arr;
     struct mt_jpeg_error_mgr* jerr_arr;
-	int thread_num = getThreadsNum();
-	unsigned char **outbuffer_arr;
-	unsigned long *outsize_arr;
+	jpeg_mt_plan plan;
+	int thread_num;
+	mt_destination_mgr *dest_arr;
+	struct iovec *iov_arr;
+	int iovcnt;
+	int pending_cnt = 0;
 	int thread_height;
 	int bufsize;
-	int storage_size;
 	int processed_lines;
+	int band;
 	int restart_cnt = 0;
 	int lines_per_iMCU_row = 16;
 	int last_thread_num;
+	volatile int init_num = 0;
 	boolean err = false;
+	boolean write_err = false;
 	boolean err_thread_num = 0;
-	int file_size = 0;
 
-	storage_size = env->GetArrayLength(jstorage);
-	bufsize = getBuffSize(height, width, thread_num);
+	YuvToJpegEncoderMT_getPlan(&plan, width, height, jpegQuality);
+	thread_num = plan.threads;
+	thread_height = plan.thread_height;
+	bufsize = plan.bufsize;
 
-    if (height < 64)
-    {
-    	thread_num = 1;
-    	thread_height = height;
-    }
-    else
-    	thread_height = getOptHeight(height, width, bufsize, thread_num);
+	LOGD("threads %d (big %d little %d) thread_height %d bands %d bufsize %d", thread_num,
+			plan.cpus_big, plan.cpus_little, thread_height, plan.bands, bufsize);
 
 	cinfo_arr = (struct jpeg_compress_struct *)malloc(sizeof(struct jpeg_compress_struct) * thread_num);
 	jerr_arr = (struct mt_jpeg_error_mgr *)malloc(sizeof(struct mt_jpeg_error_mgr) * thread_num);
-	outbuffer_arr = (unsigned char**)malloc(sizeof(unsigned char *)*thread_num);
-	outsize_arr = (unsigned long*)malloc(sizeof(unsigned long)*thread_num);
+	dest_arr = (mt_destination_mgr *)calloc(thread_num, sizeof(mt_destination_mgr));
+	iov_arr = (struct iovec*)malloc(sizeof(struct iovec)*thread_num);
 
 	//init cinfo structures
 	for (i = 0; i < thread_num; i++)
 	{
-		outbuffer_arr[i] = NULL;
-
-		outsize_arr[i] = 0;
-
 	    cinfo_arr[i].err = jpeg_std_error(&jerr_arr[i]);
 	    jerr_arr[i].error_exit = mt_jpeg_error_exit;
 	    jerr_arr[i].thread_num = i+1;
@@ -254,185 +654,150 @@ boolean YuvToJpegEncoderMT_encode(JNIEnv* env, jobject jstream, jbyteArray jstor
 	    }
 
 	    jpeg_create_compress(&cinfo_arr[i]);
+	    init_num = i + 1;
 
 	    YuvToJpegEncoderMT_setJpegCompressStruct(&cinfo_arr[i], width, height, jpegQuality);
 
-	    outsize_arr[i] = bufsize;
-
-	    outbuffer_arr[i] = (uint8_t*)malloc(outsize_arr[i]);
-
-	    jpeg_mem_dest(&cinfo_arr[i], &outbuffer_arr[i], &outsize_arr[i]);
+	    if (mt_dest_init(&cinfo_arr[i], &dest_arr[i], bufsize))
+	    {
+	    	err = true;
+	    	break;
+	    }
 
 	    cinfo_arr[i].restart_in_rows = thread_height/lines_per_iMCU_row;
 
 		jpeg_start_compress(&cinfo_arr[i], TRUE);
 	}
 
-	if (err)
+	if (!err)
 	{
-		for (i = 0; i < err_thread_num; i++)
+		// Pipeline: while workers compress band N into one buffer of their destination,
+		// band N-1 is passed to the sink from the other one. Iteration 0 is the sink
+		// writer and static schedule keeps it on the calling thread (JNI env of the stream).
+		for (processed_lines = 0, band = 0; processed_lines < height; processed_lines += thread_height * thread_num, band++)
 		{
-			jpeg_destroy((j_common_ptr)&cinfo_arr[i]);
-			free(outbuffer_arr[i]);
-		}
-	    free(cinfo_arr);
-	    free(jerr_arr);
-	    free(outbuffer_arr);
-	    free(outsize_arr);
-		return false;
-	}
+			boolean last_iter = (processed_lines + thread_height * thread_num) >= height;
+			LOGD("processed_lines %d %d last_iter", processed_lines, last_iter);
 
-	for (processed_lines = 0; processed_lines < height; processed_lines += thread_height * thread_num)
-	{
-		boolean last_iter = (processed_lines + thread_height * thread_num) >= height;
-		LOGD("processed_lines %d %d last_iter", processed_lines, last_iter);
-#pragma omp parallel for num_threads(thread_num)
-		for (i = 0; i < thread_num; i++)
-		{
-			boolean call_pass_startup = (i == 0) && (processed_lines == 0);
-			int start_row = i * thread_height + processed_lines;
-			int end_row = start_row +  thread_height;
-
-			if (start_row >= height)
-				continue;
+			for (i = 0; i < thread_num; i++)
+				mt_dest_select(&cinfo_arr[i], band & 1);
 
-			if (end_row >= height)
+#pragma omp parallel for num_threads(thread_num + 1) schedule(static, 1)
+			for (k = 0; k <= thread_num; k++)
 			{
-				end_row = height;
-				cinfo_arr[i].restart_in_rows = 0;
-			}
+				if (k == 0)
+				{
+					if (pending_cnt && sink_write(sink, iov_arr, pending_cnt))
+						write_err = true;
+					continue;
+				}
 
-		   /* if (err_thread_num = setjmp(jerr_arr[i].fJmpBuf)) {
-		        err = true;
-		        continue;
-		    }*/
+				int i = k - 1;
+				boolean call_pass_startup = (i == 0) && (processed_lines == 0);
+				int start_row = i * thread_height + processed_lines;
+				int end_row = start_row +  thread_height;
 
-			if (fFormat == ImageFormat_NV21)
-				err |= Yuv420SpToJpegEncoderMT_compress(&cinfo_arr[i],
-						(uint8_t*) inYuv, offsets, start_row, end_row, call_pass_startup);
-			else
-				err |= Yuv422IToJpegEncoderMT_compress(&cinfo_arr[i], (uint8_t*) inYuv,
-						offsets, start_row, end_row, call_pass_startup);
+				if (start_row >= height)
+					continue;
 
-			if (err)
-			{
-				continue;
-			}
+				if (end_row >= height)
+				{
+					end_row = height;
+					cinfo_arr[i].restart_in_rows = 0;
+				}
 
-			if (end_row == height)
-			{
-				last_thread_num = i;
-				jpeg_finish_compress(&cinfo_arr[i]);
-			}
+				if (fFormat == ImageFormat_NV21)
+					err |= Yuv420SpToJpegEncoderMT_compress(&cinfo_arr[i],
+							(uint8_t*) inYuv, offsets, start_row, end_row, call_pass_startup);
+				else
+					err |= Yuv422IToJpegEncoderMT_compress(&cinfo_arr[i], (uint8_t*) inYuv,
+							offsets, start_row, end_row, call_pass_startup);
 
-			LOGD("start_row %d end_row %d i %d ", start_row, end_row, i);
-		}
+				if (err)
+				{
+					continue;
+				}
 
-		if (err) break;
+				if (end_row == height)
+				{
+					last_thread_num = i;
+					jpeg_finish_compress(&cinfo_arr[i]);
+				}
 
-		if (!last_iter)
-		{
-			for (i = 0; i < thread_num; i++)
-			{
-				dest = (mem_dest_ptr) cinfo_arr[i].dest;
-				outsize = (dest->bufsize)-(dest->pub.free_in_buffer);
-				out_data = dest->buffer;
-				dest->pub.free_in_buffer = dest->bufsize;
-				dest->pub.next_output_byte = dest->buffer;
+				LOGD("start_row %d end_row %d i %d ", start_row, end_row, i);
+			}
 
-				//correct restart marker;
-				out_data[outsize-1] =  JPEG_RST0 + (restart_cnt & 0x7);
-				restart_cnt++;
+			pending_cnt = 0;
 
-				file_size += outsize;
+			if (err || write_err) break;
 
-				if(write_to_stream(env, jstream, jstorage, storage_size, out_data, outsize))
+			if (!last_iter)
+			{
+				// queue this band for writing during the next one
+				for (i = 0; i < thread_num; i++)
 				{
-					err= true;
-					break;
-				}
-			}
-		}
+					out_data = mt_dest_data(&cinfo_arr[i], &outsize);
 
-		if (err) break;
-	}
+					//correct restart marker;
+					out_data[outsize-1] =  JPEG_RST0 + (restart_cnt & 0x7);
+					restart_cnt++;
 
-	if (err)
-	{
-		for (i = 0; i < thread_num; i++)
-		{
-			jpeg_destroy((j_common_ptr)&cinfo_arr[i]);
-			free(outbuffer_arr[i]);
+					iov_arr[i].iov_base = out_data;
+					iov_arr[i].iov_len = outsize;
+				}
+				pending_cnt = thread_num;
+			}
 		}
-	    free(cinfo_arr);
-	    free(jerr_arr);
-	    free(outbuffer_arr);
-	    free(outsize_arr);
-		return false;
 	}
 
-	for (i = 0; i < thread_num; i++)
+	if (!err && !write_err)
 	{
-		dest = (mem_dest_ptr) cinfo_arr[i].dest;
-		outsize = (dest->bufsize)-(dest->pub.free_in_buffer);
-		out_data = dest->buffer;
-
-		//correct restart marker;
-
-    	if (i < last_thread_num)
-    	{
-    		out_data[outsize-1] =  JPEG_RST0 + (restart_cnt & 0x7);
-    		restart_cnt++;
-    	}
-
-		if (i <= last_thread_num)
+		iovcnt = 0;
+		for (i = 0; i <= last_thread_num; i++)
 		{
-			file_size += outsize;
-
-			if(write_to_stream(env, jstream, jstorage, storage_size, out_data, outsize))
-			{
-				err= true;
-				break;
-			}
+			out_data = mt_dest_data(&cinfo_arr[i], &outsize);
+
+			//correct restart marker;
+	    	if (i < last_thread_num)
+	    	{
+	    		out_data[outsize-1] =  JPEG_RST0 + (restart_cnt & 0x7);
+	    		restart_cnt++;
+	    	}
+
+			iov_arr[iovcnt].iov_base = out_data;
+			iov_arr[iovcnt].iov_len = outsize;
+			iovcnt++;
 		}
 
-    	if (i != last_thread_num)
-    	{
-    		cinfo_arr[i].next_scanline = cinfo_arr[i].image_height;
-    		jpeg_finish_compress(&cinfo_arr[i]);
-    	}
-		if (err) break;
-	}
+		// write out before finishing the remaining compressors, they still append to their buffers
+		if (sink_write(sink, iov_arr, iovcnt))
+			write_err = true;
 
-	if (err)
-	{
-		for (i = 0; i < thread_num; i++)
+		for (i = 0; i < thread_num && !write_err; i++)
 		{
-			jpeg_destroy((j_common_ptr)&cinfo_arr[i]);
-			free(outbuffer_arr[i]);
+	    	if (i != last_thread_num)
+	    	{
+	    		cinfo_arr[i].next_scanline = cinfo_arr[i].image_height;
+	    		jpeg_finish_compress(&cinfo_arr[i]);
+	    	}
 		}
-	    free(cinfo_arr);
-	    free(jerr_arr);
-	    free(outbuffer_arr);
-	    free(outsize_arr);
-		return false;
 	}
 
-    env->CallVoidMethod(jstream, gOutputStream_flushMethodID);
+	if (!err && !write_err)
+		sink_flush(sink);
 
-    for ( i = 0; i < thread_num; i++)
-	{
-		jpeg_destroy_compress(&cinfo_arr[i]);
-		free(outbuffer_arr[i]);
-	}
+    for (i = 0; i < init_num; i++)
+		jpeg_destroy((j_common_ptr)&cinfo_arr[i]);
+    for (i = 0; i < thread_num; i++)
+    	mt_dest_free(&dest_arr[i]);
 
-    LOGD("file_size %d ", file_size);
+    LOGD("file_size %d ", (int)sink->written);
 
     free(cinfo_arr);
     free(jerr_arr);
-    free(outbuffer_arr);
-    free(outsize_arr);
-    return true;
+    free(dest_arr);
+    free(iov_arr);
+    return !(err || write_err);
 }
 
 void YuvToJpegEncoderMT_setJpegCompressStruct(jpeg_compress_struct* cinfo,
@@ -495,7 +860,6 @@ boolean Yuv420SpToJpegEncoderMT_compress(jpeg_compress_struct* cinfo,
     uint8_t* vuPlanar = yuv + offsets[1]; //width * height;
     uint8_t* uRows = (uint8_t*)malloc(8 * (width >> 1));
     uint8_t* vRows = (uint8_t*)malloc(8 * (width >> 1));
-    mem_dest_ptr dest;
     mt_jpeg_error_mgr *err = (mt_jpeg_error_mgr *)cinfo->err;
     int err_thread_num = 0;
 
@@ -510,9 +874,7 @@ boolean Yuv420SpToJpegEncoderMT_compress(jpeg_compress_struct* cinfo,
 	else
 	{
 		cinfo->master->call_pass_startup = FALSE;
-		dest = (mem_dest_ptr) cinfo->dest;
-		dest->pub.free_in_buffer = dest->bufsize;
-		dest->pub.next_output_byte = dest->buffer;
+		mt_dest_reset(cinfo);
 	}
 
 	cinfo->next_scanline = start_row;
@@ -595,7 +957,6 @@ boolean Yuv422IToJpegEncoderMT_compress(jpeg_compress_struct* cinfo,
     uint8_t* vRows = (uint8_t*)malloc(16 * (width >> 1));
 
     uint8_t* yuvOffset = yuv + offsets[0];
-    mem_dest_ptr dest;
     mt_jpeg_error_mgr *err = (mt_jpeg_error_mgr *)cinfo->err;
     int err_thread_num = 0;
 
@@ -611,9 +972,7 @@ boolean Yuv422IToJpegEncoderMT_compress(jpeg_compress_struct* cinfo,
 	else
 	{
 		cinfo->master->call_pass_startup = FALSE;
-		dest = (mem_dest_ptr) cinfo->dest;
-		dest->pub.free_in_buffer = dest->bufsize;
-		dest->pub.next_output_byte = dest->buffer;
+		mt_dest_reset(cinfo);
 	}
 
 	cinfo->next_scanline = start_row;
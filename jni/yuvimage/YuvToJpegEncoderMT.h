@@ -24,9 +24,54 @@ extern "C" {
     #include "jerror.h"
 }
 
+// Destination of the encoded jpeg data
+typedef enum {
+	JPEG_MT_SINK_STREAM = 0,	// java OutputStream, data is passed through temp byte[] storage
+	JPEG_MT_SINK_FD,			// native file descriptor, segments are written with writev()
+	JPEG_MT_SINK_MEMORY			// caller-provided memory region (direct or mmap'd buffer)
+} jpeg_mt_sink_type;
+
+typedef struct {
+	jpeg_mt_sink_type type;
+
+	// JPEG_MT_SINK_STREAM
+	JNIEnv* env;
+	jobject jstream;
+	jbyteArray jstorage;
+	int storage_size;
+
+	// JPEG_MT_SINK_FD
+	int fd;
+
+	// JPEG_MT_SINK_MEMORY
+	uint8_t* mem;
+	size_t mem_size;
+
+	// total number of bytes passed to the sink so far
+	size_t written;
+} jpeg_mt_sink;
+
+// Work split chosen for one image
+typedef struct {
+	int threads;		// number of libjpeg compressors working in parallel
+	int thread_height;	// rows per compressor and band, also the restart interval in rows
+	int bands;			// number of lock-step bands (thread_height*threads rows each)
+	int bufsize;		// initial size of each output buffer
+	int cpus_online;
+	int cpus_big;		// online cores close to the highest max frequency
+	int cpus_little;	// remaining online cores
+} jpeg_mt_plan;
+
 extern int initStreamMethods(JNIEnv* env);
+extern void YuvToJpegEncoderMT_setThreadsNum(int threads);
+extern void YuvToJpegEncoderMT_getPlan(jpeg_mt_plan* plan, int width, int height, int jpegQuality);
+extern void YuvToJpegEncoderMT_initStreamSink(jpeg_mt_sink* sink, JNIEnv* env, jobject jstream, jbyteArray jstorage);
+extern void YuvToJpegEncoderMT_initFdSink(jpeg_mt_sink* sink, int fd);
+extern void YuvToJpegEncoderMT_initMemorySink(jpeg_mt_sink* sink, uint8_t* mem, size_t mem_size);
 extern int YuvToJpegEncoderMT_init(int format, int* strides);
 extern boolean YuvToJpegEncoderMT_encode(JNIEnv* env, jobject jstream, jbyteArray jstorage, uint8_t* inYuv, int width,
         int height, int* offsets, int* strides, int jpegQuality, int format);
+extern boolean YuvToJpegEncoderMT_encodeToSink(jpeg_mt_sink* sink, uint8_t* inYuv, int width,
+        int height, int* offsets, int* strides, int jpegQuality, int format);
 
 #endif
@@ -24,21 +24,58 @@
 #include "YuvToJpegEncoderMT.h"
 #include "almashot.h"
 #include "almashot_raw.h"
+#include "FrameHandle.h"
+#include "FramePool.h"
 
 static unsigned char *yuv;
 static int SX = 0;
 static int SY = 0;
 
+// Returns native descriptor behind java.io.FileOutputStream or -1 for any other stream
+static int getOutputStreamFd(JNIEnv* env, jobject jstream)
+{
+	jclass fileOutputStream_Clazz = env->FindClass("java/io/FileOutputStream");
+	if (fileOutputStream_Clazz == NULL || !env->IsInstanceOf(jstream, fileOutputStream_Clazz))
+	{
+		env->ExceptionClear();
+		return -1;
+	}
+
+	jmethodID getFD = env->GetMethodID(fileOutputStream_Clazz, "getFD", "()Ljava/io/FileDescriptor;");
+	jobject jfd = (getFD != NULL) ? env->CallObjectMethod(jstream, getFD) : NULL;
+	if (env->ExceptionCheck() || jfd == NULL)
+	{
+		env->ExceptionClear();
+		return -1;
+	}
+
+	jfieldID descriptor = env->GetFieldID(env->GetObjectClass(jfd), "descriptor", "I");
+	if (env->ExceptionCheck() || descriptor == NULL)
+	{
+		env->ExceptionClear();
+		return -1;
+	}
+
+	return env->GetIntField(jfd, descriptor);
+}
+
+// Writes directly into file descriptor if jstream is a FileOutputStream,
+// otherwise the data goes through jstorage into jstream.
 extern "C" JNIEXPORT jboolean JNICALL Java_com_almalence_YuvImage_SaveJpegFreeOutMT
 (
-		JNIEnv* env, jobject, int jout,
+		JNIEnv* env, jobject, jlong jout,
 		int format, int width, int height, jintArray offsets,
 		jintArray strides, int jpegQuality, jobject jstream, jbyteArray jstorage
 )
 {
 	jbyte* OutPic;
+	jpeg_mt_sink sink;
+	int fd;
 
-	OutPic = (jbyte *)jout;
+	// frame stays owned by the caller, it is released from java after saving
+	OutPic = (jbyte *)FrameHandle_Data(jout, 1);
+	if (OutPic == NULL)
+		return false;
 
 	initStreamMethods(env);
 
@@ -47,36 +84,129 @@ extern "C" JNIEXPORT jboolean JNICALL Java_com_almalence_YuvImage_SaveJpegFreeOu
 
 	if (YuvToJpegEncoderMT_init(format, imgStrides))
 	{
-		free(OutPic);
+		env->ReleaseIntArrayElements(offsets, imgOffsets, JNI_ABORT);
+		env->ReleaseIntArrayElements(strides, imgStrides, JNI_ABORT);
 		return false;
 	}
 
+	fd = getOutputStreamFd(env, jstream);
+	if (fd >= 0)
+		YuvToJpegEncoderMT_initFdSink(&sink, fd);
+	else
+		YuvToJpegEncoderMT_initStreamSink(&sink, env, jstream, jstorage);
+
 	boolean result = true;
 
-	result = YuvToJpegEncoderMT_encode(env, jstream, jstorage, (uint8_t*)OutPic, width, height, imgOffsets, imgStrides, jpegQuality, format);
+	result = YuvToJpegEncoderMT_encodeToSink(&sink, (uint8_t*)OutPic, width, height, imgOffsets, imgStrides, jpegQuality, format);
 
-	env->ReleaseIntArrayElements(offsets, imgOffsets, 0);
-	env->ReleaseIntArrayElements(strides, imgStrides, 0);
+	env->ReleaseIntArrayElements(offsets, imgOffsets, JNI_ABORT);
+	env->ReleaseIntArrayElements(strides, imgStrides, JNI_ABORT);
 
 	return result;
 }
 
+// Return: number of bytes written to direct (or mapped) jbuffer, -1 on error
+extern "C" JNIEXPORT jint JNICALL Java_com_almalence_YuvImage_SaveJpegFreeOutMTToBuffer
+(
+		JNIEnv* env, jobject, jlong jout,
+		int format, int width, int height, jintArray offsets,
+		jintArray strides, int jpegQuality, jobject jbuffer
+)
+{
+	jbyte* OutPic;
+	jpeg_mt_sink sink;
+	uint8_t* mem;
+	jlong mem_size;
+
+	OutPic = (jbyte *)FrameHandle_Data(jout, 1);
+	if (OutPic == NULL)
+		return -1;
+
+	mem = (uint8_t*)env->GetDirectBufferAddress(jbuffer);
+	mem_size = env->GetDirectBufferCapacity(jbuffer);
+	if (mem == NULL || mem_size <= 0)
+		return -1;
+
+	jint* imgOffsets = env->GetIntArrayElements(offsets, NULL);
+	jint* imgStrides = env->GetIntArrayElements(strides, NULL);
+
+	if (YuvToJpegEncoderMT_init(format, imgStrides))
+	{
+		env->ReleaseIntArrayElements(offsets, imgOffsets, JNI_ABORT);
+		env->ReleaseIntArrayElements(strides, imgStrides, JNI_ABORT);
+		return -1;
+	}
+
+	YuvToJpegEncoderMT_initMemorySink(&sink, mem, (size_t)mem_size);
+
+	boolean result = YuvToJpegEncoderMT_encodeToSink(&sink, (uint8_t*)OutPic, width, height, imgOffsets, imgStrides, jpegQuality, format);
+
+	env->ReleaseIntArrayElements(offsets, imgOffsets, JNI_ABORT);
+	env->ReleaseIntArrayElements(strides, imgStrides, JNI_ABORT);
+
+	return result ? (jint)sink.written : -1;
+}
+
+// Return: {threads, thread_height, bands, bufsize, cpus_online, cpus_big, cpus_little}
+extern "C" JNIEXPORT jintArray JNICALL Java_com_almalence_YuvImage_GetJpegEncodePlan
+(
+		JNIEnv* env, jobject, int width, int height, int jpegQuality
+)
+{
+	jpeg_mt_plan plan;
+	jint values[7];
+	jintArray jplan;
+
+	YuvToJpegEncoderMT_getPlan(&plan, width, height, jpegQuality);
+
+	values[0] = plan.threads;
+	values[1] = plan.thread_height;
+	values[2] = plan.bands;
+	values[3] = plan.bufsize;
+	values[4] = plan.cpus_online;
+	values[5] = plan.cpus_big;
+	values[6] = plan.cpus_little;
+
+	jplan = env->NewIntArray(7);
+	if (jplan != NULL)
+		env->SetIntArrayRegion(jplan, 0, 7, values);
+
+	return jplan;
+}
+
+extern "C" JNIEXPORT void JNICALL Java_com_almalence_YuvImage_SetJpegEncodeThreads
+(
+		JNIEnv* env, jobject, int threads
+)
+{
+	YuvToJpegEncoderMT_setThreadsNum(threads);
+}
+
 extern "C" JNIEXPORT void JNICALL Java_com_almalence_YuvImage_RemoveFrame
 (
 		JNIEnv* env,
 		jobject thiz
 )
 {
-	free((void*)yuv);
+	FramePool_Free(yuv);
+	yuv = NULL;
 }
 
-extern "C" JNIEXPORT jint JNICALL Java_com_almalence_YuvImage_GetFrame
+// frame is handed over to java, it is freed by releasing the handle
+extern "C" JNIEXPORT jlong JNICALL Java_com_almalence_YuvImage_GetFrame
 (
 		JNIEnv* env,
 		jobject thiz
 )
 {
-	return (jint)yuv;
+	FrameHandle h;
+
+	h = FrameHandle_Create(yuv, SX*SY+SX*((SY+1)/2), FRAME_FORMAT_NV21, SX, SY, SX, NULL);
+	if (h == 0)
+		FramePool_Free(yuv);
+	yuv = NULL;
+
+	return h;
 }
 
 extern "C" JNIEXPORT jbyte* JNICALL Java_com_almalence_YuvImage_GetByteFrame
@@ -94,7 +224,8 @@ extern "C" JNIEXPORT jbyte* JNICALL Java_com_almalence_YuvImage_GetByteFrame
 	memcpy (pixels, yuv, SX*SY+SX*((SY+1)/2));
 	env->ReleaseByteArrayElements(jpixels, (jbyte*)pixels, 0);
 
-	free(yuv);
+	FramePool_Free(yuv);
+	yuv = NULL;
 
 	return (jbyte *)jpixels;
 }
@@ -170,12 +301,12 @@ extern "C" JNIEXPORT int JNICALL Java_com_almalence_YuvImage_CreateYUVImageFromR
 	SX = w;
 	SY = h;
 
-	yuv = (unsigned char *)malloc (w*h+w*((h+1)/2));
+	yuv = (unsigned char *)FramePool_Alloc(w*h+w*((h+1)/2));
 	if (yuv == NULL)
 	return -2;
 
 	// RAW store ecah pixel in 2 bytes, thet's why w*2.
-	rawCropped = (unsigned char *) malloc(2 * w * h);
+	rawCropped = (unsigned char *)FramePool_Alloc(2 * w * h);
 
 	for (int y=0; y<h; y+=2)
 	{
@@ -188,7 +319,7 @@ extern "C" JNIEXPORT int JNICALL Java_com_almalence_YuvImage_CreateYUVImageFromR
 	Raw_DemosaicAndColorCorrect(rawCropped, yuv, w, h, kelvin, colorMatrix, blevel, wlevel, cameraIndex, outputRGB);
 	//Raw_DemosaicAndColorCorrect(rawCropped, yuv, w, h, kelvin, blevel, wlevel, cameraIndex, outputRGB);
 
-	free(rawCropped);
+	FramePool_Free(rawCropped);
 
 //	__android_log_print(ANDROID_LOG_INFO, "OpenCamera. CreateYUV", "NV21 created from RAW");
 
@@ -226,7 +357,7 @@ extern "C" JNIEXPORT int JNICALL Java_com_almalence_YuvImage_CreateYUVImage
 	SY = sy;
 
 	// extract as NV21 image
-	yuv = (unsigned char *)malloc (sx*sy+sx*((sy+1)/2));
+	yuv = (unsigned char *)FramePool_Alloc(sx*sy+sx*((sy+1)/2));
 	if (yuv == NULL)
 	return -2;
 
@@ -272,19 +403,69 @@ extern "C" JNIEXPORT jbyte* JNICALL Java_com_almalence_YuvImage_CreateYUVImageBy
 	unsigned char * single_yuv;
 
 	jpixels = env->NewByteArray(SX*SY+SX*((SY+1)/2));
+	if (jpixels == NULL)
+	return NULL;
 
-	single_yuv = (unsigned char *)env->GetByteArrayElements(jpixels, NULL);
+	// fill the new array in place - GetByteArrayElements may hand out a copy
+	// which would then be copied back once more on release
+	single_yuv = (unsigned char *)env->GetPrimitiveArrayCritical(jpixels, NULL);
 	if (single_yuv == NULL)
 	return NULL;
 
 	ExtractYuvFromDirectBuffer(Y, U, V, single_yuv, pixelStrideY, rowStrideY, pixelStrideU, rowStrideU, pixelStrideV, rowStrideV, sx, sy);
 
-	env->ReleaseByteArrayElements(jpixels, (jbyte*)single_yuv, 0);
+	env->ReleasePrimitiveArrayCritical(jpixels, single_yuv, 0);
 
 	return (jbyte *)jpixels;
 }
 
-extern "C" JNIEXPORT int JNICALL Java_com_almalence_YuvImage_AllocateMemoryForYUV
+// fills an array of SX*SY+SX*((SY+1)/2) bytes, e.g. from PreviewBufferPool
+extern "C" JNIEXPORT jint JNICALL Java_com_almalence_YuvImage_FillYUVImageByteArray
+(
+		JNIEnv* env,
+		jobject thiz,
+		jobject bufY,
+		jobject bufU,
+		jobject bufV,
+		jint pixelStrideY,
+		jint rowStrideY,
+		jint pixelStrideU,
+		jint rowStrideU,
+		jint pixelStrideV,
+		jint rowStrideV,
+		jint sx,
+		jint sy,
+		jbyteArray jpixels
+)
+{
+	unsigned char *Y, *U, *V;
+	unsigned char * single_yuv;
+
+	Y = (unsigned char*)env->GetDirectBufferAddress(bufY);
+	U = (unsigned char*)env->GetDirectBufferAddress(bufU);
+	V = (unsigned char*)env->GetDirectBufferAddress(bufV);
+
+	if ((Y == NULL) || (U == NULL) || (V == NULL))
+	return -1;
+
+	if (env->GetArrayLength(jpixels) < sx*sy+sx*((sy+1)/2))
+	return -1;
+
+	SX = sx;
+	SY = sy;
+
+	single_yuv = (unsigned char *)env->GetPrimitiveArrayCritical(jpixels, NULL);
+	if (single_yuv == NULL)
+	return -1;
+
+	ExtractYuvFromDirectBuffer(Y, U, V, single_yuv, pixelStrideY, rowStrideY, pixelStrideU, rowStrideU, pixelStrideV, rowStrideV, sx, sy);
+
+	env->ReleasePrimitiveArrayCritical(jpixels, single_yuv, 0);
+
+	return 0;
+}
+
+extern "C" JNIEXPORT jlong JNICALL Java_com_almalence_YuvImage_AllocateMemoryForYUV
 (
 		JNIEnv* env,
 		jobject thiz,
@@ -292,7 +473,6 @@ extern "C" JNIEXPORT int JNICALL Java_com_almalence_YuvImage_AllocateMemoryForYU
 		jint sy
 )
 {
-	unsigned char* yuv_mem = (unsigned char *)malloc (sx*sy+sx*((sy+1)/2));
-	return (jint)yuv_mem;
+	return FrameHandle_Alloc(sx*sy+sx*((sy+1)/2), FRAME_FORMAT_NV21, sx, sy, sx);
 }
 
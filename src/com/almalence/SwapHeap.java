@@ -18,20 +18,36 @@ by Almalence Inc. All Rights Reserved.
 
 package com.almalence;
 
+import java.nio.ByteBuffer;
+
+// Frames in native heap are referred to by 64-bit handles, 0 is never a valid
+// handle. A handle is released once with FreeFromHeap or SwapFromHeap.
+//
+// Frames can be read in place through GetBuffer, the buffer belongs to the
+// handle and must not be touched after the handle is released.
 public final class SwapHeap
 {
-	public static native int SwapToHeap(byte[] data);
+	public static native long SwapToHeap(byte[] data);
+
+	// data has to be a direct buffer
+	public static native long SwapDirectToHeap(ByteBuffer data, int offset, int length);
+
+	// shares the frame, returned handle has to be released one more time
+	public static native long SwapYuvToHeap(long handle, int length);
+
+	public static native ByteBuffer GetBuffer(long handle, int length);
 
-	public static native int SwapYuvToHeap(int ptr, int length);
+	public static native int GetLength(long handle);
 
-	public static native byte[] SwapFromHeap(int ptr, int length);
+	public static native byte[] SwapFromHeap(long handle, int length);
 
-	public static native byte[] CopyFromHeap(int ptr, int length);
+	public static native byte[] CopyFromHeap(long handle, int length);
 
-	public static native boolean FreeFromHeap(int ptr);
+	public static native boolean FreeFromHeap(long handle);
 
 	static
 	{
+		System.loadLibrary("utils-image");
 		System.loadLibrary("swapheap");
 	}
 }
@@ -60,7 +60,7 @@ public class YuvImage
 	 * The raw YUV data. In the case of more than one image plane, the image
 	 * planes must be concatenated into a single byte array.
 	 */
-	private int					mData;
+	private long				mData;
 
 	/**
 	 * The number of row bytes in each image plane.
@@ -98,7 +98,7 @@ public class YuvImage
 	 *             if format is not support; width or height <= 0; or yuv is
 	 *             null.
 	 */
-	public YuvImage(int yuv, int format, int width, int height, int[] strides)
+	public YuvImage(long yuv, int format, int width, int height, int[] strides)
 	{
 		if (format != ImageFormat.NV21 && format != ImageFormat.YUY2)
 		{
@@ -137,7 +137,8 @@ public class YuvImage
 	 *            Hint to the compressor, 0-100. 0 meaning compress for small
 	 *            size, 100 meaning compress for max quality.
 	 * @param stream
-	 *            OutputStream to write the compressed data.
+	 *            OutputStream to write the compressed data. FileOutputStream
+	 *            is written directly through its file descriptor.
 	 * @return True if the compression is successful.
 	 * @throws IllegalArgumentException
 	 *             if rectangle is invalid; quality is not within [0, 100]; or
@@ -169,6 +170,47 @@ public class YuvImage
 		return res;
 	}
 
+	/**
+	 * Compress a rectangle region in the YuvImage to a jpeg placed in a direct
+	 * (or memory-mapped) buffer, without passing data through java heap.
+	 * 
+	 * @param rectangle
+	 *            The rectangle region to be compressed.
+	 * @param quality
+	 *            Hint to the compressor, 0-100.
+	 * @param buffer
+	 *            Direct ByteBuffer receiving the compressed data, starting at
+	 *            its beginning.
+	 * @return Size of the jpeg in bytes, -1 if compression failed or buffer is
+	 *         too small.
+	 * @throws IllegalArgumentException
+	 *             if quality is not within [0, 100]; or buffer is not direct.
+	 */
+	public int compressToJpeg(Rect rectangle, int quality, ByteBuffer buffer)
+	{
+		Rect wholeImage = new Rect(0, 0, mWidth, mHeight);
+		if (!wholeImage.contains(rectangle))
+		{
+			wholeImage.set(rectangle);
+		}
+
+		if (quality < 0 || quality > 100)
+		{
+			throw new IllegalArgumentException("quality must be 0..100");
+		}
+
+		if (buffer == null || !buffer.isDirect())
+		{
+			throw new IllegalArgumentException("buffer must be a direct ByteBuffer");
+		}
+
+		adjustRectangle(rectangle);
+		int[] offsets = calculateOffsets(rectangle.left, rectangle.top);
+
+		return SaveJpegFreeOutMTToBuffer(mData, mFormat, rectangle.width(), rectangle.height(), offsets, mStrides,
+				quality, buffer);
+	}
+
 	/**
 	 * @return the YUV format as defined in {@link PixelFormat}.
 	 */
@@ -264,15 +306,28 @@ public class YuvImage
 
 	// ////////// native methods
 
-	public static native boolean SaveJpegFreeOut(int oriYuv, int format, int width, int height, int[] offsets,
+	public static native boolean SaveJpegFreeOut(long oriYuv, int format, int width, int height, int[] offsets,
 			int[] strides, int quality, OutputStream stream, byte[] tempStorage);
 
 	// Multithreaded version of SaveJpegFreeOut
-	public static native boolean SaveJpegFreeOutMT(int oriYuv, int format, int width, int height, int[] offsets,
+	public static native boolean SaveJpegFreeOutMT(long oriYuv, int format, int width, int height, int[] offsets,
 			int[] strides, int quality, OutputStream stream, byte[] tempStorage);
 
-	// Return: pointer to the frame data in heap converted to int
-	public static synchronized native int GetFrame();
+	// Multithreaded encoding into direct buffer
+	// Return: size of jpeg in bytes, -1 on error
+	public static native int SaveJpegFreeOutMTToBuffer(long oriYuv, int format, int width, int height, int[] offsets,
+			int[] strides, int quality, ByteBuffer buffer);
+
+	// Return: work split of the multithreaded encoder for given image,
+	// {threads, rows per thread, bands, buffer size, online cpus, big cpus, little cpus}
+	public static native int[] GetJpegEncodePlan(int width, int height, int quality);
+
+	// Force number of encoder threads (for benchmarking), 0 = choose automatically
+	public static native void SetJpegEncodeThreads(int threads);
+
+	// Return: handle of the frame data in heap, see SwapHeap
+	// Note: this will remove image from here, the handle is to be released
+	public static synchronized native long GetFrame();
 
 	// Return: byte-array copy of the frame in heap
 	// Note: this will remove image from heap
@@ -292,11 +347,18 @@ public class YuvImage
 			int pixelStrideY, int rowStrideY, int pixelStrideU, int rowStrideU, int pixelStrideV, int rowStrideV,
 			int sx, int sy);
 
-	// Return pointer to heap with size for one yuv image
-	public static synchronized native int AllocateMemoryForYUV(int sx, int sy);
+	// Same as CreateYUVImageByteArray, into an existing array of sx*sy+sx*((sy+1)/2) bytes
+	// Return: error status (0 = all ok)
+	public static synchronized native int FillYUVImageByteArray(ByteBuffer Y, ByteBuffer U, ByteBuffer V,
+			int pixelStrideY, int rowStrideY, int pixelStrideU, int rowStrideU, int pixelStrideV, int rowStrideV,
+			int sx, int sy, byte[] out);
+
+	// Return handle of heap memory with size for one yuv image
+	public static synchronized native long AllocateMemoryForYUV(int sx, int sy);
 
 	static
 	{
+		System.loadLibrary("utils-image");
 		System.loadLibrary("yuvimage");
 	}
 }
@@ -90,6 +90,7 @@ import com.almalence.opencam.R;
 //-+- -->
 
 import com.almalence.sony.cameraremote.SimpleStreamSurfaceView;
+import com.almalence.util.HeapUtil;
 import com.almalence.util.Util;
 
 /***
@@ -1196,6 +1197,15 @@ abstract public class ApplicationScreen extends Activity implements ApplicationI
 		onApplicationPause();
 	}
 
+	@Override
+	public void onTrimMemory(int level)
+	{
+		super.onTrimMemory(level);
+
+		// frames kept for the next capture are the first to go
+		HeapUtil.trimFramePool();
+	}
+
 	protected void onApplicationPause()
 	{
 		if (onResumeTimer != null)
@@ -263,7 +263,7 @@ public abstract class Plugin
 	{
 	}
 
-	public void onImageTaken(int frame, byte[] frameData, int frame_len, int format)
+	public void onImageTaken(long frame, byte[] frameData, int frame_len, int format)
 	{
 		
 	}
@@ -121,7 +121,7 @@ public abstract class PluginCapture extends Plugin
 	}
 
 	@Override
-	public abstract void onImageTaken(int frame, byte[] frameData, int frame_len, int format);
+	public abstract void onImageTaken(long frame, byte[] frameData, int frame_len, int format);
 
 	@Override
 	public abstract void onPreviewFrame(byte[] data);
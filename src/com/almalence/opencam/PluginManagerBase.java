@@ -722,7 +722,7 @@ abstract public class PluginManagerBase implements PluginManagerInterface
 	}
 
 	@Override
-	public void onImageTaken(int frame, byte[] frameData, int frame_len, int format)
+	public void onImageTaken(long frame, byte[] frameData, int frame_len, int format)
 	{
 		if (null != pluginList.get(activeCapture))
 			pluginList.get(activeCapture).onImageTaken(frame, frameData, frame_len, format);
@@ -1406,7 +1406,7 @@ abstract public class PluginManagerBase implements PluginManagerInterface
 		ApplicationScreen.instance.startService(mServiceIntent);
 	}
 
-	public void saveInputFile(boolean isYUV, Long SessionID, int i, byte[] buffer, int yuvBuffer, String fileFormat)
+	public void saveInputFile(boolean isYUV, Long SessionID, int i, byte[] buffer, long yuvBuffer, String fileFormat)
 	{
 		// if Android 5+ use new saving method.
 		if (Build.VERSION.SDK_INT >= Build.VERSION_CODES.LOLLIPOP)
@@ -1513,7 +1513,7 @@ abstract public class PluginManagerBase implements PluginManagerInterface
 		ApplicationScreen.instance.getContentResolver().insert(Images.Media.EXTERNAL_CONTENT_URI, values);
 	}
 
-	private void saveInputFileNew(boolean isYUV, Long SessionID, int i, byte[] buffer, int yuvBuffer, String fileFormat)
+	private void saveInputFileNew(boolean isYUV, Long SessionID, int i, byte[] buffer, long yuvBuffer, String fileFormat)
 	{
 		
 		int mImageWidth = Integer.parseInt(PluginManager.getInstance().getFromSharedMem("imageWidth" + SessionID));
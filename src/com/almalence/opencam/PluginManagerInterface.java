@@ -46,7 +46,7 @@ public interface PluginManagerInterface
 	public void onPreviewFrame(byte[] data);
 
 	//Callback for captured still images
-	public void onImageTaken(int frame, byte[] frameData, int frame_len, int format);
+	public void onImageTaken(long frame, byte[] frameData, int frame_len, int format);
 	
 	//Callback for CaptureResult (used in camera2 mode)
 	public void onCaptureCompleted(CaptureResult result);
@@ -32,6 +32,8 @@ import java.io.IOException;
 import java.io.InputStream;
 import java.io.OutputStream;
 import java.nio.ByteBuffer;
+import java.nio.channels.Channels;
+import java.nio.channels.WritableByteChannel;
 import java.text.SimpleDateFormat;
 import java.util.Calendar;
 import java.util.Date;
@@ -307,10 +309,15 @@ public class SavingService extends NotificationService
 
 					if (os != null)
 					{
-						byte[] frame = SwapHeap.SwapFromHeap(
-								Integer.parseInt(getFromSharedMem("resultframe" + i + Long.toString(sessionID))),
-								Integer.parseInt(getFromSharedMem("resultframelen" + i + Long.toString(sessionID))));
-						os.write(frame);
+						long frame = Long.parseLong(getFromSharedMem("resultframe" + i + Long.toString(sessionID)));
+						try
+						{
+							writeFromHeap(os, frame,
+									Integer.parseInt(getFromSharedMem("resultframelen" + i + Long.toString(sessionID))));
+						} finally
+						{
+							SwapHeap.FreeFromHeap(frame);
+						}
 						try
 						{
 							os.close();
@@ -324,7 +331,7 @@ public class SavingService extends NotificationService
 					saveDNGPicture(i, sessionID, os, x, y, orientation, cameraMirrored);
 				} else
 				{// if result in nv21 format
-					int yuv = Integer.parseInt(getFromSharedMem("resultframe" + i + Long.toString(sessionID)));
+					long yuv = Long.parseLong(getFromSharedMem("resultframe" + i + Long.toString(sessionID)));
 					com.almalence.YuvImage out = new com.almalence.YuvImage(yuv, ImageFormat.NV21, x, y, null);
 					Rect r;
 
@@ -664,10 +671,15 @@ public class SavingService extends NotificationService
 
 					if (os != null)
 					{
-						byte[] frame = SwapHeap.SwapFromHeap(
-								Integer.parseInt(getFromSharedMem("resultframe" + i + Long.toString(sessionID))),
-								Integer.parseInt(getFromSharedMem("resultframelen" + i + Long.toString(sessionID))));
-						os.write(frame);
+						long frame = Long.parseLong(getFromSharedMem("resultframe" + i + Long.toString(sessionID)));
+						try
+						{
+							writeFromHeap(os, frame,
+									Integer.parseInt(getFromSharedMem("resultframelen" + i + Long.toString(sessionID))));
+						} finally
+						{
+							SwapHeap.FreeFromHeap(frame);
+						}
 						try
 						{
 							os.close();
@@ -682,7 +694,7 @@ public class SavingService extends NotificationService
 					saveDNGPicture(i, sessionID, os, x, y, orientation, cameraMirrored);
 				} else
 				{// if result in nv21 format
-					int yuv = Integer.parseInt(getFromSharedMem("resultframe" + i + Long.toString(sessionID)));
+					long yuv = Long.parseLong(getFromSharedMem("resultframe" + i + Long.toString(sessionID)));
 					com.almalence.YuvImage out = new com.almalence.YuvImage(yuv, ImageFormat.NV21, x, y, null);
 					Rect r;
 
@@ -1576,13 +1588,11 @@ public class SavingService extends NotificationService
 	{
 		DngCreator creator = new DngCreator(CameraController.getCameraCharacteristics(), PluginManager.getInstance()
 				.getFromRAWCaptureResults("captureResult" + frameNum + sessionID));
-		byte[] frame = SwapHeap.SwapFromHeap(
-				Integer.parseInt(getFromSharedMem("resultframe" + frameNum + Long.toString(sessionID))),
+		long frame = Long.parseLong(getFromSharedMem("resultframe" + frameNum + Long.toString(sessionID)));
+		// RAW data is read in place
+		ByteBuffer buff = SwapHeap.GetBuffer(frame,
 				Integer.parseInt(getFromSharedMem("resultframelen" + frameNum + Long.toString(sessionID))));
 
-		ByteBuffer buff = ByteBuffer.allocateDirect(frame.length);
-		buff.put(frame);
-
 		int exif_orientation = ExifInterface.ORIENTATION_NORMAL;
 		switch ((orientation + 360) % 360)
 		{
@@ -1605,16 +1615,34 @@ public class SavingService extends NotificationService
 
 		try
 		{
+			if (buff == null)
+				throw new IOException("no frame in native heap");
+
 			creator.setOrientation(exif_orientation);
 			creator.writeByteBuffer(os, new Size(width, height), buff, 0);
 		} catch (IOException e)
 		{
-			creator.close();
 			e.printStackTrace();
 			Log.e("Open Camera", "saveDNGPicture error: " + e.getMessage());
+		} finally
+		{
+			creator.close();
+			SwapHeap.FreeFromHeap(frame);
 		}
+	}
 
-		creator.close();
+	// Writes frame kept in native heap without copying it to java heap. Frame
+	// is not released
+	private static void writeFromHeap(OutputStream os, long frame, int length) throws IOException
+	{
+		ByteBuffer buffer = SwapHeap.GetBuffer(frame, length);
+		if (buffer == null)
+			throw new IOException("no frame in native heap");
+
+		WritableByteChannel channel = (os instanceof FileOutputStream) ? ((FileOutputStream) os).getChannel()
+				: Channels.newChannel(os);
+		while (buffer.hasRemaining())
+			channel.write(buffer);
 	}
 
 	protected static final String[]	MEMCARD_DIR_PATH		= new String[] { "/storage", "/mnt", "", "/storage",
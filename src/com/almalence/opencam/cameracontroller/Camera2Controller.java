@@ -69,6 +69,7 @@ import android.widget.Toast;
 import com.almalence.SwapHeap;
 import com.almalence.YuvImage;
 import com.almalence.util.ImageConversion;
+import com.almalence.util.PreviewBufferPool;
 import com.almalence.util.Util;
 
 //<!-- -+-
@@ -3492,7 +3493,16 @@ public class Camera2Controller
 				// - U and V strides are the same
 				// So, passing all these parameters is a bit overkill
 
-				byte[] data = YuvImage.CreateYUVImageByteArray(
+				// preview arrays are reused instead of allocating one per frame
+				byte[] data = PreviewBufferPool.acquire(imageWidth * imageHeight + imageWidth
+						* ((imageHeight + 1) / 2));
+				if (data == null)
+				{
+					im.close();
+					return;
+				}
+
+				int status = YuvImage.FillYUVImageByteArray(
 								Y,
 								U,
 								V,
@@ -3503,12 +3513,15 @@ public class Camera2Controller
 								im.getPlanes()[2].getPixelStride(),
 								im.getPlanes()[2].getRowStride(),
 								imageWidth,
-								imageHeight);
+								imageHeight,
+								data);
 
-				pluginManager.onPreviewFrame(data);
+				if (status == 0)
+					pluginManager.onPreviewFrame(data);
+				PreviewBufferPool.release(data);
 			} else
 			{
-				int frame = 0;
+				long frame = 0;
 				byte[] frameData = new byte[0];
 				int frame_len = 0;
 				boolean isYUV = false;
@@ -3645,14 +3658,22 @@ public class Camera2Controller
 						ByteBuffer raw = im.getPlanes()[0].getBuffer();
 						
 						frame_len = raw.limit();
-						frameData = new byte[frame_len];
-						raw.get(frameData, 0, frame_len);
-						
-						if (resultInHeap)
+						if (resultInHeap && raw.isDirect())
 						{
-							frame = SwapHeap.SwapToHeap(frameData);
+							// straight from the image plane, no java copy of the whole RAW
+							frame = SwapHeap.SwapDirectToHeap(raw, 0, frame_len);
 							frameData = null;
-							System.gc();
+						} else
+						{
+							frameData = new byte[frame_len];
+							raw.get(frameData, 0, frame_len);
+							
+							if (resultInHeap)
+							{
+								frame = SwapHeap.SwapToHeap(frameData);
+								frameData = null;
+								System.gc();
+							}
 						}
 					}
 					
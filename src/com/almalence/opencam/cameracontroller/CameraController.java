@@ -4391,14 +4391,14 @@ public class CameraController implements Camera.PictureCallback, Camera.AutoFocu
 			pluginManager.collectExifData(paramArrayOfByte);
 			if (!CameraController.takeYUVFrame) // if JPEG frame requested
 			{
-				int frame = 0;
+				long frame = 0;
 				if (resultInHeap)
 					frame = SwapHeap.SwapToHeap(paramArrayOfByte);
 				pluginManager.onImageTaken(frame, paramArrayOfByte, paramArrayOfByte.length, CameraController.JPEG);
 			} else
 			// is YUV frame requested
 			{
-				int yuvFrame = ImageConversion.JpegConvert(paramArrayOfByte, imageSize.getWidth(),
+				long yuvFrame = ImageConversion.JpegConvert(paramArrayOfByte, imageSize.getWidth(),
 						imageSize.getHeight(), false, false, 0);
 				int frameLen = imageSize.getWidth() * imageSize.getHeight() + 2 * ((imageSize.getWidth() + 1) / 2)
 						* ((imageSize.getHeight() + 1) / 2);
@@ -4415,7 +4415,7 @@ public class CameraController implements Camera.PictureCallback, Camera.AutoFocu
 		} else
 		{
 			pluginManager.collectExifData(paramArrayOfByte);
-			int frame = SwapHeap.SwapToHeap(paramArrayOfByte);
+			long frame = SwapHeap.SwapToHeap(paramArrayOfByte);
 			pluginManager.onImageTaken(frame, paramArrayOfByte, paramArrayOfByte.length, CameraController.JPEG);
 		}
 
@@ -4434,14 +4434,14 @@ public class CameraController implements Camera.PictureCallback, Camera.AutoFocu
 		if (!CameraController.takeYUVFrame) // if JPEG frame requested
 		{
 
-			int frame = 0;
+			long frame = 0;
 			if (resultInHeap)
 				frame = SwapHeap.SwapToHeap(paramArrayOfByte);
 			pluginManager.onImageTaken(frame, paramArrayOfByte, paramArrayOfByte.length, CameraController.JPEG);
 		} else
 		// is YUV frame requested
 		{
-			int yuvFrame = ImageConversion.JpegConvert(paramArrayOfByte, imageSize.getWidth(), imageSize.getHeight(),
+			long yuvFrame = ImageConversion.JpegConvert(paramArrayOfByte, imageSize.getWidth(), imageSize.getHeight(),
 					false, false, 0);
 			int frameLen = imageSize.getWidth() * imageSize.getHeight() + 2 * ((imageSize.getWidth() + 1) / 2)
 					* ((imageSize.getHeight() + 1) / 2);
@@ -4541,7 +4541,7 @@ public class CameraController implements Camera.PictureCallback, Camera.AutoFocu
 			takePreviewFrame = false;
 			if (CameraController.takeYUVFrame)
 			{
-				int frame = 0;
+				long frame = 0;
 				int dataLenght = data.length;
 				if (resultInHeap)
 				{
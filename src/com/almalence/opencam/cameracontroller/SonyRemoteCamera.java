@@ -1196,7 +1196,7 @@ public class SonyRemoteCamera
 		previewImagesCount++;
 		if (!opening)
 		{
-			int frame = ImageConversion.JpegConvert(jpegData, previewWidth, previewHeight, false, false, 0);
+			long frame = ImageConversion.JpegConvert(jpegData, previewWidth, previewHeight, false, false, 0);
 			int frameLen = previewWidth * previewHeight + 2 * ((previewWidth + 1) / 2) * ((previewHeight + 1) / 2);
 			final byte[] data = SwapHeap.SwapFromHeap(frame, frameLen);
 
@@ -148,7 +148,7 @@ public class BestShotCapturePlugin extends PluginCapture
 	}
 
 	@Override
-	public void onImageTaken(int frame, byte[] frameData, int frame_len, int format)
+	public void onImageTaken(long frame, byte[] frameData, int frame_len, int format)
 	{
 		imagesTaken++;
 
@@ -368,7 +368,7 @@ public class BurstCapturePlugin extends PluginCapture
 	}
 
 	@Override
-	public void onImageTaken(int frame, byte[] frameData, int frame_len, int format)
+	public void onImageTaken(long frame, byte[] frameData, int frame_len, int format)
 	{
 		if (frame == 0)
 		{
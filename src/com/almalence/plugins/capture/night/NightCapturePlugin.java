@@ -117,7 +117,7 @@ public class NightCapturePlugin extends PluginCapture
 	private int                 sensorGain = 0;
 	private int                 burstGain = 0; 
 	private long                exposureTime = 0;
-	private int                 frameForExposure = 0;
+	private long                frameForExposure = 0;
 	
 
 	// preferences
@@ -668,7 +668,7 @@ public class NightCapturePlugin extends PluginCapture
 	
 	final Object syncObject = new Object();
 	@Override
-	public synchronized void onImageTaken(int frame, byte[] frameData, int frame_len, int format)
+	public synchronized void onImageTaken(long frame, byte[] frameData, int frame_len, int format)
 	{
 		if (takingImageForExposure)
 		{
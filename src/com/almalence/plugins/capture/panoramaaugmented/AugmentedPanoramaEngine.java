@@ -757,7 +757,7 @@ public class AugmentedPanoramaEngine implements Renderer, AugmentedRotationRecei
 	}
 
 	@TargetApi(19)
-	public boolean onFrameAdded(final int image)
+	public boolean onFrameAdded(final long image)
 	{
 		final boolean goodPlace;
 		final int framesCount;
@@ -1224,7 +1224,7 @@ public class AugmentedPanoramaEngine implements Renderer, AugmentedRotationRecei
 
 		private final float			angleShift;
 
-		private int					nv21address;
+		private long				nv21address;
 		private final Object		nv21addressSync		= new Object();
 
 		private final Object		glSync				= new Object();
@@ -1238,7 +1238,7 @@ public class AugmentedPanoramaEngine implements Renderer, AugmentedRotationRecei
 		
 		
 
-		public int getNV21address()
+		public long getNV21address()
 		{
 			synchronized (this.nv21addressSync)
 			{
@@ -1283,7 +1283,7 @@ public class AugmentedPanoramaEngine implements Renderer, AugmentedRotationRecei
 		 * For YUV input
 		 */
 		public AugmentedFrameTaken(final float angleShift, final Vector3d position,
-				final Vector3d topVec, final float[] rotation, final int yuv_address,
+				final Vector3d topVec, final float[] rotation, final long yuv_address,
 				final boolean displayAsPerfect)
 		{
 			this(angleShift, position, topVec, rotation, displayAsPerfect);
@@ -1066,7 +1066,7 @@ public class PanoramaAugmentedCapturePlugin extends PluginCapture
 		mainButtons.setVisibility(View.INVISIBLE);
 	}
 
-	private void takePictureUnimode(final int image)
+	private void takePictureUnimode(final long image)
 	{
 		if (this.focused)
 		{
@@ -1220,7 +1220,7 @@ public class PanoramaAugmentedCapturePlugin extends PluginCapture
 	}
 
 	@Override
-	public void onImageTaken(int frame, byte[] frameDataOrig, int frame_len, int format)
+	public void onImageTaken(long frame, byte[] frameDataOrig, int frame_len, int format)
 	{
 		final boolean goodPlace;
 		
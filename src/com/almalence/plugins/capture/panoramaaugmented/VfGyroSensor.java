@@ -95,7 +95,6 @@ public class VfGyroSensor implements Closeable, Handler.Callback
 
 	private boolean				m_justStability;
 
-	private byte[]				datacopy;
 	private long				timestamp;
 	private long				timestamp_initial;
 	private VfGyroSensor		mThiz;
@@ -220,12 +219,12 @@ public class VfGyroSensor implements Closeable, Handler.Callback
 		if ((!doneWithNewData) || (data == null))
 			return;
 
-		if (datacopy == null)
-			datacopy = new byte[data.length];
-		else if (datacopy.length != data.length)
-			datacopy = new byte[data.length];
-
-		System.arraycopy(data, 0, datacopy, 0, data.length);
+		// the preview frame is only read here, on the preview thread, and just
+		// its downsampled luma is kept for the worker - no copy of the frame
+		synchronized (mThiz)
+		{
+			Downsample(data);
+		}
 
 		doneWithNewData = false;
 
@@ -243,7 +242,7 @@ public class VfGyroSensor implements Closeable, Handler.Callback
 			{
 				synchronized (mThiz)
 				{
-					Update(datacopy, sensorEvent.timestamp, m_justStability);
+					UpdateDownsampled(sensorEvent.timestamp, m_justStability);
 
 					Get(sensorEvent.values);
 
@@ -322,6 +321,12 @@ public class VfGyroSensor implements Closeable, Handler.Callback
 
 	public native void Update(byte[] data, long timestamp, boolean justStability);
 
+	// Update split in two: Downsample takes the frame, UpdateDownsampled
+	// estimates motion from it
+	public native void Downsample(byte[] data);
+
+	public native void UpdateDownsampled(long timestamp, boolean justStability);
+
 	public native long Get(float[] values); // return value is timestamp
 
 	public static native void FixDrift(float[] values, boolean updateDrift);
@@ -24,6 +24,9 @@ public final class PreShot
 
 	public static native int AllocateBuffer(int imgW, int imgH, int fps, int secondsToAllocate, int isJPG);
 
+	// preview frames are kept compressed to jpeg of given quality
+	public static native int AllocateCompressedBuffer(int imgW, int imgH, int fps, int secondsToAllocate, int quality);
+
 	public static native int[] GetFromBufferRGBA(int idx, boolean manualOrientation, boolean orientation);
 
 	public static native byte[] GetFromBufferToShowInSlow(int idx, int previewW, int previewH);
@@ -34,9 +37,10 @@ public final class PreShot
 
 	public static native int GetImageCount();
 
-	public static native byte[] GetFromBufferNV21(int idx, int W, int H, int mirrored);
+	// frames are returned in native heap, see SwapHeap
+	public static native long GetFromBufferToHeap(int idx, int mirrored);
 
-	public static native byte[] GetFromBufferSimpleNV21(int idx);
+	public static native long GetFromBufferSimpleToHeap(int idx);
 	
 	// /reserved
 //	public static native int MakeCopy();
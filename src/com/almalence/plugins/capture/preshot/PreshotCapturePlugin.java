@@ -68,6 +68,7 @@ public class PreshotCapturePlugin extends PluginCapture
 	private static String		FPS;
 	private static boolean		RefocusPreference;
 	private static boolean		AutostartPreference;
+	private static boolean		CompressPreference;
 	private static String		PauseBetweenShots;
 	private int					preferenceFocusMode;
 
@@ -78,6 +79,9 @@ public class PreshotCapturePlugin extends PluginCapture
 	private static int			counter				= 0;
 	private static final int	REFOCUS_INTERVAL	= 3;
 
+	// jpeg quality of preview frames buffered with compressPrefPreShot
+	private static final int	COMPRESSED_FRAME_QUALITY	= 90;
+
 	private Switch				modeSwitcher;
 
 	private boolean				captureStarted		= false;
@@ -199,6 +203,7 @@ public class PreshotCapturePlugin extends PluginCapture
 		SharedPreferences prefs = PreferenceManager.getDefaultSharedPreferences(ApplicationScreen.getMainContext());
 		RefocusPreference = prefs.getBoolean("refocusPrefPreShot", false);
 		AutostartPreference = prefs.getBoolean("autostartPrefPreShot", false);
+		CompressPreference = prefs.getBoolean("compressPrefPreShot", false);
 		PauseBetweenShots = prefs.getString("pauseBetweenShotsPrefPreShot", "500");
 		PreShotInterval = prefs.getString("backInTimePrefPreShot", "5");
 
@@ -329,8 +334,13 @@ public class PreshotCapturePlugin extends PluginCapture
 
 			Log.i("Preshot capture", "StartBuffering trying to allocate!");
 
-			int secondsAllocated = PreShot.AllocateBuffer(imW, imH, Integer.parseInt(FPS),
-					Integer.parseInt(PreShotInterval), 0);
+			int secondsAllocated;
+			if (CompressPreference)
+				secondsAllocated = PreShot.AllocateCompressedBuffer(imW, imH, Integer.parseInt(FPS),
+						Integer.parseInt(PreShotInterval), COMPRESSED_FRAME_QUALITY);
+			else
+				secondsAllocated = PreShot.AllocateBuffer(imW, imH, Integer.parseInt(FPS),
+						Integer.parseInt(PreShotInterval), 0);
 			if (secondsAllocated == 0)
 			{
 				Log.i("Preshot capture", "StartBuffering failed, can't allocate native buffer!");
@@ -441,7 +451,7 @@ public class PreshotCapturePlugin extends PluginCapture
 	}
 	
 	@Override
-	public void onImageTaken(int frame, byte[] frameData, int frame_len, int format)
+	public void onImageTaken(long frame, byte[] frameData, int frame_len, int format)
 	{
 		PreShot.InsertToBuffer(frameData, ApplicationScreen.getGUIManager().getImageDataOrientation());
 
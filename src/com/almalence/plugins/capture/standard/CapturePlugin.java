@@ -260,7 +260,7 @@ public class CapturePlugin extends PluginCapture
 
 	
 	@Override
-	public void onImageTaken(int frame, byte[] frameData, int frame_len, int format)
+	public void onImageTaken(long frame, byte[] frameData, int frame_len, int format)
 	{
 		framesCaptured++;
 		boolean isRAW = (format == CameraController.RAW);
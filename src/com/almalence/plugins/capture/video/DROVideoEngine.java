@@ -104,7 +104,7 @@ public class DROVideoEngine
 	}
 
 	private final Object		stateSync			= new Object();
-	private int					instance			= 0;
+	private long					instance			= 0;
 	private int					previewWidth		= -1;
 	private int					previewHeight		= -1;
 
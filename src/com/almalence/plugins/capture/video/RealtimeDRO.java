@@ -9,10 +9,10 @@ public class RealtimeDRO
 		System.loadLibrary("almashot-dro");
 	}
 
-	public static native int initialize(int output_width, int output_height);
+	public static native long initialize(int output_width, int output_height);
 
 	public static native void render(
-			int instance,
+			long instance,
 			int texture_in,
 			float[] jmtx,
 			int sx,
@@ -33,5 +33,5 @@ public class RealtimeDRO
 			int texture_out
 			);
 
-	public static native void release(int instance);
+	public static native void release(long instance);
 }
@@ -69,12 +69,12 @@ public class BestshotProcessingPlugin extends PluginProcessing
 				.getFromSharedMem("frameorientation1" + sessionID));
 		AlmaShotBestShot.Initialize();
 
-		int[] compressed_frame = new int[imagesAmount];
+		long[] compressed_frame = new long[imagesAmount];
 		int[] compressed_frame_len = new int[imagesAmount];
 
 		for (int i = 0; i < imagesAmount; i++)
 		{
-			compressed_frame[i] = Integer.parseInt(PluginManager.getInstance().getFromSharedMem(
+			compressed_frame[i] = Long.parseLong(PluginManager.getInstance().getFromSharedMem(
 					"frame" + (i + 1) + sessionID));
 			compressed_frame_len[i] = Integer.parseInt(PluginManager.getInstance().getFromSharedMem(
 					"framelen" + (i + 1) + sessionID));
@@ -96,7 +96,7 @@ public class BestshotProcessingPlugin extends PluginProcessing
 			PluginManager.getInstance().addToSharedMem("saveImageHeight" + sessionID, String.valueOf(mImageHeight));
 		}
 
-		int frame = compressed_frame[idxResult];
+		long frame = compressed_frame[idxResult];
 		int len = compressed_frame_len[idxResult];
 
 		PluginManager.getInstance().addToSharedMem("resultframe1" + sessionID, String.valueOf(frame));
@@ -52,14 +52,14 @@ public final class AlmaShotGroupShot
 	 *            height of input frame
 	 * @return status string such as "frames total: "
 	 */
-	public static synchronized native int DetectFacesFromYUVs(int[] frame, int[] frame_len, int nFrames, int sx,
+	public static synchronized native int DetectFacesFromYUVs(long[] frame, int[] frame_len, int nFrames, int sx,
 			int sy, int fd_sx, int fd_sy, boolean mirrored, int rotationDegree);
 
 	public static synchronized native int GetFaces(int index, Face[] faces);
 
-	public static synchronized native int[] NV21toARGB(int inptr, int width, int height, Rect rect, int dstWidth, int dstHeight);
+	public static synchronized native int[] NV21toARGB(long inptr, int width, int height, Rect rect, int dstWidth, int dstHeight);
 
-	public static synchronized native int getInputFrame(int index);
+	public static synchronized native long getInputFrame(int index);
 
 	/**
 	 * Initialize Seamless engine
@@ -113,7 +113,7 @@ public final class AlmaShotGroupShot
 	 *            filled with index of frame.
 	 * @return NV21(YVU420 planer)
 	 */
-	public static synchronized native int RealView(int width, int height, int[] crop, byte[] layout);
+	public static synchronized native long RealView(int width, int height, int[] crop, byte[] layout);
 
 	static
 	{
@@ -115,7 +115,7 @@ public class GroupShotCore
 	private int							mMatrixRotation				= 0;
 
 	private int[]							ARGBBuffer				= null;
-	private int								mOutNV21;
+	private long							mOutNV21;
 	private int[]							mCrop;
 	private ArrayList<ArrayList<Rect>>		mFacesList				= null;
 	private ArrayList<ArrayList<Bitmap>>	mFacesBitmapsList		= null;
@@ -134,17 +134,17 @@ public class GroupShotCore
 	private boolean						mIsBaseFrameChanged			= false;
 	private boolean						mIsFacesChanged				= false;
 
-	private ArrayList<Integer>			mYUVBufferList;															// List
+	private ArrayList<Long>			mYUVBufferList;															// List
 																													// of
 																													// input
 																													// images.
 
-	public void setYUVBufferList(ArrayList<Integer> YUVBufferList)
+	public void setYUVBufferList(ArrayList<Long> YUVBufferList)
 	{
 		this.mYUVBufferList = YUVBufferList;
 	}
 
-	public ArrayList<Integer> getYUVBufferList()
+	public ArrayList<Long> getYUVBufferList()
 	{
 		return mYUVBufferList;
 	}
@@ -465,7 +465,7 @@ public class GroupShotCore
 	{
 		AlmaShotGroupShot.Initialize();
 
-		int[] yuvPtrs = new int[mNumOfFrame]; // Pointers to YUV image data.
+		long[] yuvPtrs = new long[mNumOfFrame]; // Handles of YUV image data.
 		int[] yuvSizes = new int[mNumOfFrame]; // Sizes of each image in bytes.
 
 		int dataSize = mImageWidth * mImageHeight * 3 / 2;
@@ -621,7 +621,7 @@ public class GroupShotCore
 		
 		for (int i = 0; i < mNumOfFrame; i++)
 		{
-			int yuvBuffer = AlmaShotGroupShot.getInputFrame(i);
+			long yuvBuffer = AlmaShotGroupShot.getInputFrame(i);
 			
 			ArrayList<Rect> faceRect = mFacesList.get(i);
 			ArrayList<Bitmap> bitmaps = new ArrayList<Bitmap>();
@@ -1158,7 +1158,7 @@ public class GroupShotCore
 	{
 		AlmaShotGroupShot.Release(mNumOfFrame);
 
-		for (int yuv : mYUVBufferList)
+		for (long yuv : mYUVBufferList)
 			SwapHeap.FreeFromHeap(yuv);
 		mYUVBufferList.clear();
 
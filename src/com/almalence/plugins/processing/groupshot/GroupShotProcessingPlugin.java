@@ -128,7 +128,7 @@ public class GroupShotProcessingPlugin extends MultiShotProcessingPlugin impleme
 	private int					iMatrixRotation			= 0;
 
 	@Override
-	public void setYUVBufferList(ArrayList<Integer> YUVBufferList)
+	public void setYUVBufferList(ArrayList<Long> YUVBufferList)
 	{
 		GroupShotCore.getInstance().setYUVBufferList(YUVBufferList);
 	}
@@ -213,7 +213,7 @@ public class GroupShotProcessingPlugin extends MultiShotProcessingPlugin impleme
 		if(imagesAmount == 0)
 			imagesAmount = 1;
 		
-		ArrayList<Integer>	mYUVBufferList = GroupShotCore.getInstance().getYUVBufferList();
+		ArrayList<Long>	mYUVBufferList = GroupShotCore.getInstance().getYUVBufferList();
 		thumbnails.clear();
 		int heightPixels = ApplicationScreen.getAppResources().getDisplayMetrics().heightPixels;
 		for (int i = 1; i <= imagesAmount; i++)
@@ -515,7 +515,7 @@ public class GroupShotProcessingPlugin extends MultiShotProcessingPlugin impleme
 		}
 
 		int frame_len = result.length;
-		int frame = SwapHeap.SwapToHeap(result);
+		long frame = SwapHeap.SwapToHeap(result);
 		PluginManager.getInstance().addToSharedMem("resultframeformat1" + sessionID, "jpeg");
 		PluginManager.getInstance().addToSharedMem("resultframe1" + sessionID, String.valueOf(frame));
 		PluginManager.getInstance().addToSharedMem("resultframelen1" + sessionID, String.valueOf(frame_len));
@@ -55,13 +55,13 @@ public class ImageAdapter extends BaseAdapter
 	static final int			IMAGEVIEW_PADDING	= 4;
 	int							mGalleryItemBackground;
 	private Context				mContext			= null;
-	private List<Integer>		mYUVList;
+	private List<Long>			mYUVList;
 	private boolean				mCameraMirrored;
 	private int					mImageDataOrientation;
 	private MemoryImageCache	cache				= null;
 	private int					mSelectedItem;
 
-	public ImageAdapter(Context context, List<Integer> list, int imageDataOrientation, boolean isMirrored)
+	public ImageAdapter(Context context, List<Long> list, int imageDataOrientation, boolean isMirrored)
 	{
 		mContext = context;
 		mYUVList = list;
@@ -26,10 +26,10 @@ public final class AlmaShotHDR
 
 	public static synchronized native int Release();
 
-	public static synchronized native String HDRConvertFromJpeg(int[] frame, int[] frame_len, int nFrames, int sx,
+	public static synchronized native String HDRConvertFromJpeg(long[] frame, int[] frame_len, int nFrames, int sx,
 			int sy);
 
-	public static synchronized native String HDRAddYUVFrames(int[] frame, int nFrames, int sx, int sy);
+	public static synchronized native String HDRAddYUVFrames(long[] frame, int nFrames, int sx, int sy);
 
 	public static synchronized native String HDRPreview(int nFrames, int sx, int sy, int[] pview, int expoPref,
 			int colorPref, int ctrstPref, int microPref, int noSegmPref, int noisePref, boolean mirrored);
@@ -170,7 +170,7 @@ public class HDRProcessingPlugin extends PluginProcessing implements OnItemClick
 			HDRProcessing();
 
 			int frame_len = yuv.length;
-			int frame = SwapHeap.SwapToHeap(yuv);
+			long frame = SwapHeap.SwapToHeap(yuv);
 
 			PluginManager.getInstance().addToSharedMem("resultfromshared" + sessionID, "true");
 
@@ -202,12 +202,12 @@ public class HDRProcessingPlugin extends PluginProcessing implements OnItemClick
 		int imagesAmount = Integer.parseInt(PluginManager.getInstance().getFromSharedMem(
 				"amountofcapturedframes" + sessionID));
 
-		int[] compressed_frame = new int[imagesAmount];
+		long[] compressed_frame = new long[imagesAmount];
 		int[] compressed_frame_len = new int[imagesAmount];
 
 		for (int i = 0; i < imagesAmount; i++)
 		{
-			compressed_frame[i] = Integer.parseInt(PluginManager.getInstance().getFromSharedMem(
+			compressed_frame[i] = Long.parseLong(PluginManager.getInstance().getFromSharedMem(
 					"frame" + (i + 1) + sessionID));
 			compressed_frame_len[i] = Integer.parseInt(PluginManager.getInstance().getFromSharedMem(
 					"framelen" + (i + 1) + sessionID));
@@ -238,7 +238,7 @@ public class HDRProcessingPlugin extends PluginProcessing implements OnItemClick
 					//Code is commented, because method saveInputFile uses only yuvBuffer pointer to save YUV image
 //					byte[] buffer = SwapHeap.CopyFromHeap(compressed_frame[ExpoBracketingCapturePlugin.evIdx[i]],
 //							compressed_frame_len[ExpoBracketingCapturePlugin.evIdx[i]]);
-					int yuvBuffer = compressed_frame[ExpoBracketingCapturePlugin.evIdx[i]];
+					long yuvBuffer = compressed_frame[ExpoBracketingCapturePlugin.evIdx[i]];
 			
 					PluginManager.getInstance().saveInputFile(true, sessionID, i, null, yuvBuffer, fileFormat + evmark);
 				}
@@ -1175,7 +1175,7 @@ public class HDRProcessingPlugin extends PluginProcessing implements OnItemClick
 			HDRProcessing();
 
 			int frame_len = yuv.length;
-			int frame = SwapHeap.SwapToHeap(yuv);
+			long frame = SwapHeap.SwapToHeap(yuv);
 
 			PluginManager.getInstance().addToSharedMem("sessionID", String.valueOf(sessionID));
 
@@ -90,7 +90,7 @@ public class AlmaCLRShot
 	private int						mGhosting;
 	private int						mAngle;
 
-	private int						mOutNV21		= 0;
+	private long					mOutNV21		= 0;
 	private ObjectInfo[]			mObjInfo		= null;
 	private ObjBorderInfo[]			mObjBorderInfo	= null;
 	private Rect[]					mBoarderRect	= null;
@@ -167,7 +167,7 @@ public class AlmaCLRShot
 		void onProcessingComplete(ObjectInfo[] objInfoList);
 	}
 
-	public void addInputFrame(List<Integer> inputFrame, Size size) throws Exception
+	public void addInputFrame(List<Long> inputFrame, Size size) throws Exception
 	{
 		mNumOfFrame = inputFrame.size();
 		mInputFrameSize = size;
@@ -198,7 +198,7 @@ public class AlmaCLRShot
 
 		synchronized (syncObject)
 		{
-			int[] PointOfData = new int[mNumOfFrame];
+			long[] PointOfData = new long[mNumOfFrame];
 			int[] LengthOfData = new int[mNumOfFrame];
 
 			int data_lenght = mInputFrameSize.getWidth() * mInputFrameSize.getHeight() + 2
@@ -1292,17 +1292,17 @@ public class AlmaCLRShot
 
 	private static native int Release(int nFrames);
 
-	private static native int ConvertFromJpeg(int[] frame, int[] frame_len, int nFrames, int sx, int sy);
+	private static native int ConvertFromJpeg(long[] frame, int[] frame_len, int nFrames, int sx, int sy);
 
-	private static native int AddYUVInputFrame(int[] frame, int[] frame_len, int nFrames, int sx, int sy);
+	private static native int AddYUVInputFrame(long[] frame, int[] frame_len, int nFrames, int sx, int sy);
 
-	private static native int[] NV21toARGB(int inptr, Size src, Rect rect, Size dst);
+	private static native int[] NV21toARGB(long inptr, Size src, Rect rect, Size dst);
 
-	private static native int getInputFrame(int index);
+	private static native long getInputFrame(int index);
 
 //	private static native int MovObjProcess(int nFrames, Size size, int sensitivity, int minSize, int[] base_area,
 //			int[] crop, byte[] layout, int ghosting, int ratio);
-	private static native int MovObjProcess(int nFrames, Size size, int sensitivity, int minSize, int[] base_area, int[] crop, byte[] layout,
+	private static native long MovObjProcess(int nFrames, Size size, int sensitivity, int minSize, int[] base_area, int[] crop, byte[] layout,
 			int ghosting, int ratio, int[] sports_order);
 
 	private static native int MovObjEnumerate(int nFrames, Size size, byte[] layout, byte[] enumObjects, int baseFrame);
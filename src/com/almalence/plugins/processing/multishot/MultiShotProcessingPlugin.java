@@ -23,7 +23,7 @@ public abstract class MultiShotProcessingPlugin extends PluginProcessing impleme
 		super(ID, mode, preferenceID, advancedPreferenceID, quickControlID,
 				quickControlInitTitle);
 	}
-	public abstract void setYUVBufferList(ArrayList<Integer> list);
+	public abstract void setYUVBufferList(ArrayList<Long> list);
 	public abstract void onStartPostProcessing();
 	public abstract void onStartProcessing(long sessionID);
 	public abstract View getPostProcessingView();
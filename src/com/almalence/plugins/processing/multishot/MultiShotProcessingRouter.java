@@ -88,7 +88,7 @@ public class MultiShotProcessingRouter extends PluginProcessing implements OnTas
 	private long									sessionID;
 
 	private boolean									mSaveInputPreference;
-	private static ArrayList<Integer>				mYUVBufferList					= new ArrayList<Integer>();
+	private static ArrayList<Long>					mYUVBufferList					= new ArrayList<Long>();
 
 	public MultiShotProcessingRouter()
 	{
@@ -210,7 +210,7 @@ public class MultiShotProcessingRouter extends PluginProcessing implements OnTas
 
 		for (int i = 1; i <= imagesAmount; i++)
 		{
-			int yuv = Integer.parseInt(PluginManager.getInstance().getFromSharedMem("frame" + i + sessionID));
+			long yuv = Long.parseLong(PluginManager.getInstance().getFromSharedMem("frame" + i + sessionID));
 			mYUVBufferList.add(i - 1, yuv);
 		}
 
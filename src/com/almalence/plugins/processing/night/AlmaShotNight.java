@@ -24,12 +24,12 @@ public final class AlmaShotNight
 
 	public static synchronized native int Release();
 
-	public static synchronized native void NightAddYUVFrames(int[] frame, int nFrames, int sx, int sy);
+	public static synchronized native void NightAddYUVFrames(long[] frame, int nFrames, int sx, int sy);
 
 	public static synchronized native boolean CheckClipping(
-			int frame, int sx, int sy, int x0, int y0, int w, int h);
+			long frame, int sx, int sy, int x0, int y0, int w, int h);
 
-	public static synchronized native int Process(
+	public static synchronized native long Process(
 			int sx, int sy, int sxo, int syo,
 			int iso, int noisePref, int DeGhostPref,
 			int lumaEnh, int chromaEnh, float fgamma, int nImages,
@@ -48,7 +48,7 @@ import com.almalence.opencam.cameracontroller.CameraController;
 public class NightProcessingPlugin extends PluginProcessing implements OnTaskCompleteListener
 {
 	// fused result
-	private int				yuv;
+	private long			yuv;
 	private static int[]	crop				= new int[4];
 
 	private long			sessionID			= 0;
@@ -172,11 +172,11 @@ public class NightProcessingPlugin extends PluginProcessing implements OnTaskCom
 		int imagesAmount = Integer.parseInt(PluginManager.getInstance().getFromSharedMem(
 				"amountofcapturedframes" + sessionID));
 
-		int[] frames = new int[imagesAmount];
+		long[] frames = new long[imagesAmount];
 
 		for (int i = 0; i < imagesAmount; i++)
 		{
-			frames[i] = Integer.parseInt(PluginManager.getInstance().getFromSharedMem("frame" + (i + 1) + sessionID));
+			frames[i] = Long.parseLong(PluginManager.getInstance().getFromSharedMem("frame" + (i + 1) + sessionID));
 		}
 
 		AlmaShotNight.NightAddYUVFrames(frames, imagesAmount, mImageWidth, mImageHeight);
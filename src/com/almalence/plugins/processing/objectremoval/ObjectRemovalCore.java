@@ -51,16 +51,16 @@ public class ObjectRemovalCore
 	public static int				mDisplayHeight;
 	
 	
-	private ArrayList<Integer>		mYUVBufferList = null;	// List of input images.
+	private ArrayList<Long>		mYUVBufferList = null;	// List of input images.
 	
 	private static Bitmap			mPreviewBitmap = null;
 	
-	public void setYUVBufferList(ArrayList<Integer> YUVBufferList)
+	public void setYUVBufferList(ArrayList<Long> YUVBufferList)
 	{
 		this.mYUVBufferList = YUVBufferList;
 	}
 	
-	public ArrayList<Integer> getYUVBufferList()
+	public ArrayList<Long> getYUVBufferList()
 	{
 		return mYUVBufferList;
 	}
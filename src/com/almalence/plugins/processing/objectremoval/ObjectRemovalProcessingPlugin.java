@@ -182,7 +182,7 @@ public class ObjectRemovalProcessingPlugin extends MultiShotProcessingPlugin
 	public static int				mDisplayHeight;
 	
 	@Override
-	public void setYUVBufferList(ArrayList<Integer> YUVBufferList)
+	public void setYUVBufferList(ArrayList<Long> YUVBufferList)
 	{
 		ObjectRemovalCore.getInstance().setYUVBufferList(YUVBufferList);
 	}
@@ -360,7 +360,7 @@ public class ObjectRemovalProcessingPlugin extends MultiShotProcessingPlugin
 	{
 		byte[] result = ObjectRemovalCore.processingSaveData();
 		int frame_len = result.length;
-		int frame = SwapHeap.SwapToHeap(result);
+		long frame = SwapHeap.SwapToHeap(result);
 		PluginManager.getInstance().addToSharedMem("resultframeformat1" + sessionID, "jpeg");
 		PluginManager.getInstance().addToSharedMem("resultframe1" + sessionID, String.valueOf(frame));
 		PluginManager.getInstance().addToSharedMem("resultframelen1" + sessionID, String.valueOf(frame_len));
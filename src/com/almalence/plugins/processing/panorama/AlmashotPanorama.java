@@ -31,6 +31,6 @@ public class AlmashotPanorama
 
 	public static native int release();
 
-	public static native int[] process(int width, int height, int[] jframes, float[][][] jtrs, int cameraFOV,
+	public static native long[] process(int width, int height, long[] jframes, float[][][] jtrs, int cameraFOV,
 			boolean useAll, boolean freeInput, float intersection);
 }
@@ -61,7 +61,7 @@ public class PanoramaProcessingPlugin extends PluginProcessing
 	private boolean				prefSaveInput;
 	private boolean				prefLandscape;
 	private int					mOrientation;
-	private int					out_ptr						= 0;
+	private long				out_ptr						= 0;
 
 	private static String				sFrameOverlapPref;
 	
@@ -121,12 +121,12 @@ public class PanoramaProcessingPlugin extends PluginProcessing
 			final boolean mirror = Boolean.parseBoolean(PluginManager.getInstance().getFromSharedMem(
 					"pano_mirror" + sessionID));
 
-			final int[] frames_ptrs = new int[frames_count];
+			final long[] frames_ptrs = new long[frames_count];
 			final float[][][] frame_trs = new float[frames_count][3][3];
 
 			for (int i = 0; i < frames_count; i++)
 			{
-				frames_ptrs[i] = Integer.parseInt(PluginManager.getInstance().getFromSharedMem(
+				frames_ptrs[i] = Long.parseLong(PluginManager.getInstance().getFromSharedMem(
 						"pano_frame" + (i + 1) + "." + sessionID));
 
 				for (int y = 0; y < 3; y++)
@@ -147,15 +147,15 @@ public class PanoramaProcessingPlugin extends PluginProcessing
 			}
 
 			AlmashotPanorama.initialize();
-			final int[] result = AlmashotPanorama.process(input_width, input_height, frames_ptrs, frame_trs,
+			final long[] result = AlmashotPanorama.process(input_width, input_height, frames_ptrs, frame_trs,
 					camera_fov, use_all, free_input, intersection);
 			this.out_ptr = result[0];
-			final int output_width = result[1];
-			final int output_height = result[2];
-			final int crop_x = result[3];
-			final int crop_y = result[4];
-			final int crop_w = result[5];
-			final int crop_h = result[6];
+			final int output_width = (int) result[1];
+			final int output_height = (int) result[2];
+			final int crop_x = (int) result[3];
+			final int crop_y = (int) result[4];
+			final int crop_w = (int) result[5];
+			final int crop_h = (int) result[6];
 
 			if (mirror)
 			{
@@ -195,7 +195,7 @@ public class PanoramaProcessingPlugin extends PluginProcessing
 	}
 
 	@SuppressLint("DefaultLocale")
-	private void saveFrames(final int[] images, final int offset, final int count, final int input_width,
+	private void saveFrames(final long[] images, final int offset, final int count, final int input_width,
 			final int input_height)
 	{
 		File saveDir = PluginManager.getSaveDir(false);
@@ -207,7 +207,7 @@ public class PanoramaProcessingPlugin extends PluginProcessing
 		final Rect crop = new Rect(0, 0, input_width, input_height);
 		for (int i = 0; i < count; ++i)
 		{
-			final int optr = images[offset + i];
+			final long optr = images[offset + i];
 			String index = String.format("_%02d", i);
 			File file = new File(saveDir, fileFormat + index + ".jpg");
 
@@ -274,7 +274,7 @@ public class PanoramaProcessingPlugin extends PluginProcessing
 		}
 	}
 
-	private void freeFrames(final int[] images, final int offset, final int count)
+	private void freeFrames(final long[] images, final int offset, final int count)
 	{
 		for (int i = 0; i < count; ++i)
 		{
@@ -293,4 +293,4 @@ public class PanoramaProcessingPlugin extends PluginProcessing
 	{
 
 	}
-}
\ No newline at end of file
+}
\ No newline at end of file
@@ -842,34 +842,26 @@ public class PreshotProcessingPlugin extends PluginProcessing implements OnTouch
 	{
 		if (!isSlowMode)
 		{
-			byte[] data = null;
+			// frame goes to native heap directly, not through a java array
+			long frame = PreShot.GetFromBufferToHeap(i, mCameraMirrored ? 1 : 0);
 
-			if (mCameraMirrored)
-				data = PreShot.GetFromBufferNV21(i, 0, 0, 1);
-			else
-				data = PreShot.GetFromBufferNV21(i, 0, 0, 0);
-
-			if (data.length == 0)
+			if (frame == 0)
 				return;
 
-			int frame = SwapHeap.SwapToHeap(data);
-
 			ApplicationScreen.getPluginManager().addToSharedMem("resultframe" + (j + 1) + sessionID, String.valueOf(frame));
 			ApplicationScreen.getPluginManager().addToSharedMem("resultframelen" + (j + 1) + sessionID,
-					String.valueOf(data.length));
+					String.valueOf(SwapHeap.GetLength(frame)));
 
 		} else if (isSlowMode)
 		{
-			byte[] data = PreShot.GetFromBufferSimpleNV21(i);
+			long frame = PreShot.GetFromBufferSimpleToHeap(i);
 
-			if (data.length == 0)
+			if (frame == 0)
 				return;
 
-			int frame = SwapHeap.SwapToHeap(data);
-
 			ApplicationScreen.getPluginManager().addToSharedMem("resultframe" + (j + 1) + sessionID, String.valueOf(frame));
 			ApplicationScreen.getPluginManager().addToSharedMem("resultframelen" + (j + 1) + sessionID,
-					String.valueOf(data.length));
+					String.valueOf(SwapHeap.GetLength(frame)));
 			ApplicationScreen.getPluginManager().addToSharedMem("resultframeformat" + (j + 1) + sessionID, "jpeg");
 		}
 	}
@@ -83,14 +83,14 @@ public class SequenceCore
 	private AlmaCLRShot					mAlmaCLRShot;
 	private int[]						indexes;
 	
-	private ArrayList<Integer>			mYUVBufferList;	// List of input images.
+	private ArrayList<Long>			mYUVBufferList;	// List of input images.
 
-	public void setYUVBufferList(ArrayList<Integer> YUVBufferList)
+	public void setYUVBufferList(ArrayList<Long> YUVBufferList)
 	{
 		this.mYUVBufferList = YUVBufferList;
 	}
 	
-	public ArrayList<Integer> getYUVBufferList()
+	public ArrayList<Long> getYUVBufferList()
 	{
 		return mYUVBufferList;
 	}
@@ -277,7 +277,7 @@ public class SequenceCore
 	{
 		byte[] result = mAlmaCLRShot.processingSaveData();
 		int frame_len = result.length;
-		int frame = SwapHeap.SwapToHeap(result);
+		long frame = SwapHeap.SwapToHeap(result);
 
 		PluginManager.getInstance().addToSharedMem("resultframeformat1" + sessionID, "jpeg");
 		PluginManager.getInstance().addToSharedMem("resultframe1" + sessionID, String.valueOf(frame));
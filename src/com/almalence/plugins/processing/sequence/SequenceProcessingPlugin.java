@@ -196,7 +196,7 @@ public class SequenceProcessingPlugin extends MultiShotProcessingPlugin implemen
 	private boolean						processingRunning = false;
 	private int[]						indexesToProcess  = null;
 
-	public void setYUVBufferList(ArrayList<Integer> mYUVBufferList)
+	public void setYUVBufferList(ArrayList<Long> mYUVBufferList)
 	{
 		SequenceCore.getInstance().setYUVBufferList(mYUVBufferList);
 	}
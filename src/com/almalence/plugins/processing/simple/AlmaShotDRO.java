@@ -24,11 +24,12 @@ public final class AlmaShotDRO
 
 	public static synchronized native int Release();
 
-	public static synchronized native String ConvertFromJpeg(int[] frame, int[] frame_len, int nFrames, int sx, int sy);
+	public static synchronized native String ConvertFromJpeg(long[] frame, int[] frame_len, int nFrames, int sx, int sy);
 
-	public static synchronized native int GetYUVFrame(int index);
+	// Return: handle of the decoded frame, it is to be released with SwapHeap.FreeFromHeap
+	public static synchronized native long GetYUVFrame(int index, int sx, int sy);
 
-    public static synchronized native int DroProcess(int yuv, int sx, int sy, float max_amplify,
+    public static synchronized native long DroProcess(long yuv, int sx, int sy, float max_amplify,
     		boolean local_mapping, int filterStrength, int pullUV, float dark_noise_pass, float gamma);
 
 	static
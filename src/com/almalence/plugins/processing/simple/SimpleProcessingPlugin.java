@@ -110,8 +110,8 @@ public class SimpleProcessingPlugin extends PluginProcessing
 			{//dro processing
 				AlmaShotDRO.Initialize();
 
-				int inputYUV = 0;
-				inputYUV = Integer.parseInt(PluginManager.getInstance().getFromSharedMem("frame" + i + sessionID));
+				long inputYUV = 0;
+				inputYUV = Long.parseLong(PluginManager.getInstance().getFromSharedMem("frame" + i + sessionID));
 
 				if (saveInputPreference)
 				{
@@ -152,7 +152,7 @@ public class SimpleProcessingPlugin extends PluginProcessing
 					break;
 				}
 				
-				int yuv = AlmaShotDRO.DroProcess(inputYUV, mImageWidth, mImageHeight, 1.5f, DROLocalTMPreference, 0,
+				long yuv = AlmaShotDRO.DroProcess(inputYUV, mImageWidth, mImageHeight, 1.5f, DROLocalTMPreference, 0,
 						prefPullYUV, dark_noise_pass, gammaTable[modePrefDro]);
 
 				AlmaShotDRO.Release();
@@ -174,7 +174,7 @@ public class SimpleProcessingPlugin extends PluginProcessing
 				PluginManager.getInstance().addToSharedMem("resultframe" + i + sessionID, String.valueOf(yuv));
 			} else
 			{//single shot processing + raw processing
-				int frame = Integer.parseInt(PluginManager.getInstance().getFromSharedMem("frame" + i + sessionID));
+				long frame = Long.parseLong(PluginManager.getInstance().getFromSharedMem("frame" + i + sessionID));
 				int len = Integer.parseInt(PluginManager.getInstance().getFromSharedMem("framelen" + i + sessionID));
 
 				boolean isRAW = Boolean.parseBoolean(PluginManager.getInstance().getFromSharedMem(
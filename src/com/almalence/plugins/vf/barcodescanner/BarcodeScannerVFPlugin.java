@@ -345,7 +345,9 @@ public class BarcodeScannerVFPlugin extends PluginViewfinder
 			return;
 		}
 
-		new DecodeAsyncTask(ApplicationScreen.getPreviewWidth(), ApplicationScreen.getPreviewHeight()).execute(data);
+		// preview arrays are reused by the camera, the decoder gets its own copy
+		new DecodeAsyncTask(ApplicationScreen.getPreviewWidth(), ApplicationScreen.getPreviewHeight()).execute(data
+				.clone());
 
 		mFrameCounter = 0;
 	}
@@ -28,6 +28,19 @@ public class HeapUtil
 	 * [0] = megabytes used [1] = megabytes free
 	 */
 	public static native int[] getMemoryInfo();
+
+	/**
+	 * Return statistics of the native frame pool:
+	 * 
+	 * [0] = hits [1] = misses [2] = frames returned to the pool [3] = frames
+	 * given back to the system [4] = idle frames [5] = megabytes idle
+	 */
+	public static native int[] getFramePoolStats();
+
+	/**
+	 * Give idle frames of the native frame pool back to the system.
+	 */
+	public static native void trimFramePool();
 	
 	//Method based on similar method from AugmentedPanorama plugin.
 	public static long getAmountOfMemoryToFitFrames()
@@ -35,24 +35,33 @@ import com.almalence.opencam.ApplicationScreen;
 
 public class ImageConversion
 {
-	public static native int JpegConvert(byte[] in, int sx, int sy, boolean rotate, boolean mirrored, int rotationDegree);
-	public static native int JpegConvertN(int in, int length, int sx, int sy, boolean rotate, boolean mirrored, int rotationDegree);
+	public static native long JpegConvert(byte[] in, int sx, int sy, boolean rotate, boolean mirrored, int rotationDegree);
+	public static native long JpegConvertN(long in, int length, int sx, int sy, boolean rotate, boolean mirrored, int rotationDegree);
 
 	public static native void sumByteArraysNV21(byte[] data1, byte[] data2, byte[] out, int width, int height);
 
 	public static native void TransformNV21(byte[] InPic, byte[] OutPic, int sx, int sy, int flipLR, int flipUD,
 			int rotate90);
 
-	public static native void TransformNV21N(int InPic, int OutPic, int sx, int sy, int flipLR, int flipUD, int rotate90);
+	public static native void TransformNV21N(long InPic, long OutPic, int sx, int sy, int flipLR, int flipUD, int rotate90);
+
+	/**
+	 * Times TransformNV21 against a per-pixel reference on a synthetic sx x sy
+	 * frame for rotate 90, rotate 90 mirrored and rotate 180.
+	 * 
+	 * @return tiled and reference microseconds per call for each case,
+	 *         followed by 1 if both produced the same output (0 otherwise)
+	 */
+	public static native int[] benchmarkTransformNV21(int sx, int sy, int iterations);
 
 	public static native void convertNV21toGL(byte[] ain, byte[] aout, int width, int height, int outWidth,
 			int outHeight);
-	public static native void convertNV21toGLN(int ain, byte[] aout, int width, int height, int outWidth,
+	public static native void convertNV21toGLN(long ain, byte[] aout, int width, int height, int outWidth,
 			int outHeight);
 	
 	public static native void addCornersRGBA8888(byte[] rgb_out, int outWidth, int outHeight);
 	
-	public static synchronized native int[] NV21toARGB(int inptr, Size src, Rect rect, Size dst);
+	public static synchronized native int[] NV21toARGB(long inptr, Size src, Rect rect, Size dst);
 
 	
 	static
@@ -61,7 +70,7 @@ public class ImageConversion
 		System.loadLibrary("utils-jni");
 	}
 
-	public static native void resizeJpeg2RGBA(int jpeg, int jpeg_length, byte[] rgb_out,
+	public static native void resizeJpeg2RGBA(long jpeg, int jpeg_length, byte[] rgb_out,
 			int inHeight, int inWidth, int outWidth, int outHeight, boolean mirror);
 
 	/**
@@ -130,7 +139,7 @@ public class ImageConversion
 	}
 
 	// Convert YUV to Bitmap. Width and height of bitmap are as close as possible to screen size.
-	public static Bitmap decodeYUVfromBuffer(int yuv, int width, int height)
+	public static Bitmap decodeYUVfromBuffer(long yuv, int width, int height)
 	{
 		Size mInputFrameSize = new Size(width, height);
 		Size mOutputFrameSize = null;
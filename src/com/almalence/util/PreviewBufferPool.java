@@ -0,0 +1,100 @@
+/*
+The contents of this file are subject to the Mozilla Public License
+Version 1.1 (the "License"); you may not use this file except in
+compliance with the License. You may obtain a copy of the License at
+http://www.mozilla.org/MPL/
+
+Software distributed under the License is distributed on an "AS IS"
+basis, WITHOUT WARRANTY OF ANY KIND, either express or implied. See the
+License for the specific language governing rights and limitations
+under the License.
+
+The Original Code is collection of files collectively known as Open Camera.
+
+The Initial Developer of the Original Code is Almalence Inc.
+Portions created by Initial Developer are Copyright (C) 2013
+by Almalence Inc. All Rights Reserved.
+ */
+
+package com.almalence.util;
+
+import java.util.ArrayDeque;
+import java.util.Iterator;
+
+/**
+ * Pool of reusable preview frame arrays.
+ *
+ * Preview consumers take byte[] frames and native code pins them with
+ * GetPrimitiveArrayCritical, so a frame needs no copy once it is in an array.
+ * The pool saves the allocation of a new full-frame array for every preview
+ * frame where the camera does not hand out an array of its own (Camera2).
+ *
+ * Arrays are reused oldest first and the most recently released one is kept,
+ * so the previous frame stays intact while the next one is filled - as some
+ * plugins compare two consecutive frames.
+ */
+public final class PreviewBufferPool
+{
+	// arrays released last which are not handed out again yet
+	private static final int				KEEP_BUFFERS		= 1;
+
+	// free arrays kept for reuse, preview size rarely changes so a few are
+	// enough
+	private static final int				MAX_FREE_BUFFERS	= 4;
+
+	private static final ArrayDeque<byte[]>	freeBuffers			= new ArrayDeque<byte[]>();
+
+	private PreviewBufferPool()
+	{
+	}
+
+	/**
+	 * Return an array of exactly size bytes, or null if there is no memory for
+	 * a new one. The content is undefined.
+	 */
+	public static synchronized byte[] acquire(int size)
+	{
+		// the last KEEP_BUFFERS released arrays are not reused yet
+		int reusable = freeBuffers.size() - KEEP_BUFFERS;
+		Iterator<byte[]> it = freeBuffers.iterator();
+		for (int i = 0; i < reusable; i++)
+		{
+			byte[] buffer = it.next();
+			if (buffer.length == size)
+			{
+				it.remove();
+				return buffer;
+			}
+		}
+
+		try
+		{
+			return new byte[size];
+		} catch (OutOfMemoryError e)
+		{
+			// drop what we hold and let the caller skip this frame
+			freeBuffers.clear();
+			return null;
+		}
+	}
+
+	/**
+	 * Return buffer to the pool. The caller must not write it afterwards, it
+	 * stays readable until KEEP_BUFFERS more arrays were released.
+	 */
+	public static synchronized void release(byte[] buffer)
+	{
+		if (buffer == null)
+			return;
+
+		if (freeBuffers.size() >= MAX_FREE_BUFFERS)
+			freeBuffers.pollFirst();
+		freeBuffers.addLast(buffer);
+	}
+
+	// Free all pooled arrays, e.g. when preview size changes
+	public static synchronized void clear()
+	{
+		freeBuffers.clear();
+	}
+}